@@ -113,8 +113,11 @@ SOURCES += \
     caretlist.cpp \
     codesnippetsmanager.cpp \
     colorscheme.cpp \
+    compiler/benchmarkrunner.cpp \
     compiler/compilerinfo.cpp \
+    compiler/compilerprobecache.cpp \
     compiler/ojproblemcasesrunner.cpp \
+    compiler/profilerunner.cpp \
     compiler/projectcompiler.cpp \
     compiler/runner.cpp \
     customfileiconprovider.cpp \
@@ -132,7 +135,9 @@ SOURCES += \
     parser/cppparser.cpp \
     parser/cpppreprocessor.cpp \
     parser/cpptokenizer.cpp \
+    parser/inactivelineranges.cpp \
     parser/parserutils.cpp \
+    parser/semantictokens.cpp \
     parser/statementmodel.cpp \
     problems/competitivecompenionhandler.cpp \
     problems/freeprojectsetformat.cpp \
@@ -173,6 +178,7 @@ SOURCES += \
     syntaxermanager.cpp \
     thememanager.cpp \
     todoparser.cpp \
+    todoscanner.cpp \
     toolsmanager.cpp \
     visithistorymanager.cpp \
     widgets/aboutdialog.cpp \
@@ -184,6 +190,7 @@ SOURCES += \
     widgets/cpudialog.cpp \
     editor.cpp \
     editorlist.cpp \
+    headerindex.cpp \
     iconsmanager.cpp \
     main.cpp \
     mainwindow.cpp \
@@ -249,12 +256,15 @@ HEADERS += \
     caretlist.h \
     codesnippetsmanager.h \
     colorscheme.h \
+    compiler/benchmarkrunner.h \
     compiler/compiler.h \
     compiler/compilerinfo.h \
+    compiler/compilerprobecache.h \
     compiler/compilermanager.h \
     compiler/executablerunner.h \
     compiler/filecompiler.h \
     compiler/ojproblemcasesrunner.h \
+    compiler/profilerunner.h \
     compiler/projectcompiler.h \
     compiler/runner.h \
     compiler/stdincompiler.h \
@@ -268,7 +278,9 @@ HEADERS += \
     parser/cppparser.h \
     parser/cpppreprocessor.h \
     parser/cpptokenizer.h \
+    parser/inactivelineranges.h \
     parser/parserutils.h \
+    parser/semantictokens.h \
     parser/statementmodel.h \
     problems/competitivecompenionhandler.h \
     problems/freeprojectsetformat.h \
@@ -309,6 +321,7 @@ HEADERS += \
     syntaxermanager.h \
     thememanager.h \
     todoparser.h \
+    todoscanner.h \
     toolsmanager.h \
     visithistorymanager.h \
     widgets/aboutdialog.h \
@@ -320,6 +333,7 @@ HEADERS += \
     widgets/cpudialog.h \
     editor.h \
     editorlist.h \
+    headerindex.h \
     iconsmanager.h \
     mainwindow.h \
     settingsdialog/compilersetdirectorieswidget.h \
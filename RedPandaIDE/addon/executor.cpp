@@ -16,6 +16,13 @@
  */
 #include "executor.h"
 
+#include <algorithm>
+#include <QCache>
+#include <QCryptographicHash>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+
 #include <lua/lua.hpp>
 
 #include "api.h"
@@ -83,6 +90,44 @@ extern "C" void luaHook_timeoutKiller(lua_State *L, lua_Debug *ar [[maybe_unused
     }
 };
 
+// total size (in bytes) of the cached bytecode of an interpreter
+#define BYTECODE_CACHE_SIZE (1024 * 1024)
+
+struct WarmInterpreter {
+    WarmInterpreter(const QString &kind, const QStringList &apis);
+
+    RaiiLuaState L;
+    int sandboxRef; // empty table, the only globals visible before `main()` is called
+    int globalsRef; // global table with libraries and APIs, read-only
+    QCache<QByteArray, QByteArray> bytecodeCache; // hash of name and source -> bytecode
+    QMutex mutex;
+};
+
+WarmInterpreter::WarmInterpreter(const QString &kind, const QStringList &apis)
+    : L(kind, {}),
+      bytecodeCache(BYTECODE_CACHE_SIZE)
+{
+    L.openLibs();
+    for (auto &api : apis)
+        registerApiGroup(L, api);
+    L.freezeGlobals();
+    L.newTable();
+    sandboxRef = L.ref();
+    L.pushGlobalTable();
+    globalsRef = L.ref();
+    L.setHook(&luaHook_timeoutKiller, LUA_MASKCOUNT, 1'000'000); // ~5ms on early 2020s desktop CPUs
+}
+
+static std::shared_ptr<WarmInterpreter> warmInterpreter(const QString &kind, const QStringList &apis) {
+    static QMutex mutex;
+    static QHash<QString, std::shared_ptr<WarmInterpreter>> interpreters;
+    QMutexLocker locker(&mutex);
+    std::shared_ptr<WarmInterpreter> &interpreter = interpreters[kind];
+    if (!interpreter)
+        interpreter = std::make_shared<WarmInterpreter>(kind, apis);
+    return interpreter;
+}
+
 ThemeExecutor::ThemeExecutor() : SimpleExecutor(
     "theme", 0, 1,
     {"C_Debug", "C_Desktop", "C_Util"})
@@ -99,8 +144,26 @@ QJsonObject ThemeExecutor::operator()(const QByteArray &script,
         throw LuaError("Theme script must return an object.");
 }
 
+QList<ScriptResult> ThemeExecutor::operator()(const QList<Script> &scripts) {
+    using namespace std::chrono_literals;
+    QList<Script> themeScripts;
+    for (const Script &script : scripts)
+        themeScripts.append({script.source, "theme:" + script.name});
+    QList<ScriptResult> results = SimpleExecutor::runScripts(themeScripts, 100ms);
+    for (ScriptResult &result : results) {
+        if (!result.error.isEmpty())
+            continue;
+        if (result.value.isNull())
+            result.value = QJsonObject();
+        else if (!result.value.isObject())
+            result.error = "Theme script must return an object.";
+    }
+    return results;
+}
+
 SimpleExecutor::SimpleExecutor(const QString &kind, int major, int minor, const QList<QString> &apis)
-    : mKind(kind), mMajor(major), mMinor(minor), mApis(apis)
+    : mKind(kind), mMajor(major), mMinor(minor), mApis(apis),
+      mInterpreter(warmInterpreter(kind, apis))
 {
 }
 
@@ -121,11 +184,67 @@ bool SimpleExecutor::apiVersionCheck(const QJsonObject &addonApi) {
 QJsonValue SimpleExecutor::runScript(const QByteArray &script,
                                      const QString &name,
                                      std::chrono::microseconds timeLimit) {
-    RaiiLuaState L(name, timeLimit);
-    int retLoad = L.loadBuffer(script, name);
-    if (retLoad != 0)
-        throw LuaError(QString("Lua load error: %1.").arg(L.popString()));
-    L.setHook(&luaHook_timeoutKiller, LUA_MASKCOUNT, 1'000'000); // ~5ms on early 2020s desktop CPUs
+    QMutexLocker locker(&mInterpreter->mutex);
+    return runScriptInInterpreter(script, name, timeLimit);
+}
+
+QList<ScriptResult> SimpleExecutor::runScripts(const QList<Script> &scripts,
+                                               std::chrono::microseconds timeLimit) {
+    QList<ScriptResult> results;
+    QMutexLocker locker(&mInterpreter->mutex);
+    for (const Script &script : scripts) {
+        try {
+            results.append({runScriptInInterpreter(script.source, script.name, timeLimit), QString()});
+        } catch (const LuaError &e) {
+            results.append({QJsonValue(), e.reason()});
+        }
+    }
+    return results;
+}
+
+QJsonValue SimpleExecutor::runScriptInInterpreter(const QByteArray &script,
+                                                  const QString &name,
+                                                  std::chrono::microseconds timeLimit) {
+    RaiiLuaState &L = mInterpreter->L;
+    int base = L.getTop();
+    auto action = finally([&L, base]{
+        L.setTop(base);
+    });
+    L.setName(name);
+    L.setTimeLimit(timeLimit);
+
+    // environment of the script: [base+1] metatable, [base+2] env
+    // before `main()`, nothing is visible to the script, as with a fresh state
+    L.newTable();
+    L.pushRef(mInterpreter->sandboxRef);
+    L.setField(-2, "__index");
+    L.push(false);
+    L.setField(-2, "__metatable"); // the script can't reach the sandbox through the metatable
+    L.newTable();
+    L.pushValue(base + 1);
+    L.setMetaTable(-2);
+
+    // compiling is the most expensive part for small scripts, reuse the bytecode
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(name.toUtf8());
+    hash.addData("\0", 1);
+    hash.addData(script);
+    QByteArray key = hash.result();
+    const QByteArray *bytecode = mInterpreter->bytecodeCache.object(key);
+    if (bytecode) {
+        int retLoad = L.loadBuffer(*bytecode, name, "b");
+        if (retLoad != 0)
+            throw LuaError(QString("Lua load error: %1.").arg(L.popString()));
+    } else {
+        int retLoad = L.loadBuffer(script, name, "t");
+        if (retLoad != 0)
+            throw LuaError(QString("Lua load error: %1.").arg(L.popString()));
+        QByteArray *dumped = new QByteArray(L.dump());
+        // the least recently used chunks are dropped when the cache is full
+        mInterpreter->bytecodeCache.insert(key, dumped, std::max(1, dumped->size()));
+    }
+    L.pushValue(base + 2);
+    L.setUpvalue(-2, 1); // _ENV
     L.setTimeStart();
     int callResult = L.pCall(0, 0, 0);
     if (callResult != 0) {
@@ -133,7 +252,7 @@ QJsonValue SimpleExecutor::runScript(const QByteArray &script,
     }
 
     // call `apiVersion()` to check compatibility
-    int type = L.getGlobal("apiVersion");
+    int type = L.getField(base + 2, "apiVersion");
     if (type != LUA_TFUNCTION) {
         throw LuaError("Add-on interface error: `apiVersion` is not a function.");
     }
@@ -148,10 +267,12 @@ QJsonValue SimpleExecutor::runScript(const QByteArray &script,
     }
 
     // inject APIs and call `main()`
-    L.openLibs();
-    for (auto &api : mApis)
-        registerApiGroup(L, api);
-    type = L.getGlobal("main");
+    // the shared globals are read-only, writes (also through `_G`) go to the script's own environment
+    L.pushRef(mInterpreter->globalsRef);
+    L.setField(base + 1, "__index");
+    L.pushValue(base + 2);
+    L.setField(base + 2, "_G");
+    type = L.getField(base + 2, "main");
     if (type != LUA_TFUNCTION) {
         throw LuaError("Add-on interface error: `main` is not a function.");
     }
@@ -159,7 +280,7 @@ QJsonValue SimpleExecutor::runScript(const QByteArray &script,
     if (callResult != 0) {
         throw LuaError(QString("Lua error: %1.").arg(L.popString()));
     }
-    return L.fetch(1);
+    return L.fetch(-1);
 }
 
 CompilerHintExecutor::CompilerHintExecutor() : SimpleExecutor(
@@ -21,10 +21,26 @@
 #include <QJsonObject>
 #include <QStringList>
 #include <chrono>
+#include <memory>
 
 namespace AddOn {
 
-// simple, stateless Lua executor
+struct Script {
+    QByteArray source;
+    QString name;
+};
+
+struct ScriptResult {
+    QJsonValue value;
+    QString error; // empty if succeeded
+};
+
+struct WarmInterpreter;
+
+// simple Lua executor
+// Scripts of the same kind share a warm interpreter (with libraries and APIs
+// loaded) and compiled chunks, but each script runs in its own environment,
+// and the shared globals and libraries are read-only.
 class SimpleExecutor {
 protected:
     SimpleExecutor(const QString &kind, int major, int minor, const QList<QString> &apis);
@@ -33,18 +49,28 @@ protected:
 
     QJsonValue runScript(const QByteArray &script, const QString &name,
                          std::chrono::microseconds timeLimit);
+    // run scripts one by one in the interpreter, without releasing it between them
+    // each script has its own environment and its own time limit
+    QList<ScriptResult> runScripts(const QList<Script> &scripts,
+                                   std::chrono::microseconds timeLimit);
+
+private:
+    QJsonValue runScriptInInterpreter(const QByteArray &script, const QString &name,
+                                      std::chrono::microseconds timeLimit);
 
 private:
     QString mKind;
     int mMajor;
     int mMinor;
     QStringList mApis;
+    std::shared_ptr<WarmInterpreter> mInterpreter;
 };
 
 class ThemeExecutor : private SimpleExecutor {
 public:
     ThemeExecutor();
     QJsonObject operator()(const QByteArray &script, const QString &name);
+    QList<ScriptResult> operator()(const QList<Script> &scripts);
 };
 
 class CompilerHintExecutor : private SimpleExecutor {
@@ -153,6 +153,11 @@ void RaiiLuaState::push(decltype(nullptr))
     lua_pushnil(mLua);
 }
 
+void RaiiLuaState::push(bool value)
+{
+    lua_pushboolean(mLua, value);
+}
+
 void RaiiLuaState::push(const QMap<QString, lua_CFunction> &value)
 {
     lua_newtable(mLua);
@@ -213,6 +218,24 @@ int RaiiLuaState::loadBuffer(const QByteArray &buff, const QString &name)
     return luaL_loadbuffer(mLua, buff.constData(), buff.size(), name.toUtf8().constData());
 }
 
+int RaiiLuaState::loadBuffer(const QByteArray &buff, const QString &name, const char *mode)
+{
+    return luaL_loadbufferx(mLua, buff.constData(), buff.size(), name.toUtf8().constData(), mode);
+}
+
+static int luaWriter_appendByteArray(lua_State *L [[maybe_unused]], const void *p, size_t sz, void *ud)
+{
+    static_cast<QByteArray *>(ud)->append(static_cast<const char *>(p), sz);
+    return 0;
+}
+
+QByteArray RaiiLuaState::dump()
+{
+    QByteArray result;
+    lua_dump(mLua, &luaWriter_appendByteArray, &result, 0);
+    return result;
+}
+
 void RaiiLuaState::openLibs()
 {
     luaL_openlibs(mLua);
@@ -233,15 +256,214 @@ void RaiiLuaState::setGlobal(const QString &name)
     return lua_setglobal(mLua, name.toUtf8().constData());
 }
 
+int RaiiLuaState::getField(int index, const QString &name)
+{
+    return lua_getfield(mLua, index, name.toUtf8().constData());
+}
+
+void RaiiLuaState::setField(int index, const QString &name)
+{
+    lua_setfield(mLua, index, name.toUtf8().constData());
+}
+
 void RaiiLuaState::setHook(lua_Hook f, int mask, int count)
 {
     lua_sethook(mLua, f, mask, count);
 }
 
+void RaiiLuaState::newTable()
+{
+    lua_newtable(mLua);
+}
+
+void RaiiLuaState::pushValue(int index)
+{
+    lua_pushvalue(mLua, index);
+}
+
+void RaiiLuaState::pushGlobalTable()
+{
+    lua_pushglobaltable(mLua);
+}
+
+void RaiiLuaState::setMetaTable(int index)
+{
+    lua_setmetatable(mLua, index);
+}
+
+void RaiiLuaState::setUpvalue(int funcIndex, int n)
+{
+    lua_setupvalue(mLua, funcIndex, n);
+}
+
+void RaiiLuaState::setTop(int index)
+{
+    lua_settop(mLua, index);
+}
+
+int RaiiLuaState::ref()
+{
+    return luaL_ref(mLua, LUA_REGISTRYINDEX);
+}
+
+void RaiiLuaState::pushRef(int ref)
+{
+    lua_rawgeti(mLua, LUA_REGISTRYINDEX, ref);
+}
+
+static const char *const READ_ONLY_MARKER = "__readonly";
+
+static int luaReadOnly_newIndex(lua_State *L)
+{
+    return luaL_error(L, "attempt to modify a read-only table");
+}
+
+// upvalue 1: contents of the read-only table, never handed to the scripts
+static int luaReadOnly_next(lua_State *L)
+{
+    lua_settop(L, 2);
+    lua_pushvalue(L, lua_upvalueindex(1));
+    lua_pushvalue(L, 2);
+    if (lua_next(L, -2))
+        return 2;
+    lua_pushnil(L);
+    return 1;
+}
+
+// upvalue 1: contents of the read-only table
+static int luaReadOnly_pairs(lua_State *L)
+{
+    lua_pushvalue(L, lua_upvalueindex(1));
+    lua_pushcclosure(L, &luaReadOnly_next, 1);
+    lua_pushvalue(L, 1);
+    lua_pushnil(L);
+    return 3;
+}
+
+// upvalue 1: contents of the read-only table
+static int luaReadOnly_len(lua_State *L)
+{
+    lua_pushinteger(L, luaL_len(L, lua_upvalueindex(1)));
+    return 1;
+}
+
+static bool isReadOnlyTable(lua_State *L, int index)
+{
+    if (!lua_getmetatable(L, index))
+        return false;
+    lua_pushstring(L, READ_ONLY_MARKER);
+    lua_rawget(L, -2);
+    bool result = lua_toboolean(L, -1);
+    lua_pop(L, 2);
+    return result;
+}
+
+// rawset() that doesn't write into read-only tables
+static int luaReadOnly_rawset(lua_State *L)
+{
+    luaL_checktype(L, 1, LUA_TTABLE);
+    luaL_checkany(L, 2);
+    luaL_checkany(L, 3);
+    if (isReadOnlyTable(L, 1))
+        return luaReadOnly_newIndex(L);
+    lua_settop(L, 3);
+    lua_rawset(L, 1);
+    return 1;
+}
+
+// Moves the contents of the table at `index` into a hidden table, and lets the
+// (now empty) table read them through its metatable.
+// The table at `visited` records the tables already frozen.
+static void freezeTable(lua_State *L, int index, int visited)
+{
+    lua_pushvalue(L, index);
+    lua_pushboolean(L, 1);
+    lua_rawset(L, visited);
+
+    lua_newtable(L);
+    int contents = lua_gettop(L);
+    lua_pushnil(L);
+    while (lua_next(L, index)) {
+        // [contents] key value
+        lua_pushvalue(L, -2);
+        lua_insert(L, -2);
+        lua_rawset(L, contents);
+        // clearing the current field is allowed while traversing
+        lua_pushvalue(L, -1);
+        lua_pushnil(L);
+        lua_rawset(L, index);
+    }
+
+    lua_newtable(L);
+    lua_pushvalue(L, contents);
+    lua_setfield(L, -2, "__index");
+    lua_pushcfunction(L, &luaReadOnly_newIndex);
+    lua_setfield(L, -2, "__newindex");
+    lua_pushvalue(L, contents);
+    lua_pushcclosure(L, &luaReadOnly_pairs, 1);
+    lua_setfield(L, -2, "__pairs");
+    lua_pushvalue(L, contents);
+    lua_pushcclosure(L, &luaReadOnly_len, 1);
+    lua_setfield(L, -2, "__len");
+    lua_pushboolean(L, 0);
+    lua_setfield(L, -2, "__metatable"); // setmetatable() can't remove the protection
+    lua_pushboolean(L, 1);
+    lua_setfield(L, -2, READ_ONLY_MARKER);
+    lua_setmetatable(L, index);
+
+    // freeze the tables in it too
+    lua_pushnil(L);
+    while (lua_next(L, contents)) {
+        if (lua_type(L, -1) == LUA_TTABLE) {
+            lua_pushvalue(L, -1);
+            lua_rawget(L, visited);
+            bool frozen = lua_toboolean(L, -1);
+            lua_pop(L, 1);
+            if (!frozen)
+                freezeTable(L, lua_gettop(L), visited);
+        }
+        lua_pop(L, 1);
+    }
+    lua_pop(L, 1); // contents
+}
+
+void RaiiLuaState::freezeGlobals()
+{
+    int top = lua_gettop(mLua);
+    lua_pushnil(mLua);
+    lua_setglobal(mLua, "debug");
+    luaL_getsubtable(mLua, LUA_REGISTRYINDEX, LUA_LOADED_TABLE);
+    lua_pushnil(mLua);
+    lua_setfield(mLua, -2, "debug");
+    lua_pushcfunction(mLua, &luaReadOnly_rawset);
+    lua_setglobal(mLua, "rawset");
+
+    // strings share a metatable, hide it from the scripts
+    lua_pushliteral(mLua, "");
+    if (lua_getmetatable(mLua, -1)) {
+        lua_pushboolean(mLua, 0);
+        lua_setfield(mLua, -2, "__metatable");
+    }
+
+    lua_newtable(mLua);
+    int visited = lua_gettop(mLua);
+    lua_pushglobaltable(mLua);
+    freezeTable(mLua, lua_gettop(mLua), visited);
+    lua_settop(mLua, top);
+}
+
 void RaiiLuaState::setTimeStart() {
     extraState().timeStart = std::chrono::system_clock::now();
 }
 
+void RaiiLuaState::setName(const QString &name) {
+    extraState().name = name;
+}
+
+void RaiiLuaState::setTimeLimit(std::chrono::microseconds timeLimit) {
+    extraState().timeLimit = timeLimit;
+}
+
 LuaExtraState &RaiiLuaState::extraState() {
     return mExtraState[mLua];
 }
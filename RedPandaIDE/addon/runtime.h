@@ -83,6 +83,7 @@ public:
     static QJsonValue pop(lua_State *L);
 
     void push(decltype(nullptr));
+    void push(bool value);
     void push(const QMap<QString, lua_CFunction> &value);
 
     static void push(lua_State *L, decltype(nullptr));
@@ -96,13 +97,35 @@ public:
     static int getTop(lua_State *L);
 
     int loadBuffer(const QByteArray &buff, const QString &name);
+    // mode: "b" (binary chunk only), "t" (text chunk only) or "bt"
+    int loadBuffer(const QByteArray &buff, const QString &name, const char *mode);
+    // bytecode of the function on the top of the stack
+    QByteArray dump();
     void openLibs();
     int pCall(int nargs, int nresults, int msgh);
     int getGlobal(const QString &name);
     void setGlobal(const QString &name);
+    int getField(int index, const QString &name);
+    void setField(int index, const QString &name);
     void setHook(lua_Hook f, int mask, int count);
 
+    void newTable();
+    void pushValue(int index);
+    void pushGlobalTable();
+    void setMetaTable(int index);
+    void setUpvalue(int funcIndex, int n);
+    void setTop(int index);
+    // pops the value on the top of the stack and keeps it in the registry
+    int ref();
+    void pushRef(int ref);
+    // Makes the global table and all the tables reachable from it (libraries,
+    // API groups) read-only, so scripts sharing the state can't change them.
+    // `debug` is removed, since it can get around the protection.
+    void freezeGlobals();
+
     void setTimeStart();
+    void setName(const QString &name);
+    void setTimeLimit(std::chrono::microseconds timeLimit);
     LuaExtraState &extraState();
     static LuaExtraState &extraState(lua_State *lua);
 
@@ -0,0 +1,435 @@
+/*
+ * Copyright (C) 2020-2022 Roy Qu (royqh1979@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "benchmarkrunner.h"
+#include "../utils.h"
+#include "../settings.h"
+#include "../systemconsts.h"
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QProcess>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#define BENCHMARK_REPORT_VERSION 1
+// relative change of the median that is reported as a regression/improvement
+#define BENCHMARK_REGRESSION_THRESHOLD 0.05
+
+BenchmarkRunner::BenchmarkRunner(const QString &filename, const QStringList &arguments, const QString &workDir,
+                                 const QVector<POJProblemCase> &problemCases, QObject *parent):
+    Runner(filename,arguments,workDir,parent),
+    mProblemCases(problemCases),
+    mRunCount(10),
+    mWarmupCount(1)
+{
+    setWaitForFinishTime(100);
+}
+
+int BenchmarkRunner::runCount() const
+{
+    return mRunCount;
+}
+
+void BenchmarkRunner::setRunCount(int newRunCount)
+{
+    mRunCount = std::max(1, newRunCount);
+}
+
+int BenchmarkRunner::warmupCount() const
+{
+    return mWarmupCount;
+}
+
+void BenchmarkRunner::setWarmupCount(int newWarmupCount)
+{
+    mWarmupCount = std::max(0, newWarmupCount);
+}
+
+const QString &BenchmarkRunner::inputFilename() const
+{
+    return mInputFilename;
+}
+
+void BenchmarkRunner::setInputFilename(const QString &newInputFilename)
+{
+    mInputFilename = newInputFilename;
+}
+
+const QStringList &BenchmarkRunner::binDirs() const
+{
+    return mBinDirs;
+}
+
+void BenchmarkRunner::addBinDirs(const QStringList &binDirs)
+{
+    mBinDirs.append(binDirs);
+}
+
+void BenchmarkRunner::addBinDir(const QString &binDir)
+{
+    mBinDirs.append(binDir);
+}
+
+bool BenchmarkRunner::runOnce(const QByteArray &input, const QString &consolePauser,
+                              const QProcessEnvironment &env, RunStatistics &statistics)
+{
+    memset(&statistics, 0, sizeof(RunStatistics));
+    QProcess process;
+    bool errorOccurred = false;
+    QString sharedMemoryId = PauserSharedMemory::generateId();
+    PauserSharedMemory sharedMemory(sharedMemoryId);
+    // The pauser measures the program itself (not the pauser), and reports
+    // cpu time and peak memory which can't be got from QProcess
+    bool usePauser = !consolePauser.isEmpty() && sharedMemory.create(0, 0);
+    if (usePauser) {
+        process.setProgram(consolePauser);
+        process.setArguments(QStringList{
+                                 "0",
+                                 sharedMemoryId,
+                                 localizePath(mFilename)
+                             } + mArguments);
+    } else {
+        process.setProgram(mFilename);
+        process.setArguments(mArguments);
+    }
+    process.setWorkingDirectory(mWorkDir);
+    process.setProcessEnvironment(env);
+    // output is not interesting, and must not block the program
+    process.setStandardOutputFile(QProcess::nullDevice());
+    process.setStandardErrorFile(QProcess::nullDevice());
+    process.connect(
+                &process, &QProcess::errorOccurred,
+                [&errorOccurred](){
+        errorOccurred= true;
+    });
+
+    QElapsedTimer elapsedTimer;
+    elapsedTimer.start();
+    process.start();
+    process.waitForStarted(5000);
+    if (process.state()==QProcess::Running) {
+        process.write(input);
+        process.closeWriteChannel();
+    }
+    while (true) {
+        process.waitForFinished(mWaitForFinishTime);
+        if (process.state()!=QProcess::Running)
+            break;
+        if (errorOccurred)
+            break;
+        if (mStop) {
+            process.terminate();
+            process.kill();
+            process.waitForFinished(1000);
+            return false;
+        }
+    }
+    qint64 wallTime = elapsedTimer.nsecsElapsed() / 1000;
+    if (errorOccurred && process.error()==QProcess::FailedToStart) {
+        emit runErrorOccurred(tr("The runner process '%1' failed to start.").arg(process.program()));
+        return false;
+    }
+    if (usePauser && sharedMemory.finished()) {
+        statistics = sharedMemory.statistics();
+        //termSignal is always 0 on Windows
+        if (process.exitStatus()==QProcess::CrashExit && statistics.termSignal==0)
+            statistics.termSignal = 1;
+    } else {
+        statistics.wallTime = wallTime;
+        statistics.exitCode = process.exitCode();
+        statistics.termSignal = (process.exitStatus()==QProcess::CrashExit)?1:0;
+    }
+    return true;
+}
+
+void BenchmarkRunner::run()
+{
+    emit started();
+    auto action = finally([this]{
+        emit terminated();
+    });
+    QString consolePauser;
+#ifdef Q_OS_WIN
+    consolePauser = includeTrailingPathDelimiter(pSettings->dirs().appDir())+CONSOLE_PAUSER;
+#else
+    consolePauser = includeTrailingPathDelimiter(pSettings->dirs().appLibexecDir())+CONSOLE_PAUSER;
+#endif
+    if (!fileExists(consolePauser))
+        consolePauser.clear();
+
+    QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+    QString path = env.value("PATH");
+    if (!path.isEmpty()) {
+        path = mBinDirs.join(PATH_SEPARATOR) + PATH_SEPARATOR + path;
+    } else {
+        path = mBinDirs.join(PATH_SEPARATOR);
+    }
+    env.insert("PATH",path);
+
+    QVector<QPair<QString,QByteArray>> inputs;
+    if (!mProblemCases.isEmpty()) {
+        foreach (const POJProblemCase& problemCase, mProblemCases) {
+            if (fileExists(problemCase->inputFileName))
+                inputs.append(qMakePair(problemCase->name, readFileToByteArray(problemCase->inputFileName)));
+            else
+                inputs.append(qMakePair(problemCase->name, problemCase->input.toLocal8Bit()));
+        }
+    } else if (!mInputFilename.isEmpty()) {
+        inputs.append(qMakePair(extractFileName(mInputFilename), readFileToByteArray(mInputFilename)));
+    } else {
+        inputs.append(qMakePair(extractFileName(mFilename), QByteArray()));
+    }
+
+    PBenchmarkReport report = std::make_shared<BenchmarkReport>();
+    report->executable = mFilename;
+    report->runCount = mRunCount;
+    report->warmupCount = mWarmupCount;
+    report->hasResourceUsage = !consolePauser.isEmpty();
+
+    int total = inputs.count() * (mWarmupCount + mRunCount);
+    int current = 0;
+    for (const QPair<QString,QByteArray>& input : inputs) {
+        PBenchmarkCaseResult result = std::make_shared<BenchmarkCaseResult>();
+        result->name = input.first;
+        result->failedRuns = 0;
+        for (int i=0; i<mWarmupCount+mRunCount; i++) {
+            if (mStop)
+                return;
+            current++;
+            emit runStarted(result->name, current, total);
+            RunStatistics statistics;
+            if (!runOnce(input.second, consolePauser, env, statistics))
+                return;
+            if (i<mWarmupCount)
+                continue;
+            //crashed or failed runs don't measure the normal path of the program
+            if (statistics.termSignal!=0 || statistics.exitCode!=0) {
+                result->failedRuns++;
+                continue;
+            }
+            result->wallTimes.append(statistics.wallTime);
+            result->cpuTimes.append(statistics.userTime + statistics.sysTime);
+            result->peakMemories.append(statistics.peakMemory);
+        }
+        report->cases.append(result);
+    }
+    emit benchmarkFinished(report);
+}
+
+BenchmarkReport::BenchmarkReport():
+    runCount{0},
+    warmupCount{0},
+    hasResourceUsage{false}
+{
+}
+
+PBenchmarkCaseResult BenchmarkReport::findCase(const QString &name) const
+{
+    foreach (const PBenchmarkCaseResult& result, cases) {
+        if (result->name == name)
+            return result;
+    }
+    return PBenchmarkCaseResult();
+}
+
+static QString formatSummaryRow(const QString& title, const QVector<qint64>& values, double scale,
+                                int precision, const QVector<qint64>* baselineValues)
+{
+    BenchmarkSummary summary = BenchmarkReport::summarize(values);
+    QString row = QString("  %1%2%3%4%5%6")
+            .arg(title, -14)
+            .arg(summary.min / scale, 12, 'f', precision)
+            .arg(summary.median / scale, 12, 'f', precision)
+            .arg(summary.p95 / scale, 12, 'f', precision)
+            .arg(summary.mean / scale, 12, 'f', precision)
+            .arg(std::sqrt(summary.variance) / scale, 12, 'f', precision);
+    if (baselineValues && !baselineValues->isEmpty()) {
+        BenchmarkSummary baseline = BenchmarkReport::summarize(*baselineValues);
+        if (baseline.median > 0) {
+            double change = (summary.median - baseline.median) / baseline.median;
+            // changes smaller than the noise of the measurements are not significant
+            double noise = std::max(std::sqrt(summary.variance), std::sqrt(baseline.variance));
+            row += QString("   %1 %2%")
+                    .arg(baseline.median / scale, 0, 'f', precision)
+                    .arg(change >= 0 ? QString("+%1").arg(change * 100, 0, 'f', 1)
+                                     : QString::number(change * 100, 'f', 1));
+            if (change > BENCHMARK_REGRESSION_THRESHOLD
+                    && summary.median - baseline.median > noise)
+                row += "  " + QObject::tr("REGRESSION");
+            else if (change < -BENCHMARK_REGRESSION_THRESHOLD
+                     && baseline.median - summary.median > noise)
+                row += "  " + QObject::tr("improved");
+        }
+    }
+    return row;
+}
+
+QStringList BenchmarkReport::format(const PBenchmarkReport &baseline) const
+{
+    QStringList lines;
+    lines.append(QObject::tr("Benchmark of \"%1\": %2 measured runs for each input, %3 warmup runs discarded.")
+                 .arg(executable).arg(runCount).arg(warmupCount));
+    if (!hasResourceUsage)
+        lines.append(QObject::tr("Console pauser not found, only wall time is measured."));
+    if (baseline)
+        lines.append(QObject::tr("Medians are compared with the saved baseline."));
+    foreach (const PBenchmarkCaseResult& result, cases) {
+        lines.append("");
+        lines.append(QObject::tr("Input \"%1\"").arg(result->name));
+        if (result->failedRuns>0)
+            lines.append(QObject::tr("  %1 runs failed or terminated abnormally and are not measured.").arg(result->failedRuns));
+        if (result->wallTimes.isEmpty())
+            continue;
+        QString header = QString("  %1%2%3%4%5%6")
+                .arg(QString(), -14)
+                .arg(QObject::tr("min"), 12)
+                .arg(QObject::tr("median"), 12)
+                .arg(QObject::tr("p95"), 12)
+                .arg(QObject::tr("mean"), 12)
+                .arg(QObject::tr("stddev"), 12);
+        PBenchmarkCaseResult baselineResult;
+        if (baseline) {
+            baselineResult = baseline->findCase(result->name);
+            if (baselineResult)
+                header += "   " + QObject::tr("baseline median / change");
+        }
+        lines.append(header);
+        lines.append(formatSummaryRow(QObject::tr("Wall (ms)"), result->wallTimes, 1000, 3,
+                                      baselineResult ? &baselineResult->wallTimes : nullptr));
+        if (hasResourceUsage) {
+            bool compareResourceUsage = baselineResult && baseline->hasResourceUsage;
+            lines.append(formatSummaryRow(QObject::tr("CPU (ms)"), result->cpuTimes, 1000, 3,
+                                          compareResourceUsage ? &baselineResult->cpuTimes : nullptr));
+            lines.append(formatSummaryRow(QObject::tr("Memory (KB)"), result->peakMemories, 1, 0,
+                                          compareResourceUsage ? &baselineResult->peakMemories : nullptr));
+        }
+    }
+    return lines;
+}
+
+static QJsonArray valuesToJson(const QVector<qint64>& values)
+{
+    QJsonArray array;
+    foreach (qint64 value, values)
+        array.append(value);
+    return array;
+}
+
+static QVector<qint64> valuesFromJson(const QJsonArray& array)
+{
+    QVector<qint64> values;
+    values.reserve(array.size());
+    foreach (const QJsonValue& value, array)
+        values.append(value.toVariant().toLongLong());
+    return values;
+}
+
+QJsonObject BenchmarkReport::toJson() const
+{
+    QJsonArray casesArray;
+    foreach (const PBenchmarkCaseResult& result, cases) {
+        QJsonObject obj;
+        obj["name"] = result->name;
+        obj["failedRuns"] = result->failedRuns;
+        obj["wall"] = valuesToJson(result->wallTimes);
+        obj["cpu"] = valuesToJson(result->cpuTimes);
+        obj["memory"] = valuesToJson(result->peakMemories);
+        casesArray.append(obj);
+    }
+    QJsonObject root;
+    root["version"] = BENCHMARK_REPORT_VERSION;
+    root["executable"] = executable;
+    root["runs"] = runCount;
+    root["warmups"] = warmupCount;
+    root["resourceUsage"] = hasResourceUsage;
+    root["cases"] = casesArray;
+    return root;
+}
+
+bool BenchmarkReport::save(const QString &filename) const
+{
+    QFile file(filename);
+    if (!file.open(QFile::WriteOnly | QFile::Truncate))
+        return false;
+    return file.write(QJsonDocument(toJson()).toJson()) >= 0;
+}
+
+PBenchmarkReport BenchmarkReport::load(const QString &filename)
+{
+    QFile file(filename);
+    if (!file.open(QFile::ReadOnly))
+        return PBenchmarkReport();
+    QJsonParseError error;
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &error);
+    if (error.error != QJsonParseError::NoError)
+        return PBenchmarkReport();
+    QJsonObject root = doc.object();
+    if (root["version"].toInt() != BENCHMARK_REPORT_VERSION)
+        return PBenchmarkReport();
+    PBenchmarkReport report = std::make_shared<BenchmarkReport>();
+    report->executable = root["executable"].toString();
+    report->runCount = root["runs"].toInt();
+    report->warmupCount = root["warmups"].toInt();
+    report->hasResourceUsage = root["resourceUsage"].toBool();
+    foreach (const QJsonValue& value, root["cases"].toArray()) {
+        QJsonObject obj = value.toObject();
+        PBenchmarkCaseResult result = std::make_shared<BenchmarkCaseResult>();
+        result->name = obj["name"].toString();
+        result->failedRuns = obj["failedRuns"].toInt();
+        result->wallTimes = valuesFromJson(obj["wall"].toArray());
+        result->cpuTimes = valuesFromJson(obj["cpu"].toArray());
+        result->peakMemories = valuesFromJson(obj["memory"].toArray());
+        report->cases.append(result);
+    }
+    return report;
+}
+
+QString BenchmarkReport::baselineFilename(const QString &executable)
+{
+    return changeFileExt(executable, "benchmark.json");
+}
+
+BenchmarkSummary BenchmarkReport::summarize(const QVector<qint64> &values)
+{
+    BenchmarkSummary summary{0, 0, 0, 0, 0};
+    int n = values.count();
+    if (n == 0)
+        return summary;
+    QVector<qint64> sorted = values;
+    std::sort(sorted.begin(), sorted.end());
+    summary.min = sorted.front();
+    if (n % 2 == 1)
+        summary.median = sorted[n / 2];
+    else
+        summary.median = (sorted[n / 2 - 1] + sorted[n / 2]) / 2.0;
+    // nearest-rank percentile
+    int p95Rank = (int)std::ceil(0.95 * n);
+    summary.p95 = sorted[std::max(p95Rank, 1) - 1];
+    double sum = 0;
+    foreach (qint64 value, sorted)
+        sum += value;
+    summary.mean = sum / n;
+    if (n > 1) {
+        double squares = 0;
+        foreach (qint64 value, sorted)
+            squares += (value - summary.mean) * (value - summary.mean);
+        summary.variance = squares / (n - 1);
+    }
+    return summary;
+}
@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2020-2022 Roy Qu (royqh1979@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef BENCHMARKRUNNER_H
+#define BENCHMARKRUNNER_H
+
+#include "runner.h"
+#include <QVector>
+#include <QJsonObject>
+#include "executablerunner.h"
+#include "../problems/ojproblemset.h"
+
+// Measurements of one input of the benchmark, warmup runs excluded
+struct BenchmarkCaseResult {
+    QString name;
+    QVector<qint64> wallTimes;    // us
+    QVector<qint64> cpuTimes;     // us, user + sys
+    QVector<qint64> peakMemories; // kb
+    int failedRuns;               // runs exited abnormally, not measured
+};
+
+using PBenchmarkCaseResult = std::shared_ptr<BenchmarkCaseResult>;
+
+struct BenchmarkSummary {
+    double min;
+    double median;
+    double p95;
+    double mean;
+    double variance;
+};
+
+class BenchmarkReport;
+using PBenchmarkReport = std::shared_ptr<BenchmarkReport>;
+
+class BenchmarkReport {
+public:
+    BenchmarkReport();
+    QString executable;
+    int runCount;
+    int warmupCount;
+    // cpu time and memory are only available when running through the console pauser
+    bool hasResourceUsage;
+    QVector<PBenchmarkCaseResult> cases;
+
+    PBenchmarkCaseResult findCase(const QString& name) const;
+
+    // text report, medians are compared with the baseline (if not null)
+    QStringList format(const PBenchmarkReport& baseline) const;
+
+    bool save(const QString& filename) const;
+    static PBenchmarkReport load(const QString& filename);
+    // the baseline file of an executable
+    static QString baselineFilename(const QString& executable);
+
+    static BenchmarkSummary summarize(const QVector<qint64>& values);
+private:
+    QJsonObject toJson() const;
+};
+
+Q_DECLARE_METATYPE(PBenchmarkReport);
+
+class BenchmarkRunner : public Runner
+{
+    Q_OBJECT
+public:
+    explicit BenchmarkRunner(const QString& filename, const QStringList& arguments, const QString& workDir,
+                             const QVector<POJProblemCase>& problemCases,
+                             QObject *parent = nullptr);
+    BenchmarkRunner(const BenchmarkRunner&)=delete;
+    BenchmarkRunner& operator=(const BenchmarkRunner&)=delete;
+
+    int runCount() const;
+    void setRunCount(int newRunCount);
+
+    int warmupCount() const;
+    void setWarmupCount(int newWarmupCount);
+
+    // used as stdin when there are no problem cases
+    const QString &inputFilename() const;
+    void setInputFilename(const QString &newInputFilename);
+
+    const QStringList &binDirs() const;
+    void addBinDirs(const QStringList &binDirs);
+    void addBinDir(const QString &binDir);
+
+signals:
+    void runStarted(const QString& caseName, int current, int total);
+    void benchmarkFinished(PBenchmarkReport report);
+private:
+    bool runOnce(const QByteArray& input, const QString& consolePauser,
+                 const QProcessEnvironment& env, RunStatistics& statistics);
+private:
+    QVector<POJProblemCase> mProblemCases;
+    int mRunCount;
+    int mWarmupCount;
+    QString mInputFilename;
+    QStringList mBinDirs;
+
+    // QThread interface
+protected:
+    void run() override;
+};
+
+#endif // BENCHMARKRUNNER_H
@@ -25,16 +25,14 @@
 #include "../mainwindow.h"
 #include "executablerunner.h"
 #include "ojproblemcasesrunner.h"
+#include "benchmarkrunner.h"
+#include "profilerunner.h"
 #include "utils.h"
 #include "utils/parsearg.h"
 #include "../systemconsts.h"
 #include "../settings.h"
 #include <QMessageBox>
-#include <QUuid>
 #include "projectcompiler.h"
-#ifdef Q_OS_MACOS
-#include <sys/posix_shm.h>
-#endif
 
 CompilerManager::CompilerManager(QObject *parent) : QObject(parent),
     mCompileMutex(),
@@ -249,7 +247,7 @@ void CompilerManager::run(
         if (pSettings->executor().enableVirualTerminalSequence())
             consoleFlag |= RPF_ENABLE_VIRTUAL_TERMINAL_PROCESSING;
         if (consoleFlag!=0) {
-            QString sharedMemoryId = QUuid::createUuid().toString();
+            QString sharedMemoryId = PauserSharedMemory::generateId();
             QString consolePauserPath = includeTrailingPathDelimiter(pSettings->dirs().appDir()) + CONSOLE_PAUSER;
             QStringList execArgs = QStringList{
                 consolePauserPath,
@@ -278,10 +276,7 @@ void CompilerManager::run(
         }
 #else
         QStringList execArgs;
-        QString sharedMemoryId = "/r"+QUuid::createUuid().toString(QUuid::StringFormat::Id128);
-#ifdef Q_OS_MACOS
-        sharedMemoryId = sharedMemoryId.mid(0, PSHMNAMLEN);
-#endif
+        QString sharedMemoryId = PauserSharedMemory::generateId();
         if (consoleFlag!=0) {
             QString consolePauserPath=includeTrailingPathDelimiter(pSettings->dirs().appLibexecDir())+"consolepauser";
             if (!fileExists(consolePauserPath)) {
@@ -335,6 +330,11 @@ void CompilerManager::run(
 
     execRunner->addBinDir(pSettings->dirs().appDir());
 
+    if (pSettings->executor().enableRunLimit()) {
+        execRunner->setCpuTimeLimit(pSettings->executor().runCpuTimeLimit());
+        execRunner->setMemoryLimit(pSettings->executor().runMemoryLimit());
+    }
+
     mRunner = execRunner;
 
     connect(mRunner, &Runner::finished, this ,&CompilerManager::onRunnerTerminated);
@@ -343,6 +343,7 @@ void CompilerManager::run(
     connect(mRunner, &Runner::pausingForFinish, pMainWindow ,&MainWindow::onRunPausingForFinish);
     connect(mRunner, &Runner::pausingForFinish, this ,&CompilerManager::onRunnerPausing);
     connect(mRunner, &Runner::runErrorOccurred, pMainWindow ,&MainWindow::onRunErrorOccured);
+    connect(execRunner, &ExecutableRunner::statisticsReady, pMainWindow, &MainWindow::onRunStatisticsReady);
     mRunner->start();
 }
 
@@ -395,6 +396,58 @@ void CompilerManager::doRunProblem(const QString &filename, const QString &argum
     mRunner->start();
 }
 
+void CompilerManager::runBenchmark(const QString &filename, const QString &arguments, const QString &workDir,
+                                   const QStringList &binDirs,
+                                   const QVector<POJProblemCase> &problemCases)
+{
+    QMutexLocker locker(&mRunnerMutex);
+    if (mRunner!=nullptr) {
+        return;
+    }
+    BenchmarkRunner * execRunner = new BenchmarkRunner(filename, parseArgumentsWithoutVariables(arguments), workDir, problemCases);
+    execRunner->setRunCount(pSettings->executor().benchmarkRuns());
+    execRunner->setWarmupCount(pSettings->executor().benchmarkWarmups());
+    if (problemCases.isEmpty()
+            && pSettings->executor().redirectInput()
+            && !pSettings->executor().inputFilename().isEmpty()) {
+        execRunner->setInputFilename(pSettings->executor().inputFilename());
+    }
+    execRunner->addBinDirs(binDirs);
+    execRunner->addBinDir(pSettings->dirs().appDir());
+    mRunner = execRunner;
+    connect(mRunner, &Runner::finished, this ,&CompilerManager::onRunnerTerminated);
+    connect(mRunner, &Runner::finished, mRunner ,&Runner::deleteLater);
+    connect(mRunner, &Runner::finished, pMainWindow ,&MainWindow::onRunFinished);
+    connect(mRunner, &Runner::runErrorOccurred, pMainWindow ,&MainWindow::onRunErrorOccured);
+    connect(execRunner, &BenchmarkRunner::runStarted, pMainWindow, &MainWindow::onBenchmarkRunStarted);
+    connect(execRunner, &BenchmarkRunner::benchmarkFinished, pMainWindow, &MainWindow::onBenchmarkFinished);
+    mRunner->start();
+}
+
+void CompilerManager::runProfile(const QString &filename, const QString &arguments, const QString &workDir,
+                                 const QStringList &binDirs)
+{
+    QMutexLocker locker(&mRunnerMutex);
+    if (mRunner!=nullptr) {
+        return;
+    }
+    ProfileRunner * execRunner = new ProfileRunner(filename, parseArgumentsWithoutVariables(arguments), workDir);
+    if (pSettings->executor().redirectInput()
+            && !pSettings->executor().inputFilename().isEmpty()) {
+        execRunner->setInputFilename(pSettings->executor().inputFilename());
+    }
+    execRunner->addBinDirs(binDirs);
+    execRunner->addBinDir(pSettings->dirs().appDir());
+    mRunner = execRunner;
+    connect(mRunner, &Runner::finished, this ,&CompilerManager::onRunnerTerminated);
+    connect(mRunner, &Runner::finished, mRunner ,&Runner::deleteLater);
+    connect(mRunner, &Runner::finished, pMainWindow ,&MainWindow::onRunFinished);
+    connect(mRunner, &Runner::runErrorOccurred, pMainWindow ,&MainWindow::onRunErrorOccured);
+    connect(execRunner, &ProfileRunner::logOutput, pMainWindow, &MainWindow::logToolsOutput);
+    connect(execRunner, &ProfileRunner::profileFinished, pMainWindow, &MainWindow::onProfileFinished);
+    mRunner->start();
+}
+
 void CompilerManager::stopRun()
 {
     QMutexLocker locker(&mRunnerMutex);
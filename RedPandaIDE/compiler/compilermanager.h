@@ -66,6 +66,11 @@ public:
     void runProblem(const QString& filename, const QString& arguments, const QString& workDir, const QVector<POJProblemCase> &problemCases,
                     const POJProblem& problem
                     );
+    void runBenchmark(const QString& filename, const QString& arguments, const QString& workDir,
+                      const QStringList& extraBinDir,
+                      const QVector<POJProblemCase> &problemCases);
+    void runProfile(const QString& filename, const QString& arguments, const QString& workDir,
+                    const QStringList& extraBinDir);
     void stopRun();
     void stopAllRunners();
     void stopPausing();
@@ -0,0 +1,171 @@
+/*
+ * Copyright (C) 2020-2022 Roy Qu (royqh1979@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "compilerprobecache.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+
+#define COMPILER_PROBE_CACHE_VERSION 1
+
+PCompilerProbeCache CompilerProbeCache::instance;
+
+CompilerProbeCache::CompilerProbeCache():
+    mModified{false}
+{
+}
+
+PCompilerProbeCache CompilerProbeCache::getInstance()
+{
+    if (!instance) {
+        instance = std::make_shared<CompilerProbeCache>();
+    }
+    return instance;
+}
+
+bool CompilerProbeCache::lookup(const QString &binFile, const QStringList &arguments, QByteArray &output)
+{
+    qint64 size, lastModified;
+    if (!fileStamp(binFile, size, lastModified))
+        return false;
+    QString key = QFileInfo(binFile).absoluteFilePath();
+    QMutexLocker locker(&mMutex);
+    mUsedKeys.insert(key);
+    PEntry entry = mEntries.value(key);
+    if (!entry)
+        return false;
+    if (entry->size != size || entry->lastModified != lastModified) {
+        //binary changed (upgraded), previous outputs are useless
+        mEntries.remove(key);
+        mModified = true;
+        return false;
+    }
+    auto it = entry->outputs.constFind(argumentsKey(arguments));
+    if (it == entry->outputs.constEnd())
+        return false;
+    output = it.value();
+    return true;
+}
+
+void CompilerProbeCache::store(const QString &binFile, const QStringList &arguments, const QByteArray &output)
+{
+    qint64 size, lastModified;
+    if (!fileStamp(binFile, size, lastModified))
+        return;
+    QString key = QFileInfo(binFile).absoluteFilePath();
+    QMutexLocker locker(&mMutex);
+    mUsedKeys.insert(key);
+    PEntry entry = mEntries.value(key);
+    if (!entry || entry->size != size || entry->lastModified != lastModified) {
+        entry = std::make_shared<Entry>();
+        entry->size = size;
+        entry->lastModified = lastModified;
+        mEntries.insert(key, entry);
+    }
+    entry->outputs.insert(argumentsKey(arguments), output);
+    mModified = true;
+}
+
+void CompilerProbeCache::load(const QString &filename)
+{
+    QMutexLocker locker(&mMutex);
+    mFilename = filename;
+    mEntries.clear();
+    mUsedKeys.clear();
+    mModified = false;
+    QFile file(filename);
+    if (!file.open(QFile::ReadOnly))
+        return;
+    QJsonParseError error;
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &error);
+    if (error.error != QJsonParseError::NoError)
+        return;
+    QJsonObject root = doc.object();
+    if (root["version"].toInt() != COMPILER_PROBE_CACHE_VERSION)
+        return;
+    QJsonArray compilers = root["compilers"].toArray();
+    for (const QJsonValue &value : compilers) {
+        QJsonObject obj = value.toObject();
+        PEntry entry = std::make_shared<Entry>();
+        entry->size = obj["size"].toVariant().toLongLong();
+        entry->lastModified = obj["lastModified"].toVariant().toLongLong();
+        QJsonObject outputs = obj["outputs"].toObject();
+        for (auto it = outputs.constBegin(); it != outputs.constEnd(); ++it) {
+            entry->outputs.insert(it.key(),
+                                  QByteArray::fromBase64(it.value().toString().toLatin1()));
+        }
+        mEntries.insert(obj["path"].toString(), entry);
+    }
+}
+
+void CompilerProbeCache::save()
+{
+    QMutexLocker locker(&mMutex);
+    if (mFilename.isEmpty())
+        return;
+    for (auto it = mEntries.begin(); it != mEntries.end();) {
+        if (mUsedKeys.contains(it.key())) {
+            ++it;
+        } else {
+            it = mEntries.erase(it);
+            mModified = true;
+        }
+    }
+    if (!mModified)
+        return;
+    QJsonArray compilers;
+    for (auto it = mEntries.constBegin(); it != mEntries.constEnd(); ++it) {
+        QJsonObject obj;
+        obj["path"] = it.key();
+        obj["size"] = QString::number(it.value()->size);
+        obj["lastModified"] = QString::number(it.value()->lastModified);
+        QJsonObject outputs;
+        for (auto outputIt = it.value()->outputs.constBegin();
+             outputIt != it.value()->outputs.constEnd(); ++outputIt) {
+            outputs[outputIt.key()] = QString::fromLatin1(outputIt.value().toBase64());
+        }
+        obj["outputs"] = outputs;
+        compilers.append(obj);
+    }
+    QJsonObject root;
+    root["version"] = COMPILER_PROBE_CACHE_VERSION;
+    root["compilers"] = compilers;
+    QFile file(mFilename);
+    if (!file.open(QFile::WriteOnly | QFile::Truncate))
+        return;
+    if (file.write(QJsonDocument(root).toJson()) >= 0)
+        mModified = false;
+}
+
+QString CompilerProbeCache::argumentsKey(const QStringList &arguments)
+{
+    return arguments.join(QChar('\n'));
+}
+
+bool CompilerProbeCache::fileStamp(const QString &binFile, qint64 &size, qint64 &lastModified)
+{
+    QFileInfo info(binFile);
+    if (!info.exists())
+        return false;
+    size = info.size();
+    lastModified = info.lastModified().toMSecsSinceEpoch();
+    return true;
+}
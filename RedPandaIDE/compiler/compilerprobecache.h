@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2020-2022 Roy Qu (royqh1979@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef COMPILERPROBECACHE_H
+#define COMPILERPROBECACHE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <memory>
+
+/*
+ * Outputs of the compiler probes ("gcc -v", "gcc -dumpmachine",
+ * "gcc -xc -v -E", ...) used when detecting compiler sets.
+ *
+ * Entries are keyed by the absolute path of the compiler binary and are
+ * only valid while the binary's size and modification time are unchanged.
+ * Entries not used since the cache is loaded (compilers that are removed or
+ * no longer found) are dropped when it's saved.
+ * The cache is thread safe so probes can run concurrently.
+ */
+class CompilerProbeCache
+{
+public:
+    CompilerProbeCache();
+    CompilerProbeCache(const CompilerProbeCache&)=delete;
+    CompilerProbeCache& operator=(const CompilerProbeCache&)=delete;
+
+    static std::shared_ptr<CompilerProbeCache> getInstance();
+
+    bool lookup(const QString& binFile, const QStringList& arguments, QByteArray& output);
+    void store(const QString& binFile, const QStringList& arguments, const QByteArray& output);
+
+    void load(const QString& filename);
+    void save();
+private:
+    struct Entry {
+        qint64 size;
+        qint64 lastModified;
+        QHash<QString,QByteArray> outputs; // arguments -> output
+    };
+    using PEntry = std::shared_ptr<Entry>;
+
+    static QString argumentsKey(const QStringList& arguments);
+    static bool fileStamp(const QString& binFile, qint64& size, qint64& lastModified);
+private:
+    static std::shared_ptr<CompilerProbeCache> instance;
+    QMutex mMutex;
+    QString mFilename;
+    QHash<QString,PEntry> mEntries;
+    QSet<QString> mUsedKeys;
+    bool mModified;
+};
+
+using PCompilerProbeCache = std::shared_ptr<CompilerProbeCache>;
+
+#endif // COMPILERPROBECACHE_H
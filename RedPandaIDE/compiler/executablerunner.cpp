@@ -20,8 +20,8 @@
 #include "compilermanager.h"
 #include "../settings.h"
 #include "../systemconsts.h"
-#ifdef Q_OS_WIN
 #include <QUuid>
+#ifdef Q_OS_WIN
 #include <windows.h>
 #else
 #include <sys/mman.h>
@@ -30,14 +30,169 @@
 #include <sys/stat.h>        /* For mode constants */
 #include <fcntl.h>           /* For O_* constants */
 #endif
+#ifdef Q_OS_MACOS
+#include <sys/posix_shm.h>
+#endif
+
+#define PAUSER_SHARED_MEMORY_SIZE 1024
+
+// Layout of the shared memory between Red Panda C++ and the console pauser.
+// Must be kept in sync with PauserSharedData in tools/consolepauser
+struct PauserSharedData {
+    char state[16];         // "FINISHED" after the program exits and the fields below are filled
+    // limits, 0 means no limit
+    qint64 cpuTimeLimit;    // ms
+    qint64 memoryLimit;     // kb
+    // statistics of the program
+    qint64 exitCode;
+    qint64 termSignal;
+    qint64 wallTime;        // us
+    qint64 userTime;        // us
+    qint64 sysTime;         // us
+    qint64 peakMemory;      // kb
+    qint64 minorPageFaults;
+    qint64 majorPageFaults;
+    qint64 voluntaryContextSwitches;
+    qint64 involuntaryContextSwitches;
+};
+
+PauserSharedMemory::PauserSharedMemory(const QString &id):
+    mId{id},
+    mBuf{nullptr},
+#ifdef Q_OS_WIN
+    mHandle{NULL}
+#else
+    mFd{-1}
+#endif
+{
+}
+
+PauserSharedMemory::~PauserSharedMemory()
+{
+    release();
+}
+
+QString PauserSharedMemory::generateId()
+{
+#ifdef Q_OS_WIN
+    return QUuid::createUuid().toString();
+#else
+    QString id = "/r"+QUuid::createUuid().toString(QUuid::StringFormat::Id128);
+#ifdef Q_OS_MACOS
+    id = id.mid(0, PSHMNAMLEN);
+#endif
+    return id;
+#endif
+}
 
+bool PauserSharedMemory::create(qint64 cpuTimeLimit, qint64 memoryLimit)
+{
+    release();
+#ifdef Q_OS_WIN
+    mHandle = CreateFileMappingA(
+                INVALID_HANDLE_VALUE,
+                NULL,
+                PAGE_READWRITE,
+                0,
+                PAUSER_SHARED_MEMORY_SIZE,
+                mId.toLocal8Bit().data()
+                );
+    if (mHandle != NULL)
+    {
+        mBuf = (char*) MapViewOfFile(mHandle,   // handle to map object
+                             FILE_MAP_ALL_ACCESS, // read/write permission
+                             0,
+                             0,
+                             PAUSER_SHARED_MEMORY_SIZE);
+    }
+#else
+    mFd = shm_open(mId.toLocal8Bit().data(),O_RDWR | O_CREAT,S_IRWXU);
+    if (mFd==-1) {
+        qDebug()<<QString("shm open failed %1:%2").arg(errno).arg(strerror(errno));
+    } else {
+        if (ftruncate(mFd,PAUSER_SHARED_MEMORY_SIZE)==-1){
+            qDebug()<<QString("truncate failed %1:%2").arg(errno).arg(strerror(errno));
+        } else {
+            mBuf = (char*)mmap(NULL,PAUSER_SHARED_MEMORY_SIZE,PROT_READ | PROT_WRITE, MAP_SHARED, mFd,0);
+            if (mBuf == MAP_FAILED) {
+                qDebug()<<QString("mmap failed %1:%2").arg(errno).arg(strerror(errno));
+                mBuf = nullptr;
+            }
+        }
+    }
+#endif
+    if (!mBuf)
+        return false;
+    PauserSharedData* pData = (PauserSharedData*)mBuf;
+    memset(pData, 0, sizeof(PauserSharedData));
+    pData->cpuTimeLimit = cpuTimeLimit;
+    pData->memoryLimit = memoryLimit;
+    return true;
+}
+
+bool PauserSharedMemory::isValid() const
+{
+    return mBuf!=nullptr;
+}
+
+bool PauserSharedMemory::finished() const
+{
+    if (!mBuf)
+        return false;
+    return strncmp(mBuf,"FINISHED",sizeof("FINISHED"))==0;
+}
+
+RunStatistics PauserSharedMemory::statistics() const
+{
+    RunStatistics statistics;
+    memset(&statistics, 0, sizeof(RunStatistics));
+    if (!mBuf)
+        return statistics;
+    const PauserSharedData* pData = (const PauserSharedData*)mBuf;
+    statistics.exitCode = pData->exitCode;
+    statistics.termSignal = pData->termSignal;
+    statistics.wallTime = pData->wallTime;
+    statistics.userTime = pData->userTime;
+    statistics.sysTime = pData->sysTime;
+    statistics.peakMemory = pData->peakMemory;
+    statistics.minorPageFaults = pData->minorPageFaults;
+    statistics.majorPageFaults = pData->majorPageFaults;
+    statistics.voluntaryContextSwitches = pData->voluntaryContextSwitches;
+    statistics.involuntaryContextSwitches = pData->involuntaryContextSwitches;
+    return statistics;
+}
+
+void PauserSharedMemory::release()
+{
+#ifdef Q_OS_WIN
+    if (mBuf) {
+        UnmapViewOfFile(mBuf);
+        mBuf = nullptr;
+    }
+    if (mHandle!=INVALID_HANDLE_VALUE && mHandle!=NULL) {
+        CloseHandle(mHandle);
+        mHandle = NULL;
+    }
+#else
+    if (mBuf) {
+        munmap(mBuf,PAUSER_SHARED_MEMORY_SIZE);
+        mBuf = nullptr;
+    }
+    if (mFd!=-1) {
+        shm_unlink(mId.toLocal8Bit().data());
+        mFd = -1;
+    }
+#endif
+}
 
 ExecutableRunner::ExecutableRunner(const QString &filename, const QStringList &arguments, const QString &workDir
                                    ,QObject* parent):
     Runner(filename,arguments,workDir,parent),
     mRedirectInput(false),
     mStartConsole(false),
-    mQuitSemaphore(0)
+    mQuitSemaphore(0),
+    mCpuTimeLimit(0),
+    mMemoryLimit(0)
 {
     setWaitForFinishTime(1000);
 }
@@ -97,6 +252,26 @@ void ExecutableRunner::setRedirectInputFilename(const QString &newDataFile)
     mRedirectInputFilename = newDataFile;
 }
 
+qint64 ExecutableRunner::cpuTimeLimit() const
+{
+    return mCpuTimeLimit;
+}
+
+void ExecutableRunner::setCpuTimeLimit(qint64 newCpuTimeLimit)
+{
+    mCpuTimeLimit = newCpuTimeLimit;
+}
+
+qint64 ExecutableRunner::memoryLimit() const
+{
+    return mMemoryLimit;
+}
+
+void ExecutableRunner::setMemoryLimit(qint64 newMemoryLimit)
+{
+    mMemoryLimit = newMemoryLimit;
+}
+
 void ExecutableRunner::run()
 {
     emit started();
@@ -138,47 +313,13 @@ void ExecutableRunner::run()
             args->startupInfo->dwFlags &= ~STARTF_USESTDHANDLES;
         }
     });
-    HANDLE hSharedMemory=INVALID_HANDLE_VALUE;
-    int BUF_SIZE=1024;
-    char* pBuf=nullptr;
-    if (mStartConsole) {
-        hSharedMemory = CreateFileMappingA(
-                INVALID_HANDLE_VALUE,
-                NULL,
-                PAGE_READWRITE,
-                0,
-                100,
-                mShareMemoryId.toLocal8Bit().data()
-                );
-        if (hSharedMemory != NULL)
-        {
-            pBuf = (char*) MapViewOfFile(hSharedMemory,   // handle to map object
-                                 FILE_MAP_ALL_ACCESS, // read/write permission
-                                 0,
-                                 0,
-                                 BUF_SIZE);
-            if (pBuf) {
-                pBuf[0]=0;
-            }
-        }
-    }
+#endif
+    PauserSharedMemory sharedMemory(mShareMemoryId);
+#ifdef Q_OS_WIN
+    if (mStartConsole)
+        sharedMemory.create(mCpuTimeLimit, mMemoryLimit);
 #else
-    int BUF_SIZE=1024;
-    char* pBuf=nullptr;
-    int fd_shm = shm_open(mShareMemoryId.toLocal8Bit().data(),O_RDWR | O_CREAT,S_IRWXU);
-    if (fd_shm==-1) {
-        qDebug()<<QString("shm open failed %1:%2").arg(errno).arg(strerror(errno));
-    } else {
-        if (ftruncate(fd_shm,BUF_SIZE)==-1){
-            qDebug()<<QString("truncate failed %1:%2").arg(errno).arg(strerror(errno));
-        } else {
-            pBuf = (char*)mmap(NULL,BUF_SIZE,PROT_READ | PROT_WRITE, MAP_SHARED, fd_shm,0);
-            if (pBuf == MAP_FAILED) {
-                qDebug()<<QString("mmap failed %1:%2").arg(errno).arg(strerror(errno));
-                pBuf = nullptr;
-            }
-        }
-    }
+    sharedMemory.create(mCpuTimeLimit, mMemoryLimit);
 #endif
 //    if (!redirectInput()) {
 //        process.closeWriteChannel();
@@ -214,45 +355,14 @@ void ExecutableRunner::run()
             }
             break;
         }
-        if (mStartConsole && !mPausing && pBuf) {
-            if (strncmp(pBuf,"FINISHED",sizeof("FINISHED"))==0) {
-#ifdef Q_OS_WIN
-                if (pBuf) {
-                    UnmapViewOfFile(pBuf);
-                    pBuf = nullptr;
-                }
-                if (hSharedMemory!=INVALID_HANDLE_VALUE && hSharedMemory!=NULL) {
-                    hSharedMemory = INVALID_HANDLE_VALUE;
-                    CloseHandle(hSharedMemory);
-                }
-#else
-                if (pBuf) {
-                    munmap(pBuf,BUF_SIZE);
-                    pBuf = nullptr;
-                }
-                if (fd_shm!=-1) {
-                    shm_unlink(mShareMemoryId.toLocal8Bit().data());
-                    fd_shm = -1;
-                }
-#endif
-                setPausing(true);
-                emit pausingForFinish();
-            }
+        if (mStartConsole && !mPausing && sharedMemory.finished()) {
+            emit statisticsReady(sharedMemory.statistics());
+            sharedMemory.release();
+            setPausing(true);
+            emit pausingForFinish();
         }
     }
-#ifdef Q_OS_WIN
-    if (pBuf)
-        UnmapViewOfFile(pBuf);
-    if (hSharedMemory!=INVALID_HANDLE_VALUE && hSharedMemory!=NULL)
-        CloseHandle(hSharedMemory);
-#else
-    if (pBuf) {
-        munmap(pBuf,BUF_SIZE);
-    }
-    if (fd_shm!=-1) {
-        shm_unlink(mShareMemoryId.toLocal8Bit().data());
-    }
-#endif
+    sharedMemory.release();
     if (errorOccurred) {
         //qDebug()<<"process error:"<<process.error();
         switch (mProcess->error()) {
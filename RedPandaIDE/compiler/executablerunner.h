@@ -22,6 +22,48 @@
 #include <QSemaphore>
 #include <memory>
 
+// Resource usage of a program run through the console pauser
+struct RunStatistics {
+    int exitCode;
+    int termSignal;  // signal that terminated the program, 0 if exited normally
+    qint64 wallTime; // us
+    qint64 userTime; // us
+    qint64 sysTime;  // us
+    qint64 peakMemory; // kb
+    qint64 minorPageFaults;
+    qint64 majorPageFaults;
+    qint64 voluntaryContextSwitches;
+    qint64 involuntaryContextSwitches;
+};
+
+Q_DECLARE_METATYPE(RunStatistics);
+
+// Shared memory used to talk with the console pauser
+class PauserSharedMemory {
+public:
+    explicit PauserSharedMemory(const QString& id);
+    ~PauserSharedMemory();
+    PauserSharedMemory(const PauserSharedMemory&)=delete;
+    PauserSharedMemory& operator=(const PauserSharedMemory&)=delete;
+
+    static QString generateId();
+
+    bool create(qint64 cpuTimeLimit, qint64 memoryLimit);
+    bool isValid() const;
+    // the pauser has filled the statistics
+    bool finished() const;
+    RunStatistics statistics() const;
+    void release();
+private:
+    QString mId;
+    char* mBuf;
+#ifdef Q_OS_WIN
+    void* mHandle;
+#else
+    int mFd;
+#endif
+};
+
 class ExecutableRunner : public Runner
 {
     Q_OBJECT
@@ -48,6 +90,15 @@ public:
     void addBinDirs(const QStringList &binDirs);
     void addBinDir(const QString &binDir);
 
+    qint64 cpuTimeLimit() const;
+    void setCpuTimeLimit(qint64 newCpuTimeLimit);
+
+    qint64 memoryLimit() const;
+    void setMemoryLimit(qint64 newMemoryLimit);
+
+signals:
+    void statisticsReady(const RunStatistics& statistics);
+
 private:
     QString mRedirectInputFilename;
     QString mShareMemoryId;
@@ -56,6 +107,8 @@ private:
     std::shared_ptr<QProcess> mProcess;
     QSemaphore mQuitSemaphore;
     QStringList mBinDirs;
+    qint64 mCpuTimeLimit; //ms, only enforced when running through the console pauser
+    qint64 mMemoryLimit; //kb, only enforced when running through the console pauser
 
     // QThread interface
 protected:
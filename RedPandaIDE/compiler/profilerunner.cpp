@@ -0,0 +1,432 @@
+/*
+ * Copyright (C) 2020-2022 Roy Qu (royqh1979@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "profilerunner.h"
+#include "../utils.h"
+#include "../settings.h"
+#include "../systemconsts.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QProcess>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <algorithm>
+
+// sampling frequency of perf (Hz)
+#define PERF_FREQUENCY "999"
+// sampling interval of the profile sampler (us)
+#define SAMPLER_INTERVAL "1000"
+
+ProfileReport::ProfileReport():
+    method{Method::Perf},
+    totalSamples{0},
+    programSamples{0},
+    mMaxLineSamples{0}
+{
+}
+
+void ProfileReport::addSamples(const QString &function, const QString &filename, int line, qint64 samples)
+{
+    programSamples += samples;
+    QString name = function.isEmpty() ? QString("??") : function;
+    PProfileFunction func = mFunctions.value(name);
+    if (!func) {
+        func = std::make_shared<ProfileFunction>();
+        func->name = name;
+        func->line = 0;
+        func->samples = 0;
+        mFunctions.insert(name, func);
+    }
+    func->samples += samples;
+    if (filename.isEmpty() || line <= 0)
+        return;
+    QString key = cleanPath(filename);
+    qint64 &samplesOfLine = mLineSamples[key][line];
+    samplesOfLine += samples;
+    // remember the hottest line of the function
+    if (func->filename.isEmpty()
+            || samplesOfLine > lineSamples(func->filename, func->line)) {
+        func->filename = key;
+        func->line = line;
+    }
+}
+
+void ProfileReport::finish()
+{
+    functions = mFunctions.values().toVector();
+    std::sort(functions.begin(), functions.end(),
+              [](const PProfileFunction& f1, const PProfileFunction& f2) {
+        return f1->samples > f2->samples;
+    });
+    mMaxLineSamples = 0;
+    foreach (const auto& lines, mLineSamples) {
+        foreach (qint64 samples, lines) {
+            mMaxLineSamples = std::max(mMaxLineSamples, samples);
+        }
+    }
+}
+
+double ProfileReport::lineHeat(const QString &filename, int line) const
+{
+    if (mMaxLineSamples <= 0)
+        return 0;
+    return (double)lineSamples(filename, line) / mMaxLineSamples;
+}
+
+qint64 ProfileReport::lineSamples(const QString &filename, int line) const
+{
+    auto it = mLineSamples.constFind(filename);
+    if (it == mLineSamples.constEnd())
+        return 0;
+    return it.value().value(line, 0);
+}
+
+QStringList ProfileReport::format(int maxFunctions) const
+{
+    QStringList lines;
+    lines.append(QObject::tr("Profile of \"%1\" (%2): %3 samples, %4 in the program.")
+                 .arg(executable)
+                 .arg(method == Method::Perf ? QString("perf") : QObject::tr("built-in sampler"))
+                 .arg(totalSamples)
+                 .arg(programSamples));
+    if (functions.isEmpty()) {
+        lines.append(QObject::tr("No samples in the program. It may exit too quickly, or be terminated abnormally."));
+        return lines;
+    }
+    lines.append("");
+    lines.append(QString("%1%2  %3  %4")
+                 .arg(QObject::tr("Samples"), 10)
+                 .arg(QObject::tr("Percent"), 8)
+                 .arg(QObject::tr("Function"), -32)
+                 .arg(QObject::tr("Hottest Line")));
+    int count = 0;
+    foreach (const PProfileFunction& func, functions) {
+        if (count >= maxFunctions)
+            break;
+        count++;
+        QString location;
+        if (!func->filename.isEmpty())
+            location = QString("%1:%2").arg(func->filename).arg(func->line);
+        lines.append(QString("%1%2%  %3  %4")
+                     .arg(func->samples, 10)
+                     .arg(totalSamples > 0 ? 100.0 * func->samples / totalSamples : 0, 7, 'f', 2)
+                     .arg(func->name, -32)
+                     .arg(location));
+    }
+    return lines;
+}
+
+ProfileRunner::ProfileRunner(const QString &filename, const QStringList &arguments, const QString &workDir, QObject *parent):
+    Runner(filename,arguments,workDir,parent)
+{
+    setWaitForFinishTime(100);
+}
+
+const QString &ProfileRunner::inputFilename() const
+{
+    return mInputFilename;
+}
+
+void ProfileRunner::setInputFilename(const QString &newInputFilename)
+{
+    mInputFilename = newInputFilename;
+}
+
+const QStringList &ProfileRunner::binDirs() const
+{
+    return mBinDirs;
+}
+
+void ProfileRunner::addBinDirs(const QStringList &binDirs)
+{
+    mBinDirs.append(binDirs);
+}
+
+void ProfileRunner::addBinDir(const QString &binDir)
+{
+    mBinDirs.append(binDir);
+}
+
+bool ProfileRunner::execute(const QString &program, const QStringList &arguments, const QProcessEnvironment &env)
+{
+    QProcess process;
+    bool errorOccurred = false;
+    process.setProgram(program);
+    process.setArguments(arguments);
+    process.setWorkingDirectory(mWorkDir);
+    process.setProcessEnvironment(env);
+    if (!mInputFilename.isEmpty())
+        process.setStandardInputFile(mInputFilename);
+    else
+        process.setStandardInputFile(QProcess::nullDevice());
+    process.setStandardOutputFile(QProcess::nullDevice());
+    process.setStandardErrorFile(QProcess::nullDevice());
+    process.connect(
+                &process, &QProcess::errorOccurred,
+                [&errorOccurred](){
+        errorOccurred= true;
+    });
+    process.start();
+    process.waitForStarted(5000);
+    while (true) {
+        process.waitForFinished(mWaitForFinishTime);
+        if (process.state()!=QProcess::Running)
+            break;
+        if (errorOccurred)
+            break;
+        if (mStop) {
+            process.terminate();
+            if (!process.waitForFinished(1000)) {
+                process.kill();
+                process.waitForFinished(1000);
+            }
+            return false;
+        }
+    }
+    if (errorOccurred && process.error()==QProcess::FailedToStart) {
+        emit runErrorOccurred(tr("The runner process '%1' failed to start.").arg(program));
+        return false;
+    }
+    return true;
+}
+
+PProfileReport ProfileRunner::profileByPerf(const QString &perf, const QString &dataDir, const QProcessEnvironment &env)
+{
+    QString dataFile = QDir(dataDir).absoluteFilePath("perf.data");
+    if (!execute(perf,
+                 QStringList{"record", "-q", "-F", PERF_FREQUENCY, "-o", dataFile, "--",
+                             localizePath(mFilename)} + mArguments,
+                 env))
+        return PProfileReport();
+    if (QFileInfo(dataFile).size() <= 0)
+        return PProfileReport();
+
+    // perf resolves the source lines itself (with libdw or addr2line), no network needed
+    QProcess process;
+    process.setProcessEnvironment(env);
+    process.start(perf, QStringList{"report", "-i", dataFile, "--stdio", "-q", "-n",
+                                    "-t", "|", "--full-source-path",
+                                    "--sort", "dso,sym,srcline"});
+    if (!process.waitForStarted(5000))
+        return PProfileReport();
+    process.closeWriteChannel();
+    QByteArray output;
+    while (!process.waitForFinished(mWaitForFinishTime)) {
+        output += process.readAllStandardOutput();
+        if (process.state()!=QProcess::Running)
+            break;
+        if (mStop) {
+            process.kill();
+            return PProfileReport();
+        }
+    }
+    output += process.readAllStandardOutput();
+    if (process.exitStatus()!=QProcess::NormalExit || process.exitCode()!=0)
+        return PProfileReport();
+
+    PProfileReport report = std::make_shared<ProfileReport>();
+    report->executable = mFilename;
+    report->method = ProfileReport::Method::Perf;
+    QString exeName = extractFileName(mFilename);
+    QStringList lines = textToLines(QString::fromLocal8Bit(output));
+    foreach (const QString& line, lines) {
+        if (line.trimmed().isEmpty() || line.trimmed().startsWith('#'))
+            continue;
+        // overhead | samples | dso | symbol | srcline
+        QStringList fields = line.split('|');
+        if (fields.count() < 5)
+            continue;
+        bool ok;
+        qint64 samples = fields[1].trimmed().toLongLong(&ok);
+        if (!ok)
+            continue;
+        report->totalSamples += samples;
+        if (extractFileName(fields[2].trimmed()) != exeName)
+            continue;
+        QString symbol = fields[3].trimmed();
+        if (symbol.startsWith('['))
+            symbol = symbol.mid(symbol.indexOf(']') + 1).trimmed();
+        QString srcLine = fields.mid(4).join('|').trimmed();
+        QString filename;
+        int lineNo = 0;
+        int pos = srcLine.lastIndexOf(':');
+        if (pos > 0) {
+            lineNo = srcLine.mid(pos + 1).toInt(&ok);
+            if (ok && srcLine.left(pos) != "??")
+                filename = sourceFilePath(srcLine.left(pos));
+            else
+                lineNo = 0;
+        }
+        report->addSamples(symbol, filename, lineNo, samples);
+    }
+    report->finish();
+    return report;
+}
+
+PProfileReport ProfileRunner::profileBySampler(const QString &sampler, const QString &dataDir, const QProcessEnvironment &env)
+{
+    QString samplesFile = QDir(dataDir).absoluteFilePath("samples.txt");
+    QProcessEnvironment programEnv = env;
+    QString preload = programEnv.value("LD_PRELOAD");
+    programEnv.insert("LD_PRELOAD", preload.isEmpty() ? sampler : sampler + ":" + preload);
+    programEnv.insert("REDPANDA_PROFILE_OUTPUT", samplesFile);
+    programEnv.insert("REDPANDA_PROFILE_INTERVAL", SAMPLER_INTERVAL);
+    if (!execute(mFilename, mArguments, programEnv))
+        return PProfileReport();
+
+    PProfileReport report = std::make_shared<ProfileReport>();
+    report->executable = mFilename;
+    report->method = ProfileReport::Method::Sampler;
+    // "address count" lines after the header
+    QStringList addresses;
+    QVector<qint64> addressSamples;
+    QStringList lines = readFileToLines(samplesFile);
+    foreach (const QString& line, lines) {
+        QStringList fields = line.split(' ', Qt::SkipEmptyParts);
+        if (fields.count() != 2)
+            continue;
+        if (fields[0] == "total") {
+            report->totalSamples = fields[1].toLongLong();
+            continue;
+        }
+        bool ok1, ok2;
+        fields[0].toULongLong(&ok1, 16);
+        qint64 samples = fields[1].toLongLong(&ok2);
+        if (!ok1 || !ok2)
+            continue;
+        addresses.append("0x" + fields[0]);
+        addressSamples.append(samples);
+    }
+    if (addresses.isEmpty()) {
+        report->finish();
+        return report;
+    }
+
+    QString addr2line = findTool(ADDR2LINE_PROGRAM);
+    if (addr2line.isEmpty()) {
+        emit logOutput(tr("Can't find \"%1\", samples are not symbolized.").arg(ADDR2LINE_PROGRAM));
+        for (int i=0;i<addresses.count();i++)
+            report->addSamples(addresses[i], QString(), 0, addressSamples[i]);
+        report->finish();
+        return report;
+    }
+    QProcess process;
+    process.setProcessEnvironment(env);
+    process.start(addr2line, QStringList{"-f", "-C", "-e", localizePath(mFilename)});
+    if (!process.waitForStarted(5000))
+        return PProfileReport();
+    process.write(addresses.join('\n').toLatin1());
+    process.write("\n");
+    process.closeWriteChannel();
+    QByteArray output;
+    while (!process.waitForFinished(mWaitForFinishTime)) {
+        output += process.readAllStandardOutput();
+        if (process.state()!=QProcess::Running)
+            break;
+        if (mStop) {
+            process.kill();
+            return PProfileReport();
+        }
+    }
+    output += process.readAllStandardOutput();
+    // two lines (function, file:line) for each address
+    QStringList symbols = textToLines(QString::fromLocal8Bit(output));
+    for (int i=0;i<addresses.count();i++) {
+        QString function = (2*i < symbols.count()) ? symbols[2*i].trimmed() : QString();
+        QString srcLine = (2*i+1 < symbols.count()) ? symbols[2*i+1].trimmed() : QString();
+        // strip " (discriminator n)"
+        int pos = srcLine.indexOf(" (");
+        if (pos > 0)
+            srcLine.truncate(pos);
+        QString filename;
+        int lineNo = 0;
+        pos = srcLine.lastIndexOf(':');
+        if (pos > 0 && !srcLine.startsWith("??")) {
+            bool ok;
+            lineNo = srcLine.mid(pos + 1).toInt(&ok);
+            if (ok)
+                filename = sourceFilePath(srcLine.left(pos));
+            else
+                lineNo = 0;
+        }
+        if (function == "??")
+            function = addresses[i];
+        report->addSamples(function, filename, lineNo, addressSamples[i]);
+    }
+    report->finish();
+    return report;
+}
+
+QString ProfileRunner::sourceFilePath(const QString &filename) const
+{
+    // relative paths in the debug info are relative to the build folder,
+    // which is the folder of the executable for the files/projects built by us
+    return generateAbsolutePath(extractFilePath(mFilename), filename);
+}
+
+QString ProfileRunner::findTool(const QString &name) const
+{
+    QString path = QStandardPaths::findExecutable(name, mBinDirs);
+    if (path.isEmpty())
+        path = QStandardPaths::findExecutable(name);
+    return path;
+}
+
+void ProfileRunner::run()
+{
+    emit started();
+    auto action = finally([this]{
+        emit terminated();
+    });
+#ifdef Q_OS_LINUX
+    QTemporaryDir dataDir;
+    if (!dataDir.isValid()) {
+        emit runErrorOccurred(tr("Can't create temporary folder for profile data."));
+        return;
+    }
+    QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+    QString path = env.value("PATH");
+    if (!path.isEmpty()) {
+        path = mBinDirs.join(PATH_SEPARATOR) + PATH_SEPARATOR + path;
+    } else {
+        path = mBinDirs.join(PATH_SEPARATOR);
+    }
+    env.insert("PATH",path);
+
+    PProfileReport report;
+    QString perf = findTool(PERF_PROGRAM);
+    if (!perf.isEmpty()) {
+        report = profileByPerf(perf, dataDir.path(), env);
+        if (mStop)
+            return;
+        if (!report)
+            emit logOutput(tr("Profiling with \"%1\" failed (check /proc/sys/kernel/perf_event_paranoid), use the built-in sampler instead.").arg(perf));
+    }
+    if (!report) {
+        QString sampler = includeTrailingPathDelimiter(pSettings->dirs().appLibexecDir())+PROFILE_SAMPLER;
+        if (!fileExists(sampler)) {
+            emit runErrorOccurred(tr("Can't find perf or the profile sampler \"%1\".").arg(sampler));
+            return;
+        }
+        report = profileBySampler(sampler, dataDir.path(), env);
+        if (mStop || !report)
+            return;
+    }
+    emit profileFinished(report);
+#else
+    emit runErrorOccurred(tr("Profiling is only supported on Linux."));
+#endif
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2020-2022 Roy Qu (royqh1979@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef PROFILERUNNER_H
+#define PROFILERUNNER_H
+
+#include "runner.h"
+#include <QHash>
+#include <QProcessEnvironment>
+#include <QVector>
+#include <memory>
+
+struct ProfileFunction {
+    QString name;
+    QString filename; // file of the hottest line
+    int line;         // hottest line
+    qint64 samples;
+};
+
+using PProfileFunction = std::shared_ptr<ProfileFunction>;
+
+class ProfileReport;
+using PProfileReport = std::shared_ptr<ProfileReport>;
+
+// Samples of a profiled run, symbolized against the executable
+class ProfileReport {
+public:
+    enum class Method {
+        Perf,
+        Sampler
+    };
+    ProfileReport();
+    QString executable;
+    Method method;
+    qint64 totalSamples;    // including samples outside of the executable
+    qint64 programSamples;  // samples inside the executable
+    QVector<PProfileFunction> functions; // sorted by samples (descending)
+
+    void addSamples(const QString& function, const QString& filename, int line, qint64 samples);
+    // sort functions and compute the hottest lines, must be called after all samples are added
+    void finish();
+
+    // 0 (no sample) ~ 1 (the hottest line)
+    double lineHeat(const QString& filename, int line) const;
+    qint64 lineSamples(const QString& filename, int line) const;
+    QStringList format(int maxFunctions) const;
+private:
+    QHash<QString, QHash<int,qint64>> mLineSamples; // filename -> line -> samples
+    QHash<QString, PProfileFunction> mFunctions;
+    qint64 mMaxLineSamples;
+};
+
+Q_DECLARE_METATYPE(PProfileReport);
+
+/*
+ * Runs the program under "perf record", or with the profile sampler
+ * (LD_PRELOAD library in tools/profsampler) when perf can't be used,
+ * and symbolizes the samples.
+ */
+class ProfileRunner : public Runner
+{
+    Q_OBJECT
+public:
+    explicit ProfileRunner(const QString& filename, const QStringList& arguments, const QString& workDir,
+                           QObject *parent = nullptr);
+    ProfileRunner(const ProfileRunner&)=delete;
+    ProfileRunner& operator=(const ProfileRunner&)=delete;
+
+    // used as stdin of the program, empty if none
+    const QString &inputFilename() const;
+    void setInputFilename(const QString &newInputFilename);
+
+    const QStringList &binDirs() const;
+    void addBinDirs(const QStringList &binDirs);
+    void addBinDir(const QString &binDir);
+
+signals:
+    void logOutput(const QString& msg);
+    void profileFinished(PProfileReport report);
+private:
+    bool execute(const QString& program, const QStringList& arguments,
+                 const QProcessEnvironment& env);
+    PProfileReport profileByPerf(const QString& perf, const QString& dataDir,
+                                 const QProcessEnvironment& env);
+    PProfileReport profileBySampler(const QString& sampler, const QString& dataDir,
+                                    const QProcessEnvironment& env);
+    QString sourceFilePath(const QString& filename) const;
+    QString findTool(const QString& name) const;
+private:
+    QString mInputFilename;
+    QStringList mBinDirs;
+
+    // QThread interface
+protected:
+    void run() override;
+};
+
+#endif // PROFILERUNNER_H
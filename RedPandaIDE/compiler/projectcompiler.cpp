@@ -179,7 +179,7 @@ void ProjectCompiler::writeMakeDefines(QFile &file, bool &genModuleDef)
     genModuleDef = false;
 
     // Create a list of object files
-    foreach(const PProjectUnit &unit, mProject->unitList()) {
+    foreach(const PProjectUnit &unit, mProject->units()) {
 
         // Only process source files
         FileType fileType = getFileType(unit->fileName());
@@ -371,7 +371,7 @@ void ProjectCompiler::writeMakeObjFilesRules(QFile &file)
     PCppParser parser = mProject->cppParser();
     QString precompileStr;
 
-    QList<PProjectUnit> projectUnits=mProject->unitList();
+    const QHash<QString,PProjectUnit>& projectUnits=mProject->units();
     foreach(const PProjectUnit &unit, projectUnits) {
         if (!unit->compile())
             continue;
@@ -388,17 +388,16 @@ void ProjectCompiler::writeMakeObjFilesRules(QFile &file)
         // if we have scanned it, use scanned info
         if (parser && parser->fileScanned(unit->fileName())) {
             QSet<QString> includedFiles = parser->getIncludedFiles(unit->fileName());
-            foreach(const PProjectUnit &unit2, projectUnits) {
-                if (unit2==unit)
+            foreach(const QString &includedFile, includedFiles) {
+                PProjectUnit unit2 = projectUnits.value(includedFile);
+                if (!unit2 || unit2==unit)
                     continue;
-                if (includedFiles.contains(unit2->fileName())) {
-                    if (mProject->options().usePrecompiledHeader &&
-                           unit2->fileName() == mProject->options().precompiledHeader)
-                        precompileStr = " $(PCH) ";
-                    else {
-                        QString prereq = extractRelativePath(mProject->makeFileName(), unit2->fileName());
-                        objStr = objStr + ' ' + escapeFilenameForMakefilePrerequisite(prereq);
-                    }
+                if (mProject->options().usePrecompiledHeader &&
+                       unit2->fileName() == mProject->options().precompiledHeader)
+                    precompileStr = " $(PCH) ";
+                else {
+                    QString prereq = extractRelativePath(mProject->makeFileName(), unit2->fileName());
+                    objStr = objStr + ' ' + escapeFilenameForMakefilePrerequisite(prereq);
                 }
             }
         } else {
@@ -509,7 +508,7 @@ void ProjectCompiler::writeMakeObjFilesRules(QFile &file)
 
         QString resFiles;
         // Concatenate all resource filenames (not created when syntax checking)
-        foreach(const PProjectUnit& unit, mProject->unitList()) {
+        foreach(const PProjectUnit& unit, mProject->units()) {
             if (getFileType(unit->fileName())!=FileType::WindowsResourceSource)
                 continue;
             if (fileExists(unit->fileName())) {
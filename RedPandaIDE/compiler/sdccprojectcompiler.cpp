@@ -110,7 +110,7 @@ void SDCCProjectCompiler::writeMakeDefines(QFile &file)
     QStringList cleanObjects;
 
     // Create a list of object files
-    foreach(const PProjectUnit &unit, mProject->unitList()) {
+    foreach(const PProjectUnit &unit, mProject->units()) {
         if (!unit->compile() && !unit->link())
             continue;
 
@@ -204,7 +204,7 @@ void SDCCProjectCompiler::writeMakeObjFilesRules(QFile &file)
 {
     PCppParser parser = mProject->cppParser();
 
-    QList<PProjectUnit> projectUnits=mProject->unitList();
+    const QHash<QString,PProjectUnit>& projectUnits=mProject->units();
     foreach(const PProjectUnit &unit, projectUnits) {
         if (!unit->compile())
             continue;
@@ -221,13 +221,12 @@ void SDCCProjectCompiler::writeMakeObjFilesRules(QFile &file)
         // if we have scanned it, use scanned info
         if (parser && parser->fileScanned(unit->fileName())) {
             QSet<QString> includedFiles = parser->getIncludedFiles(unit->fileName());
-            foreach(const PProjectUnit &unit2, projectUnits) {
-                if (unit2==unit)
+            foreach(const QString &includedFile, includedFiles) {
+                PProjectUnit unit2 = projectUnits.value(includedFile);
+                if (!unit2 || unit2==unit)
                     continue;
-                if (includedFiles.contains(unit2->fileName())) {
-                    QString header = extractRelativePath(mProject->makeFileName(),unit2->fileName());
-                    objStr = objStr + ' ' + escapeFilenameForMakefilePrerequisite(header);
-                }
+                QString header = extractRelativePath(mProject->makeFileName(),unit2->fileName());
+                objStr = objStr + ' ' + escapeFilenameForMakefilePrerequisite(header);
             }
         } else {
             foreach(const PProjectUnit &unit2, projectUnits) {
@@ -188,11 +188,11 @@ void CppRefacter::doFindOccurenceInProject(PStatement statement, std::shared_ptr
                 tr("Searching..."),
                 tr("Abort"),
                 0,
-                pMainWindow->project()->unitList().count(),
+                pMainWindow->project()->units().count(),
                 pMainWindow);
     progressDlg.setWindowModality(Qt::WindowModal);
     int i=0;
-    foreach (const PProjectUnit& unit, project->unitList()) {
+    foreach (const PProjectUnit& unit, project->units()) {
         i++;
         if (isCFile(unit->fileName()) || isHFile(unit->fileName())) {
             progressDlg.setValue(i);
@@ -222,9 +222,16 @@ PSearchResultTreeItem CppRefacter::findOccurenceInFile(
     parentItem->filename = filename;
     parentItem->parent = nullptr;
     QStringList buffer;
+    bool opened = pMainWindow->editorList()->getContentFromOpenedEditor(
+                filename,buffer);
+    // Only check the lines that have the symbol's name.
+    // Contents of opened editors may be changed after the last parse, so they are fully searched.
+    QVector<int> candidateLines;
+    bool indexed = !opened && parser->findIdentifierLines(filename, statement->command, candidateLines);
+    if (indexed && candidateLines.isEmpty())
+        return parentItem;
     Editor editor(nullptr);
-    if (pMainWindow->editorList()->getContentFromOpenedEditor(
-                filename,buffer)){
+    if (opened){
         editor.document()->setContents(buffer);
     } else if (!fileExists(filename)){
         return parentItem;
@@ -238,13 +245,10 @@ PSearchResultTreeItem CppRefacter::findOccurenceInFile(
         }
     }
     editor.setSyntaxer(syntaxerManager.getSyntaxer(QSynedit::ProgrammingLanguage::CPP));
-    int posY = 0;
-    while (posY < editor.lineCount()) {
+    auto findInLine = [&](int posY) {
         QString line = editor.document()->getLine(posY);
-        if (line.isEmpty()) {
-            posY++;
-            continue;
-        }
+        if (line.isEmpty())
+            return;
 
         if (posY == 0) {
             editor.syntaxer()->resetState();
@@ -285,7 +289,16 @@ PSearchResultTreeItem CppRefacter::findOccurenceInFile(
             }
             editor.syntaxer()->next();
         }
-        posY++;
+    };
+    if (indexed) {
+        foreach (int line, candidateLines) {
+            if (line > editor.lineCount())
+                break;
+            findInLine(line-1);
+        }
+    } else {
+        for (int posY = 0; posY < editor.lineCount(); posY++)
+            findInLine(posY);
     }
     return parentItem;
 }
@@ -51,6 +51,13 @@ void CustomFileIconProvider::update()
 #endif
 }
 
+void CustomFileIconProvider::requestUpdate()
+{
+#ifdef ENABLE_VCS
+    mVCSRepository->requestUpdate();
+#endif
+}
+
 #ifdef ENABLE_VCS
 GitRepository *CustomFileIconProvider::VCSRepository() const
 {
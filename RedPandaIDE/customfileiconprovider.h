@@ -27,6 +27,7 @@ public:
     ~CustomFileIconProvider();
     void setRootFolder(const QString& folder);
     void update();
+    void requestUpdate();
 private:
 #ifdef ENABLE_VCS
     GitRepository* mVCSRepository;
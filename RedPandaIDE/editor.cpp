@@ -39,6 +39,10 @@
 #include <QDebug>
 #include <QMimeData>
 #include <QTemporaryFile>
+#include <QThreadPool>
+#include <QPointer>
+#include <QProgressDialog>
+#include <atomic>
 #include <qsynedit/document.h>
 #include <qsynedit/syntaxer/cpp.h>
 #include <qsynedit/syntaxer/asm.h>
@@ -95,7 +99,9 @@ Editor::Editor(QWidget *parent, const QString& filename,
   mCurrentTipType{TipType::None},
   mSaving{false},
   mHoverModifiedLine{-1},
-  mWheelAccumulatedDelta{0}
+  mWheelAccumulatedDelta{0},
+  mSemanticTokensGeneration{0},
+  mSemanticTokensPending{false}
 {
     mLastFocusOutTime = 0;
     mInited=false;
@@ -172,6 +178,14 @@ Editor::Editor(QWidget *parent, const QString& filename,
             this, &Editor::onLinesDeleted);
     connect(this,&QSynEdit::linesInserted,
             this, &Editor::onLinesInserted);
+    connect(document().get(), &QSynedit::Document::deleted,
+            this, &Editor::onDocumentLinesDeleted);
+    connect(document().get(), &QSynedit::Document::inserted,
+            this, &Editor::onDocumentLinesInserted);
+    connect(document().get(), &QSynedit::Document::putted,
+            this, &Editor::onDocumentLinePutted);
+    connect(document().get(), &QSynedit::Document::cleared,
+            this, &Editor::onDocumentCleared);
 
     setContextMenuPolicy(Qt::CustomContextMenu);
 
@@ -815,6 +829,9 @@ void Editor::keyPressEvent(QKeyEvent *event)
     }
     if (readOnly())
         return;
+    //symbol completion, tab stops and code completion only work with one caret
+    if (hasExtraCarets())
+        return;
 
     switch (event->key()) {
     case Qt::Key_Return:
@@ -1223,6 +1240,23 @@ void Editor::onGutterPaint(QPainter &painter, int aLine, int X, int Y)
     }
 }
 
+void Editor::onGutterGetBackground(int aLine, QColor &color)
+{
+    PProfileReport report = pMainWindow->profileReport();
+    double heat = report ? report->lineHeat(mFilename, aLine) : 0;
+    if (heat > 0) {
+        // translucent red, the hotter the more opaque
+        color = QColor(255, 0, 0, 40 + int(heat * 160));
+        return;
+    }
+    // mark lines skipped by the preprocessor (false #if branches)
+    if (syntaxer() && isLineInactive(aLine)) {
+        color = syntaxer()->commentAttribute()->foreground();
+        if (color.isValid())
+            color.setAlpha(40);
+    }
+}
+
 void setIncludeUnderline(const QString& lineText, int startPos,
                   const QChar& quoteEndChar,
                   QSynedit::PSyntaxer syntaxer,
@@ -1306,6 +1340,11 @@ bool Editor::onGetSpecialLineColors(int Line, QColor &foreground, QColor &backgr
             foreground = mBreakpointForegroundColor;
         backgroundColor = mBreakpointBackgroundColor;
         return true;
+    } else if (syntaxer() && isLineInactive(Line)) {
+        // grey out the whole line (to the right edge) in false #if branches
+        foreground = syntaxer()->commentAttribute()->foreground();
+        backgroundColor = syntaxer()->commentAttribute()->background();
+        return foreground.isValid() || backgroundColor.isValid();
     }
     return false;
 }
@@ -1316,13 +1355,9 @@ void Editor::onPreparePaintHighlightToken(int line, int aChar, const QString &to
         return;
 
     if (mParser) {
-        // ifdef lines
-        if (!mParser->isLineVisible(mFilename, line)) {
-            background = syntaxer()->commentAttribute()->background();
-            if (attr->tokenType() != QSynedit::TokenType::Space)
-                foreground = syntaxer()->commentAttribute()->foreground();
+        // ifdef lines are colored by onGetSpecialLineColors()
+        if (isLineInactive(line))
             return;
-        }
         QString sLine = lineText(line);
         if (mParser->isIncludeLine(sLine) && attr->tokenType() != QSynedit::TokenType::Comment) {
             // #include header names (<>)
@@ -1339,8 +1374,10 @@ void Editor::onPreparePaintHighlightToken(int line, int aChar, const QString &to
             QSynedit::BufferCoord p{aChar,line};
 
             StatementKind kind;
-            if (mParser->parsing()){
-                kind=mIdentCache.value(QString("%1 %2").arg(aChar).arg(token),StatementKind::Unknown);
+            if (mSemanticTokens && mSemanticTokens->lookup(line, aChar, kind)) {
+                //found in the semantic tokens built after the last parse
+            } else if (mParser->parsing()){
+                kind=mIdentCache.value(QString("%1 %2 %3").arg(line).arg(aChar).arg(token),StatementKind::Unknown);
             } else {
                 QStringList expression = getExpressionAtPosition(p);
                 PStatement statement = parser()->findStatementOf(
@@ -1350,7 +1387,7 @@ void Editor::onPreparePaintHighlightToken(int line, int aChar, const QString &to
                 while (statement && statement->kind == StatementKind::Alias)
                     statement = mParser->findAliasedStatement(statement);
                 kind = getKindOfStatement(statement);
-                mIdentCache.insert(QString("%1 %2").arg(aChar).arg(token),kind);
+                mIdentCache.insert(QString("%1 %2 %3").arg(line).arg(aChar).arg(token),kind);
             }
             if (kind == StatementKind::Unknown) {
                 QSynedit::BufferCoord pBeginPos,pEndPos;
@@ -1511,7 +1548,7 @@ void Editor::inputMethodEvent(QInputMethodEvent *event)
 {
     QSynedit::QSynEdit::inputMethodEvent(event);  
     QString s = event->commitString();
-    if (s.isEmpty())
+    if (s.isEmpty() || hasExtraCarets())
         return;
     if (mCompletionPopup->isVisible()) {
         onCompletionInputMethod(event);
@@ -1568,6 +1605,8 @@ void Editor::closeEvent(QCloseEvent *)
 
 void Editor::showEvent(QShowEvent */*event*/)
 {
+    //the file may have been parsed while the editor was hidden
+    updateInactiveLineRanges();
 //    if (pSettings->codeCompletion().clearWhenEditorHidden()
 //            && !inProject()) {
 ////        initParser();
@@ -2219,10 +2258,105 @@ void Editor::onTooltipTimer()
 void Editor::onEndParsing()
 {
     mIdentCache.clear();
+    updateInactiveLineRanges();
+    updateSemanticTokens();
     document()->invalidateAllNonTempLineWidth();
     invalidate();
 }
 
+void Editor::updateInactiveLineRanges()
+{
+    if (mParser)
+        mInactiveLineRanges = mParser->inactiveLineRanges(mFilename);
+    else
+        mInactiveLineRanges.clear();
+}
+
+bool Editor::isLineInactive(int line) const
+{
+    return isLineInInactiveRanges(mInactiveLineRanges, line);
+}
+
+void Editor::onDocumentLinesDeleted(int first, int count)
+{
+    if (mSemanticTokens)
+        mSemanticTokens->linesDeleted(first,count);
+    if (mSemanticTokensPending)
+        mPendingSemanticTokensEdits.append(
+                    DocumentLinesEdit{DocumentLinesEdit::Type::Deleted,first,count});
+}
+
+void Editor::onDocumentLinesInserted(int first, int count)
+{
+    if (mSemanticTokens)
+        mSemanticTokens->linesInserted(first,count);
+    if (mSemanticTokensPending)
+        mPendingSemanticTokensEdits.append(
+                    DocumentLinesEdit{DocumentLinesEdit::Type::Inserted,first,count});
+}
+
+void Editor::onDocumentLinePutted(int line)
+{
+    if (mSemanticTokens)
+        mSemanticTokens->linePutted(line);
+    if (mSemanticTokensPending)
+        mPendingSemanticTokensEdits.append(
+                    DocumentLinesEdit{DocumentLinesEdit::Type::Putted,line,1});
+}
+
+void Editor::onDocumentCleared()
+{
+    mSemanticTokens.reset();
+    //the pending table is useless
+    mSemanticTokensGeneration++;
+    mSemanticTokensPending = false;
+    mPendingSemanticTokensEdits.clear();
+}
+
+void Editor::updateSemanticTokens()
+{
+    mSemanticTokensGeneration++;
+    mPendingSemanticTokensEdits.clear();
+    mSemanticTokensPending = false;
+    if (!mParser || !mParser->enabled() || mParser->parsing()
+            || !syntaxer() || syntaxer()->language() != QSynedit::ProgrammingLanguage::CPP) {
+        mSemanticTokens.reset();
+        return;
+    }
+    mSemanticTokensPending = true;
+    int generation = mSemanticTokensGeneration;
+    PCppParser parser = mParser;
+    QString filename = mFilename;
+    QStringList lines = document()->contents();
+    QPointer<Editor> editor(this);
+    QThreadPool::globalInstance()->start(QRunnable::create([=](){
+        PSemanticTokenTable table = SemanticTokenTable::build(parser, filename, lines);
+        QMetaObject::invokeMethod(qApp, [=](){
+            if (!editor || editor->mSemanticTokensGeneration != generation)
+                return;
+            editor->mSemanticTokensPending = false;
+            if (table) {
+                foreach (const DocumentLinesEdit& edit, editor->mPendingSemanticTokensEdits) {
+                    switch(edit.type) {
+                    case DocumentLinesEdit::Type::Inserted:
+                        table->linesInserted(edit.first, edit.count);
+                        break;
+                    case DocumentLinesEdit::Type::Deleted:
+                        table->linesDeleted(edit.first, edit.count);
+                        break;
+                    case DocumentLinesEdit::Type::Putted:
+                        table->linePutted(edit.first);
+                        break;
+                    }
+                }
+            }
+            editor->mPendingSemanticTokensEdits.clear();
+            editor->mSemanticTokens = table;
+            editor->invalidate();
+        }, Qt::QueuedConnection);
+    }));
+}
+
 void Editor::resolveAutoDetectEncodingOption()
 {
     if (mEncodingOption==ENCODING_AUTO_DETECT) {
@@ -2374,8 +2508,7 @@ QStringList Editor::getExpressionAtPosition(
         return result;
     int line = pos.line-1;
     int ch = pos.ch-1;
-    int symbolMatchingLevel = 0;
-    LastSymbolType lastSymbolType=LastSymbolType::None;
+    BackwardExpressionMatcher matcher;
     QSynedit::CppSyntaxer syntaxer;
     while (true) {
         if (line>=lineCount() || line<0)
@@ -2400,7 +2533,7 @@ QStringList Editor::getExpressionAtPosition(
                  && (start<=ch) && (ch<=endPos)) {
                 if (attr->tokenType() == QSynedit::TokenType::Comment
                         || attr->tokenType() == QSynedit::TokenType::String) {
-                    return result;
+                    return QStringList();
                 }
             }
             if (attr->tokenType() != QSynedit::TokenType::Comment
@@ -2410,198 +2543,15 @@ QStringList Editor::getExpressionAtPosition(
             syntaxer.next();
         }
         for (int i=tokens.count()-1;i>=0;i--) {
-            QString token = tokens[i];
-            if (token=="using")
-                return result;
-            switch(lastSymbolType) {
-            case LastSymbolType::ScopeResolutionOperator: //before '::'
-                if (token==">") {
-                    lastSymbolType=LastSymbolType::MatchingAngleQuotation;
-                    symbolMatchingLevel=0;
-                } else if (isIdentStartChar(token.front())) {
-                    lastSymbolType=LastSymbolType::Identifier;
-                } else
-                    return result;
-                break;
-            case LastSymbolType::ObjectMemberOperator: //before '.'
-            case LastSymbolType::PointerMemberOperator: //before '->'
-            case LastSymbolType::PointerToMemberOfObjectOperator: //before '.*'
-            case LastSymbolType::PointerToMemberOfPointerOperator: //before '->*'
-                if (token == ")" ) {
-                    lastSymbolType=LastSymbolType::MatchingParenthesis;
-                    symbolMatchingLevel = 0;
-                } else if (token == "]") {
-                    lastSymbolType=LastSymbolType::MatchingBracket;
-                    symbolMatchingLevel = 0;
-                } else if (isIdentStartChar(token.front())) {
-                    lastSymbolType=LastSymbolType::Identifier;
-                } else
-                    return result;
-                break;
-            case LastSymbolType::AsteriskSign: // before '*':
-                if (token == '*') {                    
-                } else {
-                    QChar ch=token.front();
-                    if (isIdentChar(ch)
-                            || ch.isDigit()
-                            || ch == '.'
-                            || ch == ')' ) {
-                        result.pop_front();
-                    }
-                    return result;
-                }
-                break;
-            case LastSymbolType::AmpersandSign: // before '&':
-            {
-                QChar ch=token.front();
-                if (isIdentChar(ch)
-                        || ch.isDigit()
-                        || ch == '.'
-                        || ch == ')' ) {
-                    result.pop_front();
-                }
-                return result;
-            }
-                break;
-            case LastSymbolType::ParenthesisMatched: //before '()'
-//                if (token == ".") {
-//                    lastSymbolType=LastSymbolType::ObjectMemberOperator;
-//                } else if (token=="->") {
-//                    lastSymbolType = LastSymbolType::PointerMemberOperator;
-//                } else if (token == ".*") {
-//                    lastSymbolType = LastSymbolType::PointerToMemberOfObjectOperator;
-//                } else if (token == "->*"){
-//                    lastSymbolType = LastSymbolType::PointerToMemberOfPointerOperator;
-//                } else if (token==">") {
-//                    lastSymbolType=LastSymbolType::MatchingAngleQuotation;
-//                    symbolMatchingLevel=0;
-//                } else
-                if (token == ")" ) {
-                    lastSymbolType=LastSymbolType::MatchingParenthesis;
-                    symbolMatchingLevel = 0;
-                } else if (token == "]") {
-                    lastSymbolType=LastSymbolType::MatchingBracket;
-                    symbolMatchingLevel = 0;
-                } else if (token == "*") {
-                    lastSymbolType=LastSymbolType::AsteriskSign;
-                } else if (token == "&") {
-                    lastSymbolType=LastSymbolType::AmpersandSign;
-                } else if (isIdentStartChar(token.front())) {
-                    lastSymbolType=LastSymbolType::Identifier;
-                } else
-                    return result;
-                break;
-            case LastSymbolType::BracketMatched: //before '[]'
-                if (token == ")" ) {
-                    lastSymbolType=LastSymbolType::MatchingParenthesis;
-                    symbolMatchingLevel = 0;
-                } else if (token == "]") {
-                    lastSymbolType=LastSymbolType::MatchingBracket;
-                    symbolMatchingLevel = 0;
-                } else if (isIdentStartChar(token.front())) {
-                    lastSymbolType=LastSymbolType::Identifier;
-                } else
-                    return result;
-                break;
-            case LastSymbolType::AngleQuotationMatched: //before '<>'
-                if (isIdentStartChar(token.front())) {
-                    lastSymbolType=LastSymbolType::Identifier;
-                } else
-                    return result;
-                break;
-            case LastSymbolType::None:
-                if (token =="::") {
-                    lastSymbolType=LastSymbolType::ScopeResolutionOperator;
-                } else if (token == ".") {
-                    lastSymbolType=LastSymbolType::ObjectMemberOperator;
-                } else if (token=="->") {
-                    lastSymbolType = LastSymbolType::PointerMemberOperator;
-                } else if (token == ".*") {
-                    lastSymbolType = LastSymbolType::PointerToMemberOfObjectOperator;
-                } else if (token == "->*"){
-                    lastSymbolType = LastSymbolType::PointerToMemberOfPointerOperator;
-                } else if (token == ")" ) {
-                    lastSymbolType=LastSymbolType::MatchingParenthesis;
-                    symbolMatchingLevel = 0;
-                } else if (token == "]") {
-                    lastSymbolType=LastSymbolType::MatchingBracket;
-                    symbolMatchingLevel = 0;
-                } else if (isIdentStartChar(token.front())) {
-                    lastSymbolType=LastSymbolType::Identifier;
-                } else
-                    return result;
-                break;
-            case LastSymbolType::TildeSign:
-                if (token =="::") {
-                    lastSymbolType=LastSymbolType::ScopeResolutionOperator;
-                } else {
-                    // "~" must appear after "::"
-                    result.pop_front();
-                    return result;
-                }
-                break;;
-            case LastSymbolType::Identifier:
-                if (token =="::") {
-                    lastSymbolType=LastSymbolType::ScopeResolutionOperator;
-                } else if (token == ".") {
-                    lastSymbolType=LastSymbolType::ObjectMemberOperator;
-                } else if (token=="->") {
-                    lastSymbolType = LastSymbolType::PointerMemberOperator;
-                } else if (token == ".*") {
-                    lastSymbolType = LastSymbolType::PointerToMemberOfObjectOperator;
-                } else if (token == "->*"){
-                    lastSymbolType = LastSymbolType::PointerToMemberOfPointerOperator;
-                } else if (token == "~") {
-                    lastSymbolType=LastSymbolType::TildeSign;
-                } else if (token == "*") {
-                    lastSymbolType=LastSymbolType::AsteriskSign;
-                } else if (token == "&") {
-                    lastSymbolType=LastSymbolType::AmpersandSign;
-                } else
-                    return result; // stop matching;
-                break;
-            case LastSymbolType::MatchingParenthesis:
-                if (token=="(") {
-                    if (symbolMatchingLevel==0) {
-                        lastSymbolType=LastSymbolType::ParenthesisMatched;
-                    } else {
-                        symbolMatchingLevel--;
-                    }
-                } else if (token==")") {
-                    symbolMatchingLevel++;
-                }
-                break;
-            case LastSymbolType::MatchingBracket:
-                if (token=="[") {
-                    if (symbolMatchingLevel==0) {
-                        lastSymbolType=LastSymbolType::BracketMatched;
-                    } else {
-                        symbolMatchingLevel--;
-                    }
-                } else if (token=="]") {
-                    symbolMatchingLevel++;
-                }
-                break;
-            case LastSymbolType::MatchingAngleQuotation:
-                if (token=="<") {
-                    if (symbolMatchingLevel==0) {
-                        lastSymbolType=LastSymbolType::AngleQuotationMatched;
-                    } else {
-                        symbolMatchingLevel--;
-                    }
-                } else if (token==">") {
-                    symbolMatchingLevel++;
-                }
-                break;
-            }
-            result.push_front(token);
+            if (!matcher.feed(tokens[i]))
+                return matcher.result();
         }
 
         line--;
         if (line>=0)
             ch = document()->getLine(line).length()+1;
     }
-    return result;
+    return matcher.result();
 }
 
 QString Editor::getWordForCompletionSearch(const QSynedit::BufferCoord &pos,bool permitTilde)
@@ -3162,6 +3112,7 @@ void Editor::initParser()
     } else {
         mParser = nullptr;
     }
+    updateInactiveLineRanges();
 }
 
 ParserLanguage Editor::calcParserLanguage()
@@ -3410,50 +3361,107 @@ void Editor::print()
 
 void Editor::exportAsRTF(const QString &rtfFilename)
 {
-    QSynedit::RTFExporter exporter(tabSize(), pCharsetInfoManager->getDefaultSystemEncoding());
-    exporter.setTitle(extractFileName(rtfFilename));
-    exporter.setUseBackground(pSettings->editor().copyRTFUseBackground());
-    exporter.setFont(font());
-    QSynedit::PSyntaxer hl = syntaxer();
+    std::shared_ptr<QSynedit::RTFExporter> exporter =
+            std::make_shared<QSynedit::RTFExporter>(tabSize(), pCharsetInfoManager->getDefaultSystemEncoding());
+    exporter->setTitle(extractFileName(rtfFilename));
+    exporter->setUseBackground(pSettings->editor().copyRTFUseBackground());
+    exporter->setFont(font());
+    //the exporter runs in another thread, so it can't share the syntaxer with the editor
+    QSynedit::PSyntaxer hl = syntaxerManager.copy(syntaxer());
     if (!pSettings->editor().copyRTFUseEditorColor()) {
-        hl = syntaxerManager.copy(syntaxer());
         syntaxerManager.applyColorScheme(hl,pSettings->editor().copyRTFColorScheme());
+    } else {
+        syntaxerManager.applyColorScheme(hl,pSettings->editor().colorScheme());
     }
-    exporter.setSyntaxer(hl);
-    exporter.setOnFormatToken(std::bind(&Editor::onExportedFormatToken,
-                                        this,
-                                        std::placeholders::_1,
-                                        std::placeholders::_2,
-                                        std::placeholders::_3,
-                                        std::placeholders::_4,
-                                        std::placeholders::_5
-                                        ));
-    exporter.exportAll(document());
-    exporter.saveToFile(rtfFilename);
+    exporter->setSyntaxer(hl);
+    exportToFile(exporter, rtfFilename);
 }
 
 void Editor::exportAsHTML(const QString &htmlFilename)
 {
-    QSynedit::HTMLExporter exporter(tabSize(), pCharsetInfoManager->getDefaultSystemEncoding());
-    exporter.setTitle(extractFileName(htmlFilename));
-    exporter.setUseBackground(pSettings->editor().copyHTMLUseBackground());
-    exporter.setFont(font());
-    QSynedit::PSyntaxer hl = syntaxer();
+    std::shared_ptr<QSynedit::HTMLExporter> exporter =
+            std::make_shared<QSynedit::HTMLExporter>(tabSize(), pCharsetInfoManager->getDefaultSystemEncoding());
+    exporter->setTitle(extractFileName(htmlFilename));
+    exporter->setUseBackground(pSettings->editor().copyHTMLUseBackground());
+    exporter->setFont(font());
+    //the exporter runs in another thread, so it can't share the syntaxer with the editor
+    QSynedit::PSyntaxer hl = syntaxerManager.copy(syntaxer());
     if (!pSettings->editor().copyHTMLUseEditorColor()) {
-        hl = syntaxerManager.copy(syntaxer());
         syntaxerManager.applyColorScheme(hl,pSettings->editor().copyHTMLColorScheme());
+    } else {
+        syntaxerManager.applyColorScheme(hl,pSettings->editor().colorScheme());
     }
-    exporter.setSyntaxer(hl);
-    exporter.setOnFormatToken(std::bind(&Editor::onExportedFormatToken,
-                                        this,
-                                        std::placeholders::_1,
-                                        std::placeholders::_2,
-                                        std::placeholders::_3,
-                                        std::placeholders::_4,
-                                        std::placeholders::_5
-                                        ));
-    exporter.exportAll(document());
-    exporter.saveToFile(htmlFilename);
+    exporter->setSyntaxer(hl);
+    exportToFile(exporter, htmlFilename);
+}
+
+void Editor::exportToFile(std::shared_ptr<QSynedit::Exporter> exporter, const QString &filename)
+{
+    // The worker gets copies of the lines and the semantic tokens, so the document
+    // can be edited (or closed) while exporting, and the tokens stay aligned with the lines.
+    // The export starts from the first line, so no syntax states are needed.
+    QStringList lines = document()->contents();
+    PSemanticTokenTable semanticTokens;
+    if (mSemanticTokens)
+        semanticTokens = std::make_shared<SemanticTokenTable>(*mSemanticTokens);
+    if (semanticTokens) {
+        exporter->setOnFormatToken([semanticTokens](QSynedit::PSyntaxer syntaxer, int line, int column,
+                                   const QString &token, QSynedit::PTokenAttribute& attr){
+            if (!syntaxer || token.isEmpty() || attr != syntaxer->identifierAttribute())
+                return;
+            StatementKind kind;
+            if (semanticTokens->lookup(line, column, kind))
+                setStatementKindAttribute(syntaxer, kind, attr);
+        });
+    }
+
+    QPointer<QProgressDialog> progressDlg = new QProgressDialog(
+                tr("Exporting..."),
+                tr("Abort"),
+                0,
+                lines.count(),
+                pMainWindow);
+    progressDlg->setWindowModality(Qt::WindowModal);
+    progressDlg->setMinimumDuration(500);
+    std::shared_ptr<std::atomic_bool> cancelled = std::make_shared<std::atomic_bool>(false);
+    connect(progressDlg, &QProgressDialog::canceled,
+            [cancelled](){
+        *cancelled = true;
+    });
+    exporter->setOnProgress([progressDlg, cancelled](int exportedLines, int ){
+        QMetaObject::invokeMethod(qApp, [progressDlg, exportedLines](){
+            if (progressDlg)
+                progressDlg->setValue(exportedLines);
+        }, Qt::QueuedConnection);
+        return !*cancelled;
+    });
+
+    QThreadPool::globalInstance()->start(QRunnable::create([exporter, filename, lines, progressDlg](){
+        QString errorMessage;
+        QFile file(filename);
+        if (file.open(QFile::WriteOnly | QFile::Truncate)) {
+            try {
+                if (!exporter->exportAllToStream(lines, file)) {
+                    file.close();
+                    file.remove();
+                }
+            } catch (const FileError& e) {
+                errorMessage = e.reason();
+            } catch (...) {
+                errorMessage = Editor::tr("Failed to export to '%1'!").arg(filename);
+            }
+        } else {
+            errorMessage = Editor::tr("Can't open file '%1' to write!").arg(filename);
+        }
+        QMetaObject::invokeMethod(qApp, [progressDlg, errorMessage](){
+            if (progressDlg) {
+                progressDlg->reset();
+                progressDlg->deleteLater();
+            }
+            if (!errorMessage.isEmpty())
+                QMessageBox::critical(pMainWindow, Editor::tr("Error"), errorMessage);
+        }, Qt::QueuedConnection);
+    }));
 }
 
 void Editor::showCompletion(const QString& preWord,bool autoComplete, CodeCompletionType type)
@@ -4507,44 +4515,51 @@ void Editor::onExportedFormatToken(QSynedit::PSyntaxer syntaxer, int Line, int c
                 kind = StatementKind::Variable;
             }
         }
-        QSynedit::CppSyntaxer* cppSyntaxer = dynamic_cast<QSynedit::CppSyntaxer*>(syntaxer.get());
-        switch(kind) {
-        case StatementKind::Function:
-        case StatementKind::Constructor:
-        case StatementKind::Destructor:
-            attr = cppSyntaxer->functionAttribute();
-            break;
-        case StatementKind::Class:
-        case StatementKind::Typedef:
-            attr = cppSyntaxer->classAttribute();
-            break;
-        case StatementKind::EnumClassType:
-        case StatementKind::EnumType:
-            break;
-        case StatementKind::LocalVariable:
-        case StatementKind::Parameter:
-            attr = cppSyntaxer->localVarAttribute();
-            break;
-        case StatementKind::Variable:
-            attr = cppSyntaxer->variableAttribute();
-            break;
-        case StatementKind::GlobalVariable:
-            attr = cppSyntaxer->globalVarAttribute();
-            break;
-        case StatementKind::Enum:
-        case StatementKind::Preprocessor:
-            attr = cppSyntaxer->preprocessorAttribute();
-            break;
-        case StatementKind::Keyword:
-            attr = cppSyntaxer->keywordAttribute();
-            break;
-        case StatementKind::Namespace:
-        case StatementKind::NamespaceAlias:
-            attr = cppSyntaxer->stringAttribute();
-            break;
-        default:
-            break;
-        }
+        setStatementKindAttribute(syntaxer, kind, attr);
+    }
+}
+
+void Editor::setStatementKindAttribute(QSynedit::PSyntaxer syntaxer, StatementKind kind, QSynedit::PTokenAttribute &attr)
+{
+    QSynedit::CppSyntaxer* cppSyntaxer = dynamic_cast<QSynedit::CppSyntaxer*>(syntaxer.get());
+    if (!cppSyntaxer)
+        return;
+    switch(kind) {
+    case StatementKind::Function:
+    case StatementKind::Constructor:
+    case StatementKind::Destructor:
+        attr = cppSyntaxer->functionAttribute();
+        break;
+    case StatementKind::Class:
+    case StatementKind::Typedef:
+        attr = cppSyntaxer->classAttribute();
+        break;
+    case StatementKind::EnumClassType:
+    case StatementKind::EnumType:
+        break;
+    case StatementKind::LocalVariable:
+    case StatementKind::Parameter:
+        attr = cppSyntaxer->localVarAttribute();
+        break;
+    case StatementKind::Variable:
+        attr = cppSyntaxer->variableAttribute();
+        break;
+    case StatementKind::GlobalVariable:
+        attr = cppSyntaxer->globalVarAttribute();
+        break;
+    case StatementKind::Enum:
+    case StatementKind::Preprocessor:
+        attr = cppSyntaxer->preprocessorAttribute();
+        break;
+    case StatementKind::Keyword:
+        attr = cppSyntaxer->keywordAttribute();
+        break;
+    case StatementKind::Namespace:
+    case StatementKind::NamespaceAlias:
+        attr = cppSyntaxer->stringAttribute();
+        break;
+    default:
+        break;
     }
 }
 
@@ -4667,6 +4682,7 @@ void Editor::setProject(Project *pProject)
     } else {
         initParser();
     }
+    updateInactiveLineRanges();
 }
 
 void Editor::gotoDeclaration(const QSynedit::BufferCoord &pos)
@@ -5099,15 +5115,29 @@ QString Editor::getPreviousWordAtPositionForCompleteFunctionDefinition(const QSy
     return result;
 }
 
-void Editor::reformat(bool doReparse)
+void Editor::reformat(bool doReparse, bool selectionOnly)
 {
     if (readOnly())
         return;
+    bool inSelection = selectionOnly && selAvail() && blockBegin().line != blockEnd().line;
+    int startLine = 1;
+    int endLine = lineCount();
+    if (inSelection) {
+        startLine = blockBegin().line;
+        endLine = blockEnd().line;
+        if (blockEnd().ch == 1)
+            endLine--;
+    }
     const QString &astyle = pSettings->environment().AStylePath();
     if (!fileExists(astyle)) {
-        QMessageBox::critical(this,
+        if (!formatter()) {
+            QMessageBox::critical(this,
                               tr("astyle not found"),
                               tr("Can't find astyle in \"%1\".").arg(astyle));
+            return;
+        }
+        pMainWindow->logToolsOutput(tr("Can't find astyle in \"%1\", only reindent lines.").arg(astyle));
+        reformatLines(startLine, endLine, doReparse);
         return;
     }
     //we must remove all breakpoints and syntax issues
@@ -5133,7 +5163,76 @@ void Editor::reformat(bool doReparse)
         pMainWindow->logToolsOutput(processError);
     if (newContent.isEmpty())
         return;
-    replaceContent(QString::fromUtf8(newContent), doReparse);
+    //astyle needs the whole file to know the context of the selected lines
+    if (inSelection)
+        replaceContentInLines(startLine, endLine, QString::fromUtf8(newContent), doReparse);
+    else
+        replaceContent(QString::fromUtf8(newContent), doReparse);
+}
+
+void Editor::reformatLines(int startLine, int endLine, bool doReparse)
+{
+    int oldTopPos = topPos();
+    QSynedit::BufferCoord oldCaret = caretXY();
+    QSynedit::BufferCoord oldBlockBegin = blockBegin();
+    QSynedit::BufferCoord oldBlockEnd = blockEnd();
+
+    beginEditing();
+    addLeftTopToUndo();
+    addCaretToUndo();
+    formatLines(startLine, endLine);
+    setCaretAndSelection(oldCaret, oldBlockBegin, oldBlockEnd);
+    setTopPos(oldTopPos);
+    endEditing();
+
+    if (doReparse)
+        reparseAfterReplace();
+}
+
+void Editor::replaceContentInLines(int startLine, int endLine, const QString &newContent, bool doReparse)
+{
+    QStringList oldLines = contents();
+    QStringList newLines = QSynedit::splitStrings(newContent);
+    //keep the changes inside the lines, and drop those crossing their bounds
+    QStringList newRangeLines;
+    int oldPos = startLine-1;
+    foreach (const QSynedit::LineDiffHunk& hunk, QSynedit::diffLines(oldLines, newLines)) {
+        if (hunk.oldStart < startLine-1)
+            continue;
+        if (hunk.oldStart >= endLine || hunk.oldStart + hunk.oldCount > endLine)
+            break;
+        newRangeLines.append(oldLines.mid(oldPos, hunk.oldStart - oldPos));
+        newRangeLines.append(newLines.mid(hunk.newStart, hunk.newCount));
+        oldPos = hunk.oldStart + hunk.oldCount;
+    }
+    newRangeLines.append(oldLines.mid(oldPos, endLine - oldPos));
+
+    int oldTopPos = topPos();
+    QSynedit::BufferCoord oldCaret = caretXY();
+    QSynedit::BufferCoord oldBlockBegin = blockBegin();
+    QSynedit::BufferCoord oldBlockEnd = blockEnd();
+    bool caretAtBlockEnd = (oldCaret == oldBlockEnd);
+    int delta = newRangeLines.count() - (endLine - startLine + 1);
+
+    beginEditing();
+    addLeftTopToUndo();
+    addCaretToUndo();
+    bool changed = replaceLines(startLine, endLine, newRangeLines);
+    //the selection still ends after the reformatted lines
+    oldBlockEnd.line = std::max(startLine, oldBlockEnd.line + delta);
+    oldBlockEnd.ch = std::min(oldBlockEnd.ch, lineText(oldBlockEnd.line).length()+1);
+    if (caretAtBlockEnd) {
+        oldCaret = oldBlockEnd;
+    } else if (oldCaret.line > startLine) {
+        oldCaret.line = std::max(startLine, std::min(oldCaret.line, oldBlockEnd.line));
+        oldCaret.ch = std::min(oldCaret.ch, lineText(oldCaret.line).length()+1);
+    }
+    setCaretAndSelection(oldCaret, oldBlockBegin, oldBlockEnd);
+    setTopPos(oldTopPos);
+    endEditing();
+
+    if (doReparse && changed)
+        reparseAfterReplace();
 }
 
 void Editor::replaceContent(const QString &newContent, bool doReparse)
@@ -5145,24 +5244,25 @@ void Editor::replaceContent(const QString &newContent, bool doReparse)
     addLeftTopToUndo();
     addCaretToUndo();
 
-    QSynedit::EditorOptions oldOptions = getOptions();
-    QSynedit::EditorOptions newOptions = oldOptions;
-    newOptions.setFlag(QSynedit::EditorOption::AutoIndent,false);
-    setOptions(newOptions);
-    replaceAll(newContent);
+    // only touch the changed lines, to keep the folds, breakpoints and bookmarks of the others
+    bool changed = replaceLines(1, lineCount(), QSynedit::splitStrings(newContent));
     setCaretXY(mOldCaret);
     setTopPos(oldTopPos);
-    setOptions(oldOptions);
     endEditing();
 
-    if (doReparse && !pMainWindow->isQuitting() && !pMainWindow->isClosingAll()
+    if (doReparse && changed)
+        reparseAfterReplace();
+}
+
+void Editor::reparseAfterReplace()
+{
+    if (!pMainWindow->isQuitting() && !pMainWindow->isClosingAll()
             && !(inProject() && pMainWindow->closingProject())) {
         reparse(true);
         checkSyntaxInBack();
         reparseTodo();
         pMainWindow->updateEditorActions();
     }
-
 }
 
 void Editor::checkSyntaxInBack()
@@ -5339,6 +5439,7 @@ void Editor::applySettings()
 
     options.setFlag(QSynedit::EditorOption::AutoHideScrollbars,pSettings->editor().autoHideScrollbar());
     options.setFlag(QSynedit::EditorOption::ScrollPastEol,pSettings->editor().scrollPastEol());
+    options.setFlag(QSynedit::EditorOption::WordWrap,pSettings->editor().wordWrap());
     options.setFlag(QSynedit::EditorOption::ScrollPastEof,pSettings->editor().scrollPastEof());
     options.setFlag(QSynedit::EditorOption::HalfPageScroll,pSettings->editor().halfPageScroll());
     options.setFlag(QSynedit::EditorOption::InvertMouseScroll, false);
@@ -5353,6 +5454,7 @@ void Editor::applySettings()
     setOptions(options);
 
     setTabSize(pSettings->editor().tabWidth());
+    setUndoMemoryLimit((size_t)pSettings->editor().undoMemoryUsage()*1024*1024);
     setInsertCaret(pSettings->editor().caretForInsert());
     setOverwriteCaret(pSettings->editor().caretForOverwrite());
     setCaretUseTextColor(pSettings->editor().caretUseTextColor());
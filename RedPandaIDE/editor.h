@@ -24,6 +24,7 @@
 #include "colorscheme.h"
 #include "common.h"
 #include "parser/cppparser.h"
+#include "parser/semantictokens.h"
 #include "widgets/codecompletionpopup.h"
 #include "widgets/headercompletionpopup.h"
 
@@ -39,6 +40,9 @@ struct TabStop {
 };
 
 class QTemporaryFile;
+namespace QSynedit {
+class Exporter;
+}
 
 using PTabStop = std::shared_ptr<TabStop>;
 
@@ -46,25 +50,6 @@ class Editor : public QSynedit::QSynEdit
 {
     Q_OBJECT
 public:
-    enum class LastSymbolType {
-        Identifier,
-        ScopeResolutionOperator, //'::'
-        ObjectMemberOperator, //'.'
-        PointerMemberOperator, //'->'
-        PointerToMemberOfObjectOperator, //'.*'
-        PointerToMemberOfPointerOperator, //'->*'
-        MatchingBracket,
-        BracketMatched,
-        MatchingParenthesis,
-        ParenthesisMatched,
-        TildeSign,    // '~'
-        AsteriskSign, // '*'
-        AmpersandSign, // '&'
-        MatchingAngleQuotation,
-        AngleQuotationMatched,
-        None
-    };
-
     enum MarginNumber {
         LineNumberMargin = 0,
         MarkerMargin = 1,
@@ -188,7 +173,8 @@ public:
     void setActiveBreakpointFocus(int Line, bool setFocus=true);
     QString getPreviousWordAtPositionForSuggestion(const QSynedit::BufferCoord& p, bool &hasTypeQualifier);
     QString getPreviousWordAtPositionForCompleteFunctionDefinition(const QSynedit::BufferCoord& p);
-    void reformat(bool doReparse=true);
+    // selectionOnly: only change the selected lines, if more than one line is selected
+    void reformat(bool doReparse=true, bool selectionOnly=false);
     void replaceContent(const QString &newContent, bool doReparse=true);
     void checkSyntaxInBack();
     void gotoDeclaration(const QSynedit::BufferCoord& pos);
@@ -264,8 +250,15 @@ private slots:
     void onAutoBackupTimer();
     void onTooltipTimer();
     void onEndParsing();
+    void onDocumentLinesDeleted(int first,int count);
+    void onDocumentLinesInserted(int first,int count);
+    void onDocumentLinePutted(int line);
+    void onDocumentCleared();
 
 private:
+    void updateSemanticTokens();
+    void updateInactiveLineRanges();
+    bool isLineInactive(int line) const;
     void resolveAutoDetectEncodingOption();
     bool isBraceChar(QChar ch);
     bool shouldOpenInReadonly();
@@ -322,12 +315,19 @@ private:
     void popUserCodeInTabStops();
     void onExportedFormatToken(QSynedit::PSyntaxer syntaxer, int Line, int column, const QString& token,
         QSynedit::PTokenAttribute &attr);
+    static void setStatementKindAttribute(QSynedit::PSyntaxer syntaxer, StatementKind kind,
+        QSynedit::PTokenAttribute &attr);
+    void exportToFile(std::shared_ptr<QSynedit::Exporter> exporter, const QString& filename);
     void onScrollBarValueChanged();
     void updateHoverLink(int line);
     void cancelHoverLink();
 
     QSize calcCompletionPopupSize();
 
+    void reformatLines(int startLine, int endLine, bool doReparse);
+    void replaceContentInLines(int startLine, int endLine, const QString &newContent, bool doReparse);
+    void reparseAfterReplace();
+
 private:
     bool mInited;
     QDateTime mBackupTime;
@@ -383,6 +383,19 @@ private:
     int mHoverModifiedLine;
     int mWheelAccumulatedDelta;
     QMap<QString,StatementKind> mIdentCache;
+    PSemanticTokenTable mSemanticTokens;
+    // lines skipped by the preprocessor, fetched from the parser after each parse
+    InactiveLineRanges mInactiveLineRanges;
+    int mSemanticTokensGeneration;
+    // edits made after the lines are sent to build the pending semantic token table
+    struct DocumentLinesEdit {
+        enum class Type { Inserted, Deleted, Putted };
+        Type type;
+        int first;
+        int count;
+    };
+    QList<DocumentLinesEdit> mPendingSemanticTokensEdits;
+    bool mSemanticTokensPending;
     qint64 mLastFocusOutTime;
 
     static QHash<ParserLanguage,std::weak_ptr<CppParser>> mSharedParsers;
@@ -390,6 +403,7 @@ private:
     // SynEdit interface
 protected:
     void onGutterPaint(QPainter &painter, int aLine, int X, int Y) override;
+    void onGutterGetBackground(int aLine, QColor &color) override;
     void onGetEditingAreas(int Line, QSynedit::EditingAreaList &areaList) override;
     bool onGetSpecialLineColors(int Line, QColor &foreground, QColor &backgroundColor) override;
     void onPreparePaintHighlightToken(int line, int aChar, const QString &token, QSynedit::PTokenAttribute attr, QSynedit::FontStyles &style, QColor &foreground, QColor &background) override;
@@ -204,6 +204,8 @@ bool EditorList::closeEditor(Editor* editor, bool transferFocus, bool force) {
             pMainWindow->rebuildOpenedFileHisotryMenu();
         }
         editor->clearBreakpoints();
+        //todos of non-project files are only kept while they are opened
+        pMainWindow->todoParser()->removeFile(editor->filename());
         doRemoveEditor(editor);
     }
     updateLayout();
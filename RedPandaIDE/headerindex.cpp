@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2020-2022 Roy Qu (royqh1979@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "headerindex.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QPointer>
+#include <QRunnable>
+#include <QThreadPool>
+
+HeaderIndex* pHeaderIndex = nullptr;
+
+HeaderIndex::HeaderIndex(QObject *parent) : QObject(parent),
+    mGeneration{0}
+{
+    connect(&mWatcher, &QFileSystemWatcher::directoryChanged,
+            this, &HeaderIndex::onDirectoryChanged);
+}
+
+HeaderIndex::Entries HeaderIndex::entries(const QString &dirPath)
+{
+    QString path = QDir::cleanPath(dirPath);
+    auto it = mDirs.constFind(path);
+    if (it != mDirs.constEnd()) {
+        watchDirectory(path);
+        return it.value();
+    }
+    Entries result = listDirectory(path);
+    onDirectoryListed(path, result, mGeneration);
+    watchDirectory(path);
+    return result;
+}
+
+void HeaderIndex::prefetch(const QStringList &dirPaths)
+{
+    QStringList paths;
+    foreach (const QString& dirPath, dirPaths) {
+        QString path = QDir::cleanPath(dirPath);
+        if (!mDirs.contains(path) && !mPendingDirs.contains(path))
+            paths.append(path);
+    }
+    listInBackground(paths, true);
+}
+
+void HeaderIndex::clear()
+{
+    if (!mWatchedDirs.isEmpty())
+        mWatcher.removePaths(mWatchedDirs.values());
+    mWatchedDirs.clear();
+    mDirs.clear();
+    mPendingDirs.clear();
+    mGeneration++;
+}
+
+void HeaderIndex::onDirectoryChanged(const QString &path)
+{
+    mDirs.remove(path);
+    if (!mPendingDirs.contains(path))
+        listInBackground(QStringList{path}, false);
+}
+
+void HeaderIndex::onDirectoryListed(const QString &path, const Entries &entries, int generation)
+{
+    if (generation != mGeneration)
+        return;
+    mPendingDirs.remove(path);
+    if (!QFileInfo(path).isDir()) {
+        mDirs.remove(path);
+        if (mWatchedDirs.remove(path))
+            mWatcher.removePath(path);
+        return;
+    }
+    mDirs.insert(path, entries);
+}
+
+void HeaderIndex::watchDirectory(const QString &path)
+{
+    if (mWatchedDirs.contains(path) || !mDirs.contains(path))
+        return;
+    mWatchedDirs.insert(path);
+    mWatcher.addPath(path);
+}
+
+void HeaderIndex::listInBackground(const QStringList &dirPaths, bool withSubDirs)
+{
+    if (dirPaths.isEmpty())
+        return;
+    foreach (const QString& path, dirPaths)
+        mPendingDirs.insert(path);
+    QPointer<HeaderIndex> self{this};
+    int generation = mGeneration;
+    QThreadPool::globalInstance()->start(QRunnable::create([self, dirPaths, withSubDirs, generation](){
+        //the index may be destroyed before the results arrive
+        auto post = [self, generation](const QString& path, const Entries& entries) {
+            QMetaObject::invokeMethod(QCoreApplication::instance(), [self, path, entries, generation](){
+                if (self)
+                    self->onDirectoryListed(path, entries, generation);
+            }, Qt::QueuedConnection);
+        };
+        foreach (const QString& path, dirPaths) {
+            Entries entries = listDirectory(path);
+            post(path, entries);
+            if (!withSubDirs)
+                continue;
+            foreach (const Entry& entry, entries) {
+                if (!entry.isFolder)
+                    continue;
+                QString subPath = path + '/' + entry.fileName;
+                post(subPath, listDirectory(subPath));
+            }
+        }
+    }));
+}
+
+HeaderIndex::Entries HeaderIndex::listDirectory(const QString &path)
+{
+    Entries result;
+    QDir dir(path);
+    if (!dir.exists())
+        return result;
+    foreach (const QFileInfo& fileInfo, dir.entryInfoList(QDir::AllEntries | QDir::NoDotAndDotDot)) {
+        QString fileName = fileInfo.fileName();
+        if (fileName.startsWith('.'))
+            continue;
+        Entry entry;
+        entry.isFolder = fileInfo.isDir();
+        entry.suffix = fileInfo.suffix();
+        if (!entry.isFolder) {
+            QString suffix = entry.suffix.toLower();
+            if (suffix != "h" && suffix != "hpp" && suffix != "")
+                continue;
+        }
+        entry.fileName = fileName;
+        entry.baseName = fileInfo.baseName();
+        result.append(entry);
+    }
+    return result;
+}
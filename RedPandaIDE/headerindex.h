@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2020-2022 Roy Qu (royqh1979@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef HEADERINDEX_H
+#define HEADERINDEX_H
+
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/*
+ * Cached listings of the header folders, used by the #include completion popup.
+ *
+ * Include folders of the compiler set (and their sub folders) are listed in a
+ * background thread when the parser is reset, other folders are listed and
+ * cached the first time they are queried. Only folders that have been queried
+ * are watched, and relisted in the background when their contents change.
+ * The index should be cleared when the compiler set or include folders change.
+ */
+class HeaderIndex : public QObject
+{
+    Q_OBJECT
+public:
+    struct Entry {
+        QString fileName;
+        QString baseName;
+        QString suffix;
+        bool isFolder;
+    };
+    using Entries = QVector<Entry>;
+
+    explicit HeaderIndex(QObject *parent = nullptr);
+    /*
+     * Headers and sub folders in the folder.
+     * The folder is listed now if it's not indexed yet.
+     */
+    Entries entries(const QString& dirPath);
+    /*
+     * Index the folders and their direct sub folders in a background thread.
+     */
+    void prefetch(const QStringList& dirPaths);
+    void clear();
+private slots:
+    void onDirectoryChanged(const QString& path);
+private:
+    void onDirectoryListed(const QString& path, const Entries& entries, int generation);
+    void watchDirectory(const QString& path);
+    void listInBackground(const QStringList& dirPaths, bool withSubDirs);
+    static Entries listDirectory(const QString& path);
+private:
+    QHash<QString,Entries> mDirs;
+    QSet<QString> mPendingDirs;
+    QSet<QString> mWatchedDirs;
+    QFileSystemWatcher mWatcher;
+    // listings started before the last clear() are dropped
+    int mGeneration;
+};
+
+extern HeaderIndex* pHeaderIndex;
+
+#endif // HEADERINDEX_H
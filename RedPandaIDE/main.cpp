@@ -33,6 +33,7 @@
 #include "colorscheme.h"
 #include "iconsmanager.h"
 #include "autolinkmanager.h"
+#include "headerindex.h"
 #include <qt_utils/charsetinfo.h>
 #include "parser/parserutils.h"
 #include "editorlist.h"
@@ -349,6 +350,9 @@ int main(int argc, char *argv[])
     qRegisterMetaType<PCompileIssue>("PCompileIssue&");
     qRegisterMetaType<QVector<int>>("QVector<int>");
     qRegisterMetaType<QHash<int,QString>>("QHash<int,QString>");
+    qRegisterMetaType<RunStatistics>("RunStatistics");
+    qRegisterMetaType<PBenchmarkReport>("PBenchmarkReport");
+    qRegisterMetaType<PProfileReport>("PProfileReport");
 
     initParser();
 
@@ -403,6 +407,8 @@ int main(int argc, char *argv[])
         pIconsManager = &iconsManager;
         AutolinkManager autolinkManager;
         pAutolinkManager = &autolinkManager;
+        HeaderIndex headerIndex;
+        pHeaderIndex = &headerIndex;
         try {
             pAutolinkManager->load();
         } catch (FileError e) {
@@ -91,6 +91,7 @@
 #include "widgets/infomessagebox.h"
 #include "widgets/newtemplatedialog.h"
 #include "visithistorymanager.h"
+#include "headerindex.h"
 #include "widgets/projectalreadyopendialog.h"
 #include "widgets/searchdialog.h"
 
@@ -289,6 +290,12 @@ MainWindow::MainWindow(QWidget *parent)
             this, &MainWindow::onDebugMemoryAddressInput);
 
     mTodoParser = std::make_shared<TodoParser>();
+    connect(mTodoParser.get(), &TodoParser::parseStarted,
+            this, &MainWindow::onTodoParseStarted);
+    connect(mTodoParser.get(), &TodoParser::todosFound,
+            this, &MainWindow::onTodosFound);
+    connect(mTodoParser.get(), &TodoParser::parseFinished,
+            this, &MainWindow::onTodoParseFinished);
     mSymbolUsageManager = std::make_shared<SymbolUsageManager>();
     try {
         mSymbolUsageManager->load();
@@ -397,6 +404,13 @@ MainWindow::MainWindow(QWidget *parent)
             this, &MainWindow::onFileRenamedInFileSystemModel);
     mFileSystemModel.setReadOnly(false);
     mFileSystemModel.setIconProvider(&mFileSystemModelIconProvider);
+#ifdef ENABLE_VCS
+    connect(mFileSystemModelIconProvider.VCSRepository(), &GitRepository::statusChanged,
+            this, [this](){
+        //reset the icon provider to repaint icons with the new status
+        mFileSystemModel.setIconProvider(&mFileSystemModelIconProvider);
+    });
+#endif
 
     mFileSystemModel.setNameFilters(pSystemConsts->defaultFileNameFilters());
     mFileSystemModel.setNameFilterDisables(true);
@@ -426,6 +440,11 @@ MainWindow::MainWindow(QWidget *parent)
             this, &MainWindow::onFileChanged);
     connect(&mFileSystemWatcher,&QFileSystemWatcher::directoryChanged,
             this, &MainWindow::onDirChanged);
+    mHandlingFileChanges = false;
+    mFileChangesTimer.setSingleShot(true);
+    mFileChangesTimer.setInterval(200);
+    connect(&mFileChangesTimer, &QTimer::timeout,
+            this, &MainWindow::onFileChangesTimeout);
 
     mStatementColors = std::make_shared<QHash<StatementKind, PColorSchemeItem> >();
     mCompletionPopup = std::make_shared<CodeCompletionPopup>();
@@ -454,6 +473,10 @@ MainWindow::MainWindow(QWidget *parent)
 #else
         ui->actionIA_32_Assembly_Language_Reference_Manual->setVisible(false);
         ui->actionx86_Assembly_Language_Reference_Manual->setVisible(false);
+#endif
+#ifndef Q_OS_LINUX
+    ui->actionProfile->setVisible(false);
+    ui->actionClear_Profile_Data->setVisible(false);
 #endif
     ui->actionEGE_Manual->setVisible(pSettings->environment().language()=="zh_CN");
     ui->actionOI_Wiki->setVisible(pSettings->environment().language()=="zh_CN");
@@ -813,6 +836,8 @@ void MainWindow::updateCompileActions(const Editor *e)
             || mCompilerManager->running() || mDebugger->executing()) {
         ui->actionCompile->setEnabled(false);
         ui->actionRun->setEnabled(false);
+        ui->actionRun_Benchmark->setEnabled(false);
+        ui->actionProfile->setEnabled(false);
         ui->actionRebuild->setEnabled(false);
         ui->actionGenerate_Assembly->setEnabled(false);
         ui->actionDebug->setEnabled(false);
@@ -879,6 +904,8 @@ void MainWindow::updateCompileActions(const Editor *e)
         }
         ui->actionCompile->setEnabled(canCompile);
         ui->actionRun->setEnabled(canRun);
+        ui->actionRun_Benchmark->setEnabled(canRun);
+        ui->actionProfile->setEnabled(canRun);
         ui->actionRebuild->setEnabled(canCompile);
         ui->actionGenerate_Assembly->setEnabled(canGenerateAssembly);
         ui->actionDebug->setEnabled(canDebug);
@@ -1190,16 +1217,15 @@ void MainWindow::onFileSaved(const QString &path, bool inProject)
         QModelIndex index =  mFileSystemModel.index(path);
         if (index.isValid()) {
             if (!inProject) {
+                //status may not be loaded yet
                 if ( (isCFile(path) || isHFile(path))
+                        && mFileSystemModelIconProvider.VCSRepository()->hasRepository(branch)
                         &&  !mFileSystemModelIconProvider.VCSRepository()->isFileInRepository(path)) {
                     QString output;
                     mFileSystemModelIconProvider.VCSRepository()->add(extractRelativePath(mFileSystemModelIconProvider.VCSRepository()->folder(),path),output);
                 }
             }
-//            qDebug()<<"update icon provider";
-            mFileSystemModelIconProvider.update();
-            mFileSystemModel.setIconProvider(&mFileSystemModelIconProvider);
-            ui->treeFiles->update(index);
+            mFileSystemModelIconProvider.requestUpdate();
         }
     }
 #else
@@ -1838,7 +1864,7 @@ void MainWindow::openProject(QString filename, bool openFiles)
     }
 
     //update editor's inproject flag
-    foreach (PProjectUnit unit, mProject->unitList()) {
+    foreach (PProjectUnit unit, mProject->units()) {
         Editor* e = mEditorList->getOpenedEditorByFilename(unit->fileName());
         mProject->associateEditorToUnit(e,unit);
         if (e)
@@ -1872,6 +1898,9 @@ void MainWindow::changeOptions(const QString &widgetName, const QString &groupNa
         return;
     }
 
+    //include folders may have changed
+    if (pHeaderIndex)
+        pHeaderIndex->clear();
     if (mProject) {
         scanActiveProject(true);
     }
@@ -2220,7 +2249,7 @@ bool MainWindow::compile(bool rebuild, CppCompileType compileType)
     CompileTarget target =getCompileTarget();
     if (target == CompileTarget::Project && compileType == CppCompileType::Normal) {
         QStringList missedUnits;
-        foreach(const PProjectUnit &unit, mProject->unitList()) {
+        foreach(const PProjectUnit &unit, mProject->units()) {
             if (!fileExists(unit->fileName())) {
                 missedUnits.append(
                             extractRelativePath(
@@ -2364,6 +2393,24 @@ void MainWindow::runExecutable(
             stretchMessagesPanel(true);
             ui->tabMessages->setCurrentWidget(ui->tabProblem);
         }
+    } else if (runType == RunType::Benchmark) {
+        QVector<POJProblemCase> problemCases;
+        POJProblem problem = mOJProblemModel.problem();
+        if (pSettings->executor().enableProblemSet() && problem)
+            problemCases = problem->cases;
+        mLastBenchmarkReport.reset();
+        clearToolsOutput();
+        stretchMessagesPanel(true);
+        ui->tabMessages->setCurrentWidget(ui->tabToolsOutput);
+        mCompilerManager->runBenchmark(exeName,params,QFileInfo(exeName).absolutePath(),
+                                       binDirs, problemCases);
+    } else if (runType == RunType::Profile) {
+        clearToolsOutput();
+        stretchMessagesPanel(true);
+        ui->tabMessages->setCurrentWidget(ui->tabToolsOutput);
+        updateStatusbarMessage(tr("Profiling \"%1\"...").arg(exeName));
+        mCompilerManager->runProfile(exeName,params,QFileInfo(exeName).absolutePath(),
+                                     binDirs);
     }
     updateCompileActions();
     updateAppTitle();
@@ -2549,7 +2596,7 @@ void MainWindow::debug()
 
 //        mDebugger->setUseUTF8(e->fileEncoding() == ENCODING_UTF8 || e->fileEncoding() == ENCODING_UTF8_BOM);
 
-        foreach(const PProjectUnit& unit, mProject->unitList()) {
+        foreach(const PProjectUnit& unit, mProject->units()) {
             if (fileExists(unit->fileName()))
                 unitFiles.insert(unit->fileName());
         }
@@ -4899,14 +4946,14 @@ void MainWindow::onClassBrowserRefreshStart()
     if (!statement) {
         return;
     }
-    mClassBrowserCurrentStatement=QString("%1+%2+%3")
-            .arg(statement->fullName)
-            .arg(statement->noNameArgs)
-            .arg((int)statement->kind);
+    mClassBrowserCurrentStatement=node->key;
 }
 
 void MainWindow::onClassBrowserRefreshEnd()
 {
+    //the current node is kept by the refresh, unless it's removed
+    if (ui->classBrowser->currentIndex().isValid())
+        return;
     QModelIndex index = mClassBrowserModel.modelIndexForStatement(mClassBrowserCurrentStatement);
     if (index.isValid()) {
         ui->classBrowser->expand(index);
@@ -5271,19 +5318,14 @@ void MainWindow::stopDebugForNoSymbolTable()
     }
 }
 
-void MainWindow::onTodoParsingFile(const QString& filename)
-{
-    mTodoModel.removeTodosForFile(filename);
-}
-
 void MainWindow::onTodoParseStarted()
 {
     mTodoModel.clear();
 }
 
-void MainWindow::onTodoFound(const QString& filename, int lineNo, int ch, const QString& line)
+void MainWindow::onTodosFound(const QString& filename, const QList<PTodoItem>& items)
 {
-    mTodoModel.addItem(filename,lineNo,ch,line);
+    mTodoModel.setTodosForFile(filename,items);
 }
 
 void MainWindow::onTodoParseFinished()
@@ -5406,6 +5448,7 @@ void MainWindow::closeProject(bool refreshEditor)
             mBookmarkModel->setIsForProject(false);
             mDebugger->clearForProject();
             mDebugger->setIsForProject(false);
+            mTodoParser->clear();
             mTodoModel.clear(true);
             mTodoModel.setIsForProject(false);
             // Clear error browser
@@ -5447,17 +5490,83 @@ void MainWindow::updateProjectView()
 
 void MainWindow::onFileChanged(const QString &path)
 {
-    if (mFilesChangedNotifying.contains(path))
+    mChangedFiles.insert(path);
+    //don't restart the timer, or files written more often than its interval are never handled
+    if (!mFileChangesTimer.isActive())
+        mFileChangesTimer.start();
+}
+
+void MainWindow::onDirChanged(const QString &path)
+{
+    mChangedDirs.insert(path);
+    if (!mFileChangesTimer.isActive())
+        mFileChangesTimer.start();
+}
+
+void MainWindow::onFileChangesTimeout()
+{
+    //message boxes of the last batch are still shown
+    if (mHandlingFileChanges) {
+        mFileChangesTimer.start();
         return;
-    mFilesChangedNotifying.insert(path);
-    Editor *e = mEditorList->getOpenedEditorByFilename(path);
-    if (e) {
+    }
+    mHandlingFileChanges = true;
+    auto action = finally([this]{
+        mHandlingFileChanges = false;
+    });
+    QSet<QString> changedDirs;
+    changedDirs.swap(mChangedDirs);
+    QSet<QString> changedFiles;
+    changedFiles.swap(mChangedFiles);
+
+    foreach (const QString& path, changedDirs) {
+        if (mProject && QString::compare(mProject->directory(),path,PATH_SENSITIVITY)==0
+                && !fileExists(path)) {
+            QMessageBox::information(this,tr("Project folder removed."),
+                                      tr("Folder for project '%1' was removed.").arg(path)
+                                     +"<BR /><BR />"
+                                     + tr("It will be closed."));
+            closeProject(false);
+        }
+    }
+
+#ifdef ENABLE_VCS
+    //vcs status of the changed files may change too
+    if (pSettings->vcs().gitOk()) {
+        if (mProject)
+            mProject->model()->iconProvider()->requestUpdate();
+        mFileSystemModelIconProvider.requestUpdate();
+    }
+#endif
+
+    QStringList paths;
+    foreach (const QString& path, changedFiles) {
+        if (mEditorList->getOpenedEditorByFilename(path))
+            paths.append(path);
+    }
+    std::sort(paths.begin(),paths.end());
+    QMessageBox::StandardButtons buttons = QMessageBox::Yes|QMessageBox::No;
+    if (paths.count()>1)
+        buttons |= QMessageBox::YesToAll|QMessageBox::NoToAll;
+    QMessageBox::StandardButton reloadAnswer = QMessageBox::NoButton;
+    QMessageBox::StandardButton keepAnswer = QMessageBox::NoButton;
+    foreach (const QString& path, paths) {
+        //the editor may be closed when handling the previous files
+        Editor *e = mEditorList->getOpenedEditorByFilename(path);
+        if (!e)
+            continue;
         if (fileExists(path)) {
-            e->activate();
-            if (QMessageBox::question(this,tr("File Changed"),
-                                      tr("File '%1' was changed.").arg(path)+"<BR /><BR />" + tr("Reload its content from disk?"),
-                                      QMessageBox::Yes|QMessageBox::No,
-                                      QMessageBox::No) == QMessageBox::Yes) {
+            QMessageBox::StandardButton answer = reloadAnswer;
+            if (answer == QMessageBox::NoButton) {
+                e->activate();
+                answer = QMessageBox::question(this,tr("File Changed"),
+                                               tr("File '%1' was changed.").arg(path)+"<BR /><BR />" + tr("Reload its content from disk?"),
+                                               buttons,
+                                               QMessageBox::No);
+                if (answer == QMessageBox::YesToAll || answer == QMessageBox::NoToAll)
+                    reloadAnswer = answer;
+            }
+            if (answer == QMessageBox::Yes || answer == QMessageBox::YesToAll) {
                 try {
                     int top = e->topPos();
                     QSynedit::BufferCoord caretPos = e->caretXY();
@@ -5472,33 +5581,22 @@ void MainWindow::onFileChanged(const QString &path)
             }
         } else {
             mFileSystemWatcher.removePath(path);
-            if (QMessageBox::question(this,tr("File Changed"),
-                                      tr("File '%1' was removed.").arg(path)+"<BR /><BR />" + tr("Keep it open?"),
-                                      QMessageBox::Yes|QMessageBox::No,
-                                      QMessageBox::Yes) == QMessageBox::No) {
+            QMessageBox::StandardButton answer = keepAnswer;
+            if (answer == QMessageBox::NoButton) {
+                answer = QMessageBox::question(this,tr("File Changed"),
+                                               tr("File '%1' was removed.").arg(path)+"<BR /><BR />" + tr("Keep it open?"),
+                                               buttons,
+                                               QMessageBox::Yes);
+                if (answer == QMessageBox::YesToAll || answer == QMessageBox::NoToAll)
+                    keepAnswer = answer;
+            }
+            if (answer == QMessageBox::No || answer == QMessageBox::NoToAll) {
                 mEditorList->closeEditor(e);
             } else {
                 e->setModified(true);
             }
         }
     }
-    mFilesChangedNotifying.remove(path);
-}
-
-void MainWindow::onDirChanged(const QString &path)
-{
-    if (mFilesChangedNotifying.contains(path))
-        return;
-    mFilesChangedNotifying.insert(path);
-    if (mProject && QString::compare(mProject->directory(),path,PATH_SENSITIVITY)==0
-            && !fileExists(path)) {
-        QMessageBox::information(this,tr("Project folder removed."),
-                                  tr("Folder for project '%1' was removed.").arg(path)
-                                 +"<BR /><BR />"
-                                 + tr("It will be closed."));
-        closeProject(false);
-    }
-    mFilesChangedNotifying.remove(path);
 }
 
 void MainWindow::onFilesViewPathChanged()
@@ -5848,6 +5946,8 @@ void MainWindow::onCompilerSetChanged(int index)
         }
         mProject->setCompilerSet(index);
         mProject->saveOptions();
+        if (pHeaderIndex)
+            pHeaderIndex->clear();
         scanActiveProject(true);
         return;
     }
@@ -5855,6 +5955,8 @@ void MainWindow::onCompilerSetChanged(int index)
     pSettings->compilerSets().setDefaultIndex(index);
     pSettings->compilerSets().saveDefaultIndex();
 
+    if (pHeaderIndex)
+        pHeaderIndex->clear();
     reparseNonProjectEditors();
 }
 
@@ -6028,6 +6130,8 @@ void MainWindow::onCompileFinished(QString filename, bool isCheckSyntax)
                     break;
                 case MainWindow::CompileSuccessionTaskType::RunProblemCases:
                 case MainWindow::CompileSuccessionTaskType::RunCurrentProblemCase:
+                case MainWindow::CompileSuccessionTaskType::RunBenchmark:
+                case MainWindow::CompileSuccessionTaskType::Profile:
                     QMessageBox::critical(this,tr("Wrong Compiler Settings"),
                                           tr("Compiler is set not to generate executable.")+"<BR/><BR/>"
                                           +tr("We need the executabe to run problem case."));
@@ -6055,6 +6159,12 @@ void MainWindow::onCompileFinished(QString filename, bool isCheckSyntax)
                 case MainWindow::CompileSuccessionTaskType::RunCurrentProblemCase:
                     runExecutable(mCompileSuccessionTask->execName,QString(),RunType::CurrentProblemCase, mCompileSuccessionTask->binDirs);
                     break;
+                case MainWindow::CompileSuccessionTaskType::RunBenchmark:
+                    runExecutable(mCompileSuccessionTask->execName,QString(),RunType::Benchmark, mCompileSuccessionTask->binDirs);
+                    break;
+                case MainWindow::CompileSuccessionTaskType::Profile:
+                    runExecutable(mCompileSuccessionTask->execName,QString(),RunType::Profile, mCompileSuccessionTask->binDirs);
+                    break;
                 case MainWindow::CompileSuccessionTaskType::Debug:
                     debug();
                     break;
@@ -6118,6 +6228,53 @@ void MainWindow::onRunPausingForFinish()
     updateCompileActions();
 }
 
+void MainWindow::onRunStatisticsReady(const RunStatistics &statistics)
+{
+    QString msg = tr("Program exited with return value %1. Time: %2 ms (user %3 ms, sys %4 ms, wall %5 ms), Peak memory: %6 KB, Page faults: %7 minor / %8 major, Context switches: %9 voluntary / %10 involuntary.")
+            .arg(statistics.exitCode)
+            .arg((statistics.userTime+statistics.sysTime)/1000.0,0,'f',1)
+            .arg(statistics.userTime/1000.0,0,'f',1)
+            .arg(statistics.sysTime/1000.0,0,'f',1)
+            .arg(statistics.wallTime/1000.0,0,'f',1)
+            .arg(statistics.peakMemory)
+            .arg(statistics.minorPageFaults)
+            .arg(statistics.majorPageFaults)
+            .arg(statistics.voluntaryContextSwitches)
+            .arg(statistics.involuntaryContextSwitches);
+    if (statistics.termSignal!=0)
+        msg += " " + tr("Terminated by signal %1.").arg(statistics.termSignal);
+    updateStatusbarMessage(msg);
+}
+
+void MainWindow::onBenchmarkRunStarted(const QString &caseName, int current, int total)
+{
+    updateStatusbarMessage(tr("Benchmarking \"%1\": run %2 of %3").arg(caseName).arg(current).arg(total));
+}
+
+void MainWindow::onBenchmarkFinished(PBenchmarkReport report)
+{
+    mLastBenchmarkReport = report;
+    PBenchmarkReport baseline = BenchmarkReport::load(BenchmarkReport::baselineFilename(report->executable));
+    foreach (const QString& line, report->format(baseline)) {
+        logToolsOutput(line);
+    }
+    if (!baseline)
+        logToolsOutput(tr("No baseline saved. Use \"Save Benchmark Baseline\" to compare later runs with this one."));
+    updateStatusbarMessage(tr("Benchmark finished."));
+}
+
+void MainWindow::onProfileFinished(PProfileReport report)
+{
+    mProfileReport = report;
+    foreach (const QString& line, report->format(50)) {
+        logToolsOutput(line);
+    }
+    for (int i=0;i<mEditorList->pageCount();i++) {
+        (*mEditorList)[i]->invalidateGutter();
+    }
+    updateStatusbarMessage(tr("Profile finished."));
+}
+
 void MainWindow::onRunProblemFinished()
 {
     updateProblemTitle();
@@ -6202,6 +6359,42 @@ void MainWindow::on_actionRun_triggered()
     runExecutable();
 }
 
+void MainWindow::on_actionRun_Benchmark_triggered()
+{
+    runExecutable(RunType::Benchmark);
+}
+
+void MainWindow::on_actionProfile_triggered()
+{
+    runExecutable(RunType::Profile);
+}
+
+void MainWindow::on_actionClear_Profile_Data_triggered()
+{
+    mProfileReport.reset();
+    for (int i=0;i<mEditorList->pageCount();i++) {
+        (*mEditorList)[i]->invalidateGutter();
+    }
+}
+
+void MainWindow::on_actionSave_Benchmark_Baseline_triggered()
+{
+    if (!mLastBenchmarkReport) {
+        QMessageBox::information(this,
+                                 tr("Save Benchmark Baseline"),
+                                 tr("Please run benchmark first."));
+        return;
+    }
+    QString filename = BenchmarkReport::baselineFilename(mLastBenchmarkReport->executable);
+    if (!mLastBenchmarkReport->save(filename)) {
+        QMessageBox::critical(this,
+                              tr("Save Benchmark Baseline"),
+                              tr("Can't write to file \"%1\".").arg(filename));
+        return;
+    }
+    updateStatusbarMessage(tr("Benchmark baseline saved to \"%1\".").arg(filename));
+}
+
 void MainWindow::on_actionUndo_triggered()
 {
     Editor * editor = mEditorList->getEditor();
@@ -6767,7 +6960,7 @@ void MainWindow::on_actionReformat_Code_triggered()
 {
     Editor* e = mEditorList->getEditor();
     if (e) {
-        e->reformat();
+        e->reformat(true, true);
         e->activate();
     }
 }
@@ -8021,6 +8214,7 @@ void MainWindow::updateVCSActions()
     bool hasRepository = false;
     bool shouldEnable = false;
     bool canBranch = false;
+    //the menu is about to show, so the status must be current (it's a single git call)
     if (ui->projectView->isVisible() && mProject) {
         mProject->model()->iconProvider()->update();
         QString branch;
@@ -8860,6 +9054,10 @@ MainWindow::CompileSuccessionTaskType MainWindow::runTypeToCompileSuccessionTask
         return CompileSuccessionTaskType::RunCurrentProblemCase;
     case RunType::ProblemCases:
         return CompileSuccessionTaskType::RunProblemCases;
+    case RunType::Benchmark:
+        return CompileSuccessionTaskType::RunBenchmark;
+    case RunType::Profile:
+        return CompileSuccessionTaskType::Profile;
     default:
         return CompileSuccessionTaskType::RunNormal;
     }
@@ -9212,7 +9410,7 @@ void MainWindow::on_actionGit_Create_Repository_triggered()
         QString output;
         vcsManager.add(mProject->folder(), extractFileName(mProject->filename()), output);
         vcsManager.add(mProject->folder(), extractFileName(mProject->options().icon), output);
-        foreach (PProjectUnit pUnit, mProject->unitList()) {
+        foreach (PProjectUnit pUnit, mProject->units()) {
             vcsManager.add(mProject->folder(),extractRelativePath(mProject->folder(),pUnit->fileName()),output);
         }
         //update project view
@@ -9841,6 +10039,11 @@ bool MainWindow::isQuitting() const
     return mQuitting;
 }
 
+const PProfileReport &MainWindow::profileReport() const
+{
+    return mProfileReport;
+}
+
 bool MainWindow::isClosingAll() const
 {
     return mClosingAll;
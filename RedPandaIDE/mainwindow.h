@@ -40,6 +40,9 @@
 #include "widgets/customfilesystemmodel.h"
 #include "customfileiconprovider.h"
 #include "problems/competitivecompenionhandler.h"
+#include "compiler/executablerunner.h"
+#include "compiler/benchmarkrunner.h"
+#include "compiler/profilerunner.h"
 
 
 QT_BEGIN_NAMESPACE
@@ -53,7 +56,9 @@ enum class CompileTarget {
 enum class RunType {
     Normal,
     CurrentProblemCase,
-    ProblemCases
+    ProblemCases,
+    Benchmark,
+    Profile
 };
 
 
@@ -95,6 +100,7 @@ class MainWindow : public QMainWindow
         RunNormal,
         RunProblemCases,
         RunCurrentProblemCase,
+        RunBenchmark,
         Debug,
         Profile
     };
@@ -248,6 +254,10 @@ public slots:
     void onRunErrorOccured(const QString& reason);
     void onRunFinished();
     void onRunPausingForFinish();
+    void onRunStatisticsReady(const RunStatistics& statistics);
+    void onBenchmarkRunStarted(const QString& caseName, int current, int total);
+    void onBenchmarkFinished(PBenchmarkReport report);
+    void onProfileFinished(PProfileReport report);
     void onRunProblemFinished();
     void onOJProblemCaseStarted(const QString& id, int current, int total);
     void onOJProblemCaseFinished(const QString& id, int current, int total);
@@ -269,9 +279,8 @@ public slots:
     void disableDebugActions();
     void enableDebugActions();
     void stopDebugForNoSymbolTable();
-    void onTodoParsingFile(const QString& filename);
     void onTodoParseStarted();
-    void onTodoFound(const QString& filename, int lineNo, int ch, const QString& line);
+    void onTodosFound(const QString& filename, const QList<PTodoItem>& items);
     void onTodoParseFinished();
     void onWatchpointHitted(const QString& var, const QString& oldVal, const QString& newVal);
     void setActiveBreakpoint(QString FileName, int Line, bool setFocus);
@@ -354,6 +363,7 @@ private slots:
     void onAutoSaveTimeout();
     void onFileChanged(const QString &path);
     void onDirChanged(const QString &path);
+    void onFileChangesTimeout();
     void onFilesViewPathChanged();
     void onWatchViewContextMenu(const QPoint& pos);
     void onBookmarkContextMenu(const QPoint& pos);
@@ -457,6 +467,14 @@ private slots:
 
     void on_actionRun_triggered();
 
+    void on_actionRun_Benchmark_triggered();
+
+    void on_actionSave_Benchmark_Baseline_triggered();
+
+    void on_actionProfile_triggered();
+
+    void on_actionClear_Profile_Data_triggered();
+
     void on_actionUndo_triggered();
 
     void on_actionRedo_triggered();
@@ -885,6 +903,8 @@ private:
 
     QComboBox *mCompilerSet;
     std::shared_ptr<CompilerManager> mCompilerManager;
+    PBenchmarkReport mLastBenchmarkReport;
+    PProfileReport mProfileReport;
     std::shared_ptr<Debugger> mDebugger;
     CPUDialog *mCPUDialog;
     SearchInFileDialog *mSearchInFilesDialog;
@@ -945,7 +965,12 @@ private:
     QColor mErrorColor;
     CompileIssuesState mCompileIssuesState;
 
-    QSet<QString> mFilesChangedNotifying;
+    // changes reported by mFileSystemWatcher are collected, and handled in batch
+    // when no new change comes in for a while
+    QTimer mFileChangesTimer;
+    QSet<QString> mChangedFiles;
+    QSet<QString> mChangedDirs;
+    bool mHandlingFileChanges;
 
     //actions for compile issue table
     QAction * mTableIssuesCopyAction;
@@ -1050,6 +1075,7 @@ public:
     bool closingProject() const;
     bool openingFiles() const;
     bool openingProject() const;
+    const PProfileReport &profileReport() const;
 };
 
 extern MainWindow* pMainWindow;
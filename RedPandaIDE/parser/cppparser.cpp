@@ -67,6 +67,7 @@ CppParser::CppParser(QObject *parent) : QObject(parent),
     mEnabled = true;
 
     internalClear();
+    mSnapshot = std::make_shared<Snapshot>();
 
     //mNamespaces;
     //mBlockBeginSkips;
@@ -827,18 +828,13 @@ QStringList CppParser::getClassesList() const
 
 QStringList CppParser::getFileDirectIncludes(const QString &filename) const
 {
-    QMutexLocker locker(&mMutex);
-    if (mParsing)
-        return QStringList();
     if (filename.isEmpty())
         return QStringList();
-    PParsedFileInfo fileInfo = mPreprocessor.findFileInfo(filename);
-
+    PParsedFileSnapshot fileInfo = snapshot()->files.value(filename);
     if (fileInfo) {
-        return fileInfo->directIncludes();
+        return fileInfo->directIncludes;
     }
     return QStringList();
-
 }
 
 QSet<QString> CppParser::internalGetIncludedFiles(const QString &filename) const {
@@ -860,14 +856,34 @@ QSet<QString> CppParser::internalGetIncludedFiles(const QString &filename) const
 
 QSet<QString> CppParser::getIncludedFiles(const QString &filename) const
 {
-    QMutexLocker locker(&mMutex);
-    return internalGetIncludedFiles(filename);
+    QSet<QString> list;
+    if (filename.isEmpty())
+        return list;
+    PParsedFileSnapshot fileInfo = snapshot()->files.value(filename);
+    if (fileInfo) {
+        list = fileInfo->includes;
+    }
+    list.insert(filename);
+    return list;
 }
 
 QSet<QString> CppParser::getFileUsings(const QString &filename) const
 {
-    QMutexLocker locker(&mMutex);
-    return internalGetFileUsings(filename);
+    QSet<QString> result;
+    if (filename.isEmpty())
+        return result;
+    PSnapshot current = snapshot();
+    PParsedFileSnapshot fileInfo = current->files.value(filename);
+    if (fileInfo) {
+        result = fileInfo->usings;
+        foreach (const QString& subFile,fileInfo->includes){
+            PParsedFileSnapshot subIncludes = current->files.value(subFile);
+            if (subIncludes) {
+                result.unite(subIncludes->usings);
+            }
+        }
+    }
+    return result;
 }
 
 QSet<QString> CppParser::internalGetFileUsings(const QString &filename) const
@@ -929,16 +945,20 @@ QString CppParser::getHeaderFileName(const QString &relativeTo, const QString &h
 
 bool CppParser::isLineVisible(const QString &fileName, int line) const
 {
-    QMutexLocker locker(&mMutex);
-    if (mParsing) {
-        return true;
-    }
-    PParsedFileInfo fileInfo = mPreprocessor.findFileInfo(fileName);
+    PParsedFileSnapshot fileInfo = snapshot()->files.value(fileName);
     if (!fileInfo)
         return true;
     return fileInfo->isLineVisible(line);
 }
 
+InactiveLineRanges CppParser::inactiveLineRanges(const QString &fileName) const
+{
+    PParsedFileSnapshot fileInfo = snapshot()->files.value(fileName);
+    if (!fileInfo)
+        return InactiveLineRanges();
+    return fileInfo->inactiveRanges;
+}
+
 void CppParser::invalidateFile(const QString &fileName)
 {
     if (!mEnabled)
@@ -952,6 +972,7 @@ void CppParser::invalidateFile(const QString &fileName)
     }
     QSet<QString> files = calculateFilesToBeReparsed(fileName);
     internalInvalidateFiles(files);
+    publishSnapshot();
     mParsing = false;
 }
 
@@ -1015,6 +1036,7 @@ void CppParser::parseFile(const QString &fileName, bool inProject, bool onlyIfNo
     {
         auto action = finally([&,this]{
             QMutexLocker locker(&mMutex);
+            publishSnapshot();
             if (updateView)
                 emit onEndParsing(mFilesScannedCount,1);
             else
@@ -1077,6 +1099,7 @@ void CppParser::parseFileList(bool updateView)
     }
     {
         auto action = finally([&,this]{
+            publishSnapshot();
             mParsing = false;
             if (updateView)
                 emit onEndParsing(mFilesScannedCount,1);
@@ -1152,6 +1175,7 @@ void CppParser::resetParser()
     }
     {
         auto action = finally([this]{
+            publishSnapshot();
             mParsing = false;
         });
         emit  onBusy();
@@ -1198,7 +1222,34 @@ bool CppParser::fileScanned(const QString &fileName) const
 
 bool CppParser::isFileParsed(const QString &filename) const
 {
-    return mPreprocessor.fileScanned(filename);
+    return snapshot()->scannedFiles.contains(filename);
+}
+
+bool CppParser::findIdentifierLines(const QString &filename, const QString &name, QVector<int> &lines) const
+{
+    PParsedFileSnapshot fileInfo = snapshot()->files.value(filename);
+    if (!fileInfo || !fileInfo->identifiersIndexed)
+        return false;
+    lines = fileInfo->identifierLines.value(name);
+    return true;
+}
+
+CppParser::PSnapshot CppParser::snapshot() const
+{
+    return std::atomic_load(&mSnapshot);
+}
+
+void CppParser::publishSnapshot()
+{
+    std::shared_ptr<Snapshot> newSnapshot = std::make_shared<Snapshot>();
+    const QHash<QString,PParsedFileInfo>& fileInfos = mPreprocessor.fileInfos();
+    newSnapshot->files.reserve(fileInfos.count());
+    //snapshots of the files that didn't change are reused, not rebuilt
+    for (auto it=fileInfos.begin();it!=fileInfos.end();++it) {
+        newSnapshot->files.insert(it.key(), it.value()->snapshot());
+    }
+    newSnapshot->scannedFiles = mPreprocessor.scannedFiles();
+    std::atomic_store(&mSnapshot, PSnapshot(newSnapshot));
 }
 
 QString CppParser::getScopePrefix(const PStatement& statement) const{
@@ -40,6 +40,18 @@ public:
     };
 
     using PParseFileCommand = std::unique_ptr<ParseFileCommand>;
+
+    /*
+     * File level infos of the last finished parse.
+     * A new snapshot is published atomically after each parse, and readers
+     * only hold a reference to it, so they never wait for the parser thread.
+     */
+    struct Snapshot {
+        QHash<QString,PParsedFileSnapshot> files;
+        QSet<QString> scannedFiles;
+    };
+    using PSnapshot = std::shared_ptr<const Snapshot>;
+
     explicit CppParser(QObject *parent = nullptr);
     CppParser(const CppParser&)=delete;
     CppParser& operator=(const CppParser)=delete;
@@ -115,6 +127,7 @@ public:
 
     void invalidateFile(const QString& fileName);
     bool isLineVisible(const QString& fileName, int line) const;
+    InactiveLineRanges inactiveLineRanges(const QString& fileName) const;
     bool isIncludeLine(const QString &line) const;
     bool isIncludeNextLine(const QString &line) const;
     bool isProjectHeaderFile(const QString& fileName) const;
@@ -130,6 +143,12 @@ public:
     bool fileScanned(const QString& fileName) const;
 
     bool isFileParsed(const QString& filename) const;
+    /*
+     * Get the lines of the file where an identifier named "name" appears.
+     * Return false if the file is not indexed (not parsed yet or a system header).
+     */
+    bool findIdentifierLines(const QString& filename, const QString& name, QVector<int>& lines) const;
+    PSnapshot snapshot() const;
 
     QString prettyPrintStatement(const PStatement& statement, const QString& filename, int line = -1) const;
 
@@ -291,6 +310,7 @@ private:
                                          const PStatement& statement,
                                          const PStatement& scopeStatement) const;
     QSet<QString> internalGetIncludedFiles(const QString &filename) const;
+    void publishSnapshot();
     PStatement findMacro(const QString& phrase, const QString& fileName) const;
     PStatement findMemberOfStatement(
             const QString& filename,
@@ -747,6 +767,7 @@ private:
     QSet<QString> mCppTypeKeywords;
 
     PParseFileCommand mLastParseFileCommand;
+    PSnapshot mSnapshot; // accessed only by std::atomic_load/atomic_store
 };
 using PCppParser = std::shared_ptr<CppParser>;
 
@@ -774,6 +774,7 @@ void CppPreprocessor::openInclude(QString fileName)
     parsedFile->fileInfo = mCurrentFileInfo;
 
     // Don't parse stuff we have already parsed
+    bool indexIdentifiers = false;
     if (!mScannedFiles.contains(fileName)) {
         // Parse ONCE
         //if not Assigned(Stream) then
@@ -788,6 +789,8 @@ void CppPreprocessor::openInclude(QString fileName)
             } else {
                 parsedFile->buffer = readFileToLines(fileName);
             }
+            // used by find usages/rename, we don't need it for system headers
+            indexIdentifiers = !isSystemFile;
         }
     } else {
         //add defines of already parsed including headers;
@@ -799,6 +802,8 @@ void CppPreprocessor::openInclude(QString fileName)
     mIndex = parsedFile->index;
     mFileName = parsedFile->fileName;
     parsedFile->buffer = removeComments(parsedFile->buffer);
+    if (indexIdentifiers)
+        mCurrentFileInfo->indexIdentifiers(parsedFile->buffer);
     mBuffer = parsedFile->buffer;
 
 //    for (int i=0;i<mBuffer.count();i++) {
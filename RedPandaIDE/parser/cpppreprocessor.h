@@ -121,6 +121,10 @@ public:
         return mScannedFiles;
     }
 
+    const QHash<QString,PParsedFileInfo>& fileInfos() const {
+        return mFileInfos;
+    }
+
     const QSet<QString> &projectIncludePaths() const {
         return mProjectIncludePaths;
     }
@@ -0,0 +1,50 @@
+/*
+ * Copyright (C) 2020-2022 Roy Qu (royqh1979@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "inactivelineranges.h"
+
+#include <algorithm>
+#include <climits>
+
+bool isLineInInactiveRanges(const InactiveLineRanges &ranges, int line)
+{
+    //find the last range starting at or before the line
+    auto it = std::upper_bound(ranges.begin(), ranges.end(), line,
+                               [](int value, const InactiveLineRange& range) {
+        return value < range.startLine;
+    });
+    if (it == ranges.begin())
+        return false;
+    --it;
+    return line <= it->endLine;
+}
+
+void insertInactiveBranch(InactiveLineRanges &ranges, int line, bool branchTrue)
+{
+    // The preprocessor reports branch changes in line order, and a later
+    // change on the same line overrides the earlier one.
+    // So the new state is in effect from the line to the end of the file.
+    while (!ranges.isEmpty() && ranges.back().startLine >= line)
+        ranges.pop_back();
+    if (!ranges.isEmpty() && ranges.back().endLine >= line)
+        ranges.back().endLine = line - 1;
+    if (branchTrue)
+        return;
+    if (!ranges.isEmpty() && ranges.back().endLine == line - 1)
+        ranges.back().endLine = INT_MAX;
+    else
+        ranges.append(InactiveLineRange{line, INT_MAX});
+}
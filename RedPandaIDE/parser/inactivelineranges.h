@@ -0,0 +1,43 @@
+/*
+ * Copyright (C) 2020-2022 Roy Qu (royqh1979@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef INACTIVELINERANGES_H
+#define INACTIVELINERANGES_H
+
+#include <QVector>
+
+/*
+ * Lines [startLine, endLine] (1-based, inclusive) skipped by the preprocessor,
+ * i.e. inside false #if/#ifdef/#else branches.
+ * An unterminated branch reaches to the end of the file (endLine is INT_MAX).
+ */
+struct InactiveLineRange {
+    int startLine;
+    int endLine;
+};
+
+// Sorted by startLine and never overlapping, so lookups are binary searches.
+using InactiveLineRanges = QVector<InactiveLineRange>;
+
+bool isLineInInactiveRanges(const InactiveLineRanges& ranges, int line);
+
+/*
+ * Lines from the given line to the end of the file become active (branchTrue)
+ * or inactive, the lines before it are unchanged.
+ */
+void insertInactiveBranch(InactiveLineRanges& ranges, int line, bool branchTrue);
+
+#endif // INACTIVELINERANGES_H
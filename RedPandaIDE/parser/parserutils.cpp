@@ -754,15 +754,72 @@ bool isTypeKind(StatementKind kind)
     }
 }
 
+void ParsedFileInfo::insertBranch(int line, bool branchTrue)
+{
+    mSnapshot.reset();
+    insertInactiveBranch(mInactiveRanges, line, branchTrue);
+}
+
 bool ParsedFileInfo::isLineVisible(int line) const
 {
-    int lastI=-1;
-    for(auto it=mBranches.begin();it!=mBranches.end();++it) {
-        int i = it.key();
-        if (line<i)
-            break;
-        else
-            lastI = i;
+    return !isLineInInactiveRanges(mInactiveRanges, line);
+}
+
+PParsedFileSnapshot ParsedFileInfo::snapshot() const
+{
+    if (mSnapshot)
+        return mSnapshot;
+    std::shared_ptr<ParsedFileSnapshot> result = std::make_shared<ParsedFileSnapshot>();
+    //containers are implicitly shared, so these are cheap
+    result->includes = mIncludes;
+    result->directIncludes = mDirectIncludes;
+    result->usings = mUsings;
+    result->inactiveRanges = mInactiveRanges;
+    result->identifiersIndexed = mIdentifiersIndexed;
+    result->identifierLines = mIdentifierLines;
+    mSnapshot = result;
+    return mSnapshot;
+}
+
+void ParsedFileInfo::indexIdentifiers(const QStringList &buffer)
+{
+    mSnapshot.reset();
+    mIdentifierLines.clear();
+    for (int i=0;i<buffer.count();i++) {
+        const QString& line = buffer[i];
+        int len = line.length();
+        int pos = 0;
+        while (pos<len) {
+            QChar ch = line[pos];
+            if (ch == '"' || ch == '\'') {
+                //skip string and char literals
+                pos++;
+                while (pos<len && line[pos]!=ch) {
+                    if (line[pos]=='\\')
+                        pos++;
+                    pos++;
+                }
+                pos++;
+            } else if (ch == '_' || ch.isLetter()) {
+                int start = pos;
+                while (pos<len && (line[pos]=='_' || line[pos].isLetterOrNumber()))
+                    pos++;
+                QVector<int> &lines = mIdentifierLines[line.mid(start,pos-start)];
+                if (lines.isEmpty() || lines.back()!=i+1)
+                    lines.append(i+1);
+            } else if (ch.isDigit()) {
+                //skip numbers like 0x1f, 10ul
+                while (pos<len && (line[pos]=='_' || line[pos]=='\'' || line[pos].isLetterOrNumber()))
+                    pos++;
+            } else {
+                pos++;
+            }
+        }
     }
-    return lastI<0?true:mBranches[lastI];
+    mIdentifiersIndexed = true;
+}
+
+bool ParsedFileSnapshot::isLineVisible(int line) const
+{
+    return !isLineInInactiveRanges(inactiveRanges, line);
 }
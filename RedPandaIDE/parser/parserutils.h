@@ -16,12 +16,14 @@
  */
 #ifndef PARSER_UTILS_H
 #define PARSER_UTILS_H
+#include <QHash>
 #include <QMap>
 #include <QObject>
 #include <QSet>
 #include <QVector>
 #include <memory>
 #include <functional>
+#include "inactivelineranges.h"
 
 using GetFileStreamCallBack = std::function<bool (const QString&, QStringList&)>;
 
@@ -319,15 +321,32 @@ struct ClassInheritanceInfo {
 
 using PClassInheritanceInfo = std::shared_ptr<ClassInheritanceInfo>;
 
+/*
+ * Read-only copy of the file level infos of a ParsedFileInfo.
+ * It's published by the parser after each parse, so the editors can query it
+ * without waiting for the parser thread.
+ */
+struct ParsedFileSnapshot {
+    QSet<QString> includes;
+    QStringList directIncludes;
+    QSet<QString> usings;
+    InactiveLineRanges inactiveRanges;
+    bool identifiersIndexed;
+    QHash<QString,QVector<int>> identifierLines;
+    bool isLineVisible(int line) const;
+};
+
+using PParsedFileSnapshot = std::shared_ptr<const ParsedFileSnapshot>;
+
 class ParsedFileInfo {
 public:
-    ParsedFileInfo(const QString& fileName): mFileName {fileName} { }
+    ParsedFileInfo(const QString& fileName): mFileName {fileName}, mIdentifiersIndexed{false} { }
     ParsedFileInfo(const ParsedFileInfo&)=delete;
     ParsedFileInfo& operator=(const ParsedFileInfo&)=delete;
-    void insertBranch(int level, bool branchTrue) { mBranches.insert(level, branchTrue); }
+    void insertBranch(int line, bool branchTrue);
     bool isLineVisible(int line) const;
-    void addInclude(const QString &fileName) { mIncludes.insert(fileName); }
-    void addDirectInclude(const QString &fileName) { mDirectIncludes.append(fileName); }
+    void addInclude(const QString &fileName) { mIncludes.insert(fileName); mSnapshot.reset(); }
+    void addDirectInclude(const QString &fileName) { mDirectIncludes.append(fileName); mSnapshot.reset(); }
     bool including(const QString &fileName) const { return mIncludes.contains(fileName); }
     PStatement findScopeAtLine(int line) const { return mScopes.findScopeAtLine(line); }
     void addStatement(const PStatement &statement) { mStatements.insert(statement->fullName,statement); }
@@ -335,8 +354,9 @@ public:
     void addScope(int line, const PStatement &scope) { mScopes.addScope(line,scope); }
     void removeLastScope() { mScopes.removeLastScope(); }
     PStatement lastScope() const { return mScopes.lastScope(); }
-    void addUsing(const QString &usingSymbol) { mUsings.insert(usingSymbol); }
+    void addUsing(const QString &usingSymbol) { mUsings.insert(usingSymbol); mSnapshot.reset(); }
     void addHandledInheritances(std::weak_ptr<ClassInheritanceInfo> classInheritanceInfo) { mHandledInheritances.append(classInheritanceInfo); }
+    void indexIdentifiers(const QStringList& buffer);
     void clearHandledInheritances() { mHandledInheritances.clear(); }
 
     QString fileName() const { return mFileName; }
@@ -344,7 +364,13 @@ public:
     const QSet<QString>& usings() const { return mUsings; }
     const QStringList& directIncludes() const { return mDirectIncludes; }
     const QSet<QString>& includes() const { return mIncludes; }
+    const InactiveLineRanges& inactiveRanges() const { return mInactiveRanges; }
     const QList<std::weak_ptr<ClassInheritanceInfo> >& handledInheritances() const { return mHandledInheritances; }
+    /*
+     * The snapshot is cached until the file level infos change,
+     * so publishing files that weren't reparsed doesn't copy anything.
+     */
+    PParsedFileSnapshot snapshot() const;
 
 private:
     QString mFileName;
@@ -353,8 +379,11 @@ private:
     QSet<QString> mUsings; // namespaces it usings
     StatementMap mStatements; // but we don't save temporary statements (full name as key)
     CppScopes mScopes; // int is start line of the statement scope
-    QMap<int,bool> mBranches;
+    InactiveLineRanges mInactiveRanges;
     QList<std::weak_ptr<ClassInheritanceInfo>> mHandledInheritances;
+    bool mIdentifiersIndexed;
+    QHash<QString,QVector<int>> mIdentifierLines; // identifier -> lines (1-based) it appears
+    mutable PParsedFileSnapshot mSnapshot;
 };
 
 using PParsedFileInfo = std::shared_ptr<ParsedFileInfo>;
@@ -0,0 +1,362 @@
+/*
+ * Copyright (C) 2020-2022 Roy Qu (royqh1979@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "semantictokens.h"
+#include "cppparser.h"
+#include <qsynedit/syntaxer/cpp.h>
+#include <algorithm>
+
+static bool isIdentStart(const QChar& ch) {
+    return ch=='_' || ch.isLetter();
+}
+
+static bool isIdent(const QChar& ch) {
+    return ch=='_' || ch.isDigit() || ch.isLetter();
+}
+
+static bool isFunctionBodyKind(StatementKind kind) {
+    switch(kind) {
+    case StatementKind::Function:
+    case StatementKind::Constructor:
+    case StatementKind::Destructor:
+    case StatementKind::Lambda:
+    case StatementKind::Block:
+        return true;
+    default:
+        return false;
+    }
+}
+
+BackwardExpressionMatcher::BackwardExpressionMatcher():
+    mLastSymbolType{LastSymbolType::None},
+    mSymbolMatchingLevel{0}
+{
+}
+
+bool BackwardExpressionMatcher::feed(const QString &token)
+{
+    if (token=="using")
+        return false;
+    switch(mLastSymbolType) {
+    case LastSymbolType::ScopeResolutionOperator: //before '::'
+        if (token==">") {
+            mLastSymbolType=LastSymbolType::MatchingAngleQuotation;
+            mSymbolMatchingLevel=0;
+        } else if (isIdentStart(token.front())) {
+            mLastSymbolType=LastSymbolType::Identifier;
+        } else
+            return false;
+        break;
+    case LastSymbolType::ObjectMemberOperator: //before '.'
+    case LastSymbolType::PointerMemberOperator: //before '->'
+    case LastSymbolType::PointerToMemberOfObjectOperator: //before '.*'
+    case LastSymbolType::PointerToMemberOfPointerOperator: //before '->*'
+        if (token == ")" ) {
+            mLastSymbolType=LastSymbolType::MatchingParenthesis;
+            mSymbolMatchingLevel = 0;
+        } else if (token == "]") {
+            mLastSymbolType=LastSymbolType::MatchingBracket;
+            mSymbolMatchingLevel = 0;
+        } else if (isIdentStart(token.front())) {
+            mLastSymbolType=LastSymbolType::Identifier;
+        } else
+            return false;
+        break;
+    case LastSymbolType::AsteriskSign: // before '*':
+        if (token == '*') {
+        } else {
+            QChar ch=token.front();
+            if (isIdent(ch)
+                    || ch.isDigit()
+                    || ch == '.'
+                    || ch == ')' ) {
+                mResult.pop_front();
+            }
+            return false;
+        }
+        break;
+    case LastSymbolType::AmpersandSign: // before '&':
+    {
+        QChar ch=token.front();
+        if (isIdent(ch)
+                || ch.isDigit()
+                || ch == '.'
+                || ch == ')' ) {
+            mResult.pop_front();
+        }
+        return false;
+    }
+        break;
+    case LastSymbolType::ParenthesisMatched: //before '()'
+        if (token == ")" ) {
+            mLastSymbolType=LastSymbolType::MatchingParenthesis;
+            mSymbolMatchingLevel = 0;
+        } else if (token == "]") {
+            mLastSymbolType=LastSymbolType::MatchingBracket;
+            mSymbolMatchingLevel = 0;
+        } else if (token == "*") {
+            mLastSymbolType=LastSymbolType::AsteriskSign;
+        } else if (token == "&") {
+            mLastSymbolType=LastSymbolType::AmpersandSign;
+        } else if (isIdentStart(token.front())) {
+            mLastSymbolType=LastSymbolType::Identifier;
+        } else
+            return false;
+        break;
+    case LastSymbolType::BracketMatched: //before '[]'
+        if (token == ")" ) {
+            mLastSymbolType=LastSymbolType::MatchingParenthesis;
+            mSymbolMatchingLevel = 0;
+        } else if (token == "]") {
+            mLastSymbolType=LastSymbolType::MatchingBracket;
+            mSymbolMatchingLevel = 0;
+        } else if (isIdentStart(token.front())) {
+            mLastSymbolType=LastSymbolType::Identifier;
+        } else
+            return false;
+        break;
+    case LastSymbolType::AngleQuotationMatched: //before '<>'
+        if (isIdentStart(token.front())) {
+            mLastSymbolType=LastSymbolType::Identifier;
+        } else
+            return false;
+        break;
+    case LastSymbolType::None:
+        if (token =="::") {
+            mLastSymbolType=LastSymbolType::ScopeResolutionOperator;
+        } else if (token == ".") {
+            mLastSymbolType=LastSymbolType::ObjectMemberOperator;
+        } else if (token=="->") {
+            mLastSymbolType = LastSymbolType::PointerMemberOperator;
+        } else if (token == ".*") {
+            mLastSymbolType = LastSymbolType::PointerToMemberOfObjectOperator;
+        } else if (token == "->*"){
+            mLastSymbolType = LastSymbolType::PointerToMemberOfPointerOperator;
+        } else if (token == ")" ) {
+            mLastSymbolType=LastSymbolType::MatchingParenthesis;
+            mSymbolMatchingLevel = 0;
+        } else if (token == "]") {
+            mLastSymbolType=LastSymbolType::MatchingBracket;
+            mSymbolMatchingLevel = 0;
+        } else if (isIdentStart(token.front())) {
+            mLastSymbolType=LastSymbolType::Identifier;
+        } else
+            return false;
+        break;
+    case LastSymbolType::TildeSign:
+        if (token =="::") {
+            mLastSymbolType=LastSymbolType::ScopeResolutionOperator;
+        } else {
+            // "~" must appear after "::"
+            mResult.pop_front();
+            return false;
+        }
+        break;;
+    case LastSymbolType::Identifier:
+        if (token =="::") {
+            mLastSymbolType=LastSymbolType::ScopeResolutionOperator;
+        } else if (token == ".") {
+            mLastSymbolType=LastSymbolType::ObjectMemberOperator;
+        } else if (token=="->") {
+            mLastSymbolType = LastSymbolType::PointerMemberOperator;
+        } else if (token == ".*") {
+            mLastSymbolType = LastSymbolType::PointerToMemberOfObjectOperator;
+        } else if (token == "->*"){
+            mLastSymbolType = LastSymbolType::PointerToMemberOfPointerOperator;
+        } else if (token == "~") {
+            mLastSymbolType=LastSymbolType::TildeSign;
+        } else if (token == "*") {
+            mLastSymbolType=LastSymbolType::AsteriskSign;
+        } else if (token == "&") {
+            mLastSymbolType=LastSymbolType::AmpersandSign;
+        } else
+            return false; // stop matching;
+        break;
+    case LastSymbolType::MatchingParenthesis:
+        if (token=="(") {
+            if (mSymbolMatchingLevel==0) {
+                mLastSymbolType=LastSymbolType::ParenthesisMatched;
+            } else {
+                mSymbolMatchingLevel--;
+            }
+        } else if (token==")") {
+            mSymbolMatchingLevel++;
+        }
+        break;
+    case LastSymbolType::MatchingBracket:
+        if (token=="[") {
+            if (mSymbolMatchingLevel==0) {
+                mLastSymbolType=LastSymbolType::BracketMatched;
+            } else {
+                mSymbolMatchingLevel--;
+            }
+        } else if (token=="]") {
+            mSymbolMatchingLevel++;
+        }
+        break;
+    case LastSymbolType::MatchingAngleQuotation:
+        if (token=="<") {
+            if (mSymbolMatchingLevel==0) {
+                mLastSymbolType=LastSymbolType::AngleQuotationMatched;
+            } else {
+                mSymbolMatchingLevel--;
+            }
+        } else if (token==">") {
+            mSymbolMatchingLevel++;
+        }
+        break;
+    }
+    mResult.push_front(token);
+    return true;
+}
+
+PSemanticTokenTable SemanticTokenTable::build(
+        const std::shared_ptr<CppParser> &parser,
+        const QString &filename,
+        const QStringList &lines)
+{
+    struct Token {
+        QString text;
+        int start;
+        bool identifier;
+    };
+    //tokenize the whole file once; expressions are matched on the token lists
+    QVector<QVector<Token>> tokensOfLines(lines.count());
+    QSynedit::CppSyntaxer syntaxer;
+    syntaxer.resetState();
+    for (int i=0;i<lines.count();i++) {
+        syntaxer.setLine(lines[i],i);
+        QVector<Token> &tokens = tokensOfLines[i];
+        while (!syntaxer.eol()) {
+            QSynedit::PTokenAttribute attr = syntaxer.getTokenAttribute();
+            if (attr->tokenType() != QSynedit::TokenType::Comment
+                    && attr->tokenType() != QSynedit::TokenType::Space) {
+                tokens.append(Token{
+                                  syntaxer.getToken(),
+                                  syntaxer.getTokenPos(),
+                                  attr->tokenType() == QSynedit::TokenType::Identifier});
+            }
+            syntaxer.next();
+        }
+        syntaxer.setState(syntaxer.getState());
+    }
+
+    PSemanticTokenTable table = std::make_shared<SemanticTokenTable>();
+    table->mLines.resize(lines.count());
+    QHash<QString,StatementKind> kindCache;
+    InactiveLineRanges inactiveRanges = parser->inactiveLineRanges(filename);
+    for (int line=0;line<tokensOfLines.count();line++) {
+        if (parser->parsing())
+            return PSemanticTokenTable();
+        Line& tableLine = table->mLines[line];
+        tableLine.valid = true;
+        if (isLineInInactiveRanges(inactiveRanges, line+1))
+            continue;
+        const QVector<Token> &tokens = tokensOfLines[line];
+        PStatement scope;
+        if (!tokens.isEmpty())
+            scope = parser->findScopeStatement(filename, line+1);
+        for (int i=0;i<tokens.count();i++) {
+            if (!tokens[i].identifier)
+                continue;
+            BackwardExpressionMatcher matcher;
+            int l = line;
+            int j = i;
+            while (l>=0) {
+                const QVector<Token> &lineTokens = tokensOfLines[l];
+                for (;j>=0;j--) {
+                    if (!matcher.feed(lineTokens[j].text))
+                        break;
+                }
+                if (j>=0)
+                    break;
+                l--;
+                if (l>=0)
+                    j = tokensOfLines[l].count()-1;
+            }
+            //outside of function bodies the kind of an expression only depends on
+            //the scope it's in, so identical expressions there share the result.
+            //Locals in function bodies can be shadowed by nested blocks or declared
+            //later in the same block, so they are always resolved at their line.
+            bool cacheable = !scope || !isFunctionBodyKind(scope->kind);
+            QString key;
+            StatementKind kind;
+            auto it = kindCache.constEnd();
+            if (cacheable) {
+                key = QString("%1 %2").arg((quintptr)scope.get()).arg(matcher.result().join(QChar(' ')));
+                it = kindCache.constFind(key);
+            }
+            if (it != kindCache.constEnd()) {
+                kind = it.value();
+            } else {
+                PStatement statement = parser->findStatementOf(
+                            filename,
+                            matcher.result(),
+                            line+1);
+                while (statement && statement->kind == StatementKind::Alias)
+                    statement = parser->findAliasedStatement(statement);
+                kind = getKindOfStatement(statement);
+                if (cacheable)
+                    kindCache.insert(key, kind);
+            }
+            tableLine.tokens.append(SemanticToken{
+                                        tokens[i].start+1,
+                                        tokens[i].text.length(),
+                                        kind});
+        }
+    }
+    return table;
+}
+
+bool SemanticTokenTable::lookup(int line, int ch, StatementKind &kind) const
+{
+    int index = line-1;
+    if (index<0 || index>=mLines.count())
+        return false;
+    const Line& tableLine = mLines[index];
+    if (!tableLine.valid)
+        return false;
+    auto it = std::lower_bound(tableLine.tokens.begin(), tableLine.tokens.end(), ch,
+                               [](const SemanticToken& token, int ch){
+        return token.ch < ch;
+    });
+    if (it == tableLine.tokens.end() || it->ch != ch)
+        return false;
+    kind = it->kind;
+    return true;
+}
+
+void SemanticTokenTable::linesInserted(int first, int count)
+{
+    if (first<0 || first>mLines.count() || count<=0)
+        return;
+    mLines.insert(first, count, Line{false, QVector<SemanticToken>()});
+}
+
+void SemanticTokenTable::linesDeleted(int first, int count)
+{
+    if (first<0 || first>=mLines.count() || count<=0)
+        return;
+    mLines.remove(first, std::min(count, mLines.count()-first));
+}
+
+void SemanticTokenTable::linePutted(int line)
+{
+    if (line<0 || line>=mLines.count())
+        return;
+    mLines[line].valid = false;
+    mLines[line].tokens.clear();
+}
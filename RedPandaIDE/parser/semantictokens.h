@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2020-2022 Roy Qu (royqh1979@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef SEMANTICTOKENS_H
+#define SEMANTICTOKENS_H
+
+#include <QStringList>
+#include <QVector>
+#include <memory>
+#include "parserutils.h"
+
+class CppParser;
+
+/*
+ * Collects the expression an identifier belongs to (e.g. "a" "." "b" for
+ * the "b" in "a.b"), fed with the (non blank, non comment) tokens before
+ * and including the identifier, from right to left.
+ */
+class BackwardExpressionMatcher {
+public:
+    BackwardExpressionMatcher();
+    // returns false if the expression is complete and no more tokens are needed
+    bool feed(const QString& token);
+    const QStringList& result() const { return mResult; }
+private:
+    enum class LastSymbolType {
+        Identifier,
+        ScopeResolutionOperator, //'::'
+        ObjectMemberOperator, //'.'
+        PointerMemberOperator, //'->'
+        PointerToMemberOfObjectOperator, //'.*'
+        PointerToMemberOfPointerOperator, //'->*'
+        MatchingBracket,
+        BracketMatched,
+        MatchingParenthesis,
+        ParenthesisMatched,
+        TildeSign,    // '~'
+        AsteriskSign, // '*'
+        AmpersandSign, // '&'
+        MatchingAngleQuotation,
+        AngleQuotationMatched,
+        None
+    };
+    LastSymbolType mLastSymbolType;
+    int mSymbolMatchingLevel;
+    QStringList mResult;
+};
+
+struct SemanticToken {
+    int ch; // 1-based
+    int length;
+    StatementKind kind;
+};
+
+/*
+ * Statement kinds of the identifiers in a file, computed in the background
+ * after the file is parsed, so painting doesn't need to query the parser.
+ *
+ * Lines are invalidated when they are edited; the painter should fall back
+ * to query the parser for them until the table is rebuilt.
+ */
+class SemanticTokenTable {
+public:
+    // returns nullptr if the parser starts a new parse while building
+    static std::shared_ptr<SemanticTokenTable> build(
+            const std::shared_ptr<CppParser>& parser,
+            const QString& filename,
+            const QStringList& lines);
+
+    // line is 1-based; returns false if the line is invalidated or the token is unknown
+    bool lookup(int line, int ch, StatementKind& kind) const;
+
+    // line indexes are 0-based (same as QSynedit::Document's signals)
+    void linesInserted(int first, int count);
+    void linesDeleted(int first, int count);
+    void linePutted(int line);
+private:
+    struct Line {
+        bool valid;
+        QVector<SemanticToken> tokens; // sorted by ch
+    };
+    QVector<Line> mLines;
+};
+
+using PSemanticTokenTable = std::shared_ptr<SemanticTokenTable>;
+
+#endif // SEMANTICTOKENS_H
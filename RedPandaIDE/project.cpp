@@ -309,9 +309,10 @@ PProjectModelNode Project::makeNewFolderNode(
     node->isUnit=false;
     node->priority = priority;
     node->folderNodeType = nodeType;
-    QModelIndex parentIndex=mModel.getNodeIndex(newParent.get());
     newParent->children.append(node);
-    mModel.insertRow(newParent->children.count()-1,parentIndex);
+    //the model will be reset by endUpdate()
+    if (!mModel.updating())
+        mModel.insertRow(newParent->children.count()-1,mModel.getNodeIndex(newParent.get()));
     return node;
 }
 
@@ -332,8 +333,9 @@ PProjectModelNode Project::makeNewFileNode(PProjectUnit unit,int priority, PProj
     node->folderNodeType = ProjectModelNodeType::File;
 
     newParent->children.append(node);
-    QModelIndex parentIndex=mModel.getNodeIndex(newParent.get());
-    mModel.insertRow(newParent->children.count()-1,parentIndex);
+    //the model will be reset by endUpdate()
+    if (!mModel.updating())
+        mModel.insertRow(newParent->children.count()-1,mModel.getNodeIndex(newParent.get()));
     return node;
 }
 
@@ -448,13 +450,9 @@ Editor *Project::unitEditor(const ProjectUnit *unit) const
     return mEditorList->getOpenedEditorByFilename(unit->fileName());
 }
 
-QList<PProjectUnit> Project::unitList()
+const QHash<QString, PProjectUnit> &Project::units() const
 {
-    QList<PProjectUnit> units;
-    foreach(PProjectUnit unit, mUnits) {
-        units.append(unit);
-    }
-    return units;
+    return mUnits;
 }
 
 QStringList Project::unitFiles()
@@ -1706,7 +1704,11 @@ void Project::createFolderNodes()
 static void addFolderRecursively(QSet<QString>& folders, QString folder) {
     if (folder.isEmpty())
         return;
-    folders.insert(excludeTrailingPathDelimiter(folder));
+    QString folderPath = excludeTrailingPathDelimiter(folder);
+    //its parents are already added
+    if (folders.contains(folderPath))
+        return;
+    folders.insert(folderPath);
     QString parentFolder = QFileInfo(folder).absolutePath();
     if (parentFolder==folder)
         return;
@@ -1814,11 +1816,7 @@ PProjectUnit Project::doAutoOpen()
 
 bool Project::fileAlreadyExists(const QString &s)
 {
-    foreach (const PProjectUnit& unit, mUnits) {
-        if (unit->fileName() == s)
-            return true;
-    }
-    return false;
+    return mUnits.contains(s);
 }
 
 PProjectModelNode Project::findFileSystemFolderNode(const QString &folderPath, ProjectModelNodeType nodeType)
@@ -1838,18 +1836,14 @@ PProjectModelNode Project::findFileSystemFolderNode(const QString &folderPath, P
             for (int i=0;i<paths.length();i++) {
                 QString currentFolderName = paths[i];
                 currentFolderFullPath = currentFolderFullPath+"/"+currentFolderName;
-                bool found=false;
-                foreach(PProjectModelNode tempNode, parentNode->children) {
-                    if (tempNode->folderNodeType == ProjectModelNodeType::Folder
-                            && tempNode->text == currentFolderName) {
-                        found=true;
-                        currentParentNode = tempNode;
-                        break;
-                    }
-                }
-                if (!found) {
+                //folder nodes are indexed by path, no need to search the children
+                QString key = QString("%1/%2").arg((int)nodeType).arg(currentFolderFullPath);
+                PProjectModelNode tempNode = mFileSystemFolderNodes.value(key,PProjectModelNode());
+                if (tempNode) {
+                    currentParentNode = tempNode;
+                } else {
                     PProjectModelNode newNode = makeNewFolderNode(currentFolderName,currentParentNode);
-                    mFileSystemFolderNodes.insert(QString("%1/%2").arg((int)nodeType).arg(currentFolderFullPath),newNode);
+                    mFileSystemFolderNodes.insert(key,newNode);
                     currentParentNode = newNode;
                 }
             }
@@ -2491,6 +2485,17 @@ ProjectModel::ProjectModel(Project *project, QObject *parent):
     mUpdateCount = 0;
     //delete in the destructor
     mIconProvider = new CustomFileIconProvider();
+#ifdef ENABLE_VCS
+    connect(mIconProvider->VCSRepository(), &GitRepository::statusChanged,
+            this, [this](){
+        if (updating() || !mProject->rootNode())
+            return;
+        //root node shows the current branch
+        QModelIndex index = rootIndex();
+        emit dataChanged(index,index);
+        refreshNodeIconRecursive(mProject->rootNode());
+    });
+#endif
 }
 
 ProjectModel::~ProjectModel()
@@ -2510,11 +2515,16 @@ void ProjectModel::endUpdate()
 {
     mUpdateCount--;
     if (mUpdateCount==0) {
-        mIconProvider->setRootFolder(mProject->folder());
         endResetModel();
+        mIconProvider->setRootFolder(mProject->folder());
     }
 }
 
+bool ProjectModel::updating() const
+{
+    return mUpdateCount>0;
+}
+
 CustomFileIconProvider *ProjectModel::iconProvider() const
 {
     return mIconProvider;
@@ -2771,7 +2781,7 @@ void ProjectModel::refreshIcon(const QModelIndex &index, bool update)
     if (!index.isValid())
         return;
     if (update)
-        mIconProvider->update();
+        mIconProvider->requestUpdate();
     QVector<int> roles;
     roles.append(Qt::DecorationRole);
     emit dataChanged(index,index, roles);
@@ -2789,8 +2799,7 @@ void ProjectModel::refreshIcon(const QString &filename)
 
 void ProjectModel::refreshIcons()
 {
-    mIconProvider->update();
-    mProject->rootNode();
+    mIconProvider->requestUpdate();
 }
 
 void ProjectModel::refreshNodeIconRecursive(PProjectModelNode node)
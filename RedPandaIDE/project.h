@@ -135,6 +135,7 @@ public:
     ~ProjectModel();
     void beginUpdate();
     void endUpdate();
+    bool updating() const;
 private:
     Project* mProject;
     int mUpdateCount;
@@ -240,7 +241,7 @@ public:
     Editor* unitEditor(const PProjectUnit& unit) const;
     Editor* unitEditor(const ProjectUnit* unit) const;
 
-    QList<PProjectUnit> unitList();
+    const QHash<QString,PProjectUnit>& units() const; // file name -> unit
     QStringList unitFiles();
 
     PProjectModelNode pointerToNode(ProjectModelNode * p, PProjectModelNode parent=PProjectModelNode());
@@ -32,6 +32,8 @@
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
+#include <QThreadPool>
+#include "compiler/compilerprobecache.h"
 #ifdef Q_OS_LINUX
 #include <sys/sysinfo.h>
 #endif
@@ -724,6 +726,16 @@ void Settings::Editor::setParseTodos(bool newParseTodos)
     mParseTodos = newParseTodos;
 }
 
+int Settings::Editor::undoMemoryUsage() const
+{
+    return mUndoMemoryUsage;
+}
+
+void Settings::Editor::setUndoMemoryUsage(int newUndoMemoryUsage)
+{
+    mUndoMemoryUsage = newUndoMemoryUsage;
+}
+
 const QStringList &Settings::Editor::customCTypeKeywords() const
 {
     return mCustomCTypeKeywords;
@@ -1229,6 +1241,16 @@ void Settings::Editor::setScrollPastEol(bool scrollPastEol)
     mScrollPastEol = scrollPastEol;
 }
 
+bool Settings::Editor::wordWrap() const
+{
+    return mWordWrap;
+}
+
+void Settings::Editor::setWordWrap(bool newWordWrap)
+{
+    mWordWrap = newWordWrap;
+}
+
 bool Settings::Editor::scrollPastEof() const
 {
     return mScrollPastEof;
@@ -1277,6 +1299,7 @@ void Settings::Editor::doSave()
     saveValue("auto_hide_scroll_bar", mAutoHideScrollbar);
     saveValue("scroll_past_eof", mScrollPastEof);
     saveValue("scroll_past_eol", mScrollPastEol);
+    saveValue("word_wrap", mWordWrap);
     saveValue("half_page_scroll", mHalfPageScroll);
     saveValue("mouse_wheel_scroll_speed", mMouseWheelScrollSpeed);
     saveValue("mouse_drag_scroll_speed",mMouseSelectionScrollSpeed);
@@ -1362,6 +1385,7 @@ void Settings::Editor::doSave()
     saveValue("auto_format_when_saved", mAutoFormatWhenSaved);
     saveValue("remove_trailing_spaces_when_saved",mRemoveTrailingSpacesWhenSaved);
     saveValue("parse_todos",mParseTodos);
+    saveValue("undo_memory_usage",mUndoMemoryUsage);
 
     saveValue("custom_c_type_keywords", mCustomCTypeKeywords);
     saveValue("enable_custom_c_type_keywords",mEnableCustomCTypeKeywords);
@@ -1403,6 +1427,7 @@ void Settings::Editor::doLoad()
     mAutoHideScrollbar = boolValue("auto_hide_scroll_bar", false);
     mScrollPastEof = boolValue("scroll_past_eof", true);
     mScrollPastEol = boolValue("scroll_past_eol", false);
+    mWordWrap = boolValue("word_wrap", false);
     mHalfPageScroll = boolValue("half_page_scroll",false);
     mMouseWheelScrollSpeed = intValue("mouse_wheel_scroll_speed", 3);
     mMouseSelectionScrollSpeed = intValue("mouse_drag_scroll_speed",10);
@@ -1520,6 +1545,7 @@ void Settings::Editor::doLoad()
     mAutoFormatWhenSaved = boolValue("auto_format_when_saved", false);
     mRemoveTrailingSpacesWhenSaved = boolValue("remove_trailing_spaces_when_saved",false);
     mParseTodos = boolValue("parse_todos",true);
+    mUndoMemoryUsage = intValue("undo_memory_usage",64);
 
     mCustomCTypeKeywords = stringListValue("custom_c_type_keywords");
     mEnableCustomCTypeKeywords = boolValue("enable_custom_c_type_keywords",false);
@@ -2258,7 +2284,7 @@ void Settings::CompilerSet::setGCCProperties(const QString& binDir, const QStrin
     // Obtain version number and compiler distro etc
     QStringList arguments;
     arguments.append("-v");
-    QByteArray output = getCompilerOutput(binDir, c_prog,arguments);
+    QByteArray output = getProbeOutput(binDir, c_prog,arguments);
 
     //Target
     QByteArray targetStr = "Target: ";
@@ -2362,7 +2388,7 @@ void Settings::CompilerSet::setGCCProperties(const QString& binDir, const QStrin
     // Obtain compiler target
     arguments.clear();
     arguments.append("-dumpmachine");
-    mDumpMachine = getCompilerOutput(binDir, c_prog, arguments);
+    mDumpMachine = getProbeOutput(binDir, c_prog, arguments);
 
     // Add the default directories
     addExistingDirectory(mBinDirs, includeTrailingPathDelimiter(folder) +  "bin");
@@ -2384,7 +2410,7 @@ void Settings::CompilerSet::setSDCCProperties(const QString& binDir, const QStri
     // Obtain version number and compiler distro etc
     QStringList arguments;
     arguments.append("-v");
-    QByteArray output = getCompilerOutput(binDir, c_prog,arguments);
+    QByteArray output = getProbeOutput(binDir, c_prog,arguments);
 
     if (!output.startsWith("SDCC"))
         return;
@@ -2572,7 +2598,7 @@ void Settings::CompilerSet::setGCCDirectories(const QString& binDir)
     arguments.append("-v");
     arguments.append("-E");
     arguments.append(NULL_FILE);
-    QByteArray output = getCompilerOutput(binDir,c_prog,arguments);
+    QByteArray output = getProbeOutput(binDir,c_prog,arguments);
 
     int delimPos1 = output.indexOf("#include <...> search starts here:");
     int delimPos2 = output.indexOf("End of search list.");
@@ -2594,7 +2620,7 @@ void Settings::CompilerSet::setGCCDirectories(const QString& binDir)
     arguments.append("-E");
     arguments.append("-v");
     arguments.append(NULL_FILE);
-    output = getCompilerOutput(binDir,c_prog,arguments);
+    output = getProbeOutput(binDir,c_prog,arguments);
     //gcc -xc++ -E -v NUL
 
     delimPos1 = output.indexOf("#include <...> search starts here:");
@@ -2614,7 +2640,7 @@ void Settings::CompilerSet::setGCCDirectories(const QString& binDir)
     arguments.clear();
     arguments.append("-print-search-dirs");
     arguments.append(NULL_FILE);
-    output = getCompilerOutput(binDir,c_prog,arguments);
+    output = getProbeOutput(binDir,c_prog,arguments);
     // bin dirs
     QByteArray targetStr = QByteArray("programs: =");
     delimPos1 = output.indexOf(targetStr);
@@ -2714,7 +2740,7 @@ void Settings::CompilerSet::setSDCCDirectories(const QString& binDir)
         if (!mCompileOptions[key].isEmpty())
             arguments.append(pOption->setting + mCompileOptions[key]);
     }
-    QByteArray output = getCompilerOutput(binDir,c_prog,arguments);
+    QByteArray output = getProbeOutput(binDir,c_prog,arguments);
 
     //bindirs
     QByteArray targetStr = QByteArray("programs:");
@@ -2843,7 +2869,7 @@ void Settings::CompilerSet::setIniOptions(const QByteArray &value)
    }
 }
 
-QByteArray Settings::CompilerSet::getCompilerOutput(const QString &binDir, const QString &binFile, const QStringList &arguments)
+QByteArray Settings::CompilerSet::getCompilerOutput(const QString &binDir, const QString &binFile, const QStringList &arguments, bool *succeeded)
 {
     QProcessEnvironment env;
     env.insert("LANG","en");
@@ -2857,9 +2883,25 @@ QByteArray Settings::CompilerSet::getCompilerOutput(const QString &binDir, const
                 false,
                 false,
                 env);
+    if (succeeded)
+        *succeeded = errorMessage.isEmpty();
     return result.trimmed();
 }
 
+QByteArray Settings::CompilerSet::getProbeOutput(const QString &binDir, const QString &binFile, const QStringList &arguments)
+{
+    PCompilerProbeCache cache = CompilerProbeCache::getInstance();
+    QString binPath = includeTrailingPathDelimiter(binDir)+binFile;
+    QByteArray output;
+    if (cache->lookup(binPath, arguments, output))
+        return output;
+    bool succeeded;
+    output = getCompilerOutput(binDir, binFile, arguments, &succeeded);
+    if (succeeded && !output.isEmpty())
+        cache->store(binPath, arguments, output);
+    return output;
+}
+
 bool Settings::CompilerSet::forceEnglishOutput() const
 {
     return mForceEnglishOutput;
@@ -3069,11 +3111,15 @@ Settings::PCompilerSet Settings::CompilerSets::addSet()
 
 Settings::PCompilerSet Settings::CompilerSets::addSet(const QString &folder, const QString& c_prog)
 {
-    PCompilerSet p=std::make_shared<CompilerSet>(folder,c_prog);
-    if (c_prog==GCC_PROGRAM && p->compilerType()==CompilerType::Clang)
+    return addProbedSet(std::make_shared<CompilerSet>(folder,c_prog), c_prog);
+}
+
+Settings::PCompilerSet Settings::CompilerSets::addProbedSet(const PCompilerSet &pSet, const QString &c_prog)
+{
+    if (c_prog==GCC_PROGRAM && pSet->compilerType()==CompilerType::Clang)
         return PCompilerSet();
-    mList.push_back(p);
-    return p;
+    mList.push_back(pSet);
+    return pSet;
 }
 
 Settings::PCompilerSet Settings::CompilerSets::addSet(const PCompilerSet &pSet)
@@ -3122,12 +3168,26 @@ static void setDebugOptions(Settings::PCompilerSet pSet, bool enableAsan = false
 }
 
 bool Settings::CompilerSets::addSets(const QString &folder, const QString& c_prog) {
+    if (hasSet(folder, c_prog))
+        return false;
+    return addProbedSets(std::make_shared<CompilerSet>(folder,c_prog), folder, c_prog);
+}
+
+bool Settings::CompilerSets::hasSet(const QString &folder, const QString &c_prog) const
+{
     foreach (const PCompilerSet& set, mList) {
         if (set->binDirs().contains(folder) && extractFileName(set->CCompiler())==c_prog)
-            return false;
+            return true;
     }
+    return false;
+}
+
+bool Settings::CompilerSets::addProbedSets(const PCompilerSet &probedSet, const QString &folder, const QString &c_prog)
+{
+    if (hasSet(folder, c_prog))
+        return false;
     // Default, release profile
-    PCompilerSet baseSet = addSet(folder,c_prog);
+    PCompilerSet baseSet = addProbedSet(probedSet,c_prog);
     if (!baseSet || baseSet->name().isEmpty())
         return false;
 #if ENABLE_SDCC
@@ -3271,6 +3331,16 @@ void Settings::CompilerSets::findSets()
         mSettings->dirs().appDir() + "/mingw64/bin",
         mSettings->dirs().appDir() + "/mingw32/bin",
     } + pathList;
+#endif
+    struct ProbeTask {
+        QString folder;
+        QString c_prog;
+        PCompilerSet set;
+    };
+    QList<ProbeTask> tasks;
+    QStringList programs{GCC_PROGRAM, CLANG_PROGRAM};
+#ifdef ENABLE_SDCC
+    programs.append(SDCC_PROGRAM);
 #endif
     QString folder, canonicalFolder;
     for (int i=pathList.count()-1;i>=0;i--) {
@@ -3286,7 +3356,29 @@ void Settings::CompilerSets::findSets()
         //   /opt/gcc-13 -> /opt/gcc-13.1.0
         // after upgrade:
         //   /opt/gcc-13 -> /opt/gcc-13.2.0
-        addSets(folder);
+        for (const QString& c_prog: programs) {
+            if (fileExists(folder, c_prog))
+                tasks.append(ProbeTask{folder, c_prog, PCompilerSet()});
+        }
+    }
+
+    // Probing a compiler runs it several times, so probe all found compilers concurrently.
+    // Results are then added in the PATH order, to keep the list stable.
+    PCompilerProbeCache probeCache = CompilerProbeCache::getInstance();
+    probeCache->load(includeTrailingPathDelimiter(mSettings->dirs().config())
+                     + DEV_COMPILER_PROBE_CACHE_FILE);
+    CompilerInfoManager::getInstance();
+    QThreadPool pool;
+    for (ProbeTask& task: tasks) {
+        pool.start(QRunnable::create([&task](){
+            task.set = std::make_shared<CompilerSet>(task.folder, task.c_prog);
+        }));
+    }
+    pool.waitForDone();
+    probeCache->save();
+
+    for (const ProbeTask& task: tasks) {
+        addProbedSets(task.set, task.folder, task.c_prog);
     }
 
 #ifdef ENABLE_LUA_ADDON
@@ -4270,6 +4362,56 @@ void Settings::Executor::setEnableVirualTerminalSequence(bool newEnableVirualTer
     mEnableVirualTerminalSequence = newEnableVirualTerminalSequence;
 }
 
+bool Settings::Executor::enableRunLimit() const
+{
+    return mEnableRunLimit;
+}
+
+void Settings::Executor::setEnableRunLimit(bool newEnableRunLimit)
+{
+    mEnableRunLimit = newEnableRunLimit;
+}
+
+size_t Settings::Executor::runCpuTimeLimit() const
+{
+    return mRunCpuTimeLimit;
+}
+
+void Settings::Executor::setRunCpuTimeLimit(size_t newRunCpuTimeLimit)
+{
+    mRunCpuTimeLimit = newRunCpuTimeLimit;
+}
+
+size_t Settings::Executor::runMemoryLimit() const
+{
+    return mRunMemoryLimit;
+}
+
+void Settings::Executor::setRunMemoryLimit(size_t newRunMemoryLimit)
+{
+    mRunMemoryLimit = newRunMemoryLimit;
+}
+
+int Settings::Executor::benchmarkRuns() const
+{
+    return mBenchmarkRuns;
+}
+
+void Settings::Executor::setBenchmarkRuns(int newBenchmarkRuns)
+{
+    mBenchmarkRuns = newBenchmarkRuns;
+}
+
+int Settings::Executor::benchmarkWarmups() const
+{
+    return mBenchmarkWarmups;
+}
+
+void Settings::Executor::setBenchmarkWarmups(int newBenchmarkWarmups)
+{
+    mBenchmarkWarmups = newBenchmarkWarmups;
+}
+
 bool Settings::Executor::convertHTMLToTextForInput() const
 {
     return mConvertHTMLToTextForInput;
@@ -4341,6 +4483,11 @@ void Settings::Executor::doSave()
     saveValue("params",mParams);
     saveValue("redirect_input",mRedirectInput);
     saveValue("input_filename",mInputFilename);
+    saveValue("enable_run_limit", mEnableRunLimit);
+    saveValue("run_cpu_time_limit_ms", mRunCpuTimeLimit);
+    saveValue("run_memory_limit", mRunMemoryLimit);
+    saveValue("benchmark_runs", mBenchmarkRuns);
+    saveValue("benchmark_warmups", mBenchmarkWarmups);
     //problem set
     saveValue("enable_proble_set", mEnableProblemSet);
     saveValue("enable_competivie_companion", mEnableCompetitiveCompanion);
@@ -4379,6 +4526,15 @@ void Settings::Executor::doLoad()
     mParams = stringValue("params", "");
     mRedirectInput = boolValue("redirect_input",false);
     mInputFilename = stringValue("input_filename","");
+    mEnableRunLimit = boolValue("enable_run_limit", false);
+    mRunCpuTimeLimit = uintValue("run_cpu_time_limit_ms", 0); //ms
+    mRunMemoryLimit = uintValue("run_memory_limit", 0); // kb
+    mBenchmarkRuns = intValue("benchmark_runs", 10);
+    if (mBenchmarkRuns<1)
+        mBenchmarkRuns = 1;
+    mBenchmarkWarmups = intValue("benchmark_warmups", 1);
+    if (mBenchmarkWarmups<0)
+        mBenchmarkWarmups = 0;
 
     mEnableProblemSet = boolValue("enable_proble_set",true);
     mEnableCompetitiveCompanion = boolValue("enable_competivie_companion",true);
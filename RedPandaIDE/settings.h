@@ -165,6 +165,9 @@ public:
         bool scrollPastEol() const;
         void setScrollPastEol(bool scrollPastEol);
 
+        bool wordWrap() const;
+        void setWordWrap(bool newWordWrap);
+
         bool halfPageScroll() const;
         void setHalfPageScroll(bool halfPageScroll);
 
@@ -359,6 +362,9 @@ public:
         bool parseTodos() const;
         void setParseTodos(bool newParseTodos);
 
+        int undoMemoryUsage() const;
+        void setUndoMemoryUsage(int newUndoMemoryUsage);
+
         const QStringList &customCTypeKeywords() const;
         void setCustomCTypeKeywords(const QStringList &newCustomTypeKeywords);
 
@@ -419,6 +425,7 @@ public:
         bool mAutoHideScrollbar;
         bool mScrollPastEof;
         bool mScrollPastEol;
+        bool mWordWrap;
         bool mHalfPageScroll;
         int mMouseWheelScrollSpeed;
         int mMouseSelectionScrollSpeed;
@@ -504,6 +511,7 @@ public:
         bool mAutoFormatWhenSaved;
         bool mRemoveTrailingSpacesWhenSaved;
         bool mParseTodos;
+        int mUndoMemoryUsage; // in MB
 
         QStringList mCustomCTypeKeywords;
         bool mEnableCustomCTypeKeywords;
@@ -948,6 +956,21 @@ public:
 
         bool enableVirualTerminalSequence() const;
         void setEnableVirualTerminalSequence(bool newEnableVirualTerminalSequence);
+
+        bool enableRunLimit() const;
+        void setEnableRunLimit(bool newEnableRunLimit);
+
+        size_t runCpuTimeLimit() const;
+        void setRunCpuTimeLimit(size_t newRunCpuTimeLimit);
+
+        size_t runMemoryLimit() const;
+        void setRunMemoryLimit(size_t newRunMemoryLimit);
+
+        int benchmarkRuns() const;
+        void setBenchmarkRuns(int newBenchmarkRuns);
+
+        int benchmarkWarmups() const;
+        void setBenchmarkWarmups(int newBenchmarkWarmups);
     private:
         // general
         bool mPauseConsole;
@@ -957,6 +980,11 @@ public:
         bool mRedirectInput;
         QString mInputFilename;
         bool mEnableVirualTerminalSequence;
+        bool mEnableRunLimit;
+        qulonglong mRunCpuTimeLimit; //ms
+        qulonglong mRunMemoryLimit; //kb
+        int mBenchmarkRuns;
+        int mBenchmarkWarmups;
 
         //Problem Set
         bool mEnableProblemSet;
@@ -1478,7 +1506,11 @@ public:
 
 
         QByteArray getCompilerOutput(const QString& binDir, const QString& binFile,
-                                     const QStringList& arguments);
+                                     const QStringList& arguments, bool *succeeded = nullptr);
+        // same as getCompilerOutput, but reuse outputs saved in the compiler probe cache.
+        // failed probes are not cached.
+        QByteArray getProbeOutput(const QString& binDir, const QString& binFile,
+                                  const QStringList& arguments);
     private:
         bool mFullLoaded;
         // Executables, most are hardcoded
@@ -1557,6 +1589,9 @@ public:
     private:
         PCompilerSet addSet(const QString& folder, const QString& c_prog);
         PCompilerSet addSet(const PCompilerSet &pSet);
+        PCompilerSet addProbedSet(const PCompilerSet &pSet, const QString& c_prog);
+        bool addProbedSets(const PCompilerSet &baseSet, const QString& folder, const QString& c_prog);
+        bool hasSet(const QString& folder, const QString& c_prog) const;
         PCompilerSet addSet(const QJsonObject &set);
         void savePath(const QString& name, const QString& path);
         void savePathList(const QString& name, const QStringList& pathList);
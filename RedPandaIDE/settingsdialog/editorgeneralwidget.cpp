@@ -75,6 +75,7 @@ void EditorGeneralWidget::doLoad()
     ui->chkAutoHideScrollBars->setChecked(pSettings->editor().autoHideScrollbar());
     ui->chkScrollPastEOF->setChecked(pSettings->editor().scrollPastEof());
     ui->chkScrollPastEOL->setChecked(pSettings->editor().scrollPastEol());
+    ui->chkWordWrap->setChecked(pSettings->editor().wordWrap());
     ui->chkScrollHalfPage->setChecked(pSettings->editor().halfPageScroll());
     ui->spinMouseWheelScrollSpeed->setValue(pSettings->editor().mouseWheelScrollSpeed());
     ui->spinMouseSelectionScrollSpeed->setValue(pSettings->editor().mouseSelectionScrollSpeed());
@@ -111,6 +112,7 @@ void EditorGeneralWidget::doSave()
     pSettings->editor().setAutoHideScrollbar(ui->chkAutoHideScrollBars->isChecked());
     pSettings->editor().setScrollPastEof(ui->chkScrollPastEOF->isChecked());
     pSettings->editor().setScrollPastEol(ui->chkScrollPastEOL->isChecked());
+    pSettings->editor().setWordWrap(ui->chkWordWrap->isChecked());
     pSettings->editor().setHalfPageScroll(ui->chkScrollHalfPage->isChecked());
     pSettings->editor().setMouseWheelScrollSpeed(ui->spinMouseWheelScrollSpeed->value());
     pSettings->editor().setMouseSelectionScrollSpeed(ui->spinMouseSelectionScrollSpeed->value());
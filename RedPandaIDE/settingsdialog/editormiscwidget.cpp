@@ -72,6 +72,7 @@ void EditorMiscWidget::doLoad()
         ui->rbNone->setChecked(true);
 
     ui->chkParseTodos->setChecked(pSettings->editor().parseTodos());
+    ui->spinUndoMemoryUsage->setValue(pSettings->editor().undoMemoryUsage());
 }
 
 void EditorMiscWidget::doSave()
@@ -89,6 +90,7 @@ void EditorMiscWidget::doSave()
     pSettings->editor().setAutoFormatWhenSaved(ui->rbAutoReformat->isChecked());
     pSettings->editor().setRemoveTrailingSpacesWhenSaved(ui->rbRemoveTrailingSpaces->isChecked());
     pSettings->editor().setParseTodos(ui->chkParseTodos->isChecked());
+    pSettings->editor().setUndoMemoryUsage(ui->spinUndoMemoryUsage->value());
 
 
     pSettings->editor().save();
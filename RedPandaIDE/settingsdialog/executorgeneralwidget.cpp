@@ -56,6 +56,11 @@ void ExecutorGeneralWidget::doLoad()
     ui->txtExecuteParamaters->setText(pSettings->executor().params());
     ui->grpRedirectInput->setChecked(pSettings->executor().redirectInput());
     ui->txtRedirectInputFile->setText(pSettings->executor().inputFilename());
+    ui->grpRunLimit->setChecked(pSettings->executor().enableRunLimit());
+    ui->spinRunCpuTimeLimit->setValue(pSettings->executor().runCpuTimeLimit());
+    ui->spinRunMemoryLimit->setValue(pSettings->executor().runMemoryLimit());
+    ui->spinBenchmarkRuns->setValue(pSettings->executor().benchmarkRuns());
+    ui->spinBenchmarkWarmups->setValue(pSettings->executor().benchmarkWarmups());
 }
 
 void ExecutorGeneralWidget::doSave()
@@ -69,6 +74,11 @@ void ExecutorGeneralWidget::doSave()
     pSettings->executor().setParams(ui->txtExecuteParamaters->text());
     pSettings->executor().setRedirectInput(ui->grpRedirectInput->isChecked());
     pSettings->executor().setInputFilename(ui->txtRedirectInputFile->text());
+    pSettings->executor().setEnableRunLimit(ui->grpRunLimit->isChecked());
+    pSettings->executor().setRunCpuTimeLimit(ui->spinRunCpuTimeLimit->value());
+    pSettings->executor().setRunMemoryLimit(ui->spinRunMemoryLimit->value());
+    pSettings->executor().setBenchmarkRuns(ui->spinBenchmarkRuns->value());
+    pSettings->executor().setBenchmarkWarmups(ui->spinBenchmarkWarmups->value());
 
     pSettings->executor().save();
 }
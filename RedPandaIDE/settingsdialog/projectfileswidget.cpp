@@ -95,7 +95,7 @@ void ProjectFilesWidget::copyUnits()
     if (!project)
         return;
     mUnits.clear();
-    foreach (const PProjectUnit& unit, project->unitList()) {
+    foreach (const PProjectUnit& unit, project->units()) {
         PProjectUnit unitCopy = std::make_shared<ProjectUnit>(project.get());
         unitCopy->setPriority(unit->priority());
         unitCopy->setCompile(unit->compile());
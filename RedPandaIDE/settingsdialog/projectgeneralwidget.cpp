@@ -77,7 +77,7 @@ void ProjectGeneralWidget::doLoad()
     ui->txtOutputFile->setText(project->outputFilename());
 
     int srcCount=0,headerCount=0,resCount=0,otherCount=0, totalCount=0;
-    foreach (const PProjectUnit& unit, project->unitList()) {
+    foreach (const PProjectUnit& unit, project->units()) {
         switch(getFileType(unit->fileName())) {
         case FileType::CSource:
         case FileType::CppSource:
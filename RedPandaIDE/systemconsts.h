@@ -63,6 +63,9 @@
 #define PACKIHX_PROGRAM   "packihx"
 #define MAKEBIN_PROGRAM   "makebin"
 #define ASTYLE_PROGRAM     "astyle"
+#define PERF_PROGRAM     "perf"
+#define ADDR2LINE_PROGRAM     "addr2line"
+#define PROFILE_SAMPLER     "libredpanda-profsampler.so"
 #endif
 
 #define DEV_PROJECT_EXT "dev"
@@ -92,6 +95,7 @@
 #define DEV_DEBUGGER_FILE "debugger.json"
 #define DEV_HISTORY_FILE "history.json"
 #define DEV_PROBLEM_SET_FILE "problemset.json"
+#define DEV_COMPILER_PROBE_CACHE_FILE "compilerprobe.json"
 
 
 #ifdef Q_OS_WIN
@@ -0,0 +1,117 @@
+#include <algorithm>
+#include <cstdlib>
+
+#include <QApplication>
+#include <QDebug>
+#include <QRandomGenerator>
+#include <QString>
+#include <QStringList>
+
+#include "widgets/qconsole.h"
+
+int testIndex = 0;
+
+void fail(const QString& msg)
+{
+    qDebug() << "Error in test" << testIndex << ":" << msg;
+    exit(1);
+}
+
+QString randomLine(QRandomGenerator& random)
+{
+    // long lines are wrapped into several rows
+    QString line;
+    int len = random.bounded(150);
+    for (int i=0;i<len;i++)
+        line += random.bounded(10)==0 ? QChar('\t') : QChar('a' + random.bounded(26));
+    return line;
+}
+
+// the rows of the kept lines are mapped as if the removed lines were never added
+void checkLines(QConsole& console, ConsoleLines& lines, const QStringList& expected, const QString& step)
+{
+    if (lines.lines() != expected.count())
+        fail(QString("%1: %2 lines kept, expected %3").arg(step).arg(lines.lines()).arg(expected.count()));
+    for (int i=0;i<expected.count();i++) {
+        if (lines.getLine(i) != expected[i])
+            fail(QString("%1: wrong text of line %2").arg(step).arg(i));
+    }
+    ConsoleLines fresh(&console);
+    fresh.setMaxLines(0);
+    fresh.setMaxBytes(0);
+    fresh.addLines(expected);
+    if (lines.rows() != fresh.rows())
+        fail(QString("%1: %2 rows, expected %3").arg(step).arg(lines.rows()).arg(fresh.rows()));
+    if (lines.getRows(1, lines.rows()) != fresh.getRows(1, fresh.rows()))
+        fail(step + ": wrong text of the rows");
+    for (int i=0;i<expected.count();i++) {
+        for (int ch=0;ch<=expected[i].length();ch+=7) {
+            RowColumn rowColumn = lines.lineCharToRowColumn(i, ch);
+            RowColumn expectedRowColumn = fresh.lineCharToRowColumn(i, ch);
+            if (rowColumn.row != expectedRowColumn.row || rowColumn.column != expectedRowColumn.column)
+                fail(QString("%1: char %2 of line %3 is at %4:%5, expected %6:%7").arg(step).arg(ch).arg(i)
+                     .arg(rowColumn.row).arg(rowColumn.column)
+                     .arg(expectedRowColumn.row).arg(expectedRowColumn.column));
+            LineChar lineChar = lines.rowColumnToLineChar(rowColumn);
+            LineChar expectedLineChar = fresh.rowColumnToLineChar(rowColumn);
+            if (lineChar.line != expectedLineChar.line || lineChar.ch != expectedLineChar.ch)
+                fail(QString("%1: row %2 column %3 is mapped to %4:%5, expected %6:%7").arg(step)
+                     .arg(rowColumn.row).arg(rowColumn.column)
+                     .arg(lineChar.line).arg(lineChar.ch)
+                     .arg(expectedLineChar.line).arg(expectedLineChar.ch));
+        }
+    }
+}
+
+void testTrimFirstLines()
+{
+    ++testIndex;
+    QConsole console;
+    console.resize(400, 300);
+    console.show();
+    QApplication::processEvents();
+    if (console.columnsPerRow() <= 0)
+        fail("console is not layouted");
+
+    QRandomGenerator random(49);
+    ConsoleLines lines(&console);
+    lines.layout();
+    lines.setMaxBytes(0);
+    int maxLines = 20;
+    lines.setMaxLines(maxLines);
+    QStringList expected;
+    for (int step=0;step<300;step++) {
+        int op = random.bounded(5);
+        if (op <= 2) {
+            QStringList newLines;
+            int n = random.bounded(8)+1;
+            for (int i=0;i<n;i++)
+                newLines.append(randomLine(random));
+            lines.addLines(newLines);
+            expected.append(newLines);
+        } else if (op == 3 && !expected.isEmpty()) {
+            QString line = randomLine(random);
+            lines.changeLastLine(line);
+            expected.last() = line;
+        } else if (!expected.isEmpty()) {
+            lines.RemoveLastLine();
+            expected.removeLast();
+        }
+        if (step % 50 == 49) {
+            maxLines = random.bounded(30)+1;
+            lines.setMaxLines(maxLines);
+        }
+        //the last line is always kept
+        while (expected.count() > std::max(maxLines, 1))
+            expected.removeFirst();
+        checkLines(console, lines, expected, QString("step %1").arg(step));
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication app(argc, argv);
+    testTrimFirstLines();
+    return 0;
+}
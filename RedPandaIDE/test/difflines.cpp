@@ -0,0 +1,129 @@
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#include <QDebug>
+#include <QRandomGenerator>
+#include <QString>
+#include <QStringList>
+
+#include "qsynedit/miscprocs.h"
+
+using QSynedit::LineDiffHunk;
+using QSynedit::diffLines;
+
+int testIndex = 0;
+
+void fail(const QString& msg)
+{
+    qDebug() << "Error in test" << testIndex << ":" << msg;
+    exit(1);
+}
+
+// number of inserted/deleted lines in the shortest edit script
+int minEdits(const QStringList& oldLines, const QStringList& newLines)
+{
+    int n = oldLines.count();
+    int m = newLines.count();
+    std::vector<std::vector<int>> lcs(n+1, std::vector<int>(m+1, 0));
+    for (int i=n-1;i>=0;i--) {
+        for (int j=m-1;j>=0;j--) {
+            if (oldLines[i] == newLines[j])
+                lcs[i][j] = lcs[i+1][j+1] + 1;
+            else
+                lcs[i][j] = std::max(lcs[i+1][j], lcs[i][j+1]);
+        }
+    }
+    return n + m - 2*lcs[0][0];
+}
+
+// check the hunks turn oldLines into newLines, and return the number of changed lines
+int applyHunks(const QStringList& oldLines, const QStringList& newLines, const QList<LineDiffHunk>& hunks)
+{
+    QStringList result;
+    int oldPos = 0;
+    int newPos = 0;
+    int edits = 0;
+    foreach (const LineDiffHunk& hunk, hunks) {
+        if (hunk.oldStart < oldPos || hunk.oldCount < 0 || hunk.newCount < 0
+                || hunk.oldCount + hunk.newCount == 0)
+            fail("hunks are not sorted or empty");
+        // unchanged lines between the hunks are the same in both
+        if (hunk.oldStart - oldPos != hunk.newStart - newPos)
+            fail("unchanged lines between hunks don't match");
+        result.append(oldLines.mid(oldPos, hunk.oldStart - oldPos));
+        result.append(newLines.mid(hunk.newStart, hunk.newCount));
+        oldPos = hunk.oldStart + hunk.oldCount;
+        newPos = hunk.newStart + hunk.newCount;
+        edits += hunk.oldCount + hunk.newCount;
+    }
+    result.append(oldLines.mid(oldPos));
+    if (result != newLines)
+        fail("applying the hunks doesn't give the new lines");
+    return edits;
+}
+
+QStringList randomLines(QRandomGenerator& random, int count)
+{
+    // few distinct lines, so there are many common lines to match
+    QStringList lines;
+    for (int i=0;i<count;i++)
+        lines.append(QString("line %1").arg(random.bounded(5)));
+    return lines;
+}
+
+void testRandom()
+{
+    ++testIndex;
+    QRandomGenerator random(2024);
+    for (int i=0;i<500;i++) {
+        QStringList oldLines = randomLines(random, random.bounded(20));
+        QStringList newLines = randomLines(random, random.bounded(20));
+        int edits = applyHunks(oldLines, newLines, diffLines(oldLines, newLines));
+        if (edits != minEdits(oldLines, newLines))
+            fail(QString("%1 lines changed, expected %2").arg(edits).arg(minEdits(oldLines, newLines)));
+    }
+}
+
+void testSimple()
+{
+    ++testIndex;
+    QStringList oldLines{"a", "b", "c", "d"};
+    if (!diffLines(oldLines, oldLines).isEmpty())
+        fail("same lines have hunks");
+    QList<LineDiffHunk> hunks = diffLines(oldLines, QStringList{"a", "B", "c", "d", "e"});
+    if (hunks.count() != 2
+            || hunks[0].oldStart != 1 || hunks[0].oldCount != 1 || hunks[0].newCount != 1
+            || hunks[1].oldStart != 4 || hunks[1].oldCount != 0 || hunks[1].newCount != 1)
+        fail("wrong hunks of a replaced line and an appended line");
+    hunks = diffLines(oldLines, QStringList());
+    if (hunks.count() != 1 || hunks[0].oldCount != 4 || hunks[0].newCount != 0)
+        fail("wrong hunks of removing all lines");
+}
+
+void testMaxEdits()
+{
+    ++testIndex;
+    QStringList oldLines;
+    QStringList newLines;
+    for (int i=0;i<20;i++) {
+        oldLines.append(QString("old %1").arg(i));
+        newLines.append(QString("new %1").arg(i));
+    }
+    oldLines.prepend("head");
+    newLines.prepend("head");
+    // too many edits, the different part is one hunk
+    QList<LineDiffHunk> hunks = diffLines(oldLines, newLines, 10);
+    if (hunks.count() != 1 || hunks[0].oldStart != 1
+            || hunks[0].oldCount != 20 || hunks[0].newCount != 20)
+        fail("different part is not one hunk when the edits exceed the limit");
+    applyHunks(oldLines, newLines, hunks);
+}
+
+int main()
+{
+    testSimple();
+    testRandom();
+    testMaxEdits();
+    return 0;
+}
@@ -0,0 +1,100 @@
+#include <cstdlib>
+
+#include <QDebug>
+#include <QString>
+#include <QStringList>
+
+#include "vcs/gitutils.h"
+
+int testIndex = 0;
+
+void fail(const QString& msg)
+{
+    qDebug() << "Error in test" << testIndex << ":" << msg;
+    exit(1);
+}
+
+// entries of "git status --porcelain=v2 -z" are separated by NUL
+QString porcelain(const QStringList& entries)
+{
+    QString output;
+    foreach (const QString& entry, entries) {
+        output += entry;
+        output += QChar('\0');
+    }
+    return output;
+}
+
+void testStatus()
+{
+    ++testIndex;
+    QString output = porcelain(QStringList{
+        "# branch.oid 1234567890abcdef1234567890abcdef12345678",
+        "# branch.head main",
+        "# branch.upstream origin/main",
+        "# branch.ab +1 -0",
+        "1 .M N... 100644 100644 100644 0123456 0123456 src/changed.cpp",
+        "1 M. N... 100644 100644 100644 0123456 789abcd staged.cpp",
+        "1 MM N... 100644 100644 100644 0123456 789abcd both.cpp",
+        "1 .M N... 100644 100644 100644 0123456 0123456 with space/a file.h",
+        // renamed entries are followed by the original path
+        "2 R. N... 100644 100644 100644 0123456 0123456 R100 new name.cpp",
+        "old name.cpp",
+        "u UU N... 100644 100644 100644 100644 0123456 789abcd ef01234 conflict.cpp",
+    });
+    QString branch;
+    QStringList changed;
+    QStringList staged;
+    QStringList conflicts;
+    if (!parseGitPorcelainStatus(output, branch, changed, staged, conflicts))
+        fail("branch header is not found");
+    if (branch != "main")
+        fail("wrong branch: " + branch);
+    if (changed != QStringList{"src/changed.cpp", "both.cpp", "with space/a file.h", "conflict.cpp"})
+        fail("wrong changed files: " + changed.join(","));
+    if (staged != QStringList{"staged.cpp", "both.cpp", "new name.cpp"})
+        fail("wrong staged files: " + staged.join(","));
+    if (conflicts != QStringList{"conflict.cpp"})
+        fail("wrong conflicts: " + conflicts.join(","));
+}
+
+void testCleanAndDetached()
+{
+    ++testIndex;
+    QString branch;
+    QStringList changed;
+    QStringList staged;
+    QStringList conflicts;
+    QString output = porcelain(QStringList{
+        "# branch.oid 1234567890abcdef1234567890abcdef12345678",
+        "# branch.head (detached)",
+    });
+    if (!parseGitPorcelainStatus(output, branch, changed, staged, conflicts))
+        fail("branch header is not found");
+    if (branch != "(detached)")
+        fail("wrong branch: " + branch);
+    if (!changed.isEmpty() || !staged.isEmpty() || !conflicts.isEmpty())
+        fail("files are found in a clean repository");
+}
+
+void testNotRepository()
+{
+    ++testIndex;
+    QString branch;
+    QStringList changed;
+    QStringList staged;
+    QStringList conflicts;
+    // git prints the error to stderr and nothing to stdout
+    if (parseGitPorcelainStatus(QString(), branch, changed, staged, conflicts))
+        fail("empty output is taken as a repository");
+    if (!branch.isEmpty())
+        fail("branch is set outside of a repository");
+}
+
+int main()
+{
+    testStatus();
+    testCleanAndDetached();
+    testNotRepository();
+    return 0;
+}
@@ -0,0 +1,94 @@
+#include <climits>
+#include <cstdlib>
+
+#include <QDebug>
+#include <QRandomGenerator>
+#include <QString>
+#include <QVector>
+
+#include "parser/inactivelineranges.h"
+
+int testIndex = 0;
+
+void fail(const QString& msg)
+{
+    qDebug() << "Error in test" << testIndex << ":" << msg;
+    exit(1);
+}
+
+void checkRanges(const InactiveLineRanges& ranges, const QVector<bool>& inactive)
+{
+    for (int i=0;i<ranges.count();i++) {
+        if (ranges[i].startLine > ranges[i].endLine)
+            fail(QString("range %1 is empty").arg(i));
+        // adjacent ranges are merged
+        if (i>0 && ranges[i].startLine <= ranges[i-1].endLine + 1)
+            fail(QString("range %1 overlaps or touches the previous one").arg(i));
+    }
+    for (int line=1;line<inactive.count();line++) {
+        if (isLineInInactiveRanges(ranges, line) != inactive[line])
+            fail(QString("line %1 is %2, expected %3").arg(line)
+                 .arg(isLineInInactiveRanges(ranges, line)).arg(inactive[line]));
+    }
+}
+
+// each branch change sets the state of its line and all the lines after it
+void testRandomBranches()
+{
+    ++testIndex;
+    QRandomGenerator random(50);
+    const int lineCount = 60;
+    for (int round=0;round<200;round++) {
+        InactiveLineRanges ranges;
+        QVector<bool> inactive(lineCount+1, false);
+        int line = 1;
+        while (line <= lineCount) {
+            bool branchTrue = random.bounded(2);
+            insertInactiveBranch(ranges, line, branchTrue);
+            for (int i=line;i<=lineCount;i++)
+                inactive[i] = !branchTrue;
+            checkRanges(ranges, inactive);
+            // the same line may change again, e.g. "#else" after a false "#if" on the previous line
+            line += random.bounded(4);
+        }
+        if (!ranges.isEmpty() && ranges.back().endLine != INT_MAX && inactive[lineCount])
+            fail("an unterminated branch doesn't reach to the end of the file");
+    }
+}
+
+void testNestedBranches()
+{
+    ++testIndex;
+    //  1 #if 0
+    //  2   a
+    //  3 #else
+    //  4   b
+    //  5 #endif
+    //  6 #ifdef X   (X is undefined)
+    //  7   c
+    //  8 #endif
+    //  9 d
+    InactiveLineRanges ranges;
+    insertInactiveBranch(ranges, 2, false);
+    insertInactiveBranch(ranges, 3, true);
+    insertInactiveBranch(ranges, 7, false);
+    insertInactiveBranch(ranges, 8, true);
+    if (ranges.count() != 2
+            || ranges[0].startLine != 2 || ranges[0].endLine != 2
+            || ranges[1].startLine != 7 || ranges[1].endLine != 7)
+        fail("wrong ranges of two false branches");
+    if (isLineInInactiveRanges(ranges, 1) || isLineInInactiveRanges(ranges, 4)
+            || isLineInInactiveRanges(ranges, 9) || !isLineInInactiveRanges(ranges, 7))
+        fail("wrong lines are inactive");
+    // reporting the branch of line 7 again makes it reach to the end of the file
+    insertInactiveBranch(ranges, 7, false);
+    if (ranges.count() != 2 || ranges[1].endLine != INT_MAX || !isLineInInactiveRanges(ranges, 1000))
+        fail("unterminated branch doesn't reach to the end of the file");
+}
+
+int main()
+{
+    testNestedBranches();
+    testRandomBranches();
+    return 0;
+}
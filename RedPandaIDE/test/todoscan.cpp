@@ -0,0 +1,115 @@
+#include <algorithm>
+#include <cstdlib>
+
+#include <QApplication>
+#include <QDebug>
+#include <QRandomGenerator>
+#include <QString>
+#include <QStringList>
+
+#include "qsynedit/syntaxer/cpp.h"
+#include "todoscanner.h"
+
+int testIndex = 0;
+
+void fail(const QString& msg)
+{
+    qDebug() << "Error in test" << testIndex << ":" << msg;
+    exit(1);
+}
+
+// lines with todos in and out of comments, and lines opening or closing block comments
+const QStringList linePool{
+    "int x; // todo: remove",
+    "/* start of a comment",
+    "   fixme inside the comment",
+    "   end of the comment */",
+    "const char* s = \"todo in a string\";",
+    "int main() {",
+    "    return 0; /* TODO */ }",
+    "// nothing to do here",
+    "#define A 1 // FIXME",
+    "}",
+    "",
+};
+
+void checkItems(const QList<PTodoItem>& items, const QList<PTodoItem>& expected, const QString& step)
+{
+    if (items.count() != expected.count())
+        fail(QString("%1: %2 todos found, expected %3").arg(step).arg(items.count()).arg(expected.count()));
+    for (int i=0;i<items.count();i++) {
+        if (items[i]->filename != expected[i]->filename
+                || items[i]->lineNo != expected[i]->lineNo
+                || items[i]->ch != expected[i]->ch
+                || items[i]->line != expected[i]->line)
+            fail(QString("%1: todo %2 is at %3:%4, expected %5:%6").arg(step).arg(i)
+                 .arg(items[i]->lineNo).arg(items[i]->ch)
+                 .arg(expected[i]->lineNo).arg(expected[i]->ch));
+    }
+}
+
+// rescanning the changed lines gives the same result as scanning the whole file
+void testIncrementalScan()
+{
+    ++testIndex;
+    QRandomGenerator random(48);
+    QSynedit::PSyntaxer syntaxer = std::make_shared<QSynedit::CppSyntaxer>();
+    QSynedit::PSyntaxer fullSyntaxer = std::make_shared<QSynedit::CppSyntaxer>();
+    QStringList lines;
+    for (int i=0;i<30;i++)
+        lines.append(linePool[random.bounded(linePool.count())]);
+    PTodoFileCache cache = scanTodosInEditorLines("test.cpp", lines, PTodoFileCache(), syntaxer);
+    for (int step=0;step<1000;step++) {
+        int op = random.bounded(3);
+        int line = random.bounded(lines.count()+1);
+        if (op == 0 || lines.isEmpty()) {
+            int n = random.bounded(3)+1;
+            for (int i=0;i<n;i++)
+                lines.insert(line, linePool[random.bounded(linePool.count())]);
+        } else if (op == 1) {
+            line = std::min(line, lines.count()-1);
+            int n = std::min(random.bounded(3)+1, lines.count()-line);
+            for (int i=0;i<n;i++)
+                lines.removeAt(line);
+        } else {
+            line = std::min(line, lines.count()-1);
+            lines[line] = linePool[random.bounded(linePool.count())];
+        }
+        cache = scanTodosInEditorLines("test.cpp", lines, cache, syntaxer);
+        QString stepName = QString("step %1").arg(step);
+        checkItems(cache->items, scanTodos("test.cpp", lines, fullSyntaxer), stepName);
+
+        PTodoFileCache fullCache = scanTodosInEditorLines("test.cpp", lines, PTodoFileCache(), fullSyntaxer);
+        if (cache->hash != fullCache->hash || cache->lineHashes != fullCache->lineHashes)
+            fail(stepName + ": wrong hashes");
+        if (cache->states.count() != lines.count())
+            fail(stepName + QString(": %1 line states kept, expected %2").arg(cache->states.count()).arg(lines.count()));
+        for (int i=0;i<lines.count();i++) {
+            if (cache->states[i].state != fullCache->states[i].state)
+                fail(stepName + QString(": wrong state at the end of line %1").arg(i+1));
+        }
+    }
+}
+
+void testUnchanged()
+{
+    ++testIndex;
+    QSynedit::PSyntaxer syntaxer = std::make_shared<QSynedit::CppSyntaxer>();
+    QStringList lines{"int x; // todo", "/* fixme", "*/"};
+    PTodoFileCache cache = scanTodosInEditorLines("test.cpp", lines, PTodoFileCache(), syntaxer);
+    if (scanTodosInEditorLines("test.cpp", lines, cache, syntaxer) != cache)
+        fail("unchanged lines are scanned again");
+    // opening a block comment turns the following lines into comments
+    lines.prepend("/*");
+    cache = scanTodosInEditorLines("test.cpp", lines, cache, syntaxer);
+    checkItems(cache->items, scanTodos("test.cpp", lines, syntaxer), "comment opened");
+}
+
+int main(int argc, char* argv[])
+{
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication app(argc, argv);
+    testIncrementalScan();
+    testUnchanged();
+    return 0;
+}
@@ -0,0 +1,131 @@
+#include <cstdlib>
+
+#include <QApplication>
+#include <QDebug>
+#include <QRandomGenerator>
+#include <QString>
+#include <QStringList>
+
+#include "qsynedit/document.h"
+#include "qsynedit/qsynedit.h"
+
+using namespace QSynedit;
+
+int testIndex = 0;
+
+void fail(const QString& msg)
+{
+    qDebug() << "Error in test" << testIndex << ":" << msg;
+    exit(1);
+}
+
+QString randomEdit(QRandomGenerator& random, const QString& line)
+{
+    // replace a random middle part, so the changes have common heads and tails
+    int start = random.bounded(line.length()+1);
+    int len = random.bounded(line.length()-start+1);
+    QString text;
+    int textLen = random.bounded(4);
+    for (int i=0;i<textLen;i++)
+        text += QChar('a' + random.bounded(3));
+    return line.left(start) + text + line.mid(start+len);
+}
+
+// replaced lines are recorded as deltas, check undo/redo give back each state
+void testReplaceLineDeltas()
+{
+    ++testIndex;
+    QRandomGenerator random(39);
+    QSynEdit edit;
+    EditorOptions options = edit.getOptions();
+    options.setFlag(EditorOption::GroupUndo, false);
+    edit.setOptions(options);
+    // the document is loaded without undo items
+    edit.document()->setContents(QStringList{"int main()", "{", "    return 0;", "}"});
+
+    QList<QStringList> states;
+    states.append(edit.contents());
+    for (int i=0;i<300;i++) {
+        int line = random.bounded(edit.lineCount()) + 1;
+        QString newText = randomEdit(random, edit.lineText(line));
+        if (newText == edit.lineText(line))
+            continue;
+        edit.replaceLine(line, newText);
+        states.append(edit.contents());
+    }
+    for (int i=states.count()-2;i>=0;i--) {
+        edit.undo();
+        if (edit.contents() != states[i])
+            fail(QString("wrong text after undoing to state %1").arg(i));
+    }
+    if (edit.canUndo())
+        fail("undo list is not empty after undoing all changes");
+    for (int i=1;i<states.count();i++) {
+        edit.redo();
+        if (edit.contents() != states[i])
+            fail(QString("wrong text after redoing to state %1").arg(i));
+    }
+}
+
+void testCompressOldItems()
+{
+    ++testIndex;
+    UndoList undoList;
+    undoList.setMaxMemoryUsage(0);
+    QString longLine = QString("x").repeated(8000);
+    for (int i=0;i<150;i++) {
+        undoList.addChange(ChangeReason::Insert, BufferCoord{1,i+1}, BufferCoord{1,i+2},
+                           QStringList{longLine, QString::number(i)}, SelectionMode::Normal);
+    }
+    size_t usage = undoList.memoryUsage();
+    // items older than the last 100 are compressed
+    if (usage > 100*(8000*sizeof(QChar)+sizeof(UndoItem)) + 50*4096)
+        fail(QString("old items are not compressed, %1 bytes used").arg(usage));
+    for (int i=149;i>=0;i--) {
+        PUndoItem item = undoList.popItem();
+        if (item->compressed() != (i<50))
+            fail(QString("item %1 is compressed: %2").arg(i).arg(item->compressed()));
+        if (item->changeText() != QStringList{longLine, QString::number(i)})
+            fail(QString("wrong text of item %1").arg(i));
+    }
+    if (undoList.memoryUsage() != 0)
+        fail("memory usage is not 0 after popping all items");
+}
+
+void testMemoryLimit()
+{
+    ++testIndex;
+    UndoList undoList;
+    const size_t limit = 64*1024;
+    undoList.setMaxMemoryUsage(limit);
+    QString line = QString("y").repeated(1000);
+    for (int i=0;i<200;i++) {
+        // 2 items per change
+        undoList.beginBlock();
+        undoList.addChange(ChangeReason::Insert, BufferCoord{1,i+1}, BufferCoord{1,i+1},
+                           QStringList{line}, SelectionMode::Normal);
+        undoList.addChange(ChangeReason::Delete, BufferCoord{1,i+1}, BufferCoord{1,i+1},
+                           QStringList{line}, SelectionMode::Normal);
+        undoList.endBlock();
+        if (undoList.memoryUsage() > limit)
+            fail(QString("%1 bytes used, over the limit").arg(undoList.memoryUsage()));
+    }
+    if (!undoList.fullUndoImposible())
+        fail("dropping old changes is not reported");
+    // only whole changes are dropped
+    if (undoList.itemCount() % 2 != 0)
+        fail("a change is partly dropped");
+    PUndoItem item = undoList.peekItem();
+    if (!item || item->changeStartPos().line != 200)
+        fail("the last change is dropped");
+}
+
+int main(int argc, char* argv[])
+{
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication app(argc, argv);
+    testReplaceLineDeltas();
+    testCompressOldItems();
+    testMemoryLimit();
+    return 0;
+}
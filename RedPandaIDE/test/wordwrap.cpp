@@ -0,0 +1,177 @@
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+
+#include <QDebug>
+#include <QRandomGenerator>
+#include <QString>
+#include <QVector>
+
+#include "qsynedit/wordwrap.h"
+
+using QSynedit::DisplayRowIndex;
+
+int testIndex = 0;
+
+// Rows of each line, kept the simple way to check the index against
+struct NaiveRows {
+    QVector<int> rows;
+    QVector<bool> hidden;
+
+    int rowsOf(int line) const { return hidden[line-1] ? 0 : rows[line-1]; }
+    int rowCount() const {
+        int sum = 0;
+        for (int line=1;line<=rows.count();line++)
+            sum += rowsOf(line);
+        return sum;
+    }
+};
+
+void fail(const QString& msg)
+{
+    qDebug() << "Error in test" << testIndex << ":" << msg;
+    exit(1);
+}
+
+QVector<int> breaksOf(int rows)
+{
+    QVector<int> breaks;
+    for (int i=1;i<rows;i++)
+        breaks.append(i*10);
+    return breaks;
+}
+
+void checkIndex(const DisplayRowIndex& index, const NaiveRows& naive)
+{
+    if (index.lineCount() != naive.rows.count())
+        fail(QString("line count %1, expected %2").arg(index.lineCount()).arg(naive.rows.count()));
+    if (index.rowCount() != naive.rowCount())
+        fail(QString("row count %1, expected %2").arg(index.rowCount()).arg(naive.rowCount()));
+    int row = 1;
+    for (int line=1;line<=naive.rows.count();line++) {
+        int rows = naive.rowsOf(line);
+        if (index.rowsOfLine(line) != rows)
+            fail(QString("rows of line %1 is %2, expected %3").arg(line).arg(index.rowsOfLine(line)).arg(rows));
+        if (rows > 0 && index.lineToRow(line) != row)
+            fail(QString("row of line %1 is %2, expected %3").arg(line).arg(index.lineToRow(line)).arg(row));
+        for (int i=0;i<rows;i++) {
+            int rowInLine;
+            int foundLine = index.rowToLine(row+i, rowInLine);
+            if (foundLine != line || rowInLine != i)
+                fail(QString("row %1 is mapped to %2:%3, expected %4:%5")
+                     .arg(row+i).arg(foundLine).arg(rowInLine).arg(line).arg(i));
+        }
+        row += rows;
+    }
+}
+
+void testEdits()
+{
+    ++testIndex;
+    QRandomGenerator random(20221);
+    DisplayRowIndex index;
+    NaiveRows naive;
+    for (int step=0;step<2000;step++) {
+        int op = random.bounded(4);
+        int count = naive.rows.count();
+        if (op == 0 || count == 0) {
+            int line = random.bounded(count+1) + 1;
+            int n = random.bounded(5) + 1;
+            index.insertLines(line, n);
+            naive.rows.insert(line-1, n, 1);
+            naive.hidden.insert(line-1, n, false);
+        } else if (op == 1) {
+            int line = random.bounded(count) + 1;
+            int n = std::min(random.bounded(4) + 1, count-line+1);
+            index.deleteLines(line, n);
+            naive.rows.remove(line-1, n);
+            naive.hidden.remove(line-1, n);
+        } else if (op == 2) {
+            int line = random.bounded(count) + 1;
+            int rows = random.bounded(6) + 1;
+            QVector<int> breaks = breaksOf(rows);
+            index.setLineBreaks(line, breaks, breaks);
+            naive.rows[line-1] = rows;
+        } else {
+            int from = random.bounded(count) + 1;
+            int to = std::min(count, from + random.bounded(5));
+            index.setHiddenRanges(QVector<int>{from}, QVector<int>{to});
+            for (int line=1;line<=count;line++)
+                naive.hidden[line-1] = (line > from && line <= to);
+        }
+        checkIndex(index, naive);
+    }
+}
+
+void testHiddenLines()
+{
+    ++testIndex;
+    DisplayRowIndex index;
+    index.insertLines(1, 6);
+    index.setLineBreaks(2, breaksOf(3), breaksOf(3));
+    // lines 3,4 are folded into line 2
+    index.setHiddenRanges(QVector<int>{2}, QVector<int>{4});
+    if (index.rowCount() != 6)
+        fail(QString("row count %1, expected 6").arg(index.rowCount()));
+    // hidden lines are displayed at the last row before them
+    if (index.lineToRow(3) != 4 || index.lineToRow(4) != 4)
+        fail("hidden lines are not mapped to the fold start row");
+    int rowInLine;
+    if (index.rowToLine(5, rowInLine) != 5 || rowInLine != 0)
+        fail("row after the fold is not mapped to the line after the fold");
+    // rows after the last line
+    if (index.rowToLine(8, rowInLine) != 8)
+        fail("rows after the last line are not mapped to virtual lines");
+}
+
+void testRowChars()
+{
+    ++testIndex;
+    DisplayRowIndex index;
+    index.insertLines(1, 1);
+    index.setLineBreaks(1, QVector<int>{10, 20}, QVector<int>{80, 160});
+    if (index.rowInLine(1, 0) != 0 || index.rowInLine(1, 9) != 0
+            || index.rowInLine(1, 10) != 1 || index.rowInLine(1, 25) != 2)
+        fail("wrong row of chars");
+    if (index.rowStartChar(1, 1) != 10 || index.rowEndChar(1, 1) != 20
+            || index.rowEndChar(1, 2) != INT_MAX)
+        fail("wrong chars of rows");
+    if (index.rowStartPosition(1, 2) != 160 || index.rowEndPosition(1, 0) != 80)
+        fail("wrong positions of rows");
+}
+
+void testLineBreaks()
+{
+    ++testIndex;
+    // 12 glyphs of width 10: "aaaa bbbb cc"
+    QString text = "aaaa bbbb cc";
+    QList<int> chars;
+    QList<int> positions;
+    for (int i=0;i<text.length();i++) {
+        chars.append(i);
+        positions.append(i*10);
+    }
+    QVector<int> breakChars;
+    QVector<int> breakPositions;
+    DisplayRowIndex::calcLineBreaks(text, chars, positions, 120, 200, breakChars, breakPositions);
+    if (!breakChars.isEmpty())
+        fail("line fitting the width is broken");
+    DisplayRowIndex::calcLineBreaks(text, chars, positions, 120, 60, breakChars, breakPositions);
+    // broken after the spaces
+    if (breakChars != QVector<int>{5, 10} || breakPositions != QVector<int>{50, 100})
+        fail(QString("wrong breaks after spaces: %1").arg(breakChars.count()));
+    DisplayRowIndex::calcLineBreaks("aaaaaaaaaa", chars.mid(0, 10), positions.mid(0, 10), 100, 40,
+                                    breakChars, breakPositions);
+    // words longer than the width are broken at the glyphs
+    if (breakChars != QVector<int>{4, 8})
+        fail("wrong breaks in long words");
+}
+
+int main()
+{
+    testEdits();
+    testHiddenLines();
+    testRowChars();
+    testLineBreaks();
+    return 0;
+}
@@ -96,6 +96,12 @@ bool ThemeManager::tryLoadThemeFromDir(const QString &dir, AppTheme::ThemeCatego
 void ThemeManager::loadThemesFromDir(const QString &dir, AppTheme::ThemeCategory category, std::set<PAppTheme, ThemeCompare> &themes)
 {
     for (const auto &[extension, type] : searchTypes) {
+#ifdef ENABLE_LUA_ADDON
+        if (type == AppTheme::ThemeType::Lua) {
+            loadLuaThemesFromDir(dir, category, themes);
+            continue;
+        }
+#endif
         QDirIterator it(dir);
         while (it.hasNext()) {
             it.next();
@@ -117,6 +123,43 @@ void ThemeManager::loadThemesFromDir(const QString &dir, AppTheme::ThemeCategory
     }
 }
 
+#ifdef ENABLE_LUA_ADDON
+void ThemeManager::loadLuaThemesFromDir(const QString &dir, AppTheme::ThemeCategory category, std::set<PAppTheme, ThemeCompare> &themes)
+{
+    //run all the theme scripts of the folder in one batch, so the interpreter is only taken once
+    QStringList filenames;
+    QList<AddOn::Script> scripts;
+    QDirIterator it(dir);
+    while (it.hasNext()) {
+        it.next();
+        QFileInfo fileInfo = it.fileInfo();
+        if (fileInfo.suffix().compare("lua", PATH_SENSITIVITY) != 0)
+            continue;
+        QFile file(fileInfo.absoluteFilePath());
+        if (!file.open(QFile::ReadOnly))
+            continue;
+        QByteArray content = file.readAll().trimmed();
+        if (content.isEmpty()) {
+            themes.insert(std::make_shared<AppTheme>(fileInfo.absoluteFilePath(), AppTheme::ThemeType::Lua, category));
+            continue;
+        }
+        filenames.append(fileInfo.absoluteFilePath());
+        scripts.append({content, fileInfo.absoluteFilePath()});
+    }
+    if (scripts.isEmpty())
+        return;
+    QList<AddOn::ScriptResult> results = AddOn::ThemeExecutor{}(scripts);
+    for (int i=0;i<results.count();i++) {
+        if (!results[i].error.isEmpty()) {
+            qDebug() << results[i].error;
+            continue;
+        }
+        themes.insert(std::make_shared<AppTheme>(filenames[i], AppTheme::ThemeType::Lua, category,
+                                                 results[i].value.toObject()));
+    }
+}
+#endif
+
 QColor AppTheme::color(ColorRole role) const
 {
     return mColors.value(role,QColor());
@@ -246,32 +289,43 @@ AppTheme::AppTheme(const QString &filename, ThemeType type, ThemeCategory catego
         }
 #endif
         }
-
-        QFileInfo fileInfo(filename);
-        mName = fileInfo.baseName();
-        mDisplayName = obj["name"].toString();
-        if (mDisplayName.isEmpty())
-            mDisplayName = mName;
-        mStyle = obj["style"].toString();
-        mDefaultColorScheme = obj["default scheme"].toString();
-        mDefaultIconSet = obj["default iconset"].toString();
-        QJsonObject colors = obj["palette"].toObject();
-        const QMetaObject &m = *metaObject();
-        QMetaEnum e = m.enumerator(m.indexOfEnumerator("ColorRole"));
-        for (int i = 0, total = e.keyCount(); i < total; ++i) {
-            const QString key = QLatin1String(e.key(i));
-            if (colors.contains(key)) {
-                QString val=colors[key].toString();
-                mColors.insert(i, QColor(val));
-            }
-        }
-
+        loadFromObject(obj);
     } else {
         throw FileError(tr("Can't open the theme file '%1' for read.")
                         .arg(filename));
     }
 }
 
+AppTheme::AppTheme(const QString &filename, ThemeType type, ThemeCategory category, const QJsonObject &obj, QObject *parent):QObject(parent)
+{
+    mFilename = filename;
+    mType = type;
+    mCategory = category;
+    loadFromObject(obj);
+}
+
+void AppTheme::loadFromObject(const QJsonObject &obj)
+{
+    QFileInfo fileInfo(mFilename);
+    mName = fileInfo.baseName();
+    mDisplayName = obj["name"].toString();
+    if (mDisplayName.isEmpty())
+        mDisplayName = mName;
+    mStyle = obj["style"].toString();
+    mDefaultColorScheme = obj["default scheme"].toString();
+    mDefaultIconSet = obj["default iconset"].toString();
+    QJsonObject colors = obj["palette"].toObject();
+    const QMetaObject &m = *metaObject();
+    QMetaEnum e = m.enumerator(m.indexOfEnumerator("ColorRole"));
+    for (int i = 0, total = e.keyCount(); i < total; ++i) {
+        const QString key = QLatin1String(e.key(i));
+        if (colors.contains(key)) {
+            QString val=colors[key].toString();
+            mColors.insert(i, QColor(val));
+        }
+    }
+}
+
 bool AppTheme::isSystemInDarkMode() {
     // https://www.qt.io/blog/dark-mode-on-windows-11-with-qt-6.5
     // compare the window color with the text color to determine whether the palette is dark or light
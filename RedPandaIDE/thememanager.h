@@ -19,6 +19,7 @@
 #include <QPalette>
 #include <QHash>
 #include <QColor>
+#include <QJsonObject>
 #include <memory>
 #include <QObject>
 #include <set>
@@ -93,6 +94,8 @@ public:
     };
 
     AppTheme(const QString& filename, ThemeType type, ThemeCategory category, QObject* parent=nullptr);
+    // the theme object is already evaluated, e.g. by a batch of lua theme scripts
+    AppTheme(const QString& filename, ThemeType type, ThemeCategory category, const QJsonObject& obj, QObject* parent=nullptr);
 
     QColor color(ColorRole role) const;
     QPalette palette() const;
@@ -125,6 +128,7 @@ public:
 
 private:
     AppTheme();
+    void loadFromObject(const QJsonObject& obj);
 
 private:
     static QPalette initialPalette();
@@ -156,6 +160,9 @@ private:
 private:
     bool tryLoadThemeFromDir(const QString &dir, AppTheme::ThemeCategory category, const QString &themeName, PAppTheme &theme);
     void loadThemesFromDir(const QString &dir, AppTheme::ThemeCategory category, std::set<PAppTheme, ThemeCompare> &themes);
+#ifdef ENABLE_LUA_ADDON
+    void loadLuaThemesFromDir(const QString &dir, AppTheme::ThemeCategory category, std::set<PAppTheme, ThemeCompare> &themes);
+#endif
 
     // lua overrides json
     inline static const std::pair<QString, AppTheme::ThemeType> searchTypes[] = {
@@ -19,144 +19,128 @@
 #include "editor.h"
 #include "editorlist.h"
 
-#include <QRegularExpression>
+#include <QCryptographicHash>
 
+#define TODO_SCAN_BATCH_SIZE 8
 
-static QRegularExpression todoReg("\\b(todo|fixme)\\b", QRegularExpression::CaseInsensitiveOption);
 TodoParser::TodoParser(QObject *parent) : QObject(parent),
-    mMutex()
+    mGeneration{0},
+    mRunningJobs{0}
 {
-    mThread = nullptr;
+}
+
+TodoParser::~TodoParser()
+{
+    mThreadPool.clear();
+    mThreadPool.waitForDone();
 }
 
 void TodoParser::parseFile(const QString &filename,bool isForProject)
 {
-    QMutexLocker locker(&mMutex);
-    if (mThread) {
-        return;
-    }
-    mThread = new TodoThread(filename);
-    connect(mThread,&QThread::finished,
-            [this] {
-        QMutexLocker locker(&mMutex);
-        if (mThread) {
-            mThread->deleteLater();
-            mThread = nullptr;
-        }
-    });
-    if (!isForProject) {
-        connect(mThread, &TodoThread::parseStarted,
-            pMainWindow, &MainWindow::onTodoParseStarted);
-    }
-    connect(mThread, &TodoThread::parsingFile,
-            pMainWindow, &MainWindow::onTodoParsingFile);
-    connect(mThread, &TodoThread::todoFound,
-            pMainWindow, &MainWindow::onTodoFound);
-    connect(mThread, &TodoThread::parseFinished,
-            pMainWindow, &MainWindow::onTodoParseFinished);
-    mThread->start();
+    QList<Request> requests;
+    requests.append(makeRequest(filename, isForProject));
+    startRequests(requests);
 }
 
 void TodoParser::parseFiles(const QStringList &files)
 {
-    QMutexLocker locker(&mMutex);
-    if (mThread) {
-        return;
+    //results of the previous files are useless
+    mGeneration++;
+    emit parseStarted();
+    QList<Request> requests;
+    foreach(const QString& filename, files) {
+        requests.append(makeRequest(filename, true));
     }
-    mThread = new TodoThread(files);
-    connect(mThread,&QThread::finished,
-            [this] {
-        QMutexLocker locker(&mMutex);
-        if (mThread) {
-            mThread->deleteLater();
-            mThread = nullptr;
-        }
-    });
-    connect(mThread, &TodoThread::parseStarted,
-            pMainWindow, &MainWindow::onTodoParseStarted);
-    connect(mThread, &TodoThread::parsingFile,
-            pMainWindow, &MainWindow::onTodoParsingFile);
-    connect(mThread, &TodoThread::todoFound,
-            pMainWindow, &MainWindow::onTodoFound);
-    connect(mThread, &TodoThread::parseFinished,
-            pMainWindow, &MainWindow::onTodoParseFinished);
-    mThread->start();
+    startRequests(requests);
 }
 
-bool TodoParser::parsing() const
+void TodoParser::removeFile(const QString &filename)
 {
-    return (mThread!=nullptr);
+    //drop results of the running scan of the file
+    if (mSerials.contains(filename))
+        mSerials[filename]++;
+    mCache.remove(filename);
 }
 
-TodoThread::TodoThread(const QString &filename, QObject *parent): QThread(parent)
+void TodoParser::clear()
 {
-    mFilename = filename;
-    mParseFiles = false;
+    //drop results of the running scans
+    mGeneration++;
+    mCache.clear();
 }
 
-TodoThread::TodoThread(const QStringList &files, QObject *parent): QThread(parent)
+bool TodoParser::parsing() const
 {
-    mFiles = files;
-    mParseFiles = true;
+    return mRunningJobs>0;
 }
 
-void TodoThread::parseFile()
+TodoParser::Request TodoParser::makeRequest(const QString &filename, bool isForProject)
 {
-    QSynedit::PSyntaxer syntaxer = syntaxerManager.getSyntaxer(QSynedit::ProgrammingLanguage::CPP);
-    emit parseStarted();
-    doParseFile(mFilename,syntaxer);
-    emit parseFinished();
+    Request request;
+    request.filename = filename;
+    request.isForProject = isForProject;
+    //editors can only be accessed in the gui thread
+    request.fromEditor = pMainWindow->editorList()->getContentFromOpenedEditor(filename, request.lines);
+    request.serial = ++mSerials[filename];
+    request.cache = mCache.value(filename);
+    return request;
 }
 
-void TodoThread::parseFiles()
+void TodoParser::startRequests(const QList<Request> &requests)
 {
-    QSynedit::PSyntaxer highlighter = syntaxerManager.getSyntaxer(QSynedit::ProgrammingLanguage::CPP);
-    emit parseStarted();
-    foreach(const QString& filename,mFiles) {
-        doParseFile(filename,highlighter);
+    int generation = mGeneration;
+    for (int i=0;i<requests.count();i+=TODO_SCAN_BATCH_SIZE) {
+        QList<Request> batch = requests.mid(i, TODO_SCAN_BATCH_SIZE);
+        mRunningJobs++;
+        mThreadPool.start(QRunnable::create([this, batch, generation](){
+            QSynedit::PSyntaxer syntaxer = syntaxerManager.getSyntaxer(QSynedit::ProgrammingLanguage::CPP);
+            QList<Result> results;
+            foreach (const Request& request, batch) {
+                Result result;
+                result.filename = request.filename;
+                result.isForProject = request.isForProject;
+                result.serial = request.serial;
+                result.cache = scanFile(request, syntaxer);
+                results.append(result);
+            }
+            QMetaObject::invokeMethod(this, [this, results, generation](){
+                onResultsReady(results, generation);
+            }, Qt::QueuedConnection);
+        }));
     }
-    emit parseFinished();
 }
 
-void TodoThread::doParseFile(const QString &filename, QSynedit::PSyntaxer syntaxer)
+void TodoParser::onResultsReady(const QList<Result> &results, int generation)
 {
-    emit parsingFile(filename);
-    QStringList lines;
-    if (!pMainWindow->editorList()->getContentFromOpenedEditor(filename,lines)) {
-        lines = readFileToLines(filename);
-    }
-    syntaxer->resetState();
-    for (int i =0;i<lines.count();i++) {
-        syntaxer->setLine(lines[i],i);
-        while (!syntaxer->eol()) {
-            QSynedit::PTokenAttribute attr;
-            attr = syntaxer->getTokenAttribute();
-            if (attr && attr->tokenType() == QSynedit::TokenType::Comment) {
-                QString token = syntaxer->getToken();
-                int pos = token.indexOf(todoReg);
-                if (pos>=0) {
-                    emit todoFound(
-                                filename,
-                                i+1,
-                                pos+syntaxer->getTokenPos(),
-                                lines[i].trimmed()
-                                );
-                    break;
-                }
-            }
-            syntaxer->next();
+    mRunningJobs--;
+    if (generation == mGeneration) {
+        foreach (const Result& result, results) {
+            //a newer scan of the file is requested
+            if (mSerials.value(result.filename) != result.serial)
+                continue;
+            mCache.insert(result.filename, result.cache);
+            //todo list of non-project files only shows the current file
+            if (!result.isForProject)
+                emit parseStarted();
+            emit todosFound(result.filename, result.cache->items);
         }
     }
-
+    if (mRunningJobs==0)
+        emit parseFinished();
 }
 
-void TodoThread::run()
+PTodoFileCache TodoParser::scanFile(const Request &request, QSynedit::PSyntaxer syntaxer)
 {
-    if (mParseFiles) {
-        parseFiles();
-    } else {
-        parseFile();
-    }
+    if (request.fromEditor)
+        return scanTodosInEditorLines(request.filename, request.lines, request.cache, syntaxer);
+    QByteArray content = readFileToByteArray(request.filename);
+    QByteArray hash = QCryptographicHash::hash(content, QCryptographicHash::Md5);
+    if (request.cache && request.cache->hash == hash)
+        return request.cache;
+    std::shared_ptr<TodoFileCache> cache = std::make_shared<TodoFileCache>();
+    cache->hash = hash;
+    cache->items = scanTodos(request.filename, readByteArrayToLines(content), syntaxer);
+    return cache;
 }
 
 TodoModel::TodoModel(QObject *parent) : QAbstractListModel(parent)
@@ -164,33 +148,29 @@ TodoModel::TodoModel(QObject *parent) : QAbstractListModel(parent)
     mIsForProject=false;
 }
 
-void TodoModel::addItem(const QString &filename, int lineNo, int ch, const QString &line)
+void TodoModel::setTodosForFile(const QString &filename, const QList<PTodoItem> &todos)
 {
     QList<PTodoItem> &items=getItems(mIsForProject);
-    int pos=-1;
-    for (int i=0;i<items.count();i++) {
-        int comp=QString::compare(filename,items[i]->filename);
-        if (comp<0) {
-            pos=i;
-            break;
-        } else if (comp==0) {
-            if (lineNo<items[i]->lineNo)  {
-                pos=i;
-                break;
-            }
-        }
+    //items are sorted by filename, so items of the file are continuous
+    auto it = std::lower_bound(items.begin(), items.end(), filename,
+                               [](const PTodoItem& item, const QString& name) {
+        return QString::compare(item->filename, name)<0;
+    });
+    int start = it - items.begin();
+    int end = start;
+    while (end<items.count() && items[end]->filename == filename)
+        end++;
+    if (end>start) {
+        beginRemoveRows(QModelIndex(),start,end-1);
+        items.erase(items.begin()+start, items.begin()+end);
+        endRemoveRows();
     }
-    if (pos<0) {
-        pos=items.count();
+    if (!todos.isEmpty()) {
+        beginInsertRows(QModelIndex(),start,start+todos.count()-1);
+        for (int i=0;i<todos.count();i++)
+            items.insert(start+i, todos[i]);
+        endInsertRows();
     }
-    beginInsertRows(QModelIndex(),pos,pos);
-    PTodoItem item = std::make_shared<TodoItem>();
-    item->filename = filename;
-    item->lineNo = lineNo;
-    item->ch = ch;
-    item->line = line;
-    items.insert(pos,item);
-    endInsertRows();
 }
 
 void TodoModel::removeTodosForFile(const QString &filename)
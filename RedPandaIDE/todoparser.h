@@ -18,27 +18,17 @@
 #define TODOPARSER_H
 
 #include <QObject>
-#include <QThread>
-#include <QMutex>
+#include <QHash>
+#include <QThreadPool>
 #include <QAbstractListModel>
 #include "syntaxermanager.h"
-#include "qsynedit/constants.h"
-
-struct TodoItem {
-    QString filename;
-    int lineNo;
-    int ch;
-    QString line;
-};
-
-using PTodoItem = std::shared_ptr<TodoItem>;
+#include "todoscanner.h"
 
 class TodoModel : public QAbstractListModel {
     Q_OBJECT
 public:
     explicit TodoModel(QObject* parent=nullptr);
-    void addItem(const QString& filename, int lineNo,
-                 int ch, const QString& line);
+    void setTodosForFile(const QString& filename, const QList<PTodoItem>& todos);
     void removeTodosForFile(const QString& filename);
     void clear();
     void clear(bool forProject);
@@ -62,45 +52,47 @@ public:
 
 };
 
-class TodoThread: public QThread
-{
-    Q_OBJECT
-public:
-    explicit TodoThread(const QString& filename, QObject* parent = nullptr);
-    explicit TodoThread(const QStringList& files, QObject* parent = nullptr);
-signals:
-    void parseStarted();
-    void parsingFile(const QString& fileName);
-    void todoFound(const QString& filename, int lineNo, int ch, const QString& line);
-    void parseFinished();
-private:
-    void parseFile();
-    void parseFiles();
-    void doParseFile(const QString& filename, QSynedit::PSyntaxer syntaxer);
-private:
-    QString mFilename;
-    QStringList mFiles;
-    bool mParseFiles;
-
-    // QThread interface
-protected:
-    void run() override;
-};
-
-using PTodoThread = std::shared_ptr<TodoThread>;
-
 class TodoParser : public QObject
 {
     Q_OBJECT
 public:
     explicit TodoParser(QObject *parent = nullptr);
+    ~TodoParser();
     void parseFile(const QString& filename,bool isForProject);
     void parseFiles(const QStringList& files);
+    // forget the cached scan of a file that's no longer shown
+    void removeFile(const QString& filename);
+    void clear();
     bool parsing() const;
-
+signals:
+    void parseStarted();
+    void todosFound(const QString& filename, const QList<PTodoItem>& items);
+    void parseFinished();
+private:
+    struct Request {
+        QString filename;
+        bool isForProject;
+        bool fromEditor;
+        QStringList lines; // content of the opened editor
+        int serial;
+        PTodoFileCache cache;
+    };
+    struct Result {
+        QString filename;
+        bool isForProject;
+        int serial;
+        PTodoFileCache cache;
+    };
+    Request makeRequest(const QString& filename, bool isForProject);
+    void startRequests(const QList<Request>& requests);
+    void onResultsReady(const QList<Result>& results, int generation);
+    static PTodoFileCache scanFile(const Request& request, QSynedit::PSyntaxer syntaxer);
 private:
-    TodoThread* mThread;
-    QRecursiveMutex mMutex;
+    QThreadPool mThreadPool;
+    QHash<QString,PTodoFileCache> mCache;
+    QHash<QString,int> mSerials;
+    int mGeneration;
+    int mRunningJobs;
 };
 
 using PTodoParser = std::shared_ptr<TodoParser>;
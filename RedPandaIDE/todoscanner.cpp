@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2020-2022 Roy Qu (royqh1979@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "todoscanner.h"
+
+#include <QCryptographicHash>
+#include <QHash>
+#include <QRegularExpression>
+
+static QRegularExpression todoReg("\\b(todo|fixme)\\b", QRegularExpression::CaseInsensitiveOption);
+
+static void scanLine(QSynedit::PSyntaxer syntaxer, const QString& filename,
+                     const QString& line, int lineIndex, QList<PTodoItem>& items)
+{
+    syntaxer->setLine(line,lineIndex);
+    while (!syntaxer->eol()) {
+        const QSynedit::PTokenAttribute &attr = syntaxer->getTokenAttribute();
+        if (attr && attr->tokenType() == QSynedit::TokenType::Comment) {
+            QString token = syntaxer->getToken();
+            int pos = token.indexOf(todoReg);
+            if (pos>=0) {
+                PTodoItem item = std::make_shared<TodoItem>();
+                item->filename = filename;
+                item->lineNo = lineIndex+1;
+                item->ch = pos+syntaxer->getTokenPos();
+                item->line = line.trimmed();
+                items.append(item);
+                //the state at the end of the line is needed by the next line
+                syntaxer->nextToEol();
+                break;
+            }
+        }
+        syntaxer->next();
+    }
+}
+
+//states that tokenize the following lines in the same way
+static bool isSameTokenState(const QSynedit::SyntaxState& s1, const QSynedit::SyntaxState& s2)
+{
+    return s1.state == s2.state && s1.extraData == s2.extraData;
+}
+
+QList<PTodoItem> scanTodos(const QString &filename, const QStringList &lines, QSynedit::PSyntaxer syntaxer)
+{
+    QList<PTodoItem> items;
+    syntaxer->resetState();
+    for (int i=0;i<lines.count();i++)
+        scanLine(syntaxer, filename, lines[i], i, items);
+    return items;
+}
+
+PTodoFileCache scanTodosInEditorLines(const QString &filename, const QStringList &lines,
+                                      PTodoFileCache oldCache, QSynedit::PSyntaxer syntaxer)
+{
+    QVector<uint> lineHashes;
+    QCryptographicHash hasher(QCryptographicHash::Md5);
+    lineHashes.reserve(lines.count());
+    foreach (const QString& line, lines) {
+        hasher.addData(reinterpret_cast<const char*>(line.constData()),
+                       line.length()*static_cast<int>(sizeof(QChar)));
+        hasher.addData("\n",1);
+        lineHashes.append(qHash(line));
+    }
+    QByteArray hash = hasher.result();
+    if (oldCache && oldCache->hash == hash)
+        return oldCache;
+
+    std::shared_ptr<TodoFileCache> cache = std::make_shared<TodoFileCache>();
+    cache->hash = hash;
+    cache->lineHashes = lineHashes;
+    cache->states.reserve(lines.count());
+    int newCount = lines.count();
+    if (!oldCache || oldCache->states.count() != oldCache->lineHashes.count()
+            || oldCache->states.isEmpty()) {
+        syntaxer->resetState();
+        for (int i=0;i<newCount;i++) {
+            scanLine(syntaxer, filename, lines[i], i, cache->items);
+            cache->states.append(syntaxer->getState());
+        }
+        return cache;
+    }
+
+    //only rescan the lines between the unchanged head and tail
+    int oldCount = oldCache->lineHashes.count();
+    int prefix = 0;
+    while (prefix<oldCount && prefix<newCount
+           && oldCache->lineHashes[prefix] == lineHashes[prefix])
+        prefix++;
+    int suffix = 0;
+    while (suffix<oldCount-prefix && suffix<newCount-prefix
+           && oldCache->lineHashes[oldCount-1-suffix] == lineHashes[newCount-1-suffix])
+        suffix++;
+    int delta = newCount - oldCount;
+
+    cache->states.append(oldCache->states.mid(0,prefix));
+    foreach (const PTodoItem& item, oldCache->items) {
+        if (item->lineNo > prefix)
+            break;
+        cache->items.append(item);
+    }
+    if (prefix == 0)
+        syntaxer->resetState();
+    else
+        syntaxer->setState(oldCache->states[prefix-1]);
+    int i = prefix;
+    bool synced = false;
+    while (i<newCount && !synced) {
+        scanLine(syntaxer, filename, lines[i], i, cache->items);
+        cache->states.append(syntaxer->getState());
+        //the unchanged tail is reached with the same state, so its old results are still valid
+        synced = (i >= newCount-suffix
+                  && isSameTokenState(cache->states.last(), oldCache->states[i-delta]));
+        i++;
+    }
+    if (synced) {
+        int oldIndex = i-delta;
+        cache->states.append(oldCache->states.mid(oldIndex));
+        foreach (const PTodoItem& item, oldCache->items) {
+            if (item->lineNo <= oldIndex)
+                continue;
+            if (delta == 0) {
+                cache->items.append(item);
+            } else {
+                PTodoItem newItem = std::make_shared<TodoItem>(*item);
+                newItem->lineNo += delta;
+                cache->items.append(newItem);
+            }
+        }
+    }
+    return cache;
+}
@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2020-2022 Roy Qu (royqh1979@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef TODOSCANNER_H
+#define TODOSCANNER_H
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <memory>
+#include "qsynedit/syntaxer/syntaxer.h"
+
+struct TodoItem {
+    QString filename;
+    int lineNo;
+    int ch;
+    QString line;
+};
+
+using PTodoItem = std::shared_ptr<TodoItem>;
+
+/*
+ * Scan result of a file. Files whose content hash is unchanged are not scanned again.
+ * For contents of opened editors, the line hashes and the syntax state at the end
+ * of each line are kept too, so only the changed lines need to be rescanned.
+ */
+struct TodoFileCache {
+    QByteArray hash;
+    QList<PTodoItem> items;
+    QVector<uint> lineHashes;
+    QVector<QSynedit::SyntaxState> states;
+};
+
+using PTodoFileCache = std::shared_ptr<const TodoFileCache>;
+
+// scan all the lines, from the start state of the syntaxer
+QList<PTodoItem> scanTodos(const QString& filename, const QStringList& lines,
+                           QSynedit::PSyntaxer syntaxer);
+
+/*
+ * Scan the lines of an opened editor. Only the lines changed since oldCache
+ * (the previous result of the same file, may be null) are scanned again.
+ */
+PTodoFileCache scanTodosInEditorLines(const QString& filename, const QStringList& lines,
+                                      PTodoFileCache oldCache, QSynedit::PSyntaxer syntaxer);
+
+#endif // TODOSCANNER_H
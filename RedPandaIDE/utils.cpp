@@ -14,6 +14,7 @@
 #include "project.h"
 #include "parser/cppparser.h"
 #include "compiler/executablerunner.h"
+#include "headerindex.h"
 #include <QComboBox>
 #include "utils/escape.h"
 #include "utils/parsearg.h"
@@ -289,6 +290,8 @@ void resetCppParser(std::shared_ptr<CppParser> parser, int compilerSetIndex)
         foreach  (const QString& file,compilerSet->defaultCIncludeDirs()) {
             parser->addIncludePath(file);
         }
+        if (pHeaderIndex)
+            pHeaderIndex->prefetch(parser->includePaths().values());
         // Set defines
         for (QString define:compilerSet->defines(parser->language()==ParserLanguage::CPlusPlus)) {
             parser->addHardDefineByLine(define);
@@ -230,6 +230,23 @@ QStringList GitManager::listConflicts(const QString &folder)
     return textToLines(runGit(folder,args));
 }
 
+bool GitManager::status(const QString &folder, QString &currentBranch,
+                        QStringList &changedFiles, QStringList &stagedFiles,
+                        QStringList &conflicts)
+{
+    QStringList args;
+    //don't let status refresh (rewrite) the index, or it will trigger repository watchers
+    args.append("--no-optional-locks");
+    args.append("status");
+    args.append("--porcelain=v2");
+    args.append("-z");
+    args.append("--branch");
+    args.append("--untracked-files=no");
+    args.append("--ignored=no");
+    return parseGitPorcelainStatus(runGit(folder,args), currentBranch,
+                                   changedFiles, stagedFiles, conflicts);
+}
+
 QStringList GitManager::listRemotes(const QString &folder)
 {
     QStringList args;
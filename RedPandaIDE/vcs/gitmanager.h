@@ -40,6 +40,9 @@ public:
     QStringList listStagedFiles(const QString& folder);
     QStringList listChangedFiles(const QString& folder);
     QStringList listConflicts(const QString& folder);
+    bool status(const QString& folder, QString& currentBranch,
+                QStringList& changedFiles, QStringList& stagedFiles,
+                QStringList& conflicts);
     QStringList listRemotes(const QString& folder);
 
     bool removeRemote(const QString& folder, const QString& remoteName, QString& output);
@@ -1,13 +1,26 @@
 #include "gitrepository.h"
 #include "gitmanager.h"
 
+#include <QCoreApplication>
 #include <QDir>
+#include <QPointer>
+#include <QThreadPool>
 
 GitRepository::GitRepository(const QString& folder, QObject *parent)
     : QObject{parent},
-      mInRepository(false)
+      mGeneration{0},
+      mUpdating{false},
+      mUpdatePending{false}
 {
     mManager = new GitManager();
+    mStatus = std::make_shared<GitStatus>();
+    mUpdateTimer.setSingleShot(true);
+    mUpdateTimer.setInterval(300);
+    connect(&mUpdateTimer, &QTimer::timeout,
+            this, &GitRepository::updateInBackground);
+    //commits, staging and branch switches all rewrite files in the .git folder
+    connect(&mWatcher, &QFileSystemWatcher::directoryChanged,
+            this, &GitRepository::requestUpdate);
     setFolder(folder);
 }
 
@@ -28,8 +41,8 @@ void GitRepository::createRepository()
 
 bool GitRepository::hasRepository(QString& currentBranch)
 {
-    currentBranch = mBranch;
-    return  mInRepository;
+    currentBranch = mStatus->branch;
+    return  mStatus->inRepository;
 }
 
 bool GitRepository::add(const QString &path, QString& output)
@@ -56,7 +69,7 @@ QSet<QString> GitRepository::listFiles(bool refresh)
 {
     if (refresh)
         update();
-    return mFilesInRepositories;
+    return mStatus->filesInRepository;
 }
 
 bool GitRepository::clone(const QString &url, QString& output)
@@ -76,34 +89,113 @@ bool GitRepository::revert(QString& output)
 
 void GitRepository::setFolder(const QString &newFolder)
 {
+    if (newFolder == mFolder) {
+        requestUpdate();
+        return;
+    }
     mFolder = newFolder;
-    if (!newFolder.isEmpty())
-        mRealFolder = mManager->rootFolder(mFolder);
-    else
-        mRealFolder = newFolder;
-    update();
+    mGeneration++;
+    mUpdateTimer.stop();
+    publishStatus(std::make_shared<GitStatus>());
+    updateInBackground();
 }
 
 void GitRepository::update()
 {
+    mUpdateTimer.stop();
+    //results of the running background update are outdated
+    mGeneration++;
+    if (!mManager->isValid() || mFolder.isEmpty())
+        publishStatus(std::make_shared<GitStatus>());
+    else
+        publishStatus(loadStatus(mFolder, mRealFolder));
+}
+
+void GitRepository::requestUpdate()
+{
+    mUpdateTimer.start();
+}
+
+void GitRepository::updateInBackground()
+{
+    if (mUpdating) {
+        mUpdatePending = true;
+        return;
+    }
+    mUpdatePending = false;
     if (!mManager->isValid() || mFolder.isEmpty()) {
-        mInRepository = false;
-        mBranch = "";
-        mFilesInRepositories.clear();
-        mChangedFiles.clear();
-        mStagedFiles.clear();
-        mConflicts.clear();
-    } else {
-        mInRepository = mManager->hasRepository(mRealFolder,mBranch);
-        convertFilesListToSet(mManager->listFiles(mRealFolder),mFilesInRepositories);
-        convertFilesListToSet(mManager->listChangedFiles(mRealFolder),mChangedFiles);
-        convertFilesListToSet(mManager->listStagedFiles(mRealFolder),mStagedFiles);
-        convertFilesListToSet(mManager->listConflicts(mRealFolder),mConflicts);
-//        qDebug()<<"update"<<mRealFolder<<mBranch;
-//        qDebug()<<mFilesInRepositories;
-//        qDebug()<<mChangedFiles;
-//        qDebug()<<mStagedFiles;
+        if (mStatus->inRepository)
+            publishStatus(std::make_shared<GitStatus>());
+        return;
+    }
+    mUpdating = true;
+    QString folder = mFolder;
+    QString realFolder = mRealFolder;
+    int generation = mGeneration;
+    QPointer<GitRepository> self{this};
+    QThreadPool::globalInstance()->start(QRunnable::create([self, folder, realFolder, generation](){
+        PGitStatus status = loadStatus(folder, realFolder);
+        //the repository object may be destroyed before the result arrives
+        QMetaObject::invokeMethod(QCoreApplication::instance(), [self, status, generation](){
+            if (self)
+                self->onStatusLoaded(status, generation);
+        }, Qt::QueuedConnection);
+    }));
+}
+
+void GitRepository::onStatusLoaded(PGitStatus status, int generation)
+{
+    mUpdating = false;
+    if (generation == mGeneration)
+        publishStatus(status);
+    if (mUpdatePending)
+        updateInBackground();
+}
+
+void GitRepository::publishStatus(PGitStatus status)
+{
+    bool folderChanged = (status->realFolder != mRealFolder);
+    mStatus = status;
+    mRealFolder = status->realFolder;
+    if (folderChanged)
+        watchRepository();
+    emit statusChanged();
+}
+
+void GitRepository::watchRepository()
+{
+    QStringList watched = mWatcher.directories();
+    if (!watched.isEmpty())
+        mWatcher.removePaths(watched);
+    if (mRealFolder.isEmpty())
+        return;
+    QFileInfo gitDir(QDir(mRealFolder).filePath(".git"));
+    if (gitDir.isDir())
+        mWatcher.addPath(gitDir.absoluteFilePath());
+}
+
+PGitStatus GitRepository::loadStatus(const QString &folder, const QString &realFolder)
+{
+    //runs in worker threads, so don't share the manager with the gui thread
+    GitManager manager;
+    std::shared_ptr<GitStatus> status = std::make_shared<GitStatus>();
+    QString rootFolder = realFolder.isEmpty()?manager.rootFolder(folder):realFolder;
+    QStringList changedFiles;
+    QStringList stagedFiles;
+    QStringList conflicts;
+    status->inRepository = manager.status(rootFolder, status->branch,
+                                          changedFiles, stagedFiles, conflicts);
+    if (!status->inRepository) {
+        status->branch = "";
+        return status;
     }
+    status->realFolder = rootFolder;
+    QDir dir(rootFolder);
+    convertFilesListToSet(dir, manager.listFiles(rootFolder), status->filesInRepository);
+    convertFilesListToSet(dir, changedFiles, status->changedFiles);
+    convertFilesListToSet(dir, stagedFiles, status->stagedFiles);
+    convertFilesListToSet(dir, conflicts, status->conflicts);
+    return status;
 }
 
 const QString &GitRepository::realFolder() const
@@ -111,12 +203,11 @@ const QString &GitRepository::realFolder() const
     return mRealFolder;
 }
 
-void GitRepository::convertFilesListToSet(const QStringList &filesList, QSet<QString> &set)
+void GitRepository::convertFilesListToSet(const QDir& dir, const QStringList &filesList, QSet<QString> &set)
 {
     set.clear();
-    QDir dir(mRealFolder);
+    set.reserve(filesList.length());
     foreach (const QString& s, filesList) {
         set.insert(cleanPath(dir.absoluteFilePath(s)));
     }
 }
-
@@ -1,12 +1,27 @@
 #ifndef GITREPOSITORY_H
 #define GITREPOSITORY_H
 
+#include <QDir>
 #include <QFileInfo>
+#include <QFileSystemWatcher>
 #include <QObject>
 #include <QSet>
+#include <QTimer>
 #include <memory>
 #include "gitutils.h"
 
+struct GitStatus {
+    QString realFolder;
+    bool inRepository;
+    QString branch;
+    QSet<QString> filesInRepository;
+    QSet<QString> changedFiles;
+    QSet<QString> stagedFiles;
+    QSet<QString> conflicts;
+};
+
+using PGitStatus = std::shared_ptr<const GitStatus>;
+
 class GitManager;
 class GitRepository : public QObject
 {
@@ -24,34 +39,34 @@ public:
         return isFileInRepository(fileInfo.absoluteFilePath());
     }
     bool isFileInRepository(const QString& filePath) {
-        return mFilesInRepositories.contains(filePath);
+        return mStatus->filesInRepository.contains(filePath);
     }
     bool isFileStaged(const QFileInfo& fileInfo) {
         return isFileStaged(fileInfo.absoluteFilePath());
     }
     bool isFileStaged(const QString& filePath) {
-        return mStagedFiles.contains(filePath);
+        return mStatus->stagedFiles.contains(filePath);
     }
     bool hasStagedFiles() {
-        return !mStagedFiles.isEmpty();
+        return !mStatus->stagedFiles.isEmpty();
     }
     bool isFileChanged(const QFileInfo& fileInfo) {
         return isFileChanged(fileInfo.absoluteFilePath());
     }
     bool isFileChanged(const QString& filePath) {
-        return mChangedFiles.contains(filePath);
+        return mStatus->changedFiles.contains(filePath);
     }
     bool hasChangedFiles() {
-        return !mChangedFiles.isEmpty();
+        return !mStatus->changedFiles.isEmpty();
     }
     bool isFileConflicting(const QFileInfo& fileInfo) {
         return isFileConflicting(fileInfo.absoluteFilePath());
     }
     bool isFileConflicting(const QString& filePath) {
-        return mConflicts.contains(filePath);
+        return mStatus->conflicts.contains(filePath);
     }
     bool hasConflicts(){
-        return !mConflicts.isEmpty();
+        return !mStatus->conflicts.isEmpty();
     }
 
     bool add(const QString& path, QString& output);
@@ -67,22 +82,30 @@ public:
 
     void setFolder(const QString &newFolder);
     void update();
+    void requestUpdate();
 
     const QString &realFolder() const;
 
 signals:
+    void statusChanged();
+private slots:
+    void updateInBackground();
 private:
     QString mRealFolder;
     QString mFolder;
-    bool mInRepository;
-    QString mBranch;
     GitManager* mManager;
-    QSet<QString> mFilesInRepositories;
-    QSet<QString> mChangedFiles;
-    QSet<QString> mStagedFiles;
-    QSet<QString> mConflicts;
+    PGitStatus mStatus;
+    QTimer mUpdateTimer;
+    QFileSystemWatcher mWatcher;
+    int mGeneration;
+    bool mUpdating;
+    bool mUpdatePending;
 private:
-    void convertFilesListToSet(const QStringList& filesList,QSet<QString>& set);
+    void onStatusLoaded(PGitStatus status, int generation);
+    void publishStatus(PGitStatus status);
+    void watchRepository();
+    static PGitStatus loadStatus(const QString& folder, const QString& realFolder);
+    static void convertFilesListToSet(const QDir& dir, const QStringList& filesList,QSet<QString>& set);
 };
 
 #endif // GITREPOSITORY_H
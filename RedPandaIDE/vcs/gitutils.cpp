@@ -1,2 +1,33 @@
 #include "gitutils.h"
 
+bool parseGitPorcelainStatus(const QString &output, QString &currentBranch,
+                             QStringList &changedFiles, QStringList &stagedFiles,
+                             QStringList &conflicts)
+{
+    QStringList entries = output.split(QChar('\0'),Qt::SkipEmptyParts);
+    bool result = false;
+    for (int i=0;i<entries.length();i++) {
+        const QString& entry = entries[i];
+        if (entry.startsWith("# branch.head ")) {
+            currentBranch = entry.mid(QString("# branch.head ").length());
+            result = true;
+        } else if (entry.startsWith("1 ") || entry.startsWith("2 ")) {
+            // "1 XY sub mH mI mW hH hI path"
+            // "2 XY sub mH mI mW hH hI Xscore path", followed by an entry of the orig path
+            QString path = entry.section(' ', entry.startsWith("1 ")?8:9);
+            if (entry[2]!='.')
+                stagedFiles.append(path);
+            if (entry[3]!='.')
+                changedFiles.append(path);
+            if (entry.startsWith("2 "))
+                i++;
+        } else if (entry.startsWith("u ")) {
+            // "u XY sub m1 m2 m3 mW h1 h2 h3 path"
+            QString path = entry.section(' ', 10);
+            conflicts.append(path);
+            changedFiles.append(path);
+        }
+    }
+    return result;
+}
+
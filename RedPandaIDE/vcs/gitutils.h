@@ -3,6 +3,7 @@
 
 #include <QDateTime>
 #include <QString>
+#include <QStringList>
 #include <memory>
 
 
@@ -45,4 +46,12 @@ struct GitCommitInfo {
 
 using PGitCommitInfo = std::shared_ptr<GitCommitInfo>;
 
+/*
+ * Parse the output of "git status --porcelain=v2 -z --branch".
+ * Returns false if there's no branch header (not in a repository).
+ */
+bool parseGitPorcelainStatus(const QString& output, QString& currentBranch,
+                             QStringList& changedFiles, QStringList& stagedFiles,
+                             QStringList& conflicts);
+
 #endif // GITUTILS_H
@@ -229,23 +229,44 @@ void ClassBrowserModel::fillStatements()
         mUpdating = true;
     }
     emit refreshStarted();
-    beginResetModel();
-    clear();
     {
         auto action = finally([this]{
-            endResetModel();
             mUpdating = false;
             emit refreshEnd();
         });
-        if (!mParser)
-            return;
-        if (!mParser->enabled())
+        if (!mParser || !mParser->enabled() || !mParser->freeze()) {
+            clear();
             return;
-        if (!mParser->freeze())
-            return;
-        QString mParserSerialId = mParser->serialId();
+        }
+        // Build the new tree aside, then merge it into the current one,
+        // so only the changed rows are removed/inserted and the view keeps
+        // its expanded and selected nodes.
+        ClassBrowserNode* oldRoot = mRoot;
+        QVector<PClassBrowserNode> oldNodes;
+        oldNodes.swap(mNodes);
+        mRoot = new ClassBrowserNode();
+        mRoot->parent = nullptr;
+        mProcessedStatements.clear();
+        mDummyStatements.clear();
+        mScopeNodes.clear();
         addMembers();
         mParser->unFreeze();
+        ClassBrowserNode* newRoot = mRoot;
+        mRoot = oldRoot;
+
+        QHash<ClassBrowserNode*,PClassBrowserNode> owners;
+        foreach (const PClassBrowserNode& node, oldNodes)
+            owners.insert(node.get(),node);
+        foreach (const PClassBrowserNode& node, mNodes)
+            owners.insert(node.get(),node);
+        mergeChildren(mRoot, newRoot, QModelIndex());
+        delete newRoot;
+        mNodes.clear();
+        mNodeIndex.clear();
+        indexNodes(mRoot, owners);
+        mProcessedStatements.clear();
+        mDummyStatements.clear();
+        mScopeNodes.clear();
     }
 }
 
@@ -254,14 +275,10 @@ PClassBrowserNode ClassBrowserModel::addChild(ClassBrowserNode *node, const PSta
     PClassBrowserNode newNode = std::make_shared<ClassBrowserNode>();
     newNode->parent = node;
     newNode->statement = statement;
+    newNode->key = statementKey(statement);
 //    newNode->childrenFetched = false;
     node->children.append(newNode.get());
     mNodes.append(newNode);
-    mNodeIndex.insert(
-                QString("%1+%2+%3")
-                .arg(statement->fullName)
-                .arg(statement->noNameArgs)
-                .arg((int)statement->kind),newNode);
     mProcessedStatements.insert(statement.get());
     if (isScopeStatement(statement)) {
         mScopeNodes.insert(statement->fullName,newNode);
@@ -450,6 +467,101 @@ ClassBrowserNode* ClassBrowserModel::getParentNode(const PStatement &parentState
     return parentNode.get();
 }
 
+void ClassBrowserModel::mergeChildren(ClassBrowserNode *node, ClassBrowserNode *newNode, const QModelIndex &index)
+{
+    // match old children with the new ones by key (keys may repeat, match them in order)
+    QHash<QString,QList<ClassBrowserNode*>> oldChildren;
+    foreach (ClassBrowserNode* child, node->children)
+        oldChildren[child->key].append(child);
+    QHash<ClassBrowserNode*,ClassBrowserNode*> matches; // old node -> new node
+    QVector<ClassBrowserNode*> targets; // the final children, matched old nodes or new nodes
+    targets.reserve(newNode->children.count());
+    foreach (ClassBrowserNode* newChild, newNode->children) {
+        auto it = oldChildren.find(newChild->key);
+        if (it!=oldChildren.end() && !it->isEmpty()) {
+            ClassBrowserNode* oldChild = it->takeFirst();
+            matches.insert(oldChild, newChild);
+            targets.append(oldChild);
+        } else {
+            targets.append(newChild);
+        }
+    }
+
+    // remove unmatched old children
+    for (int i=node->children.count()-1;i>=0;i--) {
+        if (matches.contains(node->children[i]))
+            continue;
+        int last = i;
+        while (i>0 && !matches.contains(node->children[i-1]))
+            i--;
+        beginRemoveRows(index,i,last);
+        node->children.remove(i,last-i+1);
+        endRemoveRows();
+    }
+
+    // move the kept children if the sort order is changed
+    QVector<ClassBrowserNode*> keptChildren;
+    keptChildren.reserve(node->children.count());
+    foreach (ClassBrowserNode* target, targets) {
+        if (matches.contains(target))
+            keptChildren.append(target);
+    }
+    if (keptChildren != node->children) {
+        emit layoutAboutToBeChanged();
+        QHash<ClassBrowserNode*,int> newRows;
+        for (int i=0;i<keptChildren.count();i++)
+            newRows.insert(keptChildren[i],i);
+        QModelIndexList fromList;
+        QModelIndexList toList;
+        for (int i=0;i<node->children.count();i++) {
+            fromList.append(createIndex(i,0,node->children[i]));
+            toList.append(createIndex(newRows.value(node->children[i]),0,node->children[i]));
+        }
+        node->children = keptChildren;
+        changePersistentIndexList(fromList,toList);
+        emit layoutChanged();
+    }
+
+    // insert new children
+    for (int i=0;i<targets.count();i++) {
+        if (matches.contains(targets[i]))
+            continue;
+        int first = i;
+        while (i+1<targets.count() && !matches.contains(targets[i+1]))
+            i++;
+        beginInsertRows(index,first,i);
+        for (int j=first;j<=i;j++) {
+            targets[j]->parent = node;
+            node->children.insert(j,targets[j]);
+        }
+        endInsertRows();
+    }
+
+    // update kept children
+    for (int i=0;i<node->children.count();i++) {
+        ClassBrowserNode* child = node->children[i];
+        ClassBrowserNode* newChild = matches.value(child,nullptr);
+        if (!newChild)
+            continue;
+        QModelIndex childIndex = createIndex(i,0,child);
+        if (child->statement != newChild->statement) {
+            child->statement = newChild->statement;
+            emit dataChanged(childIndex,childIndex);
+        }
+        mergeChildren(child, newChild, childIndex);
+    }
+}
+
+void ClassBrowserModel::indexNodes(ClassBrowserNode *node, const QHash<ClassBrowserNode *, PClassBrowserNode> &owners)
+{
+    foreach (ClassBrowserNode* child, node->children) {
+        PClassBrowserNode p = owners.value(child);
+        mNodes.append(p);
+        mNodeIndex.insert(child->key, p);
+        indexNodes(child, owners);
+    }
+}
+
 bool ClassBrowserModel::isScopeStatement(const PStatement &statement)
 {
     switch(statement->kind) {
@@ -481,6 +593,13 @@ QModelIndex ClassBrowserModel::modelIndexForStatement(const QString &key) const
     return createIndex(row,0,node.get());
 }
 
+QString ClassBrowserModel::statementKey(const PStatement &statement)
+{
+    return statement->fullName
+            + '+' + statement->noNameArgs
+            + '+' + QString::number((int)statement->kind);
+}
+
 ProjectClassBrowserType ClassBrowserModel::classBrowserType() const
 {
     return mClassBrowserType;
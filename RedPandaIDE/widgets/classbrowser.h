@@ -24,6 +24,7 @@
 struct ClassBrowserNode {
     ClassBrowserNode* parent;
     PStatement statement;
+    QString key; // see ClassBrowserModel::statementKey()
     QVector<ClassBrowserNode *> children;
 //    bool childrenFetched;
 };
@@ -63,6 +64,7 @@ public:
     void setClassBrowserType(ProjectClassBrowserType newClassBrowserType);
 
     QModelIndex modelIndexForStatement(const QString& key) const;
+    static QString statementKey(const PStatement& statement);
 signals:
     void refreshStarted();
     void refreshEnd();
@@ -76,6 +78,8 @@ private:
     PStatement createDummy(const PStatement& statement);
     ClassBrowserNode* getParentNode(const PStatement &parentStatement, int depth);
     bool isScopeStatement(const PStatement& statement);
+    void mergeChildren(ClassBrowserNode* node, ClassBrowserNode* newNode, const QModelIndex& index);
+    void indexNodes(ClassBrowserNode* node, const QHash<ClassBrowserNode*,PClassBrowserNode>& owners);
 private:
     ClassBrowserNode * mRoot;
     QHash<QString,PStatement> mDummyStatements;
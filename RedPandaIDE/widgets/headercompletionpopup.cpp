@@ -25,6 +25,7 @@
 #include "../utils.h"
 #include "../settings.h"
 #include "../colorscheme.h"
+#include "../headerindex.h"
 #include <qsynedit/constants.h>
 
 HeaderCompletionPopup::HeaderCompletionPopup(QWidget* parent):QWidget(parent)
@@ -236,37 +237,24 @@ void HeaderCompletionPopup::getCompletionFor(const QString &phrase)
 void HeaderCompletionPopup::addFilesInPath(const QString &path, HeaderCompletionListItemType type)
 {
     QDir dir(path);
-    if (!dir.exists())
-        return;
-    foreach (const QFileInfo& fileInfo, dir.entryInfoList()) {
-        if (fileInfo.fileName().startsWith("."))
-            continue;
-        if (fileInfo.isDir()) {
-            addFile(dir, fileInfo, type);
-            continue;
-        }
-        QString suffix = fileInfo.suffix().toLower();
-        if (suffix == "h" || suffix == "hpp" || suffix == "") {
-            addFile(dir, fileInfo, type);
-        }
+    foreach (const HeaderIndex::Entry& entry, pHeaderIndex->entries(path)) {
+        addFile(dir, entry, type);
     }
 }
 
-void HeaderCompletionPopup::addFile(const QDir& dir, const QFileInfo& fileInfo, HeaderCompletionListItemType type)
+void HeaderCompletionPopup::addFile(const QDir& dir, const HeaderIndex::Entry& entry, HeaderCompletionListItemType type)
 {
-    QString fileName = fileInfo.fileName();
+    QString fileName = entry.fileName;
     if (fileName.isEmpty())
         return;
-    if (fileName.startsWith('.'))
-        return;
     PHeaderCompletionListItem item = std::make_shared<HeaderCompletionListItem>();
     item->filename = fileName;
-    item->noSuffixFilename = fileInfo.baseName();
-    item->suffix = fileInfo.suffix();
+    item->noSuffixFilename = entry.baseName;
+    item->suffix = entry.suffix;
     item->itemType = type;
     item->fullpath = cleanPath(dir.absoluteFilePath(fileName));
     item->usageCount = mHeaderUsageCounts.value(item->fullpath,0);
-    item->isFolder = fileInfo.isDir();
+    item->isFolder = entry.isFolder;
     mFullCompletionList.insert(fileName,item);
 }
 
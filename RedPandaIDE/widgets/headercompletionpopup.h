@@ -22,6 +22,7 @@
 #include <QWidget>
 #include "codecompletionlistview.h"
 #include "../parser/cppparser.h"
+#include "../headerindex.h"
 
 enum class HeaderCompletionListItemType {
     LocalHeader,
@@ -117,7 +118,7 @@ private:
     void filterList(const QString& member);
     void getCompletionFor(const QString& phrase);
     void addFilesInPath(const QString& path, HeaderCompletionListItemType type);
-    void addFile(const QDir& dir,  const QFileInfo &fileInfo, HeaderCompletionListItemType type);
+    void addFile(const QDir& dir, const HeaderIndex::Entry &entry, HeaderCompletionListItemType type);
     void addFilesInSubDir(const QString& baseDirPath, const QString& subDirName, HeaderCompletionListItemType type);
 private:
 
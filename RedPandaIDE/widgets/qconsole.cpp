@@ -64,8 +64,13 @@ QConsole::QConsole(QWidget *parent):
     mScrollTimer = new QTimer(this);
     mScrollTimer->setInterval(100);
     connect(mScrollTimer,&QTimer::timeout,this, &QConsole::scrollTimerHandler);
+    mFlushTimer = new QTimer(this);
+    mFlushTimer->setSingleShot(true);
+    mFlushTimer->setInterval(16);
+    connect(mFlushTimer,&QTimer::timeout,this, &QConsole::flushPendingLines);
     connect(&mContents,&ConsoleLines::layoutFinished,this, &QConsole::contentsLayouted);
     connect(&mContents,&ConsoleLines::rowsAdded,this, &QConsole::contentsRowsAdded);
+    connect(&mContents,&ConsoleLines::firstLinesRemoved,this, &QConsole::contentsFirstLinesRemoved);
     connect(&mContents,&ConsoleLines::lastRowsChanged,this, &QConsole::contentsLastRowsChanged);
     connect(&mContents,&ConsoleLines::lastRowsRemoved,this, &QConsole::contentsLastRowsRemoved);
     connect(verticalScrollBar(),&QScrollBar::valueChanged,
@@ -105,7 +110,12 @@ int QConsole::charColumns(QChar ch, int columnsBefore) const
     }
     if (ch == ' ')
         return 1;
-    return std::ceil((int)(fontMetrics().horizontalAdvance(ch)) / (double) mColumnWidth);
+    auto it = mCharColumnsCache.constFind(ch);
+    if (it != mCharColumnsCache.constEnd())
+        return it.value();
+    int columns = std::ceil((int)(fontMetrics().horizontalAdvance(ch)) / (double) mColumnWidth);
+    mCharColumnsCache.insert(ch, columns);
+    return columns;
 }
 
 void QConsole::invalidate()
@@ -156,9 +166,9 @@ void QConsole::addLine(const QString &line)
 {
     mCurrentEditableLine = "";
     mCaretChar=0;
-    mSelectionBegin = caretPos();
-    mSelectionEnd = caretPos();
-    mContents.addLine(line);
+    mPendingLines.append(line);
+    if (!mFlushTimer->isActive())
+        mFlushTimer->start();
 }
 
 void QConsole::addText(const QString &text)
@@ -171,6 +181,7 @@ void QConsole::addText(const QString &text)
 
 void QConsole::removeLastLine()
 {
+    flushPendingLines();
     mCurrentEditableLine = "";
     mCaretChar=0;
     mSelectionBegin = caretPos();
@@ -180,16 +191,20 @@ void QConsole::removeLastLine()
 
 void QConsole::changeLastLine(const QString &line)
 {
+    flushPendingLines();
     mContents.changeLastLine(line);
 }
 
 QString QConsole::getLastLine()
 {
+    flushPendingLines();
     return mContents.getLastLine();
 }
 
 void QConsole::clear()
 {
+    mFlushTimer->stop();
+    mPendingLines.clear();
     mContents.clear();
     mCommand = "";
     mCurrentEditableLine = "";
@@ -202,6 +217,7 @@ void QConsole::clear()
 
 void QConsole::copy()
 {
+    flushPendingLines();
     if (!this->hasSelection())
         return;
     QString s = selText();
@@ -220,6 +236,7 @@ void QConsole::paste()
 
 void QConsole::selectAll()
 {
+    flushPendingLines();
     if (mContents.lines()>0) {
         mSelectionBegin = {1,1};
         mSelectionEnd = { mContents.getLastLine().length()+1,mContents.lines()};
@@ -260,6 +277,7 @@ QString QConsole::selText()
 void QConsole::recalcCharExtent() {
     mRowHeight = fontMetrics().lineSpacing();
     mColumnWidth = fontMetrics().horizontalAdvance("M");
+    mCharColumnsCache.clear();
 }
 
 void QConsole::sizeOrFontChanged(bool)
@@ -467,6 +485,14 @@ void QConsole::contentsRowsAdded(int )
     updateScrollbars();
 }
 
+void QConsole::contentsFirstLinesRemoved(int lineCount, int rowCount)
+{
+    //keep the selection and the view on the same text
+    mSelectionBegin.line = std::max(mSelectionBegin.line - lineCount, 0);
+    mSelectionEnd.line = std::max(mSelectionEnd.line - lineCount, 0);
+    mTopRow = std::max(mTopRow - rowCount, 1);
+}
+
 void QConsole::contentsLastRowsRemoved(int )
 {
     ensureCaretVisible();
@@ -512,6 +538,7 @@ void QConsole::mousePressEvent(QMouseEvent *event)
     int Y=event->pos().y();
 
     QAbstractScrollArea::mousePressEvent(event);
+    flushPendingLines();
 
     //fKbdHandler.ExecuteMouseDown(Self, Button, Shift, X, Y);
 
@@ -564,6 +591,7 @@ void QConsole::mouseMoveEvent(QMouseEvent *event)
 
 void QConsole::keyPressEvent(QKeyEvent *event)
 {
+    flushPendingLines();
     switch(event->key()) {
     case Qt::Key_Return:
     case Qt::Key_Enter:
@@ -760,6 +788,7 @@ void QConsole::paintCaret(QPainter &painter, const QRect rcClip)
 
 void QConsole::textInputed(const QString &text)
 {
+    flushPendingLines();
     if (mContents.rows()<=0) {
         mContents.addLine("");
     }
@@ -925,9 +954,22 @@ QString QConsole::lineBreak()
 }
 
 
+void QConsole::flushPendingLines()
+{
+    if (mPendingLines.isEmpty())
+        return;
+    mFlushTimer->stop();
+    QStringList lines;
+    lines.swap(mPendingLines);
+    mContents.addLines(lines);
+    mSelectionBegin = caretPos();
+    mSelectionEnd = caretPos();
+}
+
 void QConsole::fontChanged()
 {
     recalcCharExtent();
+    mContents.invalidateColumns();
     sizeOrFontChanged(true);
 }
 
@@ -1019,13 +1061,24 @@ void ConsoleLines::layout()
     mLayouting = true;
     mNeedRelayout = false;
     emit layoutStarted();
-    mRows = 0;
-    bool forceUpdate = (mOldTabSize!=mConsole->tabSize());
-    for (PConsoleLine consoleLine: mLines) {
-        if (forceUpdate || consoleLine->maxColumns > mConsole->columnsPerRow()) {
-            consoleLine->maxColumns = breakLine(consoleLine->text,consoleLine->fragments);
+    bool columnsChanged = mColumnsInvalid || (mOldTabSize!=mConsole->tabSize());
+    bool widthChanged = (mOldColumnsPerRow!=mConsole->columnsPerRow());
+    mColumnsInvalid = false;
+    mOldTabSize = mConsole->tabSize();
+    mOldColumnsPerRow = mConsole->columnsPerRow();
+    if (columnsChanged || widthChanged) {
+        mRows = 0;
+        mRemovedRows = 0;
+        for (PConsoleLine consoleLine: mLines) {
+            if (columnsChanged)
+                consoleLine->columns = columnsOf(consoleLine->text);
+            //lines that fit in the row don't need to be broken again
+            if (columnsChanged || consoleLine->rows>1
+                    || consoleLine->columns > mOldColumnsPerRow)
+                updateLineRows(consoleLine);
+            consoleLine->startRow = mRows;
+            mRows+=consoleLine->rows;
         }
-        mRows+=consoleLine->fragments.count();
     }
     emit layoutFinished();
     mLayouting = false;
@@ -1037,41 +1090,46 @@ ConsoleLines::ConsoleLines(QConsole *console)
 {
     mConsole = console;
     mRows = 0;
+    mRemovedRows = 0;
+    mBytes = 0;
     mLayouting = false;
     mNeedRelayout = false;
     mOldTabSize = -1;
+    mOldColumnsPerRow = -1;
+    mColumnsInvalid = true;
     mMaxLines = 1000;
+    mMaxBytes = 4*1024*1024;
     connect(this,&ConsoleLines::needRelayout,this,&ConsoleLines::layout);
 }
 
 void ConsoleLines::addLine(const QString &line)
 {
-    PConsoleLine consoleLine=std::make_shared<ConsoleLine>();
-    consoleLine->text = line;
-    consoleLine->maxColumns = breakLine(line,consoleLine->fragments);
-    if (mLines.count()<mMaxLines || mMaxLines <= 0) {
-        mLines.append(consoleLine);
-        mRows += consoleLine->fragments.count();
-        emit rowsAdded(consoleLine->fragments.count());
-    } else {
-        PConsoleLine firstLine = mLines[0];
-        mLines.pop_front();
-        mRows -= firstLine->fragments.count();
+    addLines(QStringList{line});
+}
+
+void ConsoleLines::addLines(const QStringList &lines)
+{
+    if (lines.isEmpty())
+        return;
+    int oldRows = mRows;
+    foreach (const QString& line, lines) {
+        PConsoleLine consoleLine = createLine(line, mRows + mRemovedRows);
         mLines.append(consoleLine);
-        mRows += consoleLine->fragments.count();
-        emit layoutStarted();
-        emit layoutFinished();
+        mRows += consoleLine->rows;
     }
+    int addedRows = mRows - oldRows;
+    removeFirstLines();
+    emit rowsAdded(addedRows);
 }
 
 void ConsoleLines::RemoveLastLine()
 {
     if (mLines.count()<=0)
         return;
-    PConsoleLine consoleLine = mLines[mLines.count()-1];
-    mLines.pop_back();
-    mRows -= consoleLine->fragments.count();
-    emit lastRowsRemoved(consoleLine->fragments.count());
+    PConsoleLine consoleLine = mLines.takeLast();
+    mRows -= consoleLine->rows;
+    mBytes -= consoleLine->text.size()*sizeof(QChar);
+    emit lastRowsRemoved(consoleLine->rows);
 }
 
 void ConsoleLines::changeLastLine(const QString &newLine)
@@ -1079,11 +1137,14 @@ void ConsoleLines::changeLastLine(const QString &newLine)
     if (mLines.count()<=0) {
         return;
     }
-    PConsoleLine consoleLine = mLines[mLines.count()-1];
-    int oldRows = consoleLine->fragments.count();
+    PConsoleLine consoleLine = mLines.last();
+    int oldRows = consoleLine->rows;
+    mBytes -= consoleLine->text.size()*sizeof(QChar);
     consoleLine->text = newLine;
-    breakLine(newLine,consoleLine->fragments);
-    int newRows = consoleLine->fragments.count();
+    mBytes += consoleLine->text.size()*sizeof(QChar);
+    consoleLine->columns = columnsOf(newLine);
+    updateLineRows(consoleLine);
+    int newRows = consoleLine->rows;
     if (newRows == oldRows) {
         emit lastRowsChanged(oldRows);
         return ;
@@ -1099,7 +1160,7 @@ QString ConsoleLines::getLastLine()
 {
     if (mLines.count()<=0)
         return "";
-    return mLines[mLines.count()-1]->text;
+    return mLines.last()->text;
 }
 
 QString ConsoleLines::getLine(int line)
@@ -1132,9 +1193,15 @@ QStringList ConsoleLines::getRows(int startRow, int endRow)
     if (startRow > endRow)
         return QStringList();
     QStringList lst;
-    int row = 0;
-    for (PConsoleLine line:mLines) {
-        for (const QString& s:line->fragments) {
+    //only break the lines in the range
+    int i = findLineByRow(std::max(startRow,1)-1);
+    if (i<0)
+        return lst;
+    int row = lineStartRow(i);
+    QStringList fragments;
+    for (;i<mLines.count();i++) {
+        breakLine(mLines[i]->text, &fragments);
+        for (const QString& s:fragments) {
             row+=1;
             if (row>endRow) {
                 return lst;
@@ -1155,31 +1222,30 @@ LineChar ConsoleLines::rowColumnToLineChar(const RowColumn &rowColumn)
 LineChar ConsoleLines::rowColumnToLineChar(int row, int column)
 {
     LineChar result{column,mLines.size()-1};
-    int rows=0;
-    for (int i=0;i<mLines.size();i++) {
-        PConsoleLine line = mLines[i];
-        if (row >= rows && row<rows+line->fragments.size()) {
-            int r=row - rows;
-            QString fragment = line->fragments[r];
-            int columnsBefore = 0;
-            int charsBefore = 0;
-            for (int j=0;j<r;j++) {
-                charsBefore += line->fragments[j].length();
-            }
-            for (int j=0;j<fragment.size();j++) {
-                QChar ch = fragment[j];
-                int charColumns= mConsole->charColumns(ch, columnsBefore);
-                if (column>=columnsBefore && column<columnsBefore+charColumns) {
-                    result.ch = charsBefore + j;
-                    break;
-                }
-                columnsBefore += charColumns;
-            }
-            result.line = i;
+    int i = findLineByRow(row);
+    if (i<0)
+        return result;
+    QStringList fragments;
+    breakLine(mLines[i]->text, &fragments);
+    int r = row - lineStartRow(i);
+    if (r>=fragments.size())
+        return result;
+    QString fragment = fragments[r];
+    int columnsBefore = 0;
+    int charsBefore = 0;
+    for (int j=0;j<r;j++) {
+        charsBefore += fragments[j].length();
+    }
+    for (int j=0;j<fragment.size();j++) {
+        QChar ch = fragment[j];
+        int charColumns= mConsole->charColumns(ch, columnsBefore);
+        if (column>=columnsBefore && column<columnsBefore+charColumns) {
+            result.ch = charsBefore + j;
             break;
         }
-        rows += line->fragments.size();
+        columnsBefore += charColumns;
     }
+    result.line = i;
     return result;
 }
 
@@ -1191,18 +1257,15 @@ RowColumn ConsoleLines::lineCharToRowColumn(const LineChar &lineChar)
 RowColumn ConsoleLines::lineCharToRowColumn(int line, int ch)
 {
     RowColumn result{ch,std::max(0,mRows-1)};
-    int rowsBefore = 0;
     if (line>=0 && line < mLines.size()) {
-        for (int i=0;i<line;i++) {
-            int rows = mLines[i]->fragments.size();
-            rowsBefore += rows;
-        }
-        PConsoleLine consoleLine = mLines[line];
+        int rowsBefore = lineStartRow(line);
+        QStringList fragments;
+        breakLine(mLines[line]->text, &fragments);
         int charsBefore = 0;
-        for (int r=0;r<consoleLine->fragments.size();r++) {
-            int chars = consoleLine->fragments[r].size();
-            if (r==consoleLine->fragments.size()-1 || (ch>=charsBefore && ch<charsBefore+chars)) {
-                QString fragment = consoleLine->fragments[r];
+        for (int r=0;r<fragments.size();r++) {
+            int chars = fragments[r].size();
+            if (r==fragments.size()-1 || (ch>=charsBefore && ch<charsBefore+chars)) {
+                QString fragment = fragments[r];
                 int columnsBefore = 0;
                 int len = std::min(ch-charsBefore,fragment.size());
                 for (int j=0;j<len;j++) {
@@ -1225,13 +1288,91 @@ bool ConsoleLines::layouting() const
     return mLayouting;
 }
 
-int ConsoleLines::breakLine(const QString &line, QStringList &fragments)
+PConsoleLine ConsoleLines::createLine(const QString &text, int startRow)
 {
-    fragments.clear();
-    QString s = "";
-    int maxColLen = 0;
-    int columnsBefore = 0;
+    PConsoleLine consoleLine=std::make_shared<ConsoleLine>();
+    consoleLine->text = text;
+    consoleLine->columns = columnsOf(text);
+    consoleLine->startRow = startRow;
+    updateLineRows(consoleLine);
+    mBytes += text.size()*sizeof(QChar);
+    return consoleLine;
+}
+
+void ConsoleLines::updateLineRows(PConsoleLine consoleLine)
+{
+    if (consoleLine->columns <= mConsole->columnsPerRow() || mConsole->columnsPerRow()<=0)
+        consoleLine->rows = 1;
+    else
+        consoleLine->rows = breakLine(consoleLine->text, nullptr);
+}
+
+int ConsoleLines::lineStartRow(int line) const
+{
+    return mLines[line]->startRow - mRemovedRows;
+}
+
+int ConsoleLines::findLineByRow(int row) const
+{
+    if (row<0 || row>=mRows)
+        return -1;
+    //start rows are in ascending order
+    int left = 0;
+    int right = mLines.count()-1;
+    while (left<right) {
+        int mid = (left+right+1)/2;
+        if (lineStartRow(mid)<=row)
+            left = mid;
+        else
+            right = mid-1;
+    }
+    return left;
+}
+
+void ConsoleLines::removeFirstLines()
+{
+    int lineCount = 0;
+    int rowCount = 0;
+    //keep the last line, it may be edited
+    while (mLines.count()>1
+           && ((mMaxLines>0 && mLines.count()>mMaxLines)
+               || (mMaxBytes>0 && mBytes>mMaxBytes))) {
+        PConsoleLine consoleLine = mLines.takeFirst();
+        mBytes -= consoleLine->text.size()*sizeof(QChar);
+        rowCount += consoleLine->rows;
+        lineCount++;
+    }
+    if (lineCount>0) {
+        mRows -= rowCount;
+        mRemovedRows += rowCount;
+        emit firstLinesRemoved(lineCount, rowCount);
+    }
+}
+
+int ConsoleLines::columnsOf(const QString &line)
+{
+    int columns = 0;
     for (QChar ch:line) {
+        columns += mConsole->charColumns(ch,columns);
+    }
+    return columns;
+}
+
+int ConsoleLines::breakLine(const QString &line, QStringList *fragments)
+{
+    if (fragments)
+        fragments->clear();
+    //not layouted yet
+    if (mConsole->columnsPerRow()<=0) {
+        if (fragments)
+            fragments->append(line);
+        return 1;
+    }
+    int rows = 0;
+    QString s;
+    int columnsBefore = 0;
+    for (int i=0;i<line.length();i++) {
+        QChar ch = line[i];
         int charColumn = mConsole->charColumns(ch,columnsBefore);
         if (charColumn + columnsBefore > mConsole->columnsPerRow()) {
             if (ch == '\t') {
@@ -1240,25 +1381,24 @@ int ConsoleLines::breakLine(const QString &line, QStringList &fragments)
                 } else
                     charColumn = mConsole->tabSize();
             }
-            fragments.append(s);
-            if (columnsBefore > maxColLen) {
-                maxColLen = columnsBefore;
-            }
+            if (fragments)
+                fragments->append(s);
+            rows++;
             s = "";
             columnsBefore = 0;
         }
         if (charColumn > 0) {
             columnsBefore += charColumn;
-            s += ch;
+            if (fragments)
+                s += ch;
         }
     }
-    if (fragments.count() == 0 || !s.isEmpty()) {
-        fragments.append(s);
-        if (columnsBefore > maxColLen) {
-            maxColLen = columnsBefore;
-        }
+    if (rows == 0 || columnsBefore>0) {
+        if (fragments)
+            fragments->append(s);
+        rows++;
     }
-    return maxColLen;
+    return rows;
 }
 
 int ConsoleLines::getMaxLines() const
@@ -1274,15 +1414,29 @@ int ConsoleLines::maxLines() const
 void ConsoleLines::setMaxLines(int maxLines)
 {
     mMaxLines = maxLines;
-    if (mMaxLines > 0) {
-        while (mLines.count()>mMaxLines) {
-            mLines.pop_front();
-        }
-    }
+    removeFirstLines();
+}
+
+qint64 ConsoleLines::maxBytes() const
+{
+    return mMaxBytes;
+}
+
+void ConsoleLines::setMaxBytes(qint64 maxBytes)
+{
+    mMaxBytes = maxBytes;
+    removeFirstLines();
 }
 
 void ConsoleLines::clear()
 {
     mLines.clear();
     mRows = 0;
+    mRemovedRows = 0;
+    mBytes = 0;
+}
+
+void ConsoleLines::invalidateColumns()
+{
+    mColumnsInvalid = true;
 }
@@ -18,13 +18,19 @@
 #define QCONSOLE_H
 
 #include <QAbstractScrollArea>
-#include <QVector>
+#include <QHash>
+#include <QList>
 #include <memory>
 
+/**
+ * Lines are not wrapped into fragments when added. Only the columns and the
+ * count of rows are kept, fragments are computed when the rows are painted.
+ */
 struct ConsoleLine {
     QString text;
-    QStringList fragments;
-    int maxColumns;
+    int columns; // columns of the unwrapped text
+    int rows;
+    int startRow; // 0-based, including rows of the lines removed from the top
 };
 
 enum class ConsoleCaretType {
@@ -33,7 +39,7 @@ enum class ConsoleCaretType {
 
 using PConsoleLine = std::shared_ptr<ConsoleLine>;
 
-using ConsoleLineList = QVector<PConsoleLine>;
+using ConsoleLineList = QList<PConsoleLine>;
 
 /**
  * @brief The RowColumn struct
@@ -59,6 +65,7 @@ class ConsoleLines : public QObject{
 public:
     explicit ConsoleLines(QConsole* console);
     void addLine(const QString& line);
+    void addLines(const QStringList& lines);
     void RemoveLastLine();
     void changeLastLine(const QString& newLine);
     QString getLastLine();
@@ -82,7 +89,10 @@ public:
     bool layouting() const;
     int maxLines() const;
     void setMaxLines(int maxLines);
+    qint64 maxBytes() const;
+    void setMaxBytes(qint64 maxBytes);
     void clear();
+    void invalidateColumns();
 
     int getMaxLines() const;
 public slots:
@@ -92,18 +102,30 @@ signals:
     void layoutFinished();
     void needRelayout();
     void rowsAdded(int rowCount);
+    void firstLinesRemoved(int lineCount, int rowCount);
     void lastRowsRemoved(int rowCount);
     void lastRowsChanged(int rowCount);
 private:
-    int breakLine(const QString& line, QStringList& fragments);
+    PConsoleLine createLine(const QString& text, int startRow);
+    void updateLineRows(PConsoleLine consoleLine);
+    int lineStartRow(int line) const;
+    int findLineByRow(int row) const;
+    void removeFirstLines();
+    int columnsOf(const QString& line);
+    int breakLine(const QString& line, QStringList* fragments);
 private:
     ConsoleLineList mLines;
     int mRows;
+    int mRemovedRows; // rows of the lines removed from the top
+    qint64 mBytes;
     bool mLayouting;
     bool mNeedRelayout;
     int mOldTabSize;
+    int mOldColumnsPerRow;
+    bool mColumnsInvalid;
     QConsole* mConsole;
     int mMaxLines;
+    qint64 mMaxBytes;
 };
 
 
@@ -168,7 +190,12 @@ private:
     int mBlinkStatus;
     QTimer* mScrollTimer;
     int mScrollDeltaY;
+    //output lines are added to the contents once per frame
+    QStringList mPendingLines;
+    QTimer* mFlushTimer;
+    mutable QHash<QChar,int> mCharColumnsCache;
 private:
+    void flushPendingLines();
     void fontChanged();
     void recalcCharExtent();
     void sizeOrFontChanged(bool bFont);
@@ -208,6 +235,7 @@ private slots:
     void doScrolled();
     void contentsLayouted();
     void contentsRowsAdded(int rowCount);
+    void contentsFirstLinesRemoved(int lineCount, int rowCount);
     void contentsLastRowsRemoved(int rowCount);
     void contentsLastRowsChanged(int rowCount);
     void scrollTimerHandler();
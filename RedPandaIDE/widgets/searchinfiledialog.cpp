@@ -279,12 +279,12 @@ void SearchInFileDialog::doSearch(bool replace)
                     tr("Searching..."),
                     tr("Abort"),
                     0,
-                    pMainWindow->project()->unitList().count(),
+                    pMainWindow->project()->units().count(),
                     pMainWindow);
 
         progressDlg.setWindowModality(Qt::WindowModal);
         int i=0;
-        foreach (PProjectUnit unit, pMainWindow->project()->unitList()) {
+        foreach (PProjectUnit unit, pMainWindow->project()->units()) {
             i++;
             progressDlg.setValue(i);
             progressDlg.setLabelText(tr("Searching...")+"<br/>"+unit->fileName());
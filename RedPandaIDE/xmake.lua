@@ -39,17 +39,21 @@ target("RedPandaIDE")
         "settings.cpp",
         "syntaxermanager.cpp",
         "systemconsts.cpp",
+        "todoscanner.cpp",
         "utils.cpp",
         "visithistorymanager.cpp",
         -- compiler
         "compiler/compilerinfo.cpp",
+        "compiler/compilerprobecache.cpp",
         -- debugger
         "debugger/dapprotocol.cpp",
         "debugger/gdbmiresultparser.cpp",
         -- parser
         "parser/cpppreprocessor.cpp",
         "parser/cpptokenizer.cpp",
+        "parser/inactivelineranges.cpp",
         "parser/parserutils.cpp",
+        "parser/semantictokens.cpp",
         -- problems
         "problems/freeprojectsetformat.cpp",
         "problems/ojproblemset.cpp",
@@ -64,6 +68,7 @@ target("RedPandaIDE")
         "cpprefacter",
         "editor",
         "editorlist",
+        "headerindex",
         "iconsmanager",
         "project",
         "projecttemplate",
@@ -73,11 +78,13 @@ target("RedPandaIDE")
         "todoparser",
         "toolsmanager",
         -- compiler
+        "compiler/benchmarkrunner",
         "compiler/compiler",
         "compiler/compilermanager",
         "compiler/executablerunner",
         "compiler/filecompiler",
         "compiler/ojproblemcasesrunner",
+        "compiler/profilerunner",
         "compiler/projectcompiler",
         "compiler/runner",
         "compiler/stdincompiler",
@@ -248,3 +255,79 @@ target("test-escape")
 
     add_files("utils/escape.cpp", "test/escape.cpp")
     add_includedirs(".")
+
+target("test-wordwrap")
+    set_kind("binary")
+    add_rules("qt.console")
+
+    set_default(false)
+    add_tests("test-wordwrap")
+
+    add_files("../libs/qsynedit/qsynedit/wordwrap.cpp", "test/wordwrap.cpp")
+    add_includedirs("../libs/qsynedit")
+
+target("test-difflines")
+    set_kind("binary")
+    add_rules("qt.console")
+    add_frameworks("QtGui", "QtWidgets")
+
+    set_default(false)
+    add_tests("test-difflines")
+
+    add_deps("redpanda_qt_utils", "qsynedit")
+    add_files("test/difflines.cpp")
+
+target("test-undo")
+    set_kind("binary")
+    add_rules("qt.console")
+    add_frameworks("QtGui", "QtWidgets")
+
+    set_default(false)
+    add_tests("test-undo")
+
+    add_deps("redpanda_qt_utils", "qsynedit")
+    add_files("test/undo.cpp")
+
+target("test-gitstatus")
+    set_kind("binary")
+    add_rules("qt.console")
+
+    set_default(false)
+    add_tests("test-gitstatus")
+
+    add_files("vcs/gitutils.cpp", "test/gitstatus.cpp")
+    add_includedirs(".")
+
+target("test-todoscan")
+    set_kind("binary")
+    add_rules("qt.console")
+    add_frameworks("QtGui", "QtWidgets")
+
+    set_default(false)
+    add_tests("test-todoscan")
+
+    add_deps("redpanda_qt_utils", "qsynedit")
+    add_files("todoscanner.cpp", "test/todoscan.cpp")
+    add_includedirs(".")
+
+target("test-inactivelines")
+    set_kind("binary")
+    add_rules("qt.console")
+
+    set_default(false)
+    add_tests("test-inactivelines")
+
+    add_files("parser/inactivelineranges.cpp", "test/inactivelines.cpp")
+    add_includedirs(".")
+
+target("test-consolelines")
+    set_kind("binary")
+    add_rules("qt.console")
+    add_frameworks("QtGui", "QtWidgets")
+
+    set_default(false)
+    add_tests("test-consolelines")
+
+    add_deps("redpanda_qt_utils")
+    add_files("widgets/qconsole.cpp", "widgets/qconsole.h", "test/consolelines.cpp")
+    add_includedirs(".")
@@ -17,6 +17,13 @@ lua.subdir = libs/lua
 RedPandaIDE.depends = consolepauser qsynedit lua
 qsynedit.depends = redpanda_qt_utils
 
+linux: {
+SUBDIRS += \
+    profsampler
+profsampler.subdir = tools/profsampler
+RedPandaIDE.depends += profsampler
+}
+
 APP_NAME = RedPandaCPP
 include(version.inc)
 
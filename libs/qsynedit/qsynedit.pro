@@ -55,7 +55,8 @@ SOURCES += qsynedit/codefolding.cpp \
     qsynedit/types.cpp \
     qsynedit/syntaxer/makefile.cpp \
     qsynedit/syntaxer/textfile.cpp \
-    qsynedit/syntaxer/syntaxer.cpp
+    qsynedit/syntaxer/syntaxer.cpp \
+    qsynedit/wordwrap.cpp
 
 HEADERS += \
     qsynedit/codefolding.h \
@@ -82,7 +83,8 @@ HEADERS += \
     qsynedit/syntaxer/lua.h \
     qsynedit/syntaxer/makefile.h \
     qsynedit/syntaxer/textfile.h \
-    qsynedit/syntaxer/syntaxer.h
+    qsynedit/syntaxer/syntaxer.h \
+    qsynedit/wordwrap.h
 
 INCLUDEPATH += ../redpanda_qt_utils
 
@@ -16,6 +16,7 @@
  */
 #include "codefolding.h"
 #include "constants.h"
+#include <algorithm>
 
 
 namespace QSynedit {
@@ -122,4 +123,57 @@ const QVector<PCodeFoldingRange> &CodeFoldingRanges::ranges() const
     return mRanges;
 }
 
+CollapsedFoldsIndex::CollapsedFoldsIndex():
+    mGeneration{0},
+    mValid{false}
+{
+
+}
+
+void CollapsedFoldsIndex::rebuild(const PCodeFoldingRanges &allFoldRanges)
+{
+    QVector<PCodeFoldingRange> folds;
+    for (int i=0;i<allFoldRanges->count();i++) {
+        PCodeFoldingRange range = (*allFoldRanges)[i];
+        if (range->collapsed && !range->parentCollapsed())
+            folds.append(range);
+    }
+    std::sort(folds.begin(),folds.end(),[](const PCodeFoldingRange& r1, const PCodeFoldingRange& r2){
+        return r1->fromLine < r2->fromLine;
+    });
+    mFromLines.resize(folds.count());
+    mToLines.resize(folds.count());
+    mFirstRows.resize(folds.count());
+    mHiddenLinesBefore.resize(folds.count()+1);
+    int hidden = 0;
+    for (int i=0;i<folds.count();i++) {
+        mFromLines[i] = folds[i]->fromLine;
+        mToLines[i] = folds[i]->toLine;
+        mFirstRows[i] = folds[i]->fromLine - hidden;
+        mHiddenLinesBefore[i] = hidden;
+        hidden += folds[i]->linesCollapsed;
+    }
+    mHiddenLinesBefore[folds.count()] = hidden;
+    mGeneration++;
+    mValid = true;
+}
+
+int CollapsedFoldsIndex::rowToLine(int row) const
+{
+    // count of the folds starting before the row
+    int count = std::lower_bound(mFirstRows.begin(), mFirstRows.end(), row) - mFirstRows.begin();
+    return row + mHiddenLinesBefore[count];
+}
+
+int CollapsedFoldsIndex::lineToRow(int line) const
+{
+    // count of the folds ending before the line
+    int count = std::lower_bound(mToLines.begin(), mToLines.end(), line) - mToLines.begin();
+    int result = line - mHiddenLinesBefore[count];
+    // inside fold
+    if (count<mFromLines.count() && mFromLines[count] < line && line <= mToLines[count])
+        result -= line - mFromLines[count];
+    return result;
+}
+
 }
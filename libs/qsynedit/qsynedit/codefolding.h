@@ -76,5 +76,33 @@ public:
     void move(int count);
 };
 
+/**
+ * @brief Index of the collapsed folds that are not inside other collapsed folds
+ *
+ * These folds don't overlap, so with their start lines and the prefix sums of
+ * their hidden lines, rows and lines can be mapped by binary search.
+ *
+ * The index is rebuilt from the fold ranges when it's used after being invalidated.
+ */
+class CollapsedFoldsIndex {
+public:
+    explicit CollapsedFoldsIndex();
+    void invalidate() { mValid = false; }
+    bool valid() const { return mValid; }
+    void rebuild(const PCodeFoldingRanges& allFoldRanges);
+    int rowToLine(int row) const;
+    int lineToRow(int line) const;
+    const QVector<int>& fromLines() const { return mFromLines; }
+    const QVector<int>& toLines() const { return mToLines; }
+    int generation() const { return mGeneration; } // increased by each rebuild
+private:
+    QVector<int> mFromLines; // sorted
+    QVector<int> mToLines;
+    QVector<int> mHiddenLinesBefore; // lines hidden by the folds before each fold, has one more element at the end
+    QVector<int> mFirstRows; // fromLine - hidden lines before, strictly increasing
+    int mGeneration;
+    bool mValid;
+};
+
 }
 #endif // CODEFOLDING_H
@@ -24,9 +24,13 @@
 #include <stdexcept>
 #include <QMessageBox>
 #include <cmath>
+#include <climits>
+#include <cstring>
 #include "qt_utils/charsetinfo.h"
+#include <QCoreApplication>
 #include <QDateTime>
 #include <QDebug>
+#include <QThread>
 
 namespace QSynedit {
 
@@ -208,6 +212,10 @@ void Document::setSyntaxState(int line, const SyntaxState& state)
         listIndexOutOfBounds(line);
     }
     mLines[line]->setSyntaxState(state);
+    //tokens of the next line depend on the state of this line
+    if (line+1<mLines.count())
+        mLines[line+1]->mTokens.reset();
+    mLines[line]->mTokens.reset();
 }
 
 QString Document::getLine(int line) const
@@ -228,6 +236,21 @@ int Document::getLineGlyphsCount(int line) const
     return mLines[line]->glyphsCount();
 }
 
+int Document::getLineGlyphs(int line, QString &text, QList<int> &glyphStartChars, QList<int> &glyphStartPositions) const
+{
+    QMutexLocker locker(&mMutex);
+    if (line<0 || line>=mLines.count()) {
+        text.clear();
+        glyphStartChars.clear();
+        glyphStartPositions.clear();
+        return 0;
+    }
+    glyphStartPositions = mLines[line]->glyphStartPositionList();
+    glyphStartChars = mLines[line]->glyphStartCharList();
+    text = mLines[line]->lineText();
+    return mLines[line]->width();
+}
+
 // QList<int> Document::getGlyphPositions(int index)
 // {
 //     QMutexLocker locker(&mMutex);
@@ -497,61 +520,41 @@ void Document::insertLines(int index, int numLines)
 }
 
 
-bool Document::tryLoadFileByEncoding(QByteArray encodingName, QFile& file) {
+bool Document::tryDecodeByEncoding(const QByteArray& encodingName, const QByteArray& content, QString& text) {
     QTextCodec* codec = QTextCodec::codecForName(encodingName);
     if (!codec)
         return false;
-    file.reset();
-    internalClear();
+    // quick reject of the chinese codecs without decoding
+    QByteArray upperName = encodingName.toUpper();
+    if (upperName.startsWith("GB") && !isValidGB18030Content(content))
+        return false;
     QTextCodec::ConverterState state;
-    while (true) {
-        if (file.atEnd()){
-            break;
-        }
-        QByteArray line = file.readLine();
-        if (line.endsWith("\r\n")) {
-            line.remove(line.length()-2,2);
-        } else if (line.endsWith("\r")) {
-            line.remove(line.length()-1,1);
-        } else if (line.endsWith("\n")){
-            line.remove(line.length()-1,1);
-        }
-        QString newLine = codec->toUnicode(line.constData(),line.length(),&state);
-        if (state.invalidChars>0) {
-            return false;
-            break;
-        }
-        addItem(newLine);
-    }
-    return true;
+    text = codec->toUnicode(content.constData(),content.length(),&state);
+    return state.invalidChars==0;
 }
 
-void Document::loadUTF16BOMFile(QFile &file)
+void Document::loadUTF16BOMFile(const QByteArray& content)
 {
     QTextCodec* codec=QTextCodec::codecForName(ENCODING_UTF16);
     if (!codec)
         return;
-    file.reset();
     internalClear();
-    QByteArray buf = file.readAll();
-    if (buf.length()<2)
+    if (content.length()<2)
         return;
-    QString text = codec->toUnicode(buf.mid(2));
-    this->setText(text);
+    QString text = codec->toUnicode(content.mid(2));
+    addItems(text);
 }
 
-void Document::loadUTF32BOMFile(QFile &file)
+void Document::loadUTF32BOMFile(const QByteArray& content)
 {
     QTextCodec* codec=QTextCodec::codecForName(ENCODING_UTF32);
     if (!codec)
         return;
-    file.reset();
     internalClear();
-    QByteArray buf = file.readAll();
-    if (buf.length()<4)
+    if (content.length()<4)
         return;
-    QString text = codec->toUnicode(buf.mid(4));
-    this->setText(text);
+    QString text = codec->toUnicode(content.mid(4));
+    addItems(text);
 }
 
 void Document::saveUTF16File(QFile &file, QTextCodec* codec)
@@ -599,87 +602,56 @@ void Document::loadFromFile(const QString& filename, const QByteArray& encoding,
             emit inserted(0,mLines.count());
         endUpdate();
     });
-    //test for utf8 / utf 8 bom
+    QByteArray content = file.readAll();
+    QString text;
     if (encoding == ENCODING_AUTO_DETECT) {
-        if (file.atEnd()) {
+        if (content.isEmpty()) {
             realEncoding = ENCODING_ASCII;
             return;
         }
-        QByteArray line = file.readLine();
-        QTextCodec* codec;
-        QTextCodec::ConverterState state;
-        bool needReread = false;
-        bool allAscii = true;
+        bool hasBOM = false;
         //test for BOM
-        if ((line.length()>=3) && ((unsigned char)line[0]==0xEF) && ((unsigned char)line[1]==0xBB) && ((unsigned char)line[2]==0xBF) ) {
-            realEncoding = ENCODING_UTF8_BOM;
-            line = line.mid(3);
-            codec = QTextCodec::codecForName(ENCODING_UTF8);
-        } else if ((line.length()>=4) && ((unsigned char)line[0]==0xFF) && ((unsigned char)line[1]==0xFE)
-                   && ((unsigned char)line[2]==0x00)
-                   && ((unsigned char)line[3]==0x00)) {
+        if ((content.length()>=3) && ((unsigned char)content[0]==0xEF) && ((unsigned char)content[1]==0xBB) && ((unsigned char)content[2]==0xBF) ) {
+            hasBOM = true;
+            content.remove(0,3);
+        } else if ((content.length()>=4) && ((unsigned char)content[0]==0xFF) && ((unsigned char)content[1]==0xFE)
+                   && ((unsigned char)content[2]==0x00)
+                   && ((unsigned char)content[3]==0x00)) {
             realEncoding = ENCODING_UTF32_BOM;
-            loadUTF32BOMFile(file);
+            loadUTF32BOMFile(content);
             return;
-        } else if ((line.length()>=2) && ((unsigned char)line[0]==0xFF) && ((unsigned char)line[1]==0xFE)) {
+        } else if ((content.length()>=2) && ((unsigned char)content[0]==0xFF) && ((unsigned char)content[1]==0xFE)) {
             realEncoding = ENCODING_UTF16_BOM;
-            loadUTF16BOMFile(file);
+            loadUTF16BOMFile(content);
             return;
-        } else {
-            realEncoding = ENCODING_UTF8;
-            codec = QTextCodec::codecForName(ENCODING_UTF8);
         }
-        if (!codec)
-            throw FileError(tr("Can't load codec '%1'!").arg(QString(realEncoding)));
-        if (line.endsWith("\r\n")) {
+        // check all the bytes in one pass, and choose the codec before decoding
+        bool hasNull, allAscii, validUTF8;
+        scanTextContent(content, hasNull, allAscii, validUTF8);
+        if (hasNull)
+            throw BinaryFileError(tr("'%1' is a binaray File!").arg(filename));
+        int lineEnd = content.indexOf('\n');
+        if (lineEnd>0 && content[lineEnd-1]=='\r') {
             mNewlineType = NewlineType::Windows;
-        } else if (line.endsWith("\n")) {
+        } else if (lineEnd>=0) {
             mNewlineType = NewlineType::Unix;
-        } else if (line.endsWith("\r")) {
+        } else if (content.endsWith('\r')) {
             mNewlineType = NewlineType::MacOld;
         }
-
-        internalClear();
-        while (true) {
-            if (line.endsWith("\r\n")) {
-                line.remove(line.length()-2,2);
-            } else if (line.endsWith("\r")) {
-                line.remove(line.length()-1,1);
-            } else if (line.endsWith("\n")){
-                line.remove(line.length()-1,1);
-            }
-            if (isBinaryContent(line))
-                throw BinaryFileError(tr("'%1' is a binaray File!").arg(filename));
-            if (allAscii) {
-                allAscii = isTextAllAscii(line);
-            }
-            if (allAscii) {
-                addItem(QString::fromLatin1(line));
-            } else {
-                QString newLine = codec->toUnicode(line.constData(),line.length(),&state);
-                if (state.invalidChars>0) {
-                    needReread = true;
-                    break;
-                }
-                addItem(newLine);
-            }
-            if (file.atEnd()){
-                break;
-            }
-            line = file.readLine();
-        }
-        if (!needReread) {
-            if (allAscii)
+        if (validUTF8) {
+            if (hasBOM)
+                realEncoding = ENCODING_UTF8_BOM;
+            else if (allAscii)
                 realEncoding = ENCODING_ASCII;
-            return;
-        }
-        realEncoding = pCharsetInfoManager->getDefaultSystemEncoding();
-        if (tryLoadFileByEncoding(realEncoding,file)) {
-            return;
-        }
-        QList<PCharsetInfo> charsets = pCharsetInfoManager->findCharsetByLocale(pCharsetInfoManager->localeName());
-        if (!charsets.isEmpty()) {
-
+            else
+                realEncoding = ENCODING_UTF8;
+            text = allAscii ? QString::fromLatin1(content) : QString::fromUtf8(content);
+        } else if (tryDecodeByEncoding(pCharsetInfoManager->getDefaultSystemEncoding(), content, text)) {
+            realEncoding = pCharsetInfoManager->getDefaultSystemEncoding();
+        } else {
+            realEncoding = pCharsetInfoManager->getDefaultSystemEncoding();
+            bool decoded = false;
+            QList<PCharsetInfo> charsets = pCharsetInfoManager->findCharsetByLocale(pCharsetInfoManager->localeName());
             QSet<QByteArray> encodingSet;
             for (int i=0;i<charsets.size();i++) {
                 encodingSet.insert(charsets[i]->name);
@@ -688,45 +660,39 @@ void Document::loadFromFile(const QString& filename, const QByteArray& encoding,
             foreach (const QByteArray& encodingName,encodingSet) {
                 if (encodingName == ENCODING_UTF8)
                     continue;
-                if (tryLoadFileByEncoding(encodingName,file)) {
-                    //qDebug()<<encodingName;
+                if (tryDecodeByEncoding(encodingName, content, text)) {
                     realEncoding = encodingName;
-                    return;
+                    decoded = true;
+                    break;
                 }
             }
+            if (!decoded) {
+                QTextCodec* codec = QTextCodec::codecForName(realEncoding);
+                if (!codec)
+                    codec = QTextCodec::codecForLocale();
+                text = codec->toUnicode(content);
+            }
         }
     } else {
         realEncoding = encoding;
-    }
-
-    if (realEncoding == ENCODING_SYSTEM_DEFAULT) {
-        realEncoding = pCharsetInfoManager->getDefaultSystemEncoding();
-    }
-    file.reset();
-    QTextStream textStream(&file);
-    if (realEncoding == ENCODING_UTF8_BOM) {
-        textStream.setAutoDetectUnicode(true);
-        textStream.setCodec(ENCODING_UTF8);
-    } else {
-        textStream.setAutoDetectUnicode(false);
-        textStream.setCodec(realEncoding);
-    }
-    QString line;
-    internalClear();
-    while (textStream.readLineInto(&line)) {
-        if (line.endsWith("\r\n")) {
-            line.remove(line.length()-2,2);
-        } else if (line.endsWith("\r")) {
-            line.remove(line.length()-1,1);
-        } else if (line.endsWith("\n")){
-            line.remove(line.length()-1,1);
+        if (realEncoding == ENCODING_SYSTEM_DEFAULT) {
+            realEncoding = pCharsetInfoManager->getDefaultSystemEncoding();
+        }
+        QTextCodec* codec;
+        if (realEncoding == ENCODING_UTF8_BOM) {
+            codec = QTextCodec::codecForName(ENCODING_UTF8);
+            if (content.startsWith("\xEF\xBB\xBF"))
+                content.remove(0,3);
+        } else {
+            codec = QTextCodec::codecForName(realEncoding);
         }
-        addItem(line);
+        if (!codec)
+            codec = QTextCodec::codecForLocale();
+        text = codec->toUnicode(content);
     }
+    addItems(text);
 }
 
-
-
 void Document::saveToFile(QFile &file, const QByteArray& encoding,
                                    const QByteArray& defaultEncoding, QByteArray& realEncoding)
 {
@@ -826,9 +792,35 @@ int Document::charToGlyphStartChar(int line, int charPos) const
 //     return mLines[line]->glyphStartColumn(glyphIdx);
 // }
 
+static bool isPureAscii(const QString &text)
+{
+    const ushort *p = text.utf16();
+    int len = text.length();
+    int i=0;
+    //test 4 chars at a time
+    for (;i+4<=len;i+=4) {
+        quint64 v;
+        memcpy(&v, p+i, sizeof(v));
+        if (v & Q_UINT64_C(0xFF80FF80FF80FF80))
+            return false;
+    }
+    for (;i<len;i++) {
+        if (p[i]>=0x80)
+            return false;
+    }
+    return true;
+}
+
 QList<int> calcGlyphStartCharList(const QString &text)
 {
     QList<int> glyphStartCharList;
+    if (isPureAscii(text)) {
+        //each ascii char is a glyph
+        glyphStartCharList.reserve(text.length());
+        for (int i=0;i<text.length();i++)
+            glyphStartCharList.append(i);
+        return glyphStartCharList;
+    }
     //parse mGlyphs
     int i=0;
     bool consecutive = false;
@@ -956,6 +948,26 @@ int Document::charToGlyphIndex(const QString& str, QList<int> glyphStartCharList
     // return glyphStartCharList.length()-1;
 }
 
+QList<int> GlyphCalculator::calcGlyphPositionList(const QString &lineText, const QList<int> &glyphStartCharList, int left, int &right) const
+{
+    right = std::max(0,left);
+    int start,end;
+    QList<int> glyphPostionList;
+    glyphPostionList.reserve(glyphStartCharList.length());
+    for (int i=0;i<glyphStartCharList.length();i++) {
+        start = glyphStartCharList[i];
+        if (i+1<glyphStartCharList.length()) {
+            end = glyphStartCharList[i+1];
+        } else {
+            end = lineText.length();
+        }
+        int gWidth = glyphWidth(lineText, start, end, right, *mWidthTable);
+        glyphPostionList.append(right);
+        right += gWidth;
+    }
+    return glyphPostionList;
+}
+
 QList<int> GlyphCalculator::calcGlyphPositionList(const QString &lineText, const QList<int> &glyphStartCharList, const QFontMetrics &fontMetrics, int left, int &right) const
 {
     right = std::max(0,left);
@@ -1088,6 +1100,27 @@ int Document::xposToGlyphStartChar(int line, const QString newStr, int xpos) con
 
 // }
 
+void Document::addItems(const QString &text)
+{
+    //lines may end with "\r\n", "\n" or a lone "\r", like putTextStr()
+    int start = 0;
+    int pos = 0;
+    while (pos < text.length()) {
+        QChar ch = text[pos];
+        if (ch != '\r' && ch != '\n') {
+            pos++;
+            continue;
+        }
+        addItem(text.mid(start, pos - start));
+        pos++;
+        if (ch == '\r' && pos < text.length() && text[pos] == '\n')
+            pos++;
+        start = pos;
+    }
+    if (start < text.length())
+        addItem(text.mid(start));
+}
+
 void Document::putTextStr(const QString &text)
 {
     beginUpdate();
@@ -1235,6 +1268,30 @@ int Document::getLineWidth(int line)
     return mLines[line]->mWidth;
 }
 
+PLineTokens Document::getLineTokens(int line)
+{
+    QMutexLocker locker(&mMutex);
+    if (line<0 || line>=mLines.count())
+        return PLineTokens();
+    return mLines[line]->mTokens;
+}
+
+void Document::setLineTokens(int line, const PLineTokens &tokens)
+{
+    QMutexLocker locker(&mMutex);
+    if (line<0 || line>=mLines.count())
+        return;
+    mLines[line]->mTokens = tokens;
+}
+
+void Document::invalidateAllLineTokens()
+{
+    QMutexLocker locker(&mMutex);
+    for (PDocumentLine& line:mLines) {
+        line->mTokens.reset();
+    }
+}
+
 NewlineType Document::getNewlineType() const
 {
     QMutexLocker locker(&mMutex);
@@ -1267,7 +1324,7 @@ void Document::invalidateAllNonTempLineWidth()
     QMutexLocker locker(&mMutex);
     for (PDocumentLine& line:mLines) {
         if (!line->mIsTempWidth)
-            line->mIsTempWidth;
+            line->mIsTempWidth = true;
     }
 }
 
@@ -1320,6 +1377,7 @@ void DocumentLine::setLineText(const QString &newLineText)
 {
     mLineText = newLineText;
     mGlyphStartCharList = calcGlyphStartCharList(newLineText);
+    mTokens.reset();
     invalidateWidth();
 }
 
@@ -1357,6 +1415,10 @@ UndoList::UndoList():QObject()
     mLastPoppedItemChangeNumber=0;
     mInitialChangeNumber = 0;
     mLastRestoredItemChangeNumber=0;
+    mMaxUndoActions = 0;
+    mMaxMemoryUsage = 64*1024*1024;
+    mMemoryUsage = 0;
+    mCompressedCount = 0;
 }
 
 void UndoList::addChange(ChangeReason reason, const BufferCoord &startPos,
@@ -1373,7 +1435,7 @@ void UndoList::addChange(ChangeReason reason, const BufferCoord &startPos,
                 reason,
                 selMode,startPos,endPos,changeText,
                 changeNumber);
-    mItems.append(newItem);
+    appendItem(newItem);
 
     if (reason!=ChangeReason::GroupBreak && !inBlock()) {
         emit addedUndo();
@@ -1391,7 +1453,7 @@ void UndoList::restoreChange(ChangeReason AReason, const BufferCoord &AStart, co
 void UndoList::restoreChange(PUndoItem item)
 {
     size_t changeNumber = item->changeNumber();
-    mItems.append(item);
+    appendItem(item);
     if (changeNumber>mNextChangeNumber)
         mNextChangeNumber=changeNumber;
     if (changeNumber!=mLastRestoredItemChangeNumber) {
@@ -1422,6 +1484,8 @@ void UndoList::beginBlock()
 void UndoList::clear()
 {
     mItems.clear();
+    mMemoryUsage = 0;
+    mCompressedCount = 0;
     mFullUndoImposible = false;
     mInitialChangeNumber=0;
     mLastPoppedItemChangeNumber=0;
@@ -1484,6 +1548,8 @@ PUndoItem UndoList::popItem()
 //        qDebug()<<"popped"<<item->changeNumber()<<item->changeText()<<(int)item->changeReason()<<mLastPoppedItemChangeNumber;
         mLastPoppedItemChangeNumber =  item->changeNumber();
         mItems.removeLast();
+        mMemoryUsage -= item->memoryUsage();
+        mCompressedCount = std::min(mCompressedCount, mItems.count());
         return item;
     }
 }
@@ -1530,6 +1596,85 @@ bool UndoList::fullUndoImposible() const
     return mFullUndoImposible;
 }
 
+int UndoList::maxUndoActions() const
+{
+    return mMaxUndoActions;
+}
+
+void UndoList::setMaxUndoActions(int maxUndoActions)
+{
+    mMaxUndoActions = maxUndoActions;
+    ensureMaxEntries();
+}
+
+size_t UndoList::maxMemoryUsage() const
+{
+    return mMaxMemoryUsage;
+}
+
+void UndoList::setMaxMemoryUsage(size_t maxMemoryUsage)
+{
+    mMaxMemoryUsage = maxMemoryUsage;
+    ensureMaxEntries();
+}
+
+size_t UndoList::memoryUsage() const
+{
+    return mMemoryUsage;
+}
+
+void UndoList::appendItem(PUndoItem item)
+{
+    mItems.append(item);
+    mMemoryUsage += item->memoryUsage();
+    compressOldItems();
+    ensureMaxEntries();
+}
+
+void UndoList::ensureMaxEntries()
+{
+    bool overLimit = (mMaxUndoActions>0 && mItems.count()>mMaxUndoActions)
+            || (mMaxMemoryUsage>0 && mMemoryUsage>mMaxMemoryUsage);
+    if (!overLimit)
+        return;
+    // drop 1/4 more than needed, so we don't need to do it on each change
+    int maxCount = (mMaxUndoActions>0) ? mMaxUndoActions - mMaxUndoActions/4 : INT_MAX;
+    size_t maxUsage = (mMaxMemoryUsage>0) ? mMaxMemoryUsage - mMaxMemoryUsage/4 : SIZE_MAX;
+    int count = 0;
+    size_t usage = mMemoryUsage;
+    // only drop whole changes, and never the last one
+    size_t lastChangeNumber = mItems.last()->changeNumber();
+    while (count < mItems.count()
+           && (mItems.count()-count > maxCount || usage > maxUsage)) {
+        size_t changeNumber = mItems[count]->changeNumber();
+        if (changeNumber == lastChangeNumber)
+            break;
+        while (count < mItems.count() && mItems[count]->changeNumber() == changeNumber) {
+            usage -= mItems[count]->memoryUsage();
+            count++;
+        }
+    }
+    if (count==0)
+        return;
+    mItems.remove(0,count);
+    mMemoryUsage = usage;
+    mCompressedCount = std::max(0, mCompressedCount - count);
+    mFullUndoImposible = true;
+}
+
+void UndoList::compressOldItems()
+{
+    // the recent changes are the most likely to be undone, keep them uncompressed
+    const int KeepUncompressedCount = 100;
+    while (mCompressedCount < mItems.count() - KeepUncompressedCount) {
+        PUndoItem item = mItems[mCompressedCount];
+        mMemoryUsage -= item->memoryUsage();
+        item->compress();
+        mMemoryUsage += item->memoryUsage();
+        mCompressedCount++;
+    }
+}
+
 SelectionMode UndoItem::changeSelMode() const
 {
     return mChangeSelMode;
@@ -1547,6 +1692,8 @@ BufferCoord UndoItem::changeEndPos() const
 
 QStringList UndoItem::changeText() const
 {
+    if (!mCompressedText.isEmpty())
+        return QString::fromUtf8(qUncompress(mCompressedText)).split('\n');
     return mChangeText;
 }
 
@@ -1555,6 +1702,40 @@ size_t UndoItem::changeNumber() const
     return mChangeNumber;
 }
 
+size_t UndoItem::memoryUsage() const
+{
+    return mMemoryUsage;
+}
+
+bool UndoItem::compressed() const
+{
+    return !mCompressedText.isEmpty();
+}
+
+void UndoItem::compress()
+{
+    // not worth compressing small texts
+    const size_t MinCompressSize = 4096;
+    if (compressed() || mMemoryUsage < MinCompressSize + sizeof(UndoItem))
+        return;
+    //the change text are lines, which don't contain line breaks
+    QByteArray compressedText = qCompress(mChangeText.join('\n').toUtf8());
+    if ((size_t)compressedText.size() + sizeof(UndoItem) >= mMemoryUsage)
+        return;
+    mCompressedText = compressedText;
+    mChangeText.clear();
+    updateMemoryUsage();
+}
+
+void UndoItem::updateMemoryUsage()
+{
+    mMemoryUsage = sizeof(UndoItem) + mCompressedText.size();
+    foreach (const QString& s, mChangeText) {
+        // approximate size of the QString data header
+        mMemoryUsage += s.length()*sizeof(QChar) + 24;
+    }
+}
+
 UndoItem::UndoItem(ChangeReason reason, SelectionMode selMode,
                                  BufferCoord startPos, BufferCoord endPos,
                                  const QStringList& text, int number)
@@ -1565,10 +1746,7 @@ UndoItem::UndoItem(ChangeReason reason, SelectionMode selMode,
     mChangeEndPos = endPos;
     mChangeText = text;
     mChangeNumber = number;
-    int length=0;
-    foreach (const QString& s, text) {
-        length+=s.length();
-    }
+    updateMemoryUsage();
 }
 
 ChangeReason UndoItem::changeReason() const
@@ -1679,7 +1857,7 @@ int searchForSegmentIdx(const QList<int> &segList, int minVal, int maxVal, int v
 int GlyphCalculator::updateGlyphStartPositionList(
         const QString &lineText,
         const QList<int> &glyphStartCharList, int startChar, int endChar,
-        const QFontMetrics &fontMetrics,
+        GlyphWidthTable &widthTable,
         QList<int> &glyphStartPositionList, int left, int &right, int &startGlyph, int &endGlyph) const
 {
     right = std::max(0,left);
@@ -1693,8 +1871,7 @@ int GlyphCalculator::updateGlyphStartPositionList(
         } else {
             end = lineText.length();
         }
-        QString glyph = lineText.mid(start,end-start);
-        int gWidth = glyphWidth(glyph, right, fontMetrics, mForceMonospace);
+        int gWidth = glyphWidth(lineText, start, end, right, widthTable);
         glyphStartPositionList[i] = right;
         right += gWidth;
     }
@@ -1722,6 +1899,26 @@ int GlyphCalculator::glyphWidth(const QString &glyph, int left, const QFontMetri
     return glyphWidth;
 }
 
+int GlyphCalculator::glyphWidth(const QString &lineText, int start, int end, int left, GlyphWidthTable &widthTable) const
+{
+    int glyphWidth;
+    if (end<=start)
+        return 0;
+    QChar ch = lineText[start];
+    if (ch == '\t') {
+        glyphWidth = tabWidth() - left % tabWidth();
+    } else if (end-start == 1) {
+        glyphWidth = widthTable.charWidth(ch);
+    } else {
+        glyphWidth = widthTable.glyphWidth(lineText.mid(start, end-start));
+    }
+    if (mForceMonospace) {
+        int cols = std::ceil(glyphWidth / (double)mCharWidth);
+        glyphWidth = cols * mCharWidth;
+    }
+    return glyphWidth;
+}
+
 void expandGlyphStartCharList(const QString &strAdded, int oldStrLen, QList<int> &glyphStartCharList)
 {
     QList<int> addedList = calcGlyphStartCharList(strAdded);
@@ -1750,6 +1947,7 @@ int segmentIntervalStart(const QList<int> &segList, int minVal, int maxVal, int
 
 GlyphCalculator::GlyphCalculator(const QFont &font):
     mFontMetrics{font},
+    mWidthTable{GlyphWidthTable::forFont(font)},
     mTabSize{4},
     mForceMonospace{false}
 {
@@ -1760,8 +1958,53 @@ GlyphCalculator::GlyphCalculator(const QFont &font):
 void GlyphCalculator::setFont(const QFont &newFont)
 {
     mFontMetrics = QFontMetrics(newFont);
+    mWidthTable = GlyphWidthTable::forFont(newFont);
     mCharWidth =  mFontMetrics.horizontalAdvance("M");
     mSpaceWidth = mFontMetrics.horizontalAdvance(" ");
 }
 
+GlyphWidthTable::GlyphWidthTable(const QFont &font):
+    mFontMetrics{font},
+    mBMPWidths(0x10000, -1)
+{
+}
+
+PGlyphWidthTable GlyphWidthTable::forFont(const QFont &font)
+{
+    // the tables are shared without locking
+    Q_ASSERT(!QCoreApplication::instance()
+             || QThread::currentThread() == QCoreApplication::instance()->thread());
+    static QHash<QString, std::weak_ptr<GlyphWidthTable>> tables;
+    // underline and strike out don't change the advances
+    QFont measuredFont = font;
+    measuredFont.setUnderline(false);
+    measuredFont.setStrikeOut(false);
+    QString key = measuredFont.key();
+    PGlyphWidthTable table = tables.value(key).lock();
+    if (!table) {
+        //remove tables of fonts no longer used
+        for (auto it=tables.begin();it!=tables.end();) {
+            if (it.value().expired())
+                it = tables.erase(it);
+            else
+                ++it;
+        }
+        table = std::make_shared<GlyphWidthTable>(measuredFont);
+        tables.insert(key, table);
+    }
+    return table;
+}
+
+int GlyphWidthTable::glyphWidth(const QString &glyph)
+{
+    if (glyph.length()==1)
+        return charWidth(glyph[0]);
+    auto it = mOtherWidths.constFind(glyph);
+    if (it!=mOtherWidths.constEnd())
+        return it.value();
+    int width = mFontMetrics.horizontalAdvance(glyph);
+    mOtherWidths.insert(glyph, width);
+    return width;
+}
+
 }
@@ -19,6 +19,7 @@
 
 #include <QStringList>
 #include <QFontMetrics>
+#include <QHash>
 #include <QMutex>
 #include <QVector>
 #include <memory>
@@ -36,6 +37,20 @@ QList<int> calcGlyphStartCharList(const QString &text);
 void expandGlyphStartCharList(const QString& strAdded, int oldStrLen, QList<int> &glyphStartCharList);
 
 class Document;
+class TokenAttribute;
+using PTokenAttribute = std::shared_ptr<TokenAttribute>;
+
+/**
+ * @brief A token of a line, as returned by the syntaxer
+ */
+struct LineToken {
+    int start; // char index in the line text
+    int length;
+    PTokenAttribute attr;
+    int bracketLevel; // embedding level of brackets/braces/parenthesis (rainbow color), only for bracket tokens
+};
+using LineTokens = QVector<LineToken>;
+using PLineTokens = std::shared_ptr<const LineTokens>;
 
 using SearchConfirmAroundProc = std::function<bool ()>;
 /**
@@ -169,6 +184,13 @@ private:
      * Which is also used in auto-indent calculating and other functions.
      */
     SyntaxState mSyntaxState;
+    /**
+     * @brief tokens of the line, cached by the painter
+     *
+     * The tokens depend on the line text and the syntax state of the previous line,
+     * so they are cleared when either of them is changed.
+     */
+    PLineTokens mTokens;
     /**
      * @brief total width (pixel) of the line text
      *
@@ -194,6 +216,41 @@ public:
     explicit BinaryFileError (const QString& reason);
 };
 
+/**
+ * @brief Widths (in pixel) of the glyphs in a font
+ *
+ * Widths of single chars in the BMP are kept in a flat array, widths of other
+ * glyphs (surrogate pairs, combined chars) are kept in a hash.
+ * Tables are shared by all documents using the same font.
+ *
+ * It's not thread safe, and should only be used in the GUI thread.
+ * The shared tables are only kept while someone holds them, so users should
+ * keep the tables of the fonts they measure with.
+ */
+class GlyphWidthTable {
+public:
+    explicit GlyphWidthTable(const QFont& font);
+    GlyphWidthTable(const GlyphWidthTable&)=delete;
+    GlyphWidthTable& operator=(const GlyphWidthTable&)=delete;
+
+    static std::shared_ptr<GlyphWidthTable> forFont(const QFont& font);
+
+    int charWidth(QChar ch) {
+        qint16 &width = mBMPWidths[ch.unicode()];
+        if (width<0)
+            width = mFontMetrics.horizontalAdvance(QString(ch));
+        return width;
+    }
+    int glyphWidth(const QString& glyph);
+    const QFontMetrics &fontMetrics() const { return mFontMetrics; }
+private:
+    QFontMetrics mFontMetrics;
+    QVector<qint16> mBMPWidths; // -1 if not measured yet
+    QHash<QString,int> mOtherWidths;
+};
+
+using PGlyphWidthTable = std::shared_ptr<GlyphWidthTable>;
+
 class GlyphCalculator {
 public:
     explicit GlyphCalculator(const QFont& font);
@@ -227,18 +284,17 @@ public:
                    bool forceMonospace) const;
 
     int glyphWidth(const QString &glyph, int left) const{
-        return glyphWidth(glyph,left,mFontMetrics,mForceMonospace);
+        return glyphWidth(glyph, 0, glyph.length(), left, *mWidthTable);
     }
 
+    int glyphWidth(const QString& lineText, int start, int end, int left,
+                   GlyphWidthTable &widthTable) const;
+
     QList<int> calcGlyphPositionList(const QString& lineText, const QList<int> &glyphStartCharList,
                                      const QFontMetrics &fontMetrics,
                                      int left, int &right) const;
 
-    QList<int> calcGlyphPositionList(const QString& lineText, const QList<int> &glyphStartCharList, int left, int &right) const {
-        return calcGlyphPositionList(lineText, glyphStartCharList,
-                                     mFontMetrics,
-                                     left,right);
-    }
+    QList<int> calcGlyphPositionList(const QString& lineText, const QList<int> &glyphStartCharList, int left, int &right) const;
 
     /**
      * @brief calculate display width of a string
@@ -262,11 +318,12 @@ public:
             const QString& lineText,
             const QList<int> &glyphStartCharList,
             int startChar, int endChar,
-            const QFontMetrics &fontMetrics,
+            GlyphWidthTable &widthTable,
             QList<int> &glyphStartPositionList,
             int left, int &right, int &startGlyph, int &endGlyph) const;
 private:
     QFontMetrics mFontMetrics;
+    PGlyphWidthTable mWidthTable;
     int mTabSize;
     int mCharWidth;
     int mSpaceWidth;
@@ -422,6 +479,19 @@ public:
      */
     int getLineGlyphsCount(int line) const;
 
+    /**
+     * @brief get the text and the glyphs of the specified line.
+     *
+     * It's thread safe.
+     *
+     * @param line line index (starts frome 0)
+     * @param text text of the line
+     * @param glyphStartChars start index of the chars of each glyph
+     * @param glyphStartPositions start position (in pixel) of each glyph
+     * @return width of the line
+     */
+    int getLineGlyphs(int line, QString& text, QList<int>& glyphStartChars, QList<int>& glyphStartPositions) const;
+
     // /**
     //  * @brief get position list of the glyphs on the specified line.
     //  *
@@ -611,6 +681,12 @@ public:
     bool forceMonospace() const { return mGlyphCalculator.forceMonospace(); }
     void setForceMonospace(bool newForceMonospace);
 
+    /**
+     * @brief clear the tokens cached for painting
+     *
+     * Should be called when the syntaxer is changed.
+     */
+    void invalidateAllLineTokens();
 public slots:
     void invalidateAllNonTempLineWidth();
 
@@ -627,6 +703,7 @@ protected:
     void setUpdateState(bool Updating);
     void insertItem(int line, const QString& s);
     void addItem(const QString& s);
+    void addItems(const QString& text); // split by line breaks
     void putTextStr(const QString& text);
     void internalClear();
 private:
@@ -644,9 +721,11 @@ private:
     QList<int> getGlyphStartCharList(int line);
     QList<int> getGlyphStartPositionList(int line);
     int getLineWidth(int line);
-    bool tryLoadFileByEncoding(QByteArray encodingName, QFile& file);
-    void loadUTF16BOMFile(QFile& file);
-    void loadUTF32BOMFile(QFile& file);
+    PLineTokens getLineTokens(int line);
+    void setLineTokens(int line, const PLineTokens& tokens);
+    bool tryDecodeByEncoding(const QByteArray& encodingName, const QByteArray& content, QString& text);
+    void loadUTF16BOMFile(const QByteArray& content);
+    void loadUTF32BOMFile(const QByteArray& content);
     void saveUTF16File(QFile& file, QTextCodec* codec);
     void saveUTF32File(QFile& file, QTextCodec* codec);
 
@@ -690,7 +769,9 @@ private:
     BufferCoord mChangeStartPos;
     BufferCoord mChangeEndPos;
     QStringList mChangeText;
+    QByteArray mCompressedText; // not empty if mChangeText is compressed
     size_t mChangeNumber;
+    size_t mMemoryUsage;
 public:
     UndoItem(ChangeReason reason,
         SelectionMode selMode,
@@ -705,6 +786,13 @@ public:
     BufferCoord changeEndPos() const;
     QStringList changeText() const;
     size_t changeNumber() const;
+    // approximate bytes used by the item
+    size_t memoryUsage() const;
+    bool compressed() const;
+    // compress the change text if it's large; changeText() decompresses it on demand
+    void compress();
+private:
+    void updateMemoryUsage();
 };
 
 using PUndoItem = std::shared_ptr<UndoItem>;
@@ -737,6 +825,9 @@ public:
 
     int maxUndoActions() const;
     void setMaxUndoActions(int maxUndoActions);
+    size_t maxMemoryUsage() const;
+    void setMaxMemoryUsage(size_t maxMemoryUsage);
+    size_t memoryUsage() const;
     bool initialState();
     void setInitialState();
 
@@ -750,6 +841,9 @@ signals:
 protected:
     bool inBlock();
     unsigned int getNextChangeNumber();
+    void appendItem(PUndoItem item);
+    void ensureMaxEntries();
+    void compressOldItems();
 protected:
     size_t mBlockChangeNumber;
     int mBlockLock;
@@ -760,6 +854,10 @@ protected:
     unsigned int mNextChangeNumber;
     unsigned int mInitialChangeNumber;
     bool mInsideRedo;
+    int mMaxUndoActions; // 0 means no limit
+    size_t mMaxMemoryUsage; // in bytes, 0 means no limit
+    size_t mMemoryUsage;
+    int mCompressedCount; // items before this index are checked for compression
 };
 
 class RedoList : public QObject {
@@ -25,9 +25,15 @@
 
 namespace QSynedit {
 
+//flush the output to the device when it's longer than this
+static const int ExportChunkSize = 64*1024;
+//report progress every ExportProgressLines lines
+static const int ExportProgressLines = 500;
+
 Exporter::Exporter(int tabSize, const QByteArray charset):
     mTabSize(tabSize),
-    mCharset(charset)
+    mCharset(charset),
+    mDevice(nullptr)
 {
     mFont = QGuiApplication::font();
     mBackgroundColor = QGuiApplication::palette().color(QPalette::Base);
@@ -53,28 +59,86 @@ void Exporter::exportAll(const PDocument& doc)
 
 void Exporter::exportRange(const PDocument& doc, BufferCoord start, BufferCoord stop)
 {
-    // abort if not all necessary conditions are met
-    if (!doc || (doc->count() == 0))
-        return;
-    stop.line = std::max(1, std::min(stop.line, doc->count()));
-    stop.ch = std::max(1, std::min(stop.ch, doc->getLine(stop.line - 1).length() + 1));
-    start.line = std::max(1, std::min(start.line, doc->count()));
-    start.ch = std::max(1, std::min(start.ch, doc->getLine(start.line - 1).length() + 1));
-    if ( (start.line > doc->count()) || (start.line > stop.line) )
+    mDevice = nullptr;
+    // initialization
+    mText.clear();
+    if (!doc)
         return;
-    if ((start.line == stop.line) && (start.ch >= stop.ch))
+    QStringList lines = doc->contents();
+    if (!normalizeRange(lines, start, stop))
         return;
-    // initialization
+    doExportRange(lines,
+                  start.line > 1 ? doc->getSyntaxState(start.line-2) : SyntaxState(),
+                  start, stop);
+    // insert header
+    insertData(0, getHeader());
+    // add footer
+    addData(getFooter());
+}
+
+bool Exporter::exportAllToStream(const QStringList &lines, QIODevice &device)
+{
+    return exportRangeToStream(lines, SyntaxState(),
+                               BufferCoord{1, 1}, BufferCoord{INT_MAX, INT_MAX}, device);
+}
+
+bool Exporter::exportRangeToStream(const QStringList &lines, const SyntaxState &stateBeforeStart,
+                                   BufferCoord start, BufferCoord stop, QIODevice &device)
+{
     mText.clear();
+    mEncoder.reset(getCodec()->makeEncoder());
+    mDevice = &device;
+    auto action = finally([this]{
+        mDevice = nullptr;
+        mEncoder.reset();
+        mText.clear();
+    });
+    // the header must be written before the formatted text
+    prepareStreamHeader();
+    addData(getHeader());
+    if (normalizeRange(lines, start, stop)) {
+        if (!doExportRange(lines, stateBeforeStart, start, stop))
+            return false;
+    }
+    addData(getFooter());
+    flushData();
+    return true;
+}
+
+bool Exporter::normalizeRange(const QStringList &lines, BufferCoord &start, BufferCoord &stop)
+{
+    // abort if not all necessary conditions are met
+    if (lines.isEmpty())
+        return false;
+    stop.line = std::max(1, std::min(stop.line, lines.count()));
+    stop.ch = std::max(1, std::min(stop.ch, lines[stop.line - 1].length() + 1));
+    start.line = std::max(1, std::min(start.line, lines.count()));
+    start.ch = std::max(1, std::min(start.ch, lines[start.line - 1].length() + 1));
+    if ( (start.line > lines.count()) || (start.line > stop.line) )
+        return false;
+    if ((start.line == stop.line) && (start.ch >= stop.ch))
+        return false;
+    return true;
+}
+
+bool Exporter::doExportRange(const QStringList& lines, const SyntaxState& stateBeforeStart,
+                             const BufferCoord& start, const BufferCoord& stop)
+{
     // export all the lines into fBuffer
     mFirstAttribute = true;
 
+    // start from the syntax state of the line before the range, not from the top
     if (start.line == 1)
         mSyntaxer->resetState();
     else
-        mSyntaxer->setState(doc->getSyntaxState(start.line-2));
+        mSyntaxer->setState(stateBeforeStart);
+    int totalLines = stop.line - start.line + 1;
     for (int i = start.line; i<=stop.line; i++) {
-        QString Line = doc->getLine(i-1);
+        if (mOnProgress && (i - start.line) % ExportProgressLines == 0) {
+            if (!mOnProgress(i - start.line, totalLines))
+                return false;
+        }
+        QString Line = lines[i-1];
         // order is important, since Start.Y might be equal to Stop.Y
 //        if (i == Stop.Line)
 //            Line.remove(Stop.Char-1, INT_MAX);
@@ -113,10 +177,9 @@ void Exporter::exportRange(const PDocument& doc, BufferCoord start, BufferCoord
     }
     if (!mFirstAttribute)
         formatAfterLastAttribute();
-    // insert header
-    insertData(0, getHeader());
-    // add footer
-    addData(getFooter());
+    if (mOnProgress)
+        mOnProgress(totalLines, totalLines);
+    return true;
 }
 
 void Exporter::saveToFile(const QString &filename)
@@ -250,7 +313,19 @@ void Exporter::addData(const QString &text)
 {
     if (!text.isEmpty()) {
         mText.append(text);
+        if (mDevice && mText.size() >= ExportChunkSize)
+            flushData();
+    }
+}
+
+void Exporter::flushData()
+{
+    if (!mDevice || mText.isEmpty())
+        return;
+    if (mDevice->write(mEncoder->fromUnicode(mText))<0) {
+        throw FileError(QObject::tr("Failed to write data."));
     }
+    mText.clear();
 }
 
 void Exporter::addDataNewLine(const QString &text)
@@ -363,6 +438,20 @@ void Exporter::setOnFormatToken(const FormatTokenHandler &onFormatToken)
     mOnFormatToken = onFormatToken;
 }
 
+ExportProgressHandler Exporter::onProgress() const
+{
+    return mOnProgress;
+}
+
+void Exporter::setOnProgress(const ExportProgressHandler &onProgress)
+{
+    mOnProgress = onProgress;
+}
+
+void Exporter::prepareStreamHeader()
+{
+}
+
 QString Exporter::lineBreak()
 {
     switch(mFileEndingType) {
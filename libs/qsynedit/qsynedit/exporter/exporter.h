@@ -24,6 +24,7 @@
 #include <QFont>
 #include <QColor>
 #include <QMap>
+#include <QTextEncoder>
 #include "qt_utils/utils.h"
 #include "../types.h"
 
@@ -35,9 +36,12 @@ class Syntaxer;
 using PSyntaxer = std::shared_ptr<Syntaxer>;
 class TokenAttribute;
 using PTokenAttribute = std::shared_ptr<TokenAttribute>;
+struct SyntaxState;
 
 using FormatTokenHandler = std::function<void(PSyntaxer syntaxHighlighter, int line, int column, const QString& token,
     PTokenAttribute& attr)>;
+// return false to cancel the export
+using ExportProgressHandler = std::function<bool(int exportedLines, int totalLines)>;
 class Exporter
 {
 
@@ -65,6 +69,24 @@ public:
      */
     void exportRange(const PDocument& doc,
                      BufferCoord start, BufferCoord stop);
+
+    /**
+     * @brief Exports all the lines (a copy of the document's contents) to the device.
+     *   The output is written in chunks, and is not kept in the output buffer.
+     *   The document is not touched, so it can be called in a worker thread while
+     *   the document is edited, if the syntaxer is not shared with an editor.
+     * @return false if the export is cancelled by the progress handler
+     */
+    bool exportAllToStream(const QStringList& lines, QIODevice& device);
+
+    /**
+     * @brief Exports the given range of the lines to the device, in chunks.
+     * @param stateBeforeStart syntax state at the end of the line before start
+     *   (not used if start is in the first line)
+     * @return false if the export is cancelled by the progress handler
+     */
+    bool exportRangeToStream(const QStringList& lines, const SyntaxState& stateBeforeStart,
+                     BufferCoord start, BufferCoord stop, QIODevice& device);
     /**
      * @brief Saves the contents of the output buffer to a file.
      * @param AFileName
@@ -112,6 +134,9 @@ public:
     FormatTokenHandler onFormatToken() const;
     void setOnFormatToken(const FormatTokenHandler &onFormatToken);
 
+    ExportProgressHandler onProgress() const;
+    void setOnProgress(const ExportProgressHandler &onProgress);
+
     QByteArray buffer() const;
     const QString& text() const;
 
@@ -221,6 +246,12 @@ protected:
      * @return
      */
     virtual QString getHeader() = 0;
+    /**
+     * @brief Can be overridden in descendant classes to collect the data needed by
+     *   the header, when exporting to a stream. The header is written before
+     *   the formatted text in that case.
+     */
+    virtual void prepareStreamHeader();
     /**
      * @brief Inserts a data block at the given position into the output buffer.  Is
      *   used to insert the format header after the exporting, since some header
@@ -243,10 +274,19 @@ protected:
     virtual void setTokenAttribute(PTokenAttribute attri);
 
     QTextCodec *getCodec() const;
+private:
+    bool normalizeRange(const QStringList& lines, BufferCoord& start, BufferCoord& stop);
+    // returns false if cancelled
+    bool doExportRange(const QStringList& lines, const SyntaxState& stateBeforeStart,
+                       const BufferCoord& start, const BufferCoord& stop);
+    void flushData();
 private:
     QString mText;
     bool mFirstAttribute;
     FormatTokenHandler mOnFormatToken;
+    ExportProgressHandler mOnProgress;
+    QIODevice* mDevice; // not null when exporting to stream
+    std::unique_ptr<QTextEncoder> mEncoder;
 
 };
 }
@@ -15,6 +15,7 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 #include "rtfexporter.h"
+#include "../miscprocs.h"
 
 #include <QFontMetrics>
 namespace QSynedit {
@@ -144,6 +145,20 @@ QString RTFExporter::getFormatName()
     return "RTF";
 }
 
+void RTFExporter::prepareStreamHeader()
+{
+    // the color table is in the header, so collect all colors the syntaxer may use
+    getColorIndex(mForegroundColor);
+    getColorIndex(mBackgroundColor);
+    enumTokenAttributes(mSyntaxer, true,
+                        [this](PSyntaxer, PTokenAttribute attri, const QString&, QList<void *>) {
+        getColorIndex(attri->foreground().isValid()?attri->foreground():mForegroundColor);
+        if (mUseBackground)
+            getColorIndex(attri->background().isValid()?attri->background():mBackgroundColor);
+        return true;
+    }, {});
+}
+
 QString RTFExporter::getHeader()
 {
     QFontMetrics fm(mFont);
@@ -44,6 +44,7 @@ protected:
     QString getFooter() override;
     QString getFormatName() override;
     QString getHeader() override;
+    void prepareStreamHeader() override;
 };
 
 }
@@ -141,4 +141,32 @@ namespace QSynedit {
     void CppFormatter::doInitOptions()
     {
     }
+
+    bool CppFormatter::canReindentLine(int line, const QString &lineText, QSynEdit *editor)
+    {
+        if (!Formatter::canReindentLine(line, lineText, editor))
+            return false;
+        if (line<=1)
+            return true;
+        if (editor->syntaxer()->language() != ProgrammingLanguage::CPP)
+            return true;
+        // leading spaces are part of the unfinished strings / macros / comments
+        SyntaxState rangePreceeding = editor->document()->getSyntaxState(line-2);
+        switch (rangePreceeding.state) {
+        case CppSyntaxer::RangeState::rsRawString:
+        case CppSyntaxer::RangeState::rsRawStringNotEscaping:
+        case CppSyntaxer::RangeState::rsRawStringEnd:
+        case CppSyntaxer::RangeState::rsMultiLineString:
+        case CppSyntaxer::RangeState::rsMultiLineDirective:
+            return false;
+        default:
+            break;
+        }
+        if (editor->syntaxer()->isStringNotFinished(rangePreceeding.state))
+            return false;
+        if (editor->syntaxer()->isCommentNotFinished(rangePreceeding.state)
+                && !editor->syntaxer()->isDocstringNotFinished(rangePreceeding.state))
+            return false;
+        return true;
+    }
 }
@@ -20,6 +20,7 @@ public:
 protected:
     int findCommentStartLine(int searchStartLine, QSynEdit *editor);
     void doInitOptions() override;
+    bool canReindentLine(int line, const QString &lineText, QSynEdit *editor) override;
 };
 }
 
@@ -1,4 +1,6 @@
 #include "formatter.h"
+#include "../qsynedit.h"
+#include "qt_utils/utils.h"
 namespace QSynedit {
     Formatter::Formatter()
     {
@@ -44,6 +46,34 @@ namespace QSynedit {
             return val;
     }
 
+    void Formatter::formatLines(int startLine, int endLine, QSynEdit *editor)
+    {
+        Q_ASSERT(editor!=nullptr);
+        startLine = std::max(1, startLine);
+        endLine = std::min(endLine, editor->lineCount());
+        for (int line=startLine;line<=endLine;line++) {
+            QString lineText = editor->lineText(line);
+            if (!canReindentLine(line, lineText, editor))
+                continue;
+            // the indents of the lines above are already fixed
+            QString trimmedLineText = trimLeft(lineText);
+            int indentSpaces = calcIndentSpaces(line, trimmedLineText, true, editor);
+            QString newLineText = editor->GetLeftSpacing(indentSpaces, true) + trimmedLineText;
+            if (newLineText != lineText)
+                editor->replaceLine(line, newLineText);
+        }
+    }
+
+    bool Formatter::canReindentLine(int /*line*/, const QString &lineText, QSynEdit */*editor*/)
+    {
+        if (lineText.trimmed().isEmpty())
+            return false;
+        // commented out codes
+        if (lineText.startsWith("//"))
+            return false;
+        return true;
+    }
+
     void Formatter::initOptions()
     {
         doInitOptions();
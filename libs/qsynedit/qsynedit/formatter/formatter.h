@@ -20,9 +20,15 @@ namespace QSynedit {
         int getIntOption(const QString& name,int defaultValue) const;
         virtual int calcIndentSpaces(int line, const QString& lineText, bool addIndent,
                              QSynEdit *editor)=0;
+        /**
+         * Reindent lines [startLine, endLine] (1-based) of the editor.
+         * Only the lines whose text changed are replaced in the editor.
+         */
+        virtual void formatLines(int startLine, int endLine, QSynEdit *editor);
         void initOptions();
     protected:
         virtual void doInitOptions() = 0;
+        virtual bool canReindentLine(int line, const QString& lineText, QSynEdit *editor);
     protected:
         QMap<QString,QVariant> mOptions;
         QStringList mOptionNames;
@@ -200,6 +200,9 @@ void EditKeyStrokes::resetDefaults()
     add(EditCommand::WordRight, Qt::Key_Right, Qt::ControlModifier);
     add(EditCommand::SelWordRight, Qt::Key_Right, Qt::KeyboardModifiers(Qt::ShiftModifier|Qt::ControlModifier));
 
+    add(EditCommand::AddCaretUp, Qt::Key_Up, Qt::KeyboardModifiers(Qt::ShiftModifier|Qt::ControlModifier|Qt::AltModifier));
+    add(EditCommand::AddCaretDown, Qt::Key_Down, Qt::KeyboardModifiers(Qt::ShiftModifier|Qt::ControlModifier|Qt::AltModifier));
+
     add(EditCommand::BlockStart, Qt::Key_Up, Qt::KeyboardModifiers(Qt::MetaModifier|Qt::ControlModifier));
     add(EditCommand::SelBlockStart, Qt::Key_Up, Qt::KeyboardModifiers(Qt::ShiftModifier|Qt::ControlModifier|Qt::MetaModifier));
     add(EditCommand::BlockEnd, Qt::Key_Down, Qt::KeyboardModifiers(Qt::MetaModifier|Qt::ControlModifier));
@@ -101,6 +101,8 @@ enum class EditCommand {
     ScrollDown      = 212,  // Scroll down one line leaving cursor position unchanged.
     ScrollLeft      = 213,  // Scroll left one char leaving cursor position unchanged.
     ScrollRight     = 214,  // Scroll right one char leaving cursor position unchanged.
+    AddCaretUp      = 215,  // Add a caret in the line above the topmost caret
+    AddCaretDown    = 216,  // Add a caret in the line below the bottommost caret
 
     InsertMode      = 221,  // Set insert mode
     OverwriteMode   = 222,  // Set overwrite mode
@@ -193,4 +193,108 @@ int calSpanLines(const BufferCoord &startPos, const BufferCoord &endPos)
     return std::abs(endPos.line - startPos.line+1);
 }
 
+QList<LineDiffHunk> diffLines(const QStringList &oldLines, const QStringList &newLines, int maxEdits)
+{
+    QList<LineDiffHunk> hunks;
+    int oldEnd = oldLines.count();
+    int newEnd = newLines.count();
+    int start = 0;
+    //skip common head and tail
+    while (start<oldEnd && start<newEnd && oldLines[start]==newLines[start])
+        start++;
+    while (oldEnd>start && newEnd>start && oldLines[oldEnd-1]==newLines[newEnd-1]) {
+        oldEnd--;
+        newEnd--;
+    }
+    int n = oldEnd - start;
+    int m = newEnd - start;
+    if (n==0 && m==0)
+        return hunks;
+    if (n==0 || m==0) {
+        hunks.append(LineDiffHunk{start,n,start,m});
+        return hunks;
+    }
+    QVector<uint> oldHashes(n);
+    QVector<uint> newHashes(m);
+    for (int i=0;i<n;i++)
+        oldHashes[i] = qHash(oldLines[start+i]);
+    for (int i=0;i<m;i++)
+        newHashes[i] = qHash(newLines[start+i]);
+    auto equals = [&](int x, int y) {
+        return oldHashes[x]==newHashes[y] && oldLines[start+x]==newLines[start+y];
+    };
+
+    int maxD = std::min(n+m, maxEdits);
+    int offset = maxD + 1;
+    std::vector<int> v(2*offset+1, 0);
+    // trace[d][k+d] is the furthest x reached on diagonal k with d edits
+    std::vector<std::vector<int>> trace;
+    int editCount = -1;
+    for (int d=0; d<=maxD && editCount<0; d++) {
+        for (int k=-d; k<=d; k+=2) {
+            int x;
+            if (k==-d || (k!=d && v[offset+k-1] < v[offset+k+1]))
+                x = v[offset+k+1];
+            else
+                x = v[offset+k-1]+1;
+            int y = x - k;
+            while (x<n && y<m && equals(x,y)) {
+                x++;
+                y++;
+            }
+            v[offset+k] = x;
+            if (x>=n && y>=m) {
+                editCount = d;
+                break;
+            }
+        }
+        trace.push_back(std::vector<int>(v.begin()+offset-d, v.begin()+offset+d+1));
+    }
+    if (editCount<0) {
+        //too many differences
+        hunks.append(LineDiffHunk{start,n,start,m});
+        return hunks;
+    }
+
+    // walk back to collect the edits, from the last one to the first one
+    struct Edit {
+        bool isInsert;
+        int x;
+        int y;
+    };
+    QVector<Edit> edits;
+    int x = n;
+    int y = m;
+    for (int d=editCount; d>0; d--) {
+        const std::vector<int>& prev = trace[d-1];
+        int k = x - y;
+        int prevK;
+        if (k==-d || (k!=d && prev[k-1+d-1] < prev[k+1+d-1]))
+            prevK = k+1;
+        else
+            prevK = k-1;
+        int prevX = prev[prevK+d-1];
+        int prevY = prevX - prevK;
+        edits.append(Edit{prevK==k+1, prevX, prevY});
+        x = prevX;
+        y = prevY;
+    }
+
+    for (int i=edits.count()-1;i>=0;i--) {
+        const Edit& edit = edits[i];
+        int oldPos = start + edit.x;
+        int newPos = start + edit.y;
+        if (hunks.isEmpty()
+                || hunks.back().oldStart + hunks.back().oldCount != oldPos
+                || hunks.back().newStart + hunks.back().newCount != newPos) {
+            hunks.append(LineDiffHunk{oldPos,0,newPos,0});
+        }
+        if (edit.isInsert)
+            hunks.back().newCount++;
+        else
+            hunks.back().oldCount++;
+    }
+    return hunks;
+}
+
 }
@@ -25,6 +25,7 @@
 #include <QPaintDevice>
 #include <QTextStream>
 #include <QVector>
+#include <QStringList>
 #include <initializer_list>
 #include <functional>
 //#include <QRect>
@@ -90,5 +91,20 @@ int findLastNonWordChar(const QString& s, int startPos);
 void ensureNotAfter(BufferCoord& cord1, BufferCoord& cord2);
 
 bool isWordChar(const QChar& ch);
+
+struct LineDiffHunk {
+    int oldStart; // 0-based
+    int oldCount;
+    int newStart; // 0-based
+    int newCount;
+};
+
+/**
+ * Find the lines changed from oldLines to newLines (Myers' O(ND) diff)
+ * If more than maxEdits lines are inserted/deleted, the whole different part
+ * is returned as one hunk.
+ * @return the changed hunks, in ascending order
+ */
+QList<LineDiffHunk> diffLines(const QStringList& oldLines, const QStringList& newLines, int maxEdits = 2000);
 }
 #endif // MISCPROCS_H
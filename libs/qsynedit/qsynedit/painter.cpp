@@ -19,6 +19,7 @@
 #include "document.h"
 #include "constants.h"
 #include "syntaxer/syntaxer.h"
+#include <climits>
 #include <cmath>
 #include <QDebug>
 
@@ -30,7 +31,10 @@ QSynEditPainter::QSynEditPainter(QSynEdit *edit, QPainter *painter, int firstRow
     mFirstRow{firstRow},
     mLastRow{lastRow},
     mLeft{left},
-    mRight{right}
+    mRight{right},
+    mTextLeft{left},
+    mTextRight{right},
+    mRowStartX{0}
 {
 }
 
@@ -38,6 +42,11 @@ void QSynEditPainter::paintEditingArea(const QRect& clip)
 {
     mPainter->fillRect(clip, mEdit->mBackgroundColor);
     mClip = clip;
+    // the syntaxer splits texts differently now (e.g. the keywords are changed)
+    if (mEdit->mLineTokensGeneration != mEdit->mSyntaxer->tokensGeneration()) {
+        mEdit->mDocument->invalidateAllLineTokens();
+        mEdit->mLineTokensGeneration = mEdit->mSyntaxer->tokensGeneration();
+    }
     mFirstLine = mEdit->rowToLine(mFirstRow);
     mLastLine = mEdit->rowToLine(mLastRow);
     mIsCurrentLine = false;
@@ -98,6 +107,20 @@ void QSynEditPainter::paintGutter(const QRect& clip)
 
     mPainter->fillRect(mClip,mEdit->mGutter.color());
 
+    // per line background (e.g. heat of the profiled lines)
+    for (int row = mFirstRow; row <= mLastRow; row++) {
+        int line = mEdit->rowToLine(row);
+        if ((line > mEdit->mDocument->count()) && (mEdit->mDocument->count() != 0))
+            break;
+        QColor background;
+        mEdit->onGutterGetBackground(line, background);
+        if (background.isValid()) {
+            int lineTop = (row - 1) * mEdit->mTextHeight - mEdit->mTopPos;
+            mPainter->fillRect(QRectF(mClip.left(), lineTop, mClip.width(), mEdit->mTextHeight),
+                               background);
+        }
+    }
+
     rcLine=mClip;
     if (mEdit->mGutter.showLineNumbers()) {
         // prepare the rect initially
@@ -125,9 +148,13 @@ void QSynEditPainter::paintGutter(const QRect& clip)
         BufferCoord selectionStart = mEdit->blockBegin();
         BufferCoord selectionEnd = mEdit->blockEnd();
         for (int row = mFirstRow; row <= mLastRow; row++) {
-            int line = mEdit->rowToLine(row);
+            int rowInLine;
+            int line = mEdit->rowToLine(row, rowInLine);
             if ((line > mEdit->mDocument->count()) && (mEdit->mDocument->count() > 0 ))
                 break;
+            // wrapped rows of a line have no line number
+            if (rowInLine > 0)
+                continue;
             if (mEdit->mGutter.activeLineTextColor().isValid()) {
                 if (
                         (mEdit->mCaretY==line)     ||
@@ -162,7 +189,8 @@ void QSynEditPainter::paintGutter(const QRect& clip)
     if (mEdit->useCodeFolding()) {
       int lineWidth = std::max(0.0,std::ceil(mEdit->font().pixelSize() / 15));
       for (int row = mLastRow; row>= mFirstRow; row--) {
-          int line = mEdit->rowToLine(row);
+          int rowInLine;
+          int line = mEdit->rowToLine(row, rowInLine);
           if ((line > mEdit->mDocument->count()) && (mEdit->mDocument->count() != 0))
             continue;
 
@@ -174,6 +202,16 @@ void QSynEditPainter::paintGutter(const QRect& clip)
 
           mPainter->setPen(QPen(mEdit->mCodeFolding.folderBarLinesColor,lineWidth));
 
+          // wrapped rows of a line only continue the fold line
+          if (rowInLine > 0) {
+              PCodeFoldingRange foldRange = mEdit->foldStartAtLine(line);
+              if (mEdit->foldAroundLine(line) || (foldRange && !foldRange->collapsed)) {
+                  x = rcFold.left() + (rcFold.width() / 2);
+                  mPainter->drawLine(x,rcFold.top(), x, rcFold.bottom());
+              }
+              continue;
+          }
+
         // Need to paint a line?
           if (mEdit->foldAroundLine(line)) {
           x = rcFold.left() + (rcFold.width() / 2);
@@ -228,9 +266,12 @@ void QSynEditPainter::paintGutter(const QRect& clip)
     }
 
     for (int row = mFirstRow; row <= mLastRow; row++) {
-        int line = mEdit->rowToLine(row);
+        int rowInLine;
+        int line = mEdit->rowToLine(row, rowInLine);
         if ((line > mEdit->mDocument->count()) && (mEdit->mDocument->count() != 0))
             break;
+        if (rowInLine > 0)
+            continue;
         mEdit->onGutterPaint(*mPainter,line, 0, (row - mEdit->yposToRow(0)) * mEdit->mTextHeight);
     }
 }
@@ -293,14 +334,16 @@ void QSynEditPainter::computeSelectionInfo()
                 QString sLine = mEdit->lineText().left(mEdit->mCaretX-1)
                         + mEdit->mInputPreeditString
                         + mEdit->lineText().mid(mEdit->mCaretX-1);
-                mSelStart.x = mEdit->charToGlyphLeft(mEdit->mCaretY, sLine,vStart.ch);
+                mSelStart.x = mEdit->charToGlyphLeft(mEdit->mCaretY, sLine,vStart.ch)
+                        - mEdit->rowStartX(mEdit->mCaretY, mSelStart.row - mEdit->lineToRow(mEdit->mCaretY));
             }
             if (mEdit->mInputPreeditString.length()
                     && vEnd.line == mEdit->mCaretY) {
                 QString sLine = mEdit->lineText().left(mEdit->mCaretX-1)
                         + mEdit->mInputPreeditString
                         + mEdit->lineText().mid(mEdit->mCaretX-1);
-                mSelEnd.x = mEdit->charToGlyphLeft(mEdit->mCaretY, sLine,vEnd.ch);
+                mSelEnd.x = mEdit->charToGlyphLeft(mEdit->mCaretY, sLine,vEnd.ch)
+                        - mEdit->rowStartX(mEdit->mCaretY, mSelEnd.row - mEdit->lineToRow(mEdit->mCaretY));
             }
             // In the column selection mode sort the begin and end of the selection,
             // this makes the painting code simpler.
@@ -329,7 +372,7 @@ void QSynEditPainter::getDrawingColors(bool selected, QColor &foreground, QColor
 
 int QSynEditPainter::fixXValue(int xpos)
 {
-    return mEdit->textOffset() + xpos;
+    return mEdit->textOffset() + xpos - mRowStartX;
 }
 
 void QSynEditPainter::paintLine()
@@ -343,11 +386,13 @@ void QSynEditPainter::paintLine()
 
     QFont font;
     QFontMetrics fm{font};
+    QString fontKey = font.key();
     int lineHeight = mRcLine.height();
     for (int i=0;i<mLineTokens.length();i++) {
         if (font!=mLineTokens[i].font) {
             font = mLineTokens[i].font;
             fm = QFontMetrics{font};
+            fontKey = font.key();
         }
         int fontHeight = fm.descent() + fm.ascent();
         int linePadding = (lineHeight - fontHeight) / 2;
@@ -357,7 +402,16 @@ void QSynEditPainter::paintLine()
         QPen pen(mLineTokens[i].foreground);
         if (pen!=mPainter->pen())
             mPainter->setPen(pen);
-        mPainter->drawText(mLineTokens[i].left,nY, mLineTokens[i].token);
+        //reuse the layout of texts painted before, so repaints are plain draw calls
+        QString key = fontKey + QChar(0) + mLineTokens[i].token;
+        QStaticText *staticText = mEdit->mStaticTextCache.object(key);
+        if (!staticText) {
+            staticText = new QStaticText(mLineTokens[i].token);
+            staticText->setTextFormat(Qt::PlainText);
+            staticText->prepare(QTransform(), font);
+            mEdit->mStaticTextCache.insert(key, staticText);
+        }
+        mPainter->drawStaticText(mLineTokens[i].left, nY - fm.ascent(), *staticText);
     }
     mLineTokens.clear();
     mLineTokenBackgrounds.clear();
@@ -739,7 +793,7 @@ void QSynEditPainter::addHighlightToken(
 //        Background = colEditorBG();
 //    }
 
-    mEdit->onPreparePaintHighlightToken(line,mEdit->mSyntaxer->getTokenPos()+1,
+    mEdit->onPreparePaintHighlightToken(line,tokenStartChar+1,
         token,attri,style,foreground,background);
 
     if (!background.isValid() ) {
@@ -784,6 +838,7 @@ void QSynEditPainter::addHighlightToken(
         mTokenAccu.font.setItalic(style & FontStyle::fsItalic);
         mTokenAccu.font.setStrikeOut(style & FontStyle::fsStrikeOut);
         mTokenAccu.font.setUnderline(style & FontStyle::fsUnderline);
+        mTokenAccu.widthTable = mEdit->glyphWidthTable(style);
     }
     //calculate width of the token ( and update it's glyph start positions )
     if (calcGlyphPosition) {
@@ -792,7 +847,7 @@ void QSynEditPainter::addHighlightToken(
                     glyphStartCharList,
                     tokenStartChar,
                     tokenEndChar,
-                    QFontMetrics(mTokenAccu.font),
+                    *mTokenAccu.widthTable,
                     glyphStartPositionList,
                     tokenLeft,
                     tokenRight,
@@ -837,9 +892,12 @@ void QSynEditPainter::paintFoldAttributes()
 
         // Now loop through all the lines. The indices are valid for Lines.
         for (int row = mFirstRow; row<=mLastRow;row++) {
-            int vLine = mEdit->rowToLine(row);
+            int rowInLine;
+            int vLine = mEdit->rowToLine(row, rowInLine);
             if (vLine > mEdit->mDocument->count() && mEdit->mDocument->count() > 0)
                 break;
+            if (rowInLine > 0)
+                continue;
             int X;
             // Set vertical coord
             int Y = (row-1) * mEdit->mTextHeight - mEdit->mTopPos; // limit inside clip rect
@@ -911,7 +969,8 @@ void QSynEditPainter::paintFoldAttributes()
             if (range->collapsed && !range->parentCollapsed() &&
                     (range->fromLine <= mLastLine) && (range->fromLine >= mFirstLine) ) {
                 // Get starting and end points
-                int Y = (mEdit->lineToRow(range->fromLine) - mEdit->yposToRow(0) + 1) * mEdit->mTextHeight - 1;
+                int lastRow = mEdit->lineToRow(range->fromLine) + mEdit->lineRowCount(range->fromLine) - 1;
+                int Y = (lastRow - mEdit->yposToRow(0) + 1) * mEdit->mTextHeight - 1;
                 mPainter->drawLine(mClip.left(),Y, mClip.right(),Y);
             }
         }
@@ -944,6 +1003,46 @@ void QSynEditPainter::getBraceColorAttr(int level, PTokenAttribute &attr)
         attr = oldAttr;
 }
 
+PLineTokens QSynEditPainter::scanLineTokens(const QString &lineText, int line)
+{
+    std::shared_ptr<LineTokens> tokens = std::make_shared<LineTokens>();
+    // Initialize highlighter with line text and range info. It is
+    // necessary because we probably did not scan to the end of the last
+    // line - the internal highlighter range might be wrong.
+    if (line == 1) {
+        mEdit->mSyntaxer->resetState();
+    } else {
+        mEdit->mSyntaxer->setState(
+                    mEdit->mDocument->getSyntaxState(line-2));
+    }
+    mEdit->mSyntaxer->setLine(lineText, line - 1);
+    while (!mEdit->mSyntaxer->eol()) {
+        QString token = mEdit->mSyntaxer->getToken();
+        if (!token.isEmpty()) {
+            int bracketLevel = 0;
+            if (token.length()==1) {
+                switch(token.front().unicode()) {
+                case '[': case '(': case '{':
+                case ']': case ')': case '}': {
+                    SyntaxState rangeState = mEdit->mSyntaxer->getState();
+                    bracketLevel = rangeState.bracketLevel
+                            +rangeState.braceLevel
+                            +rangeState.parenthesisLevel;
+                }
+                    break;
+                }
+            }
+            tokens->append(LineToken{
+                               mEdit->mSyntaxer->getTokenPos(),
+                               token.length(),
+                               mEdit->mSyntaxer->getTokenAttribute(),
+                               bracketLevel});
+        }
+        mEdit->mSyntaxer->next();
+    }
+    return tokens;
+}
+
 void QSynEditPainter::paintLines()
 {
     mEdit->mDocument->beginSetLinesWidth();
@@ -969,10 +1068,20 @@ void QSynEditPainter::paintLines()
     BufferCoord selectionBegin = mEdit->blockBegin();
     BufferCoord selectionEnd= mEdit->blockEnd();
     for (int row = mFirstRow; row<=mLastRow; row++) {
-        int vLine = mEdit->rowToLine(row);
+        int rowInLine;
+        int vLine = mEdit->rowToLine(row, rowInLine);
         bool lineTextChanged = false;
         if (vLine > mEdit->mDocument->count() && mEdit->mDocument->count() != 0)
             break;
+        // Wrapped rows are painted as the part of the line between the row start and end,
+        // moved to the left of the text area.
+        if (mEdit->wordWrap()) {
+            mRowStartX = mEdit->mDisplayRowIndex.rowStartPosition(vLine, rowInLine);
+            int rowEndX = mEdit->mDisplayRowIndex.rowEndPosition(vLine, rowInLine);
+            mLeft = mTextLeft + mRowStartX;
+            mRight = (rowEndX == INT_MAX) ? mTextRight + mRowStartX
+                                          : std::min(mTextRight + mRowStartX, rowEndX - 1);
+        }
 
         // Get the line.
         sLine = mEdit->lineText(vLine);
@@ -1017,7 +1126,7 @@ void QSynEditPainter::paintLines()
             mLineSelEnd = mRight + 1;
             if ((mEdit->mActiveSelectionMode == SelectionMode::Column) ||
                     ((mEdit->mActiveSelectionMode == SelectionMode::Normal) && (row == mSelStart.row)) ) {
-                int xpos = mSelStart.x;
+                int xpos = mSelStart.x + mRowStartX;
                 if (xpos > mRight) {
                     mLineSelStart = 0;
                     mLineSelEnd = 0;
@@ -1028,7 +1137,7 @@ void QSynEditPainter::paintLines()
             }
             if ( (mEdit->mActiveSelectionMode == SelectionMode::Column) ||
                  ((mEdit->mActiveSelectionMode == SelectionMode::Normal) && (row == mSelEnd.row)) ) {
-                int xpos = mSelEnd.x;
+                int xpos = mSelEnd.x + mRowStartX;
                 if (xpos < mLeft) {
                     mLineSelStart = 0;
                     mLineSelEnd = 0;
@@ -1074,16 +1183,16 @@ void QSynEditPainter::paintLines()
             glyphStartPositionsList = mEdit->mDocument->getGlyphStartPositionList(vLine-1);
             mCurrentLineWidth = mEdit->mDocument->getLineWidth(vLine-1);
         }
-        // Initialize highlighter with line text and range info. It is
-        // necessary because we probably did not scan to the end of the last
-        // line - the internal highlighter range might be wrong.
-        if (vLine == 1) {
-            mEdit->mSyntaxer->resetState();
-        } else {
-            mEdit->mSyntaxer->setState(
-                        mEdit->mDocument->getSyntaxState(vLine-2));
+        // Tokens of unchanged lines are cached in the document, so we only
+        // run the syntaxer for lines that are edited or painted the first time.
+        PLineTokens lineTokens;
+        if (!lineTextChanged)
+            lineTokens = mEdit->mDocument->getLineTokens(vLine-1);
+        if (!lineTokens) {
+            lineTokens = scanLineTokens(sLine, vLine);
+            if (!lineTextChanged)
+                mEdit->mDocument->setLineTokens(vLine-1, lineTokens);
         }
-        mEdit->mSyntaxer->setLine(sLine, vLine - 1);
         // Try to concatenate as many tokens as possible to minimize the count
         // of ExtTextOut calls necessary. This depends on the selection state
         // or the line having special colors. For spaces the foreground color
@@ -1091,41 +1200,31 @@ void QSynEditPainter::paintLines()
         mTokenAccu.width = 0;
         tokenLeft = 0;
         // Test first whether anything of this token is visible.
-        while (!mEdit->mSyntaxer->eol()) {
-            sToken = mEdit->mSyntaxer->getToken();
-            if (sToken.isEmpty())  {
-                continue;
-            }
-            int tokenStartChar = mEdit->mSyntaxer->getTokenPos();
+        for (const LineToken& lineToken : *lineTokens) {
+            sToken = sLine.mid(lineToken.start, lineToken.length);
+            int tokenStartChar = lineToken.start;
             int tokenEndChar = tokenStartChar + sToken.length();
 
             // It's at least partially visible. Get the token attributes now.
-            attr = mEdit->mSyntaxer->getTokenAttribute();
+            attr = lineToken.attr;
 
             //rainbow parenthesis
             if (sToken == "["
                     || sToken == "("
                     || sToken == "{"
                     ) {
-                SyntaxState rangeState = mEdit->mSyntaxer->getState();
-                getBraceColorAttr(rangeState.bracketLevel
-                                  +rangeState.braceLevel
-                                  +rangeState.parenthesisLevel
-                                  ,attr);
+                getBraceColorAttr(lineToken.bracketLevel,attr);
             } else if (sToken == "]"
                        || sToken == ")"
                        || sToken == "}"
                        ){
-                SyntaxState rangeState = mEdit->mSyntaxer->getState();
-                getBraceColorAttr(rangeState.bracketLevel
-                                  +rangeState.braceLevel
-                                  +rangeState.parenthesisLevel+1,
+                getBraceColorAttr(lineToken.bracketLevel+1,
                                   attr);
             }
             //input method
             if (mIsCurrentLine && mEdit->mInputPreeditString.length()>0) {
-                int startPos = mEdit->mSyntaxer->getTokenPos()+1;
-                int endPos = mEdit->mSyntaxer->getTokenPos() + sToken.length();
+                int startPos = tokenStartChar+1;
+                int endPos = tokenStartChar + sToken.length();
                 if (!(endPos < mEdit->mCaretX
                         || startPos >= mEdit->mCaretX+mEdit->mInputPreeditString.length())) {
                     if (!preeditAttr) {
@@ -1137,7 +1236,7 @@ void QSynEditPainter::paintLines()
             }
             bool showGlyph=false;
             if (attr && attr->tokenType() == TokenType::Space) {
-                int pos = mEdit->mSyntaxer->getTokenPos();
+                int pos = tokenStartChar;
                 if (pos==0) {
                     showGlyph = mEdit->mOptions.testFlag(EditorOption::ShowLeadingSpaces);
                 } else if (pos+sToken.length()==sLine.length()) {
@@ -1162,8 +1261,6 @@ void QSynEditPainter::paintLines()
             //So we just quit if already out of the right edge of the editor
             if (lineWidthValid && (tokenLeft>mRight))
                     break;
-            // Let the highlighter scan the next token.
-            mEdit->mSyntaxer->next();
         }
         if (!lineWidthValid)
             mEdit->mDocument->setLineWidth(vLine-1, tokenLeft, glyphStartPositionsList);
@@ -1175,7 +1272,7 @@ void QSynEditPainter::paintLines()
             if ((foldRange) && foldRange->collapsed) {
                 addOnStr = mEdit->mSyntaxer->foldString(sLine);
                 attr = mEdit->mSyntaxer->symbolAttribute();
-                getBraceColorAttr(mEdit->mSyntaxer->getState().braceLevel,attr);
+                getBraceColorAttr(mEdit->mDocument->getSyntaxState(vLine-1).braceLevel,attr);
             } else {
                 // Draw LineBreak glyph.
                 if (mEdit->mOptions.testFlag(EditorOption::ShowLineBreaks)
@@ -21,6 +21,7 @@
 #include <QPainter>
 #include <QString>
 #include "types.h"
+#include "document.h"
 
 namespace QSynedit {
 struct TokenTextInfo {
@@ -54,6 +55,7 @@ class QSynEditPainter
         QColor background;
         FontStyles style;
         QFont font;
+        PGlyphWidthTable widthTable;
         bool showSpecialGlyphs;
     };
 
@@ -105,6 +107,7 @@ private:
 
     void paintFoldAttributes();
     void getBraceColorAttr(int level, PTokenAttribute &attr);
+    PLineTokens scanLineTokens(const QString& lineText, int line);
     void paintLines();
 
 private:
@@ -133,6 +136,9 @@ private:
 
     QRect mClip;
     int mFirstRow, mLastRow, mLeft, mRight;
+    // x range of the painting area in the line text, and start x of the painted row
+    // (differ from mLeft,mRight and 0 only when long lines are wrapped)
+    int mTextLeft, mTextRight, mRowStartX;
     SynTokenAccu mTokenAccu;
 };
 
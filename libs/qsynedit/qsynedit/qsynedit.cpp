@@ -47,9 +47,15 @@
 namespace QSynedit {
 QSynEdit::QSynEdit(QWidget *parent) : QAbstractScrollArea(parent),
     mEditingCount{0},
+    mEditingFirstLine{-1},
+    mEditingLastLine{-1},
     mDropped{false},
     mWheelAccumulatedDeltaX{0},
-    mWheelAccumulatedDeltaY{0}
+    mWheelAccumulatedDeltaY{0},
+    mBatchEditCount{0},
+    mBatchRowsChanged{false},
+    mStaticTextCache{4096},
+    mLineTokensGeneration{0}
 {
     mSyntaxer = std::make_shared<TextSyntaxer>();
     mCharWidth=1;
@@ -144,6 +150,9 @@ QSynEdit::QSynEdit(QWidget *parent) : QAbstractScrollArea(parent),
 
     mAllFoldRanges = std::make_shared<CodeFoldingRanges>();
     mUseCodeFolding = true;
+    mDisplayRowIndexValid = false;
+    mDisplayRowFoldsGeneration = -1;
+    mDisplayRowWrapWidth = 0;
     m_blinkTimerId = 0;
     m_blinkStatus = 0;
 
@@ -175,6 +184,10 @@ int QSynEdit::displayLineCount() const
     if (mDocument->empty()) {
         return 0;
     }
+    if (wordWrap()) {
+        ensureDisplayRowIndex();
+        return mDisplayRowIndex.rowCount();
+    }
     return lineToRow(mDocument->count());
 }
 
@@ -279,6 +292,16 @@ bool QSynEdit::canUndo() const
     return !mReadOnly && mUndoList->canUndo();
 }
 
+size_t QSynEdit::undoMemoryLimit() const
+{
+    return mUndoList->maxMemoryUsage();
+}
+
+void QSynEdit::setUndoMemoryLimit(size_t bytes)
+{
+    mUndoList->setMaxMemoryUsage(bytes);
+}
+
 bool QSynEdit::canRedo() const
 {
     return !mReadOnly && mRedoList->canRedo();
@@ -286,6 +309,8 @@ bool QSynEdit::canRedo() const
 
 int QSynEdit::maxScrollWidth() const
 {
+    if (wordWrap())
+        return 0;
     int maxWidth = mDocument->maxLineWidth();
     if (maxWidth < 0)
         return -1;
@@ -623,7 +648,7 @@ void QSynEdit::invalidateGutterLines(int firstLine, int lastLine)
         // find the visible lines first
         if (lastLine < firstLine)
             std::swap(lastLine, firstLine);
-        if (useCodeFolding()) {
+        if (useCodeFolding() || wordWrap()) {
             firstLine = lineToRow(firstLine);
             if (lastLine <= mDocument->count())
               lastLine = lineToRow(lastLine);
@@ -652,11 +677,14 @@ DisplayCoord QSynEdit::pixelsToNearestGlyphPos(int aX, int aY) const
 {
     int xpos = std::max(0, leftPos() + aX - mGutterWidth - 2);
     int row = yposToRow(aY);
-    int line = rowToLine(row);
+    int rowInLine;
+    int line = rowToLine(row, rowInLine);
     if (line<1)
         line = 1;
     if (line>mDocument->count())
         line = mDocument->count();
+    int rowStart = rowStartX(line, rowInLine);
+    xpos += rowStart;
     if (xpos<0) {
         xpos=0;
     } else if (xpos>mDocument->lineWidth(line-1)) {
@@ -669,21 +697,24 @@ DisplayCoord QSynEdit::pixelsToNearestGlyphPos(int aX, int aY) const
         else
             xpos = mDocument->glyphStartPostion(line-1, glyphIndex);
     }
-    return DisplayCoord{xpos, row};
+    return DisplayCoord{xpos - rowStart, row};
 }
 
 DisplayCoord QSynEdit::pixelsToGlyphPos(int aX, int aY) const
 {
     int xpos = std::max(0, leftPos() + aX - mGutterWidth - 2);
     int row = yposToRow(aY);
-    int line = rowToLine(row);
+    int rowInLine;
+    int line = rowToLine(row, rowInLine);
     if (line<1 || line > mDocument->count() )
         return DisplayCoord{-1,-1};
+    int rowStart = rowStartX(line, rowInLine);
+    xpos += rowStart;
     if (xpos<0 || xpos>mDocument->lineWidth(line-1))
         return DisplayCoord{-1,-1};
     int glyphIndex = mDocument->xposToGlyphIndex(line-1, xpos);
     xpos = mDocument->glyphStartPostion(line-1, glyphIndex);
-    return DisplayCoord{xpos, row};
+    return DisplayCoord{xpos - rowStart, row};
 }
 
 QPoint QSynEdit::displayCoordToPixels(const DisplayCoord &coord) const
@@ -706,8 +737,16 @@ DisplayCoord QSynEdit::bufferToDisplayPos(const BufferCoord &p) const
     if (p.line<1)
         return result;
     // Account for tabs and charColumns
-    if (p.line-1 <mDocument->count())
+    if (p.line-1 <mDocument->count()) {
         result.x = charToGlyphLeft(p.line,p.ch);
+        if (wordWrap()) {
+            ensureDisplayRowIndex();
+            int rowInLine = mDisplayRowIndex.rowInLine(p.line, p.ch-1);
+            result.x -= mDisplayRowIndex.rowStartPosition(p.line, rowInLine);
+            result.row = mDisplayRowIndex.lineToRow(p.line) + rowInLine;
+            return result;
+        }
+    }
     result.row = lineToRow(result.row);
     return result;
 }
@@ -722,11 +761,20 @@ BufferCoord QSynEdit::displayToBufferPos(const DisplayCoord &p) const
     BufferCoord result{p.x,p.row};
     if (p.row<1)
         return result;
-    // Account for code folding
-    result.line = rowToLine(p.row);
+    // Account for code folding and word wrap
+    int rowInLine;
+    result.line = rowToLine(p.row, rowInLine);
     // Account for tabs
     if (result.line <= mDocument->count() ) {
-        result.ch = xposToGlyphStartChar(result.line,p.x);
+        if (wordWrap()) {
+            result.ch = xposToGlyphStartChar(result.line,
+                                             p.x + mDisplayRowIndex.rowStartPosition(result.line, rowInLine));
+            // keep in the row
+            int rowEnd = mDisplayRowIndex.rowEndChar(result.line, rowInLine);
+            if (rowEnd != INT_MAX)
+                result.ch = std::min(result.ch, rowEnd + 1);
+        } else
+            result.ch = xposToGlyphStartChar(result.line,p.x);
     }
     return result;
 }
@@ -859,6 +907,10 @@ int QSynEdit::getLineIndent(const QString &line) const
 
 int QSynEdit::rowToLine(int aRow) const
 {
+    if (wordWrap()) {
+        int rowInLine;
+        return rowToLine(aRow, rowInLine);
+    }
     if (useCodeFolding())
         return foldRowToLine(aRow);
     else
@@ -866,41 +918,56 @@ int QSynEdit::rowToLine(int aRow) const
     //return displayToBufferPos({1, aRow}).Line;
 }
 
+int QSynEdit::rowToLine(int row, int &rowInLine) const
+{
+    if (wordWrap()) {
+        ensureDisplayRowIndex();
+        return mDisplayRowIndex.rowToLine(row, rowInLine);
+    }
+    rowInLine = 0;
+    return rowToLine(row);
+}
+
 int QSynEdit::lineToRow(int aLine) const
 {
+    if (wordWrap()) {
+        ensureDisplayRowIndex();
+        return mDisplayRowIndex.lineToRow(aLine);
+    }
     if (useCodeFolding())
         return foldLineToRow(aLine);
     else
         return aLine;
 }
 
+int QSynEdit::lineRowCount(int line) const
+{
+    if (!wordWrap())
+        return 1;
+    ensureDisplayRowIndex();
+    return std::max(1, mDisplayRowIndex.rowsOfLine(line));
+}
+
+int QSynEdit::rowStartX(int line, int rowInLine) const
+{
+    if (!wordWrap())
+        return 0;
+    ensureDisplayRowIndex();
+    return mDisplayRowIndex.rowStartPosition(line, rowInLine);
+}
+
 int QSynEdit::foldRowToLine(int row) const
 {
-    int result = row;
-    for (int i=0;i<mAllFoldRanges->count();i++) {
-        PCodeFoldingRange range = (*mAllFoldRanges)[i];
-        if (range->collapsed && !range->parentCollapsed() && range->fromLine < result) {
-            result += range->linesCollapsed;
-        }
-    }
-    return result;
+    if (!mCollapsedFoldsIndex.valid())
+        mCollapsedFoldsIndex.rebuild(mAllFoldRanges);
+    return mCollapsedFoldsIndex.rowToLine(row);
 }
 
 int QSynEdit::foldLineToRow(int line) const
 {
-    int result = line;
-    for (int i=mAllFoldRanges->count()-1;i>=0;i--) {
-        PCodeFoldingRange range =(*mAllFoldRanges)[i];
-        if (range->collapsed && !range->parentCollapsed()) {
-            // Line is found after fold
-            if (range->toLine < line)
-                result -= range->linesCollapsed;
-            // Inside fold
-            else if (range->fromLine < line && line <= range->toLine)
-                result -= line - range->fromLine;
-        }
-    }
-    return result;
+    if (!mCollapsedFoldsIndex.valid())
+        mCollapsedFoldsIndex.rebuild(mAllFoldRanges);
+    return mCollapsedFoldsIndex.lineToRow(line);
 }
 
 void QSynEdit::setDefaultKeystrokes()
@@ -921,13 +988,16 @@ void QSynEdit::invalidateLine(int line)
         return;
 
     // invalidate text area of this line
-    if (useCodeFolding())
+    int rows = lineRowCount(line);
+    if (wordWrap())
+        line = lineToRow(line);
+    else if (useCodeFolding())
         line = foldLineToRow(line);
-    if (line >= yposToRow(0) && line <= yposToRow(clientHeight())) {
+    if (line + rows - 1 >= yposToRow(0) && line <= yposToRow(clientHeight())) {
         rcInval = { mGutterWidth,
                     mTextHeight * (line-1) - mTopPos,
                     clientWidth(),
-                    mTextHeight};
+                    mTextHeight * rows};
         invalidateRect(rcInval);
     }
 }
@@ -950,7 +1020,7 @@ void QSynEdit::invalidateLines(int firstLine, int lastLine)
         if (lastLine >= mDocument->count())
             lastLine = mDocument->count() + mLinesInWindow + 2; // paint empty space beyond last line
 
-        if (useCodeFolding()) {
+        if (useCodeFolding() || wordWrap()) {
           firstLine = lineToRow(firstLine);
           // Could avoid this conversion if (First = Last) and
           // (Length < CharsInWindow) but the dependency isn't worth IMO.
@@ -1734,6 +1804,8 @@ void QSynEdit::endEditing()
         if (!mUndoing)
             mUndoList->endBlock();
         reparseDocument();
+        mEditingFirstLine = -1;
+        mEditingLastLine = -1;
     }
     decPaintLock();
 }
@@ -2402,6 +2474,7 @@ QRect QSynEdit::calculateCaretRect() const
             coord.x = segmentIntervalStart(mGlyphPostionCacheForInputMethod.glyphPositionList,0,mGlyphPostionCacheForInputMethod.strWidth, glyphIdx);
         } else
             coord.x = charToGlyphLeft(mCaretY, sLine, mCaretX+mInputPreeditString.length());
+        coord.x -= rowStartX(mCaretY, coord.row - lineToRow(mCaretY));
     }
     int rows=1;
     if (mActiveSelectionMode == SelectionMode::Column) {
@@ -2942,12 +3015,29 @@ QRect QSynEdit::clientRect() const
 
 void QSynEdit::synFontChanged()
 {
+    mStaticTextCache.clear();
+    for (PGlyphWidthTable& table : mGlyphWidthTables)
+        table.reset();
+    invalidateDisplayRows();
     incPaintLock();
     recalcCharExtent();
     decPaintLock();
 }
 
 
+const PGlyphWidthTable &QSynEdit::glyphWidthTable(FontStyles style) const
+{
+    int index = ((style & FontStyle::fsBold) ? 1 : 0) + ((style & FontStyle::fsItalic) ? 2 : 0);
+    PGlyphWidthTable &table = mGlyphWidthTables[index];
+    if (!table) {
+        QFont f = font();
+        f.setBold(style & FontStyle::fsBold);
+        f.setItalic(style & FontStyle::fsItalic);
+        table = GlyphWidthTable::forFont(f);
+    }
+    return table;
+}
+
 void QSynEdit::updateLastCaretX()
 {
     mLastCaretColumn = displayX();
@@ -3276,11 +3366,16 @@ int QSynEdit::reparseLines(int startLine, int endLine, bool needRescanFolds, boo
         line++;
     } while (line < maxLine);
 
-    //don't rescan folds if only currentLine is reparsed
-    if (line-startLine==1)
+    if (mEditingCount>0) {
+        //folds are rescanned once when the editing ends
+        if (mEditingFirstLine<0 || startLine<mEditingFirstLine)
+            mEditingFirstLine = startLine;
+        mEditingLastLine = std::max(mEditingLastLine, line);
         return line;
+    }
 
-    if (mEditingCount>0)
+    //don't rescan folds if only currentLine is reparsed
+    if (line-startLine==1)
         return line;
 
     if (needRescanFolds && useCodeFolding())
@@ -3330,6 +3425,7 @@ void QSynEdit::uncollapse(PCodeFoldingRange FoldRange)
 {
     FoldRange->linesCollapsed = 0;
     FoldRange->collapsed = false;
+    mCollapsedFoldsIndex.invalidate();
 
     // Redraw the collapsed line
     invalidateLines(FoldRange->fromLine, INT_MAX);
@@ -3344,6 +3440,7 @@ void QSynEdit::collapse(PCodeFoldingRange FoldRange)
 {
     FoldRange->linesCollapsed = FoldRange->toLine - FoldRange->fromLine;
     FoldRange->collapsed = true;
+    mCollapsedFoldsIndex.invalidate();
 
     // Extract caret from fold
     if ((mCaretY > FoldRange->fromLine) && (mCaretY <= FoldRange->toLine)) {
@@ -3363,6 +3460,7 @@ void QSynEdit::collapse(PCodeFoldingRange FoldRange)
 
 void QSynEdit::foldOnLinesInserted(int Line, int Count)
 {
+    mCollapsedFoldsIndex.invalidate();
     // Delete collapsed inside selection
     for (int i = mAllFoldRanges->count()-1;i>=0;i--) {
         PCodeFoldingRange range = (*mAllFoldRanges)[i];
@@ -3376,6 +3474,7 @@ void QSynEdit::foldOnLinesInserted(int Line, int Count)
 
 void QSynEdit::foldOnLinesDeleted(int Line, int Count)
 {
+    mCollapsedFoldsIndex.invalidate();
     // Delete collapsed inside selection
     for (int i = mAllFoldRanges->count()-1;i>=0;i--) {
         PCodeFoldingRange range = (*mAllFoldRanges)[i];
@@ -3394,6 +3493,7 @@ void QSynEdit::foldOnLinesDeleted(int Line, int Count)
 void QSynEdit::foldOnListCleared()
 {
     mAllFoldRanges->clear();
+    mCollapsedFoldsIndex.invalidate();
 }
 
 void QSynEdit::rescanFolds()
@@ -3403,10 +3503,63 @@ void QSynEdit::rescanFolds()
 
     incPaintLock();
     rescanForFoldRanges();
+    mCollapsedFoldsIndex.invalidate();
     invalidateGutter();
     decPaintLock();
 }
 
+int QSynEdit::wrapWidth() const
+{
+    // leave room for the caret at the end of the row
+    return std::max(viewWidth() - mCharWidth, mCharWidth);
+}
+
+void QSynEdit::invalidateDisplayRows()
+{
+    mDisplayRowIndexValid = false;
+    mDisplayRowIndex.clear();
+}
+
+void QSynEdit::ensureDisplayRowIndex() const
+{
+    if (!mDisplayRowIndexValid || mDisplayRowIndex.lineCount() != mDocument->count()) {
+        mDisplayRowWrapWidth = wrapWidth();
+        mDisplayRowIndex.clear();
+        mDisplayRowIndex.insertLines(1, mDocument->count());
+        for (int line=1;line<=mDocument->count();line++)
+            updateDisplayRowsOfLine(line);
+        mDisplayRowIndexValid = true;
+        mDisplayRowFoldsGeneration = -1;
+    }
+    if (useCodeFolding()) {
+        if (!mCollapsedFoldsIndex.valid())
+            mCollapsedFoldsIndex.rebuild(mAllFoldRanges);
+        if (mDisplayRowFoldsGeneration != mCollapsedFoldsIndex.generation()) {
+            mDisplayRowIndex.setHiddenRanges(mCollapsedFoldsIndex.fromLines(),
+                                             mCollapsedFoldsIndex.toLines());
+            mDisplayRowFoldsGeneration = mCollapsedFoldsIndex.generation();
+        }
+    } else if (mDisplayRowFoldsGeneration != 0) {
+        // generation of a built folds index is always greater than 0
+        mDisplayRowIndex.setHiddenRanges(QVector<int>(), QVector<int>());
+        mDisplayRowFoldsGeneration = 0;
+    }
+}
+
+void QSynEdit::updateDisplayRowsOfLine(int line) const
+{
+    QString lineText;
+    QList<int> glyphStartChars;
+    QList<int> glyphStartPositions;
+    int width = mDocument->getLineGlyphs(line-1, lineText, glyphStartChars, glyphStartPositions);
+    QVector<int> breakChars;
+    QVector<int> breakPositions;
+    DisplayRowIndex::calcLineBreaks(lineText, glyphStartChars, glyphStartPositions,
+                                    width, mDisplayRowWrapWidth,
+                                    breakChars, breakPositions);
+    mDisplayRowIndex.setLineBreaks(line, breakChars, breakPositions);
+}
+
 void QSynEdit::rescanForFoldRanges()
 {
     // Delete all uncollapsed folds
@@ -3718,6 +3871,8 @@ EditCommand QSynEdit::TranslateKeyCode(int key, Qt::KeyboardModifiers modifiers)
 void QSynEdit::onSizeOrFontChanged()
 {
     mLinesInWindow = clientHeight() / mTextHeight;
+    if (wordWrap() && mDisplayRowIndexValid && wrapWidth() != mDisplayRowWrapWidth)
+        invalidateDisplayRows();
     if (mGutter.showLineNumbers())
         onGutterChanged();
     updateHScrollbar();
@@ -3783,7 +3938,8 @@ ScrollStyle QSynEdit::scrollBars() const
 void QSynEdit::setScrollBars(ScrollStyle newScrollBars)
 {
     mScrollBars = newScrollBars;
-    if (mScrollBars == ScrollStyle::Both ||  mScrollBars == ScrollStyle::OnlyHorizontal) {
+    if ((mScrollBars == ScrollStyle::Both ||  mScrollBars == ScrollStyle::OnlyHorizontal)
+            && !wordWrap()) {
         if (mOptions.testFlag(EditorOption::AutoHideScrollbars)) {
             setHorizontalScrollBarPolicy(Qt::ScrollBarPolicy::ScrollBarAsNeeded);
         } else {
@@ -4002,6 +4158,7 @@ void QSynEdit::setTabSize(int newTabSize)
     if (newTabSize!=tabSize()) {
         incPaintLock();
         mDocument->setTabSize(newTabSize);
+        invalidateDisplayRows();
         invalidate();
         decPaintLock();
     }
@@ -4032,10 +4189,20 @@ void QSynEdit::setOptions(const EditorOptions &value)
                 || !sameEditorOption(value,mOptions, EditorOption::ShowTrailingSpaces)
                 || !sameEditorOption(value,mOptions, EditorOption::ShowLineBreaks)
                 || !sameEditorOption(value,mOptions, EditorOption::ShowRainbowColor);
+        bool bUpdateRows =
+                !sameEditorOption(value,mOptions, EditorOption::LigatureSupport)
+                || !sameEditorOption(value,mOptions, EditorOption::ForceMonospace)
+                || !sameEditorOption(value,mOptions, EditorOption::WordWrap);
         mOptions = value;
 
         setScrollBars(mScrollBars);
         mDocument->setForceMonospace(mOptions.testFlag(EditorOption::ForceMonospace) );
+        if (bUpdateRows) {
+            invalidateDisplayRows();
+            if (wordWrap())
+                setLeftPos(0);
+            bUpdateAll = true;
+        }
 
         // constrain caret position to MaxScrollWidth if eoScrollPastEol is enabled
         internalSetCaretXY(caretXY());
@@ -4094,6 +4261,8 @@ void QSynEdit::doUndo()
     PUndoItem item = mUndoList->peekItem();
     if (item) {
         size_t oldChangeNumber = item->changeNumber();
+        //reparse the document only once after all items are undone
+        beginEditingWithoutUndo();
         {
             ChangeReason  lastChange = mUndoList->lastChangeReason();
             bool keepGoing;
@@ -4114,6 +4283,7 @@ void QSynEdit::doUndo()
                 }
             } while (keepGoing);
         }
+        endEditingWithoutUndo();
     }
     ensureCaretVisible();
     updateModifiedStatus();
@@ -4184,17 +4354,19 @@ void QSynEdit::doUndoItem()
             ensureCaretVisible();
             break;
         }
-        case ChangeReason::ReplaceLine:
+        case ChangeReason::ReplaceLine: {
+            QString replacedText;
+            BufferCoord newEnd = doReplaceLineChange(item, replacedText);
             mRedoList->addRedo(
                         item->changeReason(),
                         item->changeStartPos(),
-                        item->changeEndPos(),
-                        QStringList(mDocument->getLine(item->changeStartPos().line-1)),
+                        newEnd,
+                        QStringList(replacedText),
                         item->changeSelMode(),
                         item->changeNumber()
                         );
-            mDocument->putLine(item->changeStartPos().line-1,item->changeText()[0]);
             break;
+        }
         case ChangeReason::MoveSelectionUp:
             setBlockBegin(BufferCoord{item->changeStartPos().ch, item->changeStartPos().line-1});
             setBlockEnd(BufferCoord{item->changeEndPos().ch, item->changeEndPos().line-1});
@@ -4297,6 +4469,8 @@ void QSynEdit::doRedo()
     }
     ChangeReason lastChange = mRedoList->lastChangeReason();
     bool keepGoing;
+    //reparse the document only once after all items are redone
+    beginEditingWithoutUndo();
     do {
       doRedoItem();
       item = mRedoList->peekItem();
@@ -4313,6 +4487,7 @@ void QSynEdit::doRedo()
         lastChange = item->changeReason();
       }
     } while (keepGoing);
+    endEditingWithoutUndo();
 
     //restore Group Break
     while (mRedoList->lastChangeReason()==ChangeReason::GroupBreak) {
@@ -4402,17 +4577,19 @@ void QSynEdit::doRedoItem()
                         item->changeSelMode(),
                         item->changeNumber());
             break;
-        case ChangeReason::ReplaceLine:
+        case ChangeReason::ReplaceLine: {
+            QString replacedText;
+            BufferCoord newEnd = doReplaceLineChange(item, replacedText);
             mUndoList->restoreChange(
                         item->changeReason(),
                         item->changeStartPos(),
-                        item->changeEndPos(),
-                        QStringList(mDocument->getLine(item->changeStartPos().line-1)),
+                        newEnd,
+                        QStringList(replacedText),
                         item->changeSelMode(),
                         item->changeNumber()
                         );
-            mDocument->putLine(item->changeStartPos().line-1,item->changeText()[0]);
             break;
+        }
         case ChangeReason::Insert:
             setCaretAndSelection(
                         item->changeStartPos(),
@@ -4677,6 +4854,9 @@ void QSynEdit::setSyntaxer(const PSyntaxer &syntaxer)
     Q_ASSERT(syntaxer!=nullptr);
     PSyntaxer oldSyntaxer = mSyntaxer;
     mSyntaxer = syntaxer;
+    //cached tokens reference attributes of the old syntaxer
+    mDocument->invalidateAllLineTokens();
+    mLineTokensGeneration = mSyntaxer->tokensGeneration();
     if (oldSyntaxer ->language() != syntaxer->language()) {
         recalcCharExtent();
         mDocument->beginUpdate();
@@ -4746,7 +4926,7 @@ void QSynEdit::moveCaretHorz(int deltaX, bool isSelection)
                 return;
             }
             int row = lineToRow(ptDst.line);
-            row++;
+            row += lineRowCount(ptDst.line);
             int line = rowToLine(row);
             if (line!=ptDst.line && line<=mDocument->count()) {
                 ptDst.line = line;
@@ -5312,6 +5492,73 @@ void QSynEdit::doDeleteText(BufferCoord startPos, BufferCoord endPos, SelectionM
     }
 }
 
+void QSynEdit::doDeleteLines(int line, int count)
+{
+    int lastLine = line + count - 1;
+    if (line==1 && lastLine>=mDocument->count()) {
+        // keep one empty line in the document
+        replaceLine(1,"");
+        if (lastLine>1)
+            doDeleteLines(2, lastLine-1);
+        return;
+    }
+    QStringList deleted;
+    for (int i=line;i<=lastLine;i++)
+        deleted.append(mDocument->getLine(i-1));
+    BufferCoord startPos;
+    BufferCoord endPos;
+    if (lastLine < mDocument->count()) {
+        startPos = BufferCoord{1, line};
+        endPos = BufferCoord{1, lastLine+1};
+        deleted.append("");
+    } else {
+        startPos = BufferCoord{mDocument->getLine(line-2).length()+1, line-1};
+        endPos = BufferCoord{mDocument->getLine(lastLine-1).length()+1, lastLine};
+        deleted.prepend("");
+    }
+    mDocument->deleteLines(line-1, count);
+    doLinesDeleted(line, count);
+    if (!mUndoing) {
+        mUndoList->addChange(ChangeReason::Delete,
+                             startPos,
+                             endPos,
+                             deleted,
+                             SelectionMode::Normal);
+    }
+}
+
+void QSynEdit::doInsertLines(int line, const QStringList &lines)
+{
+    if (lines.isEmpty())
+        return;
+    BufferCoord startPos;
+    BufferCoord endPos;
+    if (line <= mDocument->count()) {
+        startPos = BufferCoord{1, line};
+        endPos = BufferCoord{1, line + lines.count()};
+    } else {
+        // append to the end of the document
+        line = mDocument->count()+1;
+        if (line>1)
+            startPos = BufferCoord{mDocument->getLine(line-2).length()+1, line-1};
+        else
+            startPos = BufferCoord{1, 1};
+        endPos = BufferCoord{lines.back().length()+1, line+lines.count()-1};
+    }
+    mDocument->insertLines(line-1, lines.count());
+    for (int i=0;i<lines.count();i++) {
+        properSetLine(line-1+i, lines[i], false);
+    }
+    doLinesInserted(line, lines.count());
+    if (!mUndoing) {
+        mUndoList->addChange(ChangeReason::Insert,
+                             startPos,
+                             endPos,
+                             QStringList(),
+                             SelectionMode::Normal);
+    }
+}
+
 void QSynEdit::doInsertText(const BufferCoord& pos,
                            const QStringList& text,
                            SelectionMode mode, int startLine, int endLine) {
@@ -5530,6 +5777,11 @@ void QSynEdit::onGutterGetText(int , QString &)
 
 }
 
+void QSynEdit::onGutterGetBackground(int , QColor &)
+{
+
+}
+
 void QSynEdit::onGutterPaint(QPainter &, int , int , int )
 {
 
@@ -5565,6 +5817,8 @@ void QSynEdit::executeCommand(EditCommand command, QChar ch, void *pData)
         decPaintLock();
         showCaret();
     });
+    if (!mExtraCarets.isEmpty() && executeMultiCaretCommand(command, ch, pData))
+        return;
     switch(command) {
     //horizontal caret movement or selection
     case EditCommand::Left:
@@ -5816,6 +6070,12 @@ void QSynEdit::executeCommand(EditCommand command, QChar ch, void *pData)
         if (!mReadOnly)
             doTrimTrailingSpaces();
         break;
+    case EditCommand::AddCaretUp:
+        doAddCaretVert(-1);
+        break;
+    case EditCommand::AddCaretDown:
+        doAddCaretVert(1);
+        break;
     default:
         break;
     }
@@ -5829,8 +6089,368 @@ void QSynEdit::beginEditingWithoutUndo()
 void QSynEdit::endEditingWithoutUndo()
 {
     mEditingCount--;
-    if (mEditingCount==0)
-        reparseDocument();
+    if (mEditingCount==0 && mEditingFirstLine>=0) {
+        //the edits reparsed their own lines, check the touched range once
+        reparseLines(mEditingFirstLine, mEditingLastLine, false);
+        if (useCodeFolding())
+            rescanFolds();
+    }
+    if (mEditingCount==0) {
+        mEditingFirstLine = -1;
+        mEditingLastLine = -1;
+    }
+}
+
+static bool caretLessThan(const BufferCoord& c1, const BufferCoord& c2)
+{
+    return (c1.line < c2.line) || (c1.line == c2.line && c1.ch < c2.ch);
+}
+
+static bool sameCaret(const BufferCoord& c1, const BufferCoord& c2)
+{
+    return c1.line == c2.line && c1.ch == c2.ch;
+}
+
+static bool sameFoldingState(const SyntaxState& s1, const SyntaxState& s2)
+{
+    return s1.blockLevel == s2.blockLevel
+            && s1.blockStarted == s2.blockStarted
+            && s1.blockEnded == s2.blockEnded
+            && s1.blockEndedLastLine == s2.blockEndedLastLine;
+}
+
+static void sortCarets(QVector<BufferCoord>& carets)
+{
+    std::sort(carets.begin(), carets.end(), caretLessThan);
+    carets.erase(std::unique(carets.begin(), carets.end(), sameCaret), carets.end());
+}
+
+bool QSynEdit::hasExtraCarets() const
+{
+    return !mExtraCarets.isEmpty();
+}
+
+const QVector<BufferCoord> &QSynEdit::extraCarets() const
+{
+    return mExtraCarets;
+}
+
+void QSynEdit::addExtraCaret(const BufferCoord &pos)
+{
+    QVector<BufferCoord> carets = mExtraCarets;
+    carets.append(pos);
+    setExtraCarets(carets);
+}
+
+void QSynEdit::setExtraCarets(const QVector<BufferCoord> &carets)
+{
+    mExtraCarets.clear();
+    if (mDocument->count()>0) {
+        BufferCoord primary = caretXY();
+        foreach (const BufferCoord& caret, carets) {
+            BufferCoord pos = validCaretPos(caret);
+            if (!sameCaret(pos, primary))
+                mExtraCarets.append(pos);
+        }
+        sortCarets(mExtraCarets);
+    }
+    if (!mExtraCarets.isEmpty()) {
+        //extra carets don't have selections
+        setActiveSelectionMode(SelectionMode::Normal);
+        setBlockBegin(caretXY());
+        setBlockEnd(caretXY());
+    }
+    invalidateLines(-1, -1);
+}
+
+void QSynEdit::clearExtraCarets()
+{
+    if (mExtraCarets.isEmpty())
+        return;
+    mExtraCarets.clear();
+    invalidateLines(-1, -1);
+}
+
+BufferCoord QSynEdit::validCaretPos(const BufferCoord &pos) const
+{
+    BufferCoord result = pos;
+    result.line = std::max(1, std::min(result.line, mDocument->count()));
+    result.ch = std::max(1, std::min(result.ch, mDocument->getLine(result.line-1).length()+1));
+    return result;
+}
+
+bool QSynEdit::executeMultiCaretCommand(EditCommand command, QChar ch, void *pData)
+{
+    switch(command) {
+    case EditCommand::Char:
+        if (!mReadOnly && (ch.isPrint() || ch=='\t'))
+            doMultiCaretEdit(command, ch);
+        return true;
+    case EditCommand::ImeStr:
+    case EditCommand::String: {
+        QString s = *((QString*)pData);
+        if (s.contains('\n') || s.contains('\r'))
+            break;
+        if (!mReadOnly)
+            doMultiCaretEdit(command, s);
+        return true;
+    }
+    case EditCommand::Tab:
+    case EditCommand::DeleteLastChar:
+    case EditCommand::DeleteChar:
+        if (!mReadOnly)
+            doMultiCaretEdit(command, QString());
+        return true;
+    case EditCommand::Left:
+    case EditCommand::Right:
+    case EditCommand::Up:
+    case EditCommand::Down:
+    case EditCommand::LineStart:
+    case EditCommand::LineEnd:
+        //extra carets move with the primary caret
+        moveExtraCarets(command);
+        return false;
+    case EditCommand::AddCaretUp:
+    case EditCommand::AddCaretDown:
+    case EditCommand::Copy:
+    case EditCommand::ScrollUp:
+    case EditCommand::ScrollDown:
+    case EditCommand::ScrollLeft:
+    case EditCommand::ScrollRight:
+    case EditCommand::ZoomIn:
+    case EditCommand::ZoomOut:
+        return false;
+    default:
+        break;
+    }
+    clearExtraCarets();
+    return false;
+}
+
+void QSynEdit::doMultiCaretEdit(EditCommand command, const QString &text)
+{
+    BufferCoord primary = validCaretPos(caretXY());
+    QVector<BufferCoord> carets = mExtraCarets;
+    for (BufferCoord& caret : carets)
+        caret = validCaretPos(caret);
+    carets.append(primary);
+    sortCarets(carets);
+    int primaryIndex = std::lower_bound(carets.begin(), carets.end(), primary, caretLessThan) - carets.begin();
+
+    if (command != EditCommand::Char || !isIdentChar(text.front()))
+        mUndoList->addGroupBreak();
+    incPaintLock();
+    mDocument->beginUpdate();
+    mUndoList->beginBlock();
+    mBatchEditCount++;
+    mBatchRowsChanged = false;
+
+    // Edits don't span lines, so the carets in different lines are independent.
+    // In each line, the edits are applied from left to right, and are recorded in the same
+    // order, so undo (which is applied backwards) always sees valid positions.
+    QVector<BufferCoord> newCarets;
+    newCarets.reserve(carets.count());
+    QVector<int> changedLines;
+    QVector<SyntaxState> oldStates; // states of the changed lines before the edit
+    int i = 0;
+    while (i < carets.count()) {
+        int line = carets[i].line;
+        QString oldText = mDocument->getLine(line-1);
+        QString newText;
+        int copied = 0; // chars of oldText copied to newText
+        int offset = 0; // length changes of the edits before, in this line
+        for (; i < carets.count() && carets[i].line == line; i++) {
+            int ch = carets[i].ch;
+            int deleteFrom = ch;
+            int deleteTo = ch;
+            QString insertText;
+            switch(command) {
+            case EditCommand::DeleteLastChar:
+                // don't join lines
+                if (ch > 1) {
+                    int glyphIndex = mDocument->charToGlyphIndex(line-1, ch-1);
+                    deleteFrom = mDocument->glyphStartChar(line-1, glyphIndex-1)+1;
+                }
+                break;
+            case EditCommand::DeleteChar:
+                if (ch <= oldText.length()) {
+                    int glyphIndex = mDocument->charToGlyphIndex(line-1, ch-1);
+                    deleteTo = ch + mDocument->glyphLength(line-1, glyphIndex);
+                }
+                break;
+            case EditCommand::Tab:
+                if (mOptions.testFlag(EditorOption::TabsToSpaces)) {
+                    QString s = newText + oldText.mid(copied, ch-1-copied);
+                    int left = charToGlyphLeft(line, s, s.length()+1);
+                    int count = std::ceil( (tabWidth() - (left) % tabWidth() ) / (float) tabSize());
+                    insertText = QString(count,' ');
+                } else {
+                    insertText = "\t";
+                }
+                break;
+            default:
+                insertText = text;
+                if (!mInserting)
+                    deleteTo = std::min(ch + text.length(), oldText.length()+1);
+            }
+            // don't overlap with the edit of the previous caret
+            deleteFrom = std::max(deleteFrom, copied+1);
+            deleteTo = std::max(deleteTo, deleteFrom);
+            newText += oldText.mid(copied, deleteFrom-1-copied);
+            BufferCoord editPos{deleteFrom + offset, line};
+            if (deleteTo > deleteFrom) {
+                mUndoList->addChange(ChangeReason::Delete,
+                                     editPos,
+                                     BufferCoord{deleteTo + offset, line},
+                                     QStringList(oldText.mid(deleteFrom-1, deleteTo-deleteFrom)),
+                                     SelectionMode::Normal);
+            }
+            if (!insertText.isEmpty()) {
+                mUndoList->addChange(ChangeReason::Insert,
+                                     editPos,
+                                     BufferCoord{editPos.ch + insertText.length(), line},
+                                     QStringList(),
+                                     SelectionMode::Normal);
+            }
+            newText += insertText;
+            copied = deleteTo-1;
+            offset += insertText.length() - (deleteTo-deleteFrom);
+            newCarets.append(BufferCoord{editPos.ch + insertText.length(), line});
+        }
+        newText += oldText.mid(copied);
+        if (newText != oldText) {
+            oldStates.append(mDocument->getSyntaxState(line-1));
+            properSetLine(line-1, newText);
+            changedLines.append(line);
+        }
+    }
+
+    internalSetCaretXY(newCarets[primaryIndex], false);
+    setBlockBegin(caretXY());
+    setBlockEnd(caretXY());
+    newCarets.remove(primaryIndex);
+    mExtraCarets.clear();
+    foreach (const BufferCoord& caret, newCarets) {
+        if (!sameCaret(caret, caretXY()))
+            mExtraCarets.append(caret);
+    }
+    sortCarets(mExtraCarets);
+    mBatchEditCount--;
+    mDocument->endUpdate();
+
+    // reparse the changed lines in one pass
+    int parsedLine = -1;
+    bool foldsChanged = false;
+    foreach (int line, changedLines) {
+        if (line-1 <= parsedLine)
+            continue;
+        parsedLine = reparseLines(line-1, line, false);
+        //states of the following lines are changed too
+        if (parsedLine > line)
+            foldsChanged = true;
+    }
+    for (int j=0;j<changedLines.count() && !foldsChanged;j++) {
+        if (!sameFoldingState(oldStates[j], mDocument->getSyntaxState(changedLines[j]-1)))
+            foldsChanged = true;
+    }
+    if (!changedLines.isEmpty()) {
+        if (foldsChanged && useCodeFolding())
+            rescanFolds();
+        if (mBatchRowsChanged)
+            invalidateLines(changedLines.front(), INT_MAX);
+        else
+            invalidateLines(changedLines.front(), std::max(changedLines.back(), parsedLine+1));
+    } else {
+        invalidateLines(-1, -1);
+    }
+    mUndoList->endBlock();
+    ensureCaretVisible();
+    decPaintLock();
+}
+
+void QSynEdit::moveExtraCarets(EditCommand command)
+{
+    for (BufferCoord& caret : mExtraCarets) {
+        caret = validCaretPos(caret);
+        int len = mDocument->getLine(caret.line-1).length();
+        switch(command) {
+        case EditCommand::Left:
+            if (caret.ch > 1) {
+                int glyphIndex = mDocument->charToGlyphIndex(caret.line-1, caret.ch-1);
+                caret.ch = mDocument->glyphStartChar(caret.line-1, glyphIndex-1)+1;
+            } else if (caret.line > 1) {
+                caret.line--;
+                caret.ch = mDocument->getLine(caret.line-1).length()+1;
+            }
+            break;
+        case EditCommand::Right:
+            if (caret.ch <= len) {
+                int glyphIndex = mDocument->charToGlyphIndex(caret.line-1, caret.ch-1);
+                caret.ch += mDocument->glyphLength(caret.line-1, glyphIndex);
+            } else if (caret.line < mDocument->count()) {
+                caret.line++;
+                caret.ch = 1;
+            }
+            break;
+        case EditCommand::Up:
+        case EditCommand::Down: {
+            DisplayCoord coord = bufferToDisplayPos(caret);
+            coord.row += (command == EditCommand::Up)?-1:1;
+            if (coord.row >= 1 && rowToLine(coord.row) <= mDocument->count())
+                caret = validCaretPos(displayToBufferPos(coord));
+            break;
+        }
+        case EditCommand::LineStart:
+            caret.ch = 1;
+            break;
+        case EditCommand::LineEnd:
+            caret.ch = len+1;
+            break;
+        default:
+            break;
+        }
+    }
+    sortCarets(mExtraCarets);
+    invalidateLines(-1, -1);
+}
+
+void QSynEdit::doAddCaretVert(int deltaY)
+{
+    if (mDocument->count()==0)
+        return;
+    BufferCoord base = validCaretPos(caretXY());
+    foreach (const BufferCoord& caret, mExtraCarets) {
+        if ((deltaY < 0) == caretLessThan(caret, base))
+            base = caret;
+    }
+    DisplayCoord coord = bufferToDisplayPos(base);
+    coord.row += deltaY;
+    if (coord.row < 1 || rowToLine(coord.row) > mDocument->count())
+        return;
+    addExtraCaret(displayToBufferPos(coord));
+}
+
+void QSynEdit::paintExtraCarets(QPainter &painter, const QRect &rcClip)
+{
+    if (mExtraCarets.isEmpty())
+        return;
+    int firstLine = rowToLine(yposToRow(0));
+    int lastLine = rowToLine(yposToRow(clientHeight()));
+    QColor caretColor = mCaretUseTextColor ? mForegroundColor : mCaretColor;
+    int size = std::max(1, mTextHeight/15);
+    QRect rcText = rcClip;
+    rcText.setLeft(std::max(rcClip.left(), mGutterWidth));
+    painter.setClipRect(rcText);
+    auto it = std::lower_bound(mExtraCarets.begin(), mExtraCarets.end(),
+                               BufferCoord{1, firstLine}, caretLessThan);
+    for (; it != mExtraCarets.end() && it->line <= lastLine; ++it) {
+        if (it->line > mDocument->count() || foldHidesLine(it->line))
+            continue;
+        if (sameCaret(*it, caretXY()))
+            continue;
+        QPoint pos = displayCoordToPixels(bufferToDisplayPos(*it));
+        painter.fillRect(QRect(pos.x()+1, pos.y(), size+1, mTextHeight), caretColor);
+    }
 }
 
 bool QSynEdit::isIdentChar(const QChar &ch)
@@ -5947,6 +6567,7 @@ void QSynEdit::paintEvent(QPaintEvent *event)
         rcCaret = calculateCaretRect();
     }
     paintCaret(painter, rcCaret);
+    paintExtraCarets(painter, rcClip);
 }
 
 void QSynEdit::resizeEvent(QResizeEvent *)
@@ -6016,7 +6637,10 @@ void QSynEdit::focusOutEvent(QFocusEvent *)
 
 void QSynEdit::keyPressEvent(QKeyEvent *event)
 {
-    if (event->key() == Qt::Key_Escape && mActiveSelectionMode != SelectionMode::Normal) {
+    if (event->key() == Qt::Key_Escape && !mExtraCarets.isEmpty()) {
+        clearExtraCarets();
+        event->accept();
+    } else if (event->key() == Qt::Key_Escape && mActiveSelectionMode != SelectionMode::Normal) {
         setActiveSelectionMode(SelectionMode::Normal);
         setBlockBegin(caretXY());
         setBlockEnd(caretXY());
@@ -6063,6 +6687,22 @@ void QSynEdit::mousePressEvent(QMouseEvent *event)
             return;
         }
     } else if (button == Qt::LeftButton) {
+        if (event->modifiers() == (Qt::ControlModifier | Qt::AltModifier)
+                && X >= mGutterWidth && !mReadOnly) {
+            //add or remove a caret
+            BufferCoord pos = validCaretPos(displayToBufferPos(pixelsToGlyphPos(X, Y)));
+            int oldCount = mExtraCarets.count();
+            mExtraCarets.erase(std::remove_if(mExtraCarets.begin(), mExtraCarets.end(),
+                                              [&pos](const BufferCoord& caret) {
+                return sameCaret(caret, pos);
+            }), mExtraCarets.end());
+            if (mExtraCarets.count() == oldCount)
+                addExtraCaret(pos);
+            else
+                invalidateLines(-1, -1);
+            return;
+        }
+        clearExtraCarets();
         if (selAvail()) {
             //remember selection state, as it will be cleared later
             bWasSel = true;
@@ -6475,6 +7115,10 @@ void QSynEdit::setGutterWidth(int Value)
     if (mGutterWidth != Value) {
         mGutterWidth = Value;
         // onSizeOrFontChanged(false);
+        if (wordWrap() && mDisplayRowIndexValid && wrapWidth() != mDisplayRowWrapWidth) {
+            invalidateDisplayRows();
+            updateVScrollbar();
+        }
         invalidate();
     }
 }
@@ -6514,8 +7158,10 @@ void QSynEdit::onLinesChanging()
 
 void QSynEdit::onLinesCleared()
 {
+    mExtraCarets.clear();
     if (useCodeFolding())
         foldOnListCleared();
+    invalidateDisplayRows();
     clearUndo();
     // invalidate the *whole* client area
     invalidate();
@@ -6531,6 +7177,8 @@ void QSynEdit::onLinesDeleted(int line, int count)
 {
     if (useCodeFolding())
         foldOnLinesDeleted(line + 1, count);
+    if (mDisplayRowIndexValid)
+        mDisplayRowIndex.deleteLines(line + 1, count);
     if (mSyntaxer->needsLineState()) {
         reparseLines(line, line + 1);
     }
@@ -6541,6 +7189,11 @@ void QSynEdit::onLinesInserted(int line, int count)
 {
     if (useCodeFolding())
         foldOnLinesInserted(line + 1, count);
+    if (mDisplayRowIndexValid) {
+        mDisplayRowIndex.insertLines(line + 1, count);
+        for (int i=line + 1;i<=line + count;i++)
+            updateDisplayRowsOfLine(i);
+    }
     if (mSyntaxer->needsLineState()) {
         reparseLines(line, line + count);
     } else {
@@ -6552,7 +7205,20 @@ void QSynEdit::onLinesInserted(int line, int count)
 
 void QSynEdit::onLinesPutted(int line)
 {
-    if (mSyntaxer->needsLineState()) {
+    bool rowsChanged = false;
+    if (mDisplayRowIndexValid) {
+        int oldRows = mDisplayRowIndex.rowsOfLine(line + 1);
+        updateDisplayRowsOfLine(line + 1);
+        rowsChanged = (oldRows != mDisplayRowIndex.rowsOfLine(line + 1));
+        if (rowsChanged)
+            updateVScrollbar();
+    }
+    if (mBatchEditCount>0) {
+        //the batch reparses and repaints all changed lines when it ends
+        mBatchRowsChanged = mBatchRowsChanged || rowsChanged;
+        return;
+    }
+    if (mSyntaxer->needsLineState() || rowsChanged) {
         reparseLines(line, line + 1);
         invalidateLines(line + 1, INT_MAX);
     } else {
@@ -6724,13 +7390,80 @@ void QSynEdit::setSelText(const QString &text)
 
 void QSynEdit::replaceLine(int line, const QString &lineText)
 {
-    BufferCoord pos;
-    pos.line=line;
-    pos.ch=1;
-    mUndoList->addChange(ChangeReason::ReplaceLine,pos,pos,QStringList(mDocument->getLine(line-1)),SelectionMode::Normal);
+    QString oldText = mDocument->getLine(line-1);
+    if (oldText == lineText)
+        return;
+    //only record the changed part of the line in the undo list
+    int prefixLen = 0;
+    int minLen = std::min(oldText.length(), lineText.length());
+    while (prefixLen<minLen && oldText[prefixLen]==lineText[prefixLen])
+        prefixLen++;
+    int suffixLen = 0;
+    while (suffixLen<minLen-prefixLen
+           && oldText[oldText.length()-1-suffixLen]==lineText[lineText.length()-1-suffixLen])
+        suffixLen++;
+    BufferCoord startPos{prefixLen+1,line};
+    BufferCoord endPos{lineText.length()-suffixLen+1,line};
+    mUndoList->addChange(ChangeReason::ReplaceLine,startPos,endPos,
+                         QStringList(oldText.mid(prefixLen, oldText.length()-prefixLen-suffixLen)),
+                         SelectionMode::Normal);
     mDocument->putLine(line-1,lineText);
 }
 
+BufferCoord QSynEdit::doReplaceLineChange(PUndoItem item, QString &replacedText)
+{
+    //text between changeStartPos and changeEndPos is replaced by the item's text
+    BufferCoord startPos = item->changeStartPos();
+    BufferCoord endPos = item->changeEndPos();
+    QString text = item->changeText()[0];
+    QString line = mDocument->getLine(startPos.line-1);
+    replacedText = line.mid(startPos.ch-1, endPos.ch-startPos.ch);
+    mDocument->putLine(startPos.line-1,
+                       line.left(startPos.ch-1) + text + line.mid(endPos.ch-1));
+    return BufferCoord{startPos.ch+text.length(), startPos.line};
+}
+
+bool QSynEdit::replaceLines(int startLine, int endLine, const QStringList &newLines)
+{
+    startLine = std::max(1, startLine);
+    endLine = std::min(endLine, mDocument->count());
+    QStringList oldLines;
+    for (int i=startLine;i<=endLine;i++)
+        oldLines.append(mDocument->getLine(i-1));
+    QList<LineDiffHunk> hunks = diffLines(oldLines, newLines);
+    if (hunks.isEmpty())
+        return false;
+    beginEditing();
+    auto action = finally([this](){
+        endEditing();
+    });
+    // from bottom to top, so line numbers of the hunks before are not changed
+    for (int i=hunks.count()-1;i>=0;i--) {
+        const LineDiffHunk& hunk = hunks[i];
+        int line = startLine + hunk.oldStart;
+        int replaced = std::min(hunk.oldCount, hunk.newCount);
+        for (int j=0;j<replaced;j++) {
+            replaceLine(line+j, newLines[hunk.newStart+j]);
+        }
+        if (hunk.oldCount > replaced)
+            doDeleteLines(line+replaced, hunk.oldCount-replaced);
+        else if (hunk.newCount > replaced)
+            doInsertLines(line+replaced, newLines.mid(hunk.newStart+replaced, hunk.newCount-replaced));
+    }
+    return true;
+}
+
+void QSynEdit::formatLines(int startLine, int endLine)
+{
+    if (!mFormatter)
+        return;
+    beginEditing();
+    auto action = finally([this](){
+        endEditing();
+    });
+    mFormatter->formatLines(startLine, endLine, this);
+}
+
 BufferCoord QSynEdit::blockBegin() const
 {
     if (mActiveSelectionMode==SelectionMode::Column)
@@ -6793,6 +7526,8 @@ void QSynEdit::setLeftPos(int value)
     //QRect iTextArea;
     //value = std::min(value,maxScrollWidth());
     value = std::max(value, 0);
+    if (wordWrap())
+        value = 0;
     if (value != mLeftPos) {
         if (mDocument->maxLineWidth()<0)
             mLeftPos = value;
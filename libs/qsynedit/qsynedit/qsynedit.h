@@ -18,14 +18,18 @@
 #define QSYNEDIT_H
 
 #include <QAbstractScrollArea>
+#include <QCache>
 #include <QCursor>
 #include <QDateTime>
 #include <QFrame>
+#include <QStaticText>
 #include <QStringList>
 #include <QTimer>
+#include <QVector>
 #include <QWidget>
 #include "gutter.h"
 #include "codefolding.h"
+#include "wordwrap.h"
 #include "types.h"
 #include "keystrokes.h"
 #include "searcher/baseseacher.h"
@@ -98,6 +102,7 @@ enum class EditorOption {
     ShowInnerSpaces =       0x00800000,
     ShowLineBreaks =        0x01000000,
     ForceMonospace =        0x02000000,
+    WordWrap =              0x04000000, //Soft wrap long lines at the right edge of the view
 };
 
 Q_DECLARE_FLAGS(EditorOptions, EditorOption)
@@ -138,6 +143,8 @@ class TokenAttribute;
 using PTokenAttribute = std::shared_ptr<TokenAttribute>;
 class Document;
 using PDocument = std::shared_ptr<Document>;
+class GlyphWidthTable;
+using PGlyphWidthTable = std::shared_ptr<GlyphWidthTable>;
 struct SyntaxState;
 class Syntaxer;
 using PSyntaxer = std::shared_ptr<Syntaxer>;
@@ -145,6 +152,8 @@ class UndoList;
 class RedoList;
 using PUndoList = std::shared_ptr<UndoList>;
 using PRedoList = std::shared_ptr<RedoList>;
+class UndoItem;
+using PUndoItem = std::shared_ptr<UndoItem>;
 
 class QSynEdit : public QAbstractScrollArea
 {
@@ -205,7 +214,10 @@ public:
     int stringWidth(const QString& line, int left) const;
     int getLineIndent(const QString& line) const;
     int rowToLine(int aRow) const;
+    int rowToLine(int row, int& rowInLine) const;
     int lineToRow(int aLine) const;
+    int lineRowCount(int line) const;
+    int rowStartX(int line, int rowInLine) const;
     int foldRowToLine(int row) const;
     int foldLineToRow(int line) const;
     void setDefaultKeystrokes();
@@ -247,6 +259,16 @@ public:
 
     bool inputMethodOn();
 
+    //Multiple carets
+    //The primary caret is caretXY(); extra carets have no selection and are kept sorted.
+    //Edits typed with extra carets are applied at all carets in one undo block,
+    //with one reparse and one repaint.
+    bool hasExtraCarets() const;
+    const QVector<BufferCoord>& extraCarets() const;
+    void addExtraCaret(const BufferCoord& pos);
+    void setExtraCarets(const QVector<BufferCoord>& carets);
+    void clearExtraCarets();
+
     void collapseAll();
     void unCollpaseAll();
     void uncollapseAroundLine(int line);
@@ -255,6 +277,13 @@ public:
     void setSelText(const QString& text);
 
     void replaceLine(int line, const QString& lineText);
+    /**
+     * Replace lines [startLine, endLine] with newLines, but only edit the lines
+     * that are really changed.
+     * @return false if nothing changed
+     */
+    bool replaceLines(int startLine, int endLine, const QStringList& newLines);
+    void formatLines(int startLine, int endLine);
     int searchReplace(const QString& sSearch, const QString& sReplace, SearchOptions options,
                PSynSearchBase searchEngine,  SearchMathedProc matchedCallback = nullptr,
                       SearchConfirmAroundProc confirmAroundCallback = nullptr);
@@ -366,6 +395,10 @@ public:
     bool useCodeFolding() const;
     void setUseCodeFolding(bool value);
 
+    bool wordWrap() const {
+        return mOptions.testFlag(EditorOption::WordWrap);
+    }
+
     CodeFoldingOptions & codeFolding();
 
     QString displayLineText();
@@ -414,6 +447,10 @@ public:
     bool canUndo() const;
     bool canRedo() const;
 
+    // max bytes used by the undo history, 0 means no limit
+    size_t undoMemoryLimit() const;
+    void setUndoMemoryLimit(size_t bytes);
+
     int textHeight() const;
 
     const QColor &selectedForeground() const;
@@ -476,6 +513,7 @@ protected:
          QColor& foreground, QColor& backgroundColor) ;
     virtual void onGetEditingAreas(int Line, EditingAreaList& areaList);
     virtual void onGutterGetText(int aLine, QString& aText);
+    virtual void onGutterGetBackground(int aLine, QColor& color);
     virtual void onGutterPaint(QPainter& painter, int aLine, int X, int Y);
     virtual void onPaint(QPainter& painter);
     virtual void onPreparePaintHighlightToken(int line,
@@ -508,6 +546,8 @@ private:
     void computeScroll(bool isDragging);
 
     void synFontChanged();
+    // width table of the editor font in the given style (only bold and italic matter)
+    const PGlyphWidthTable& glyphWidthTable(FontStyles style) const;
 
     void doSetSelText(const QString& value);
 
@@ -537,6 +577,10 @@ private:
     void foldOnLinesDeleted(int Line, int Count);
     void foldOnListCleared();
     void rescanFolds(); // rescan for folds
+    int wrapWidth() const;
+    void invalidateDisplayRows();
+    void ensureDisplayRowIndex() const;
+    void updateDisplayRowsOfLine(int line) const;
     void rescanForFoldRanges();
     void scanForFoldRanges(PCodeFoldingRanges topFoldRanges);
     void findSubFoldRange(PCodeFoldingRanges topFoldRanges,PCodeFoldingRanges& parentFoldRanges, PCodeFoldingRange Parent);
@@ -550,6 +594,7 @@ private:
     PCodeFoldingRange checkFoldRange(PCodeFoldingRanges foldRangesToCheck,int line, bool wantCollapsed, bool AcceptFromLine, bool AcceptToLine);
     PCodeFoldingRange foldEndAtLine(int line);
     void paintCaret(QPainter& painter, const QRect rcClip);
+    void paintExtraCarets(QPainter& painter, const QRect& rcClip);
     int textOffset() const;
     EditCommand TranslateKeyCode(int key, Qt::KeyboardModifiers modifiers);
     /**
@@ -580,6 +625,16 @@ private:
     void doInsertText(const BufferCoord& pos, const QStringList& text, SelectionMode mode, int startLine, int endLine);
     int doInsertTextByNormalMode(const BufferCoord& pos, const QStringList& text, BufferCoord &newPos);
     int doInsertTextByColumnMode(const BufferCoord& pos, const QStringList& text, int startLine, int endLine);
+    void doDeleteLines(int line, int count);
+    void doInsertLines(int line, const QStringList& lines);
+    BufferCoord doReplaceLineChange(PUndoItem item, QString& replacedText);
+
+    //multiple carets
+    BufferCoord validCaretPos(const BufferCoord& pos) const;
+    bool executeMultiCaretCommand(EditCommand command, QChar ch, void* pData);
+    void doMultiCaretEdit(EditCommand command, const QString& text);
+    void moveExtraCarets(EditCommand command);
+    void doAddCaretVert(int deltaY);
 
     void doTrimTrailingSpaces();
     void deleteFromTo(const BufferCoord& start, const BufferCoord& end);
@@ -665,8 +720,16 @@ private slots:
 private:
     std::shared_ptr<QImage> mContentImage;
     PCodeFoldingRanges mAllFoldRanges;
+    mutable CollapsedFoldsIndex mCollapsedFoldsIndex;
+    mutable DisplayRowIndex mDisplayRowIndex;
+    mutable bool mDisplayRowIndexValid;
+    mutable int mDisplayRowFoldsGeneration;
+    mutable int mDisplayRowWrapWidth;
     CodeFoldingOptions mCodeFolding;
     int mEditingCount;
+    // lines (0-based) reparsed while editing without undo, -1 if none
+    int mEditingFirstLine;
+    int mEditingLastLine;
     bool mUseCodeFolding;
     bool  mAlwaysShowCaret;
     BufferCoord mBlockBegin;
@@ -750,7 +813,19 @@ private:
     int mWheelAccumulatedDeltaY;
 
     PFormatter mFormatter;
+
+    QVector<BufferCoord> mExtraCarets;
+    int mBatchEditCount; // >0 while editing at multiple carets, reparse/repaint of putted lines is deferred
+    bool mBatchRowsChanged;
+
     GlyphPostionsListCache mGlyphPostionCacheForInputMethod;
+    // laid out texts drawn by the painter, keyed by font key + text
+    QCache<QString,QStaticText> mStaticTextCache;
+    // keeps the shared width tables of the styled fonts alive while the editor uses them
+    // indexed by (bold ? 1 : 0) + (italic ? 2 : 0)
+    mutable PGlyphWidthTable mGlyphWidthTables[4];
+    // tokens generation of the syntaxer when the line tokens are cached
+    int mLineTokensGeneration;
 
 friend class QSynEditPainter;
 
@@ -183,6 +183,7 @@ void ASMSyntaxer::setATT(bool newATT)
     if (mATT!=newATT) {
         mATT = newATT;
         mKeywordsCache.clear();
+        invalidateTokens();
     }
 }
 
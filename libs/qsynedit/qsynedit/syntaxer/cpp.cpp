@@ -1442,6 +1442,7 @@ const QSet<QString> &CppSyntaxer::customTypeKeywords() const
 void CppSyntaxer::setCustomTypeKeywords(const QSet<QString> &newCustomTypeKeywords)
 {
     mCustomTypeKeywords = newCustomTypeKeywords;
+    invalidateTokens();
 }
 
 bool CppSyntaxer::supportBraceLevel()
@@ -966,6 +966,7 @@ void LuaSyntaxer::setUseXMakeLibs(bool newUseXMakeLibs)
     if (mUseXMakeLibs!=newUseXMakeLibs) {
         mKeywordsCache.clear();
         mUseXMakeLibs = newUseXMakeLibs;
+        invalidateTokens();
     }
 }
 
@@ -1003,6 +1004,7 @@ void LuaSyntaxer::setCustomTypeKeywords(const QSet<QString> &newCustomTypeKeywor
 {
     mCustomTypeKeywords = newCustomTypeKeywords;
     mKeywordsCache.clear();
+    invalidateTokens();
 }
 
 bool LuaSyntaxer::supportBraceLevel()
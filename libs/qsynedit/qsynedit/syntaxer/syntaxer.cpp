@@ -19,7 +19,8 @@
 
 namespace QSynedit {
 Syntaxer::Syntaxer() :
-    mWordBreakChars{ WordBreakChars }
+    mWordBreakChars{ WordBreakChars },
+    mTokensGeneration{0}
 {
     mCommentAttribute = std::make_shared<TokenAttribute>(SYNS_AttrComment,
                                                                TokenType::Comment);
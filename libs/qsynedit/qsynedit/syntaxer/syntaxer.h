@@ -177,6 +177,9 @@ public:
 
     virtual bool supportFolding() = 0;
     virtual bool needsLineState() = 0;
+    // Changes when the same text would be split into different tokens
+    // (e.g. the keyword sets are changed), so cached tokens must be dropped.
+    int tokensGeneration() const { return mTokensGeneration; }
 
 
 protected:
@@ -190,10 +193,12 @@ protected:
     void addAttribute(PTokenAttribute attribute) { mAttributes[attribute->name()]=attribute; }
     void clearAttributes() { mAttributes.clear(); }
     virtual int attributesCount() const { return mAttributes.size(); }
+    void invalidateTokens() { mTokensGeneration++; }
 
 private:
     QMap<QString,PTokenAttribute> mAttributes;
     QSet<QChar> mWordBreakChars;
+    int mTokensGeneration;
 };
 
 using PSyntaxer = std::shared_ptr<Syntaxer>;
@@ -0,0 +1,232 @@
+/*
+ * Copyright (C) 2020-2022 Roy Qu (royqh1979@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "wordwrap.h"
+#include <algorithm>
+#include <climits>
+
+namespace QSynedit {
+
+DisplayRowIndex::DisplayRowIndex():
+    mRowCount{0}
+{
+
+}
+
+void DisplayRowIndex::clear()
+{
+    mLines.clear();
+    mTree.clear();
+    mRowCount = 0;
+}
+
+void DisplayRowIndex::insertLines(int line, int count)
+{
+    if (count<=0)
+        return;
+    line = std::max(1, std::min(line, mLines.count()+1));
+    mLines.insert(line-1, count, LineRows());
+    rebuildTree();
+}
+
+void DisplayRowIndex::deleteLines(int line, int count)
+{
+    if (line<1 || line>mLines.count())
+        return;
+    count = std::min(count, mLines.count()-line+1);
+    if (count<=0)
+        return;
+    mLines.remove(line-1, count);
+    rebuildTree();
+}
+
+void DisplayRowIndex::setLineBreaks(int line, const QVector<int> &breakChars, const QVector<int> &breakPositions)
+{
+    if (line<1 || line>mLines.count())
+        return;
+    LineRows& lineRows = mLines[line-1];
+    int oldRows = rowsOf(lineRows);
+    lineRows.breakChars = breakChars;
+    lineRows.breakPositions = breakPositions;
+    int newRows = rowsOf(lineRows);
+    if (newRows!=oldRows)
+        addRows(line, newRows - oldRows);
+}
+
+void DisplayRowIndex::setHiddenRanges(const QVector<int> &fromLines, const QVector<int> &toLines)
+{
+    for (LineRows& lineRows:mLines)
+        lineRows.hidden = false;
+    for (int i=0;i<fromLines.count() && i<toLines.count();i++) {
+        int last = std::min(toLines[i], mLines.count());
+        for (int line=std::max(fromLines[i]+1, 1);line<=last;line++)
+            mLines[line-1].hidden = true;
+    }
+    rebuildTree();
+}
+
+int DisplayRowIndex::rowToLine(int row, int &rowInLine) const
+{
+    rowInLine = 0;
+    if (row<1)
+        return row;
+    if (row>mRowCount)
+        return mLines.count() + row - mRowCount;
+    // find the first line whose rows (including rows before it) reach the row
+    int n = mLines.count();
+    int step = 1;
+    while (step*2<=n)
+        step*=2;
+    int line = 0;
+    int remain = row;
+    for (;step>0;step/=2) {
+        if (line+step<=n && mTree[line+step]<remain) {
+            line+=step;
+            remain-=mTree[line];
+        }
+    }
+    rowInLine = remain - 1;
+    return line + 1;
+}
+
+int DisplayRowIndex::lineToRow(int line) const
+{
+    if (line<1)
+        return line;
+    if (line>mLines.count())
+        return mRowCount + line - mLines.count();
+    int before = rowsBefore(line);
+    // hidden line is displayed at the (last) row of the fold start line
+    if (mLines[line-1].hidden)
+        return std::max(before, 1);
+    return before + 1;
+}
+
+int DisplayRowIndex::rowsOfLine(int line) const
+{
+    if (line<1 || line>mLines.count())
+        return 1;
+    return rowsOf(mLines[line-1]);
+}
+
+int DisplayRowIndex::rowInLine(int line, int ch) const
+{
+    if (line<1 || line>mLines.count())
+        return 0;
+    const LineRows& lineRows = mLines[line-1];
+    if (lineRows.hidden)
+        return 0;
+    return std::upper_bound(lineRows.breakChars.begin(), lineRows.breakChars.end(), ch)
+            - lineRows.breakChars.begin();
+}
+
+int DisplayRowIndex::rowStartChar(int line, int rowInLine) const
+{
+    if (line<1 || line>mLines.count() || rowInLine<=0)
+        return 0;
+    const LineRows& lineRows = mLines[line-1];
+    rowInLine = std::min(rowInLine, lineRows.breakChars.count());
+    return lineRows.breakChars[rowInLine-1];
+}
+
+int DisplayRowIndex::rowEndChar(int line, int rowInLine) const
+{
+    if (line<1 || line>mLines.count())
+        return INT_MAX;
+    const LineRows& lineRows = mLines[line-1];
+    if (rowInLine<0 || rowInLine>=lineRows.breakChars.count())
+        return INT_MAX;
+    return lineRows.breakChars[rowInLine];
+}
+
+int DisplayRowIndex::rowStartPosition(int line, int rowInLine) const
+{
+    if (line<1 || line>mLines.count() || rowInLine<=0)
+        return 0;
+    const LineRows& lineRows = mLines[line-1];
+    rowInLine = std::min(rowInLine, lineRows.breakPositions.count());
+    return lineRows.breakPositions[rowInLine-1];
+}
+
+int DisplayRowIndex::rowEndPosition(int line, int rowInLine) const
+{
+    if (line<1 || line>mLines.count())
+        return INT_MAX;
+    const LineRows& lineRows = mLines[line-1];
+    if (rowInLine<0 || rowInLine>=lineRows.breakPositions.count())
+        return INT_MAX;
+    return lineRows.breakPositions[rowInLine];
+}
+
+void DisplayRowIndex::calcLineBreaks(const QString &lineText, const QList<int> &glyphStartChars, const QList<int> &glyphStartPositions, int lineWidth, int wrapWidth, QVector<int> &breakChars, QVector<int> &breakPositions)
+{
+    breakChars.clear();
+    breakPositions.clear();
+    if (wrapWidth<=0 || lineWidth<=wrapWidth)
+        return;
+    int glyphCount = std::min(glyphStartChars.count(), glyphStartPositions.count());
+    int rowStartGlyph = 0;
+    int rowStartX = 0;
+    int wordStartGlyph = -1; // the glyph after the last space in the row
+    for (int i=0;i<glyphCount;i++) {
+        int glyphRight = (i+1<glyphCount) ? glyphStartPositions[i+1] : lineWidth;
+        if (glyphRight - rowStartX > wrapWidth && i > rowStartGlyph) {
+            int breakGlyph = (wordStartGlyph > rowStartGlyph) ? wordStartGlyph : i;
+            rowStartGlyph = breakGlyph;
+            rowStartX = glyphStartPositions[breakGlyph];
+            breakChars.append(glyphStartChars[breakGlyph]);
+            breakPositions.append(rowStartX);
+            wordStartGlyph = -1;
+        }
+        int ch = glyphStartChars[i];
+        if (ch < lineText.length() && (lineText[ch] == ' ' || lineText[ch] == '\t'))
+            wordStartGlyph = i + 1;
+    }
+}
+
+void DisplayRowIndex::rebuildTree()
+{
+    int n = mLines.count();
+    mTree.resize(n+1);
+    mTree[0] = 0;
+    mRowCount = 0;
+    for (int i=1;i<=n;i++) {
+        mTree[i] = rowsOf(mLines[i-1]);
+        mRowCount += mTree[i];
+    }
+    for (int i=1;i<=n;i++) {
+        int parent = i + (i & -i);
+        if (parent<=n)
+            mTree[parent] += mTree[i];
+    }
+}
+
+void DisplayRowIndex::addRows(int line, int delta)
+{
+    mRowCount += delta;
+    for (int i=line;i<mTree.count();i+=(i & -i))
+        mTree[i] += delta;
+}
+
+int DisplayRowIndex::rowsBefore(int line) const
+{
+    int sum = 0;
+    for (int i=line-1;i>0;i-=(i & -i))
+        sum += mTree[i];
+    return sum;
+}
+
+}
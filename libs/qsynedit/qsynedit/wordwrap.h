@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2020-2022 Roy Qu (royqh1979@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef WORDWRAP_H
+#define WORDWRAP_H
+#include <QList>
+#include <QString>
+#include <QVector>
+
+namespace QSynedit {
+
+/**
+ * @brief Index of the display rows when long lines are soft wrapped
+ *
+ * Each line is broken into one or more rows at the glyphs exceeding the wrap width.
+ * Lines hidden in collapsed folds have no rows.
+ * The row counts of the lines are kept in a fenwick tree, so rows and lines are mapped
+ * in O(log n), and the rows of an edited line are updated in O(log n).
+ *
+ * Lines are 1-based. Rows in a line (rowInLine) are 0-based.
+ */
+class DisplayRowIndex {
+public:
+    explicit DisplayRowIndex();
+    void clear();
+    int lineCount() const { return mLines.count(); }
+    int rowCount() const { return mRowCount; }
+
+    void insertLines(int line, int count);
+    void deleteLines(int line, int count);
+    void setLineBreaks(int line, const QVector<int>& breakChars, const QVector<int>& breakPositions);
+    /**
+     * @brief hide the lines in the collapsed folds
+     * @param fromLines start lines of the collapsed folds (not hidden)
+     * @param toLines end lines of the collapsed folds (hidden)
+     */
+    void setHiddenRanges(const QVector<int>& fromLines, const QVector<int>& toLines);
+
+    int rowToLine(int row, int& rowInLine) const;
+    int lineToRow(int line) const;
+    int rowsOfLine(int line) const;
+    /**
+     * @param ch char index in the line text (starting from 0)
+     * @return the row in the line which contains the char
+     */
+    int rowInLine(int line, int ch) const;
+    int rowStartChar(int line, int rowInLine) const; // starting from 0
+    int rowEndChar(int line, int rowInLine) const; // INT_MAX for the last row
+    int rowStartPosition(int line, int rowInLine) const; // in pixel
+    int rowEndPosition(int line, int rowInLine) const; // INT_MAX for the last row
+
+    /**
+     * @brief break a line into rows not wider than wrapWidth
+     *
+     * The line is broken after the last space in the row if possible.
+     *
+     * @param breakChars start char indice of the 2nd, 3rd ... rows
+     * @param breakPositions start positions of the 2nd, 3rd ... rows
+     */
+    static void calcLineBreaks(const QString& lineText,
+                               const QList<int>& glyphStartChars,
+                               const QList<int>& glyphStartPositions,
+                               int lineWidth, int wrapWidth,
+                               QVector<int>& breakChars,
+                               QVector<int>& breakPositions);
+private:
+    struct LineRows {
+        QVector<int> breakChars;
+        QVector<int> breakPositions;
+        bool hidden = false;
+    };
+    static int rowsOf(const LineRows& lineRows) {
+        return lineRows.hidden ? 0 : lineRows.breakChars.count() + 1;
+    }
+    void rebuildTree();
+    void addRows(int line, int delta);
+    int rowsBefore(int line) const;
+private:
+    QVector<LineRows> mLines;
+    QVector<int> mTree; // fenwick tree of the row counts, mTree[0] is not used
+    int mRowCount;
+};
+
+}
+#endif // WORDWRAP_H
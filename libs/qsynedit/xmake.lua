@@ -11,6 +11,7 @@ target("qsynedit")
         "qsynedit/miscprocs.cpp",
         "qsynedit/painter.cpp",
         "qsynedit/types.cpp",
+        "qsynedit/wordwrap.cpp",
         -- exporter
         "qsynedit/exporter/exporter.cpp",
         "qsynedit/exporter/htmlexporter.cpp",
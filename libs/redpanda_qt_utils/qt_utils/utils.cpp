@@ -16,6 +16,7 @@
  */
 #include "utils.h"
 #include <QApplication>
+#include <QBuffer>
 #include <QByteArray>
 #include <QDir>
 #include <QFile>
@@ -33,6 +34,7 @@
 #include <QScreen>
 #include <QDirIterator>
 #include <QTextEdit>
+#include <cstring>
 #ifdef Q_OS_WIN
 #include <QDirIterator>
 #include <QFont>
@@ -113,11 +115,141 @@ const QByteArray guessTextEncoding(const QByteArray& text){
 
 
 
+static const quint64 HighBitsOfBytes = 0x8080808080808080ULL;
+static const quint64 LowBitsOfBytes = 0x0101010101010101ULL;
+
+static inline quint64 loadBytesWord(const char* p) {
+    quint64 v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline bool wordHasNullByte(quint64 v) {
+    return ((v - LowBitsOfBytes) & ~v & HighBitsOfBytes) != 0;
+}
+
 bool isTextAllAscii(const QByteArray& text) {
-    for (QChar c:text) {
-        if (c.unicode()>127) {
+    const char* p = text.constData();
+    int size = text.size();
+    int i = 0;
+    for (;i+8<=size;i+=8) {
+        if (loadBytesWord(p+i) & HighBitsOfBytes)
             return false;
+    }
+    for (;i<size;i++) {
+        if ((unsigned char)p[i] > 127)
+            return false;
+    }
+    return true;
+}
+
+void scanTextContent(const QByteArray &text, bool &hasNull, bool &allAscii, bool &validUTF8)
+{
+    hasNull = false;
+    allAscii = true;
+    validUTF8 = true;
+    const char* data = text.constData();
+    const unsigned char* p = (const unsigned char*)data;
+    int size = text.size();
+    int i = 0;
+    while (i < size) {
+        // skip runs of ascii chars
+        while (i+8 <= size) {
+            quint64 v = loadBytesWord(data+i);
+            if (v & HighBitsOfBytes)
+                break;
+            if (wordHasNullByte(v)) {
+                hasNull = true;
+                return;
+            }
+            i += 8;
+        }
+        if (i >= size)
+            break;
+        unsigned char ch = p[i];
+        if (ch == 0) {
+            hasNull = true;
+            return;
+        }
+        if (ch < 0x80) {
+            i++;
+            continue;
+        }
+        allAscii = false;
+        if (!validUTF8) {
+            // only looking for '\0' now
+            i++;
+            continue;
+        }
+        int len;
+        unsigned char minNext = 0x80;
+        unsigned char maxNext = 0xBF;
+        if (ch >= 0xC2 && ch <= 0xDF) {
+            len = 2;
+        } else if (ch >= 0xE0 && ch <= 0xEF) {
+            len = 3;
+            if (ch == 0xE0)
+                minNext = 0xA0; // overlong
+            else if (ch == 0xED)
+                maxNext = 0x9F; // surrogates
+        } else if (ch >= 0xF0 && ch <= 0xF4) {
+            len = 4;
+            if (ch == 0xF0)
+                minNext = 0x90; // overlong
+            else if (ch == 0xF4)
+                maxNext = 0x8F; // > U+10FFFF
+        } else {
+            validUTF8 = false;
+            i++;
+            continue;
+        }
+        if (i + len > size || p[i+1] < minNext || p[i+1] > maxNext) {
+            validUTF8 = false;
+            i++;
+            continue;
         }
+        for (int j=2;j<len;j++) {
+            if ((p[i+j] & 0xC0) != 0x80) {
+                validUTF8 = false;
+                break;
+            }
+        }
+        i += validUTF8 ? len : 1;
+    }
+}
+
+bool isValidGB18030Content(const QByteArray &text)
+{
+    const char* data = text.constData();
+    const unsigned char* p = (const unsigned char*)data;
+    int size = text.size();
+    int i = 0;
+    while (i < size) {
+        while (i+8 <= size && !(loadBytesWord(data+i) & HighBitsOfBytes))
+            i += 8;
+        if (i >= size)
+            break;
+        unsigned char ch = p[i];
+        if (ch < 0x80) {
+            i++;
+            continue;
+        }
+        if (ch == 0x80 || ch == 0xFF || i+1 >= size)
+            return false;
+        unsigned char ch2 = p[i+1];
+        if ((ch2 >= 0x40 && ch2 <= 0x7E) || (ch2 >= 0x80 && ch2 <= 0xFE)) {
+            i += 2;
+        } else if (ch2 >= 0x30 && ch2 <= 0x39) {
+            // four bytes sequence
+            if (i+3 >= size)
+                return false;
+            unsigned char ch3 = p[i+2];
+            unsigned char ch4 = p[i+3];
+            if (ch3 < 0x81 || ch3 > 0xFE || ch4 < 0x30 || ch4 > 0x39)
+                return false;
+            i += 4;
+        } else
+            return false;
     }
     return true;
 }
@@ -305,7 +437,7 @@ void readFileToLines(const QString &fileName, QTextCodec *codec, LineProcessFunc
     }
 }
 
-static QStringList tryLoadFileByEncoding(QByteArray encodingName, QFile& file, bool* isOk) {
+static QStringList tryLoadFileByEncoding(QByteArray encodingName, QIODevice& file, bool* isOk) {
     QStringList result;
     *isOk=false;
     QTextCodec* codec = QTextCodec::codecForName(encodingName);
@@ -335,44 +467,59 @@ static QStringList tryLoadFileByEncoding(QByteArray encodingName, QFile& file, b
     return result;
 }
 
-QStringList readFileToLines(const QString &fileName)
+static QStringList loadLinesByDetectedEncoding(QIODevice& file)
 {
-    QFile file(fileName);
-    if (file.size()<=0)
-        return QStringList();
     QStringList result;
-    if (file.open(QFile::ReadOnly)) {
-        bool ok;
-        result = tryLoadFileByEncoding("UTF-8",file,&ok);
-        if (ok) {
-            return result;
-        }
+    bool ok;
+    result = tryLoadFileByEncoding("UTF-8",file,&ok);
+    if (ok) {
+        return result;
+    }
 
-        QByteArray realEncoding = pCharsetInfoManager->getDefaultSystemEncoding();
-        result = tryLoadFileByEncoding(realEncoding,file,&ok);
-        if (ok) {
-            return result;
+    QByteArray realEncoding = pCharsetInfoManager->getDefaultSystemEncoding();
+    result = tryLoadFileByEncoding(realEncoding,file,&ok);
+    if (ok) {
+        return result;
+    }
+    QList<PCharsetInfo> charsets = pCharsetInfoManager->findCharsetByLocale(pCharsetInfoManager->localeName());
+    if (!charsets.isEmpty()) {
+        QSet<QByteArray> encodingSet;
+        for (int i=0;i<charsets.size();i++) {
+            encodingSet.insert(charsets[i]->name);
         }
-        QList<PCharsetInfo> charsets = pCharsetInfoManager->findCharsetByLocale(pCharsetInfoManager->localeName());
-        if (!charsets.isEmpty()) {
-            QSet<QByteArray> encodingSet;
-            for (int i=0;i<charsets.size();i++) {
-                encodingSet.insert(charsets[i]->name);
-            }
-            encodingSet.remove(realEncoding);
-            foreach (const QByteArray& encodingName,encodingSet) {
-                if (encodingName == ENCODING_UTF8)
-                    continue;
-                result = tryLoadFileByEncoding("UTF-8",file,&ok);
-                if (ok) {
-                    return result;
-                }
+        encodingSet.remove(realEncoding);
+        foreach (const QByteArray& encodingName,encodingSet) {
+            if (encodingName == ENCODING_UTF8)
+                continue;
+            result = tryLoadFileByEncoding("UTF-8",file,&ok);
+            if (ok) {
+                return result;
             }
         }
     }
     return result;
 }
 
+QStringList readFileToLines(const QString &fileName)
+{
+    QFile file(fileName);
+    if (file.size()<=0)
+        return QStringList();
+    if (file.open(QFile::ReadOnly))
+        return loadLinesByDetectedEncoding(file);
+    return QStringList();
+}
+
+QStringList readByteArrayToLines(const QByteArray &content)
+{
+    if (content.isEmpty())
+        return QStringList();
+    QBuffer buffer;
+    buffer.setData(content);
+    buffer.open(QBuffer::ReadOnly);
+    return loadLinesByDetectedEncoding(buffer);
+}
+
 QByteArray readFileToByteArray(const QString &fileName)
 {
     QFile file(fileName);
@@ -721,12 +868,7 @@ QStringList absolutePaths(const QString &dirPath, const QStringList &relativePat
 
 bool isBinaryContent(const QByteArray &text)
 {
-    for (char c:text) {
-        if (c==0) {
-            return true;
-        }
-    }
-    return false;
+    return memchr(text.constData(), 0, text.size()) != nullptr;
 }
 
 void clearQPlainTextEditFormat(QTextEdit *editor)
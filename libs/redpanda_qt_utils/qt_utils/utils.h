@@ -75,6 +75,20 @@ bool isBinaryContent(const QByteArray& text);
 bool isTextAllAscii(const QByteArray& text);
 bool isTextAllAscii(const QString& text);
 
+/**
+ * @brief check the raw bytes of a text file in one pass
+ *
+ * Runs of ascii bytes are checked 8 bytes at a time.
+ * The scan stops at the first '\0' (hasNull is set), the other results are
+ * not meaningful then.
+ */
+void scanTextContent(const QByteArray& text, bool& hasNull, bool& allAscii, bool& validUTF8);
+
+/**
+ * @brief check whether the bytes are well formed GB18030 (and so GBK/GB2312) multibyte sequences
+ */
+bool isValidGB18030Content(const QByteArray& text);
+
 bool isNonPrintableAsciiChar(char ch);
 
 using LineProcessFunc =  std::function<void(const QString&)>;
@@ -111,6 +125,8 @@ void readStreamToLines(QTextStream* stream, LineProcessFunc lineFunc);
  */
 QStringList readFileToLines(const QString& fileName, QTextCodec* codec);
 QStringList readFileToLines(const QString& fileName);
+// same as readFileToLines(fileName), but decodes content already read into memory
+QStringList readByteArrayToLines(const QByteArray& content);
 void readFileToLines(const QString& fileName, QTextCodec* codec, LineProcessFunc lineFunc);
 
 QByteArray readFileToByteArray(const QString& fileName);
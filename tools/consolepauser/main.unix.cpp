@@ -32,6 +32,8 @@ using std::vector;
 #include <sys/time.h>
 #include <sys/resource.h>
 #include <sys/wait.h>
+#include <stdint.h>
+#include <signal.h>
 #define MAX_COMMAND_LENGTH 32768
 #define MAX_ERROR_LENGTH 2048
 
@@ -40,6 +42,32 @@ enum RunProgramFlag {
     RPF_REDIRECT_INPUT =    0x0002
 };
 
+// Layout of the shared memory between Red Panda C++ and the console pauser.
+// Must be kept in sync with PauserSharedData in RedPandaIDE/compiler/executablerunner.cpp
+struct PauserSharedData {
+    char state[16];         // "FINISHED" after the program exits and the fields below are filled
+    // limits set by Red Panda C++, 0 means no limit
+    int64_t cpuTimeLimit;   // ms
+    int64_t memoryLimit;    // kb, limit of the address space
+    // statistics of the program
+    int64_t exitCode;
+    int64_t termSignal;     // signal that terminated the program, 0 if exited normally
+    int64_t wallTime;       // us
+    int64_t userTime;       // us
+    int64_t sysTime;        // us
+    int64_t peakMemory;     // kb
+    int64_t minorPageFaults;
+    int64_t majorPageFaults;
+    int64_t voluntaryContextSwitches;
+    int64_t involuntaryContextSwitches;
+};
+
+struct RunResult {
+    int exitCode;
+    int termSignal;
+    struct rusage usage;
+};
+
 
 void PauseExit(int exitcode, bool reInp) {
     if (reInp) {
@@ -86,10 +114,32 @@ string unescapeSpaces(const string& s) {
     return result;
 }
 
-int ExecuteCommand(vector<string>& command,bool reInp, long int &peakMemory) {
-    peakMemory = 0;
+void SetLimits(int64_t cpuTimeLimit, int64_t memoryLimit) {
+    struct rlimit limit;
+    if (cpuTimeLimit>0) {
+        // RLIMIT_CPU is in seconds; SIGXCPU is sent at the soft limit, SIGKILL at the hard one
+        limit.rlim_cur = (cpuTimeLimit + 999) / 1000;
+        limit.rlim_max = limit.rlim_cur + 1;
+        if (setrlimit(RLIMIT_CPU, &limit)!=0)
+            fprintf(stderr,"Failed to set cpu time limit: %s\n",strerror(errno));
+    }
+    if (memoryLimit>0) {
+        limit.rlim_cur = (rlim_t)memoryLimit * 1024;
+        limit.rlim_max = limit.rlim_cur;
+        if (setrlimit(RLIMIT_AS, &limit)!=0)
+            fprintf(stderr,"Failed to set memory limit: %s\n",strerror(errno));
+    }
+}
+
+int64_t TimevalToMicroseconds(const struct timeval& tv) {
+    return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+int ExecuteCommand(vector<string>& command,bool reInp, int64_t cpuTimeLimit, int64_t memoryLimit, RunResult &runResult) {
+    memset(&runResult, 0, sizeof(runResult));
     pid_t pid = fork();
     if (pid == 0) {
+        SetLimits(cpuTimeLimit, memoryLimit);
         string path_to_command;
         char * * argv;
         int command_begin;
@@ -137,18 +187,19 @@ int ExecuteCommand(vector<string>& command,bool reInp, long int &peakMemory) {
     } else {
         int status;
         pid_t w;
-        struct rusage usage;
-        w = wait4(pid, &status, WUNTRACED | WCONTINUED, &usage);
+        w = wait4(pid, &status, WUNTRACED | WCONTINUED, &runResult.usage);
         if (w==-1) {
             fprintf(stderr,"wait4 failed!");
             exit(EXIT_FAILURE);
         }
-        peakMemory = usage.ru_maxrss;
         if (WIFEXITED(status)) {
-            return WEXITSTATUS(status);
+            runResult.exitCode = WEXITSTATUS(status);
         } else {
-            return status;
+            if (WIFSIGNALED(status))
+                runResult.termSignal = WTERMSIG(status);
+            runResult.exitCode = status;
         }
+        return runResult.exitCode;
     }
     return 0;
 }
@@ -180,6 +231,7 @@ int main(int argc, char** argv) {
 
     int BUF_SIZE=1024;
     char* pBuf=nullptr;
+    PauserSharedData* pSharedData=nullptr;
     int fd_shm = shm_open(sharedMemoryId,O_RDWR,S_IRWXU);
     if (fd_shm==-1) {
         //todo: handle error
@@ -190,24 +242,49 @@ int main(int argc, char** argv) {
         if (pBuf == MAP_FAILED) {
             fprintf(stderr,"mmap failed %d:%s\n",errno,strerror(errno));
             pBuf = nullptr;
+        } else {
+            pSharedData = (PauserSharedData*)pBuf;
         }
     }
+    int64_t cpuTimeLimit = pSharedData ? pSharedData->cpuTimeLimit : 0;
+    int64_t memoryLimit = pSharedData ? pSharedData->memoryLimit : 0;
 
     // Save starting timestamp
     auto starttime = std::chrono::high_resolution_clock::now();
 
     // Execute the command
-    long int peakMemory;
-    int returnvalue = ExecuteCommand(command,reInp, peakMemory);
+    RunResult runResult;
+    int returnvalue = ExecuteCommand(command,reInp, cpuTimeLimit, memoryLimit, runResult);
 
     // Get ending timestamp
     auto endtime = std::chrono::high_resolution_clock::now();
     auto difftime = endtime - starttime;
-    auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(difftime);
-    double seconds = milliseconds.count()/1000.0;
+    auto microseconds = std::chrono::duration_cast<std::chrono::microseconds>(difftime);
+    double seconds = microseconds.count()/1000000.0;
+    int64_t userTime = TimevalToMicroseconds(runResult.usage.ru_utime);
+    int64_t sysTime = TimevalToMicroseconds(runResult.usage.ru_stime);
+#ifdef __APPLE__
+    long int peakMemory = runResult.usage.ru_maxrss / 1024; // bytes in macOS
+#else
+    long int peakMemory = runResult.usage.ru_maxrss;
+#endif
 
+    if (pSharedData) {
+        pSharedData->exitCode = runResult.exitCode;
+        pSharedData->termSignal = runResult.termSignal;
+        pSharedData->wallTime = microseconds.count();
+        pSharedData->userTime = userTime;
+        pSharedData->sysTime = sysTime;
+        pSharedData->peakMemory = peakMemory;
+        pSharedData->minorPageFaults = runResult.usage.ru_minflt;
+        pSharedData->majorPageFaults = runResult.usage.ru_majflt;
+        pSharedData->voluntaryContextSwitches = runResult.usage.ru_nvcsw;
+        pSharedData->involuntaryContextSwitches = runResult.usage.ru_nivcsw;
+        // make sure the statistics are visible before the state
+        __sync_synchronize();
+        strcpy(pSharedData->state,"FINISHED");
+    }
     if (pBuf) {
-        strcpy(pBuf,"FINISHED");
         munmap(pBuf,BUF_SIZE);
     }
     if (fd_shm!=-1) {
@@ -216,7 +293,11 @@ int main(int argc, char** argv) {
 
     // Done? Print return value of executed program
     printf("\n--------------------------------");
-    printf("\nProcess exited after %.4g seconds with return value %d, %ld KB mem used.\n",seconds,returnvalue,peakMemory);
+    printf("\nProcess exited after %.4g seconds with return value %d (%.4g ms cpu time, %ld KB mem used).\n",
+           seconds,returnvalue,(userTime+sysTime)/1000.0,peakMemory);
+    if (runResult.termSignal == SIGXCPU || (cpuTimeLimit>0 && runResult.termSignal == SIGKILL
+                                              && (userTime+sysTime)/1000 >= cpuTimeLimit))
+        printf("CPU time limit (%lld ms) exceeded.\n",(long long)cpuTimeLimit);
     if (pauseAfterExit)
         PauseExit(returnvalue,reInp);
     return 0;
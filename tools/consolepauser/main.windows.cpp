@@ -52,6 +52,26 @@ enum RunProgramFlag {
     RPF_ENABLE_VIRTUAL_TERMINAL_PROCESSING = 0x0004
 };
 
+// Layout of the shared memory between Red Panda C++ and the console pauser.
+// Must be kept in sync with PauserSharedData in RedPandaIDE/compiler/executablerunner.cpp
+struct PauserSharedData {
+    char state[16];         // "FINISHED" after the program exits and the fields below are filled
+    // limits set by Red Panda C++, 0 means no limit
+    LONGLONG cpuTimeLimit;  // ms
+    LONGLONG memoryLimit;   // kb
+    // statistics of the program
+    LONGLONG exitCode;
+    LONGLONG termSignal;    // always 0 in windows
+    LONGLONG wallTime;      // us
+    LONGLONG userTime;      // us
+    LONGLONG sysTime;       // us
+    LONGLONG peakMemory;    // kb
+    LONGLONG minorPageFaults;
+    LONGLONG majorPageFaults;
+    LONGLONG voluntaryContextSwitches;
+    LONGLONG involuntaryContextSwitches;
+};
+
 HANDLE hJob;
 bool enableJobControl = IsWindowsXPOrGreater();
 
@@ -134,7 +154,14 @@ string GetCommand(int argc,char** argv,bool &reInp, bool &enableVisualTerminalSe
     return result;
 }
 
-DWORD ExecuteCommand(string& command,bool reInp, LONGLONG &peakMemory, LONGLONG &execTime) {
+LONGLONG FileTimeToMicroseconds(const FILETIME& fileTime) {
+    ULARGE_INTEGER value;
+    value.LowPart = fileTime.dwLowDateTime;
+    value.HighPart = fileTime.dwHighDateTime;
+    return value.QuadPart / 10; // in 100ns
+}
+
+DWORD ExecuteCommand(string& command,bool reInp, LONGLONG &peakMemory, LONGLONG &userTime, LONGLONG &sysTime, LONGLONG &pageFaults) {
     STARTUPINFOA si;
     PROCESS_INFORMATION pi;
 
@@ -162,21 +189,23 @@ DWORD ExecuteCommand(string& command,bool reInp, LONGLONG &peakMemory, LONGLONG
     WaitForSingleObject(pi.hProcess, INFINITE); // Wait for it to finish
 
     peakMemory = 0;
+    pageFaults = 0;
     PROCESS_MEMORY_COUNTERS counter;
     counter.cb = sizeof(counter);
     if (GetProcessMemoryInfo(pi.hProcess,&counter,
                                  sizeof(counter))){
         peakMemory = counter.PeakPagefileUsage/1024;
+        pageFaults = counter.PageFaultCount;
     }
     FILETIME creationTime;
     FILETIME exitTime;
-    FILETIME kernelTime;
-    FILETIME userTime;
-    execTime=0;
-    if (GetProcessTimes(pi.hProcess,&creationTime,&exitTime,&kernelTime,&userTime)) {
-        execTime=((LONGLONG)kernelTime.dwHighDateTime<<32)
-                +((LONGLONG)userTime.dwHighDateTime<<32)
-                +(kernelTime.dwLowDateTime)+(userTime.dwLowDateTime);
+    FILETIME kernelFileTime;
+    FILETIME userFileTime;
+    userTime=0;
+    sysTime=0;
+    if (GetProcessTimes(pi.hProcess,&creationTime,&exitTime,&kernelFileTime,&userFileTime)) {
+        userTime = FileTimeToMicroseconds(userFileTime);
+        sysTime = FileTimeToMicroseconds(kernelFileTime);
     }
     DWORD result = 0;
     GetExitCodeProcess(pi.hProcess, &result);
@@ -220,6 +249,28 @@ int main(int argc, char** argv) {
     // Then build the to-run application command
     string command = GetCommand(argc, argv, reInp, enableVisualTerminalSeq);
 
+    HANDLE hSharedMemory=INVALID_HANDLE_VALUE;
+    int BUF_SIZE=1024;
+    char* pBuf=nullptr;
+    hSharedMemory = OpenFileMappingA(
+        FILE_MAP_ALL_ACCESS,
+        FALSE,
+        sharedMemoryId
+        );
+    if (hSharedMemory != NULL)
+    {
+        pBuf = (char*) MapViewOfFile(hSharedMemory,   // handle to map object
+            FILE_MAP_ALL_ACCESS, // read/write permission
+            0,
+            0,
+            BUF_SIZE);
+//    } else {
+//        printf("can't open shared memory!\n");
+    }
+    PauserSharedData* pSharedData = (PauserSharedData*)pBuf;
+    LONGLONG cpuTimeLimit = pSharedData ? pSharedData->cpuTimeLimit : 0;
+    LONGLONG memoryLimit = pSharedData ? pSharedData->memoryLimit : 0;
+
     if (enableJobControl) {
         hJob= CreateJobObject( &sa, NULL );
 
@@ -231,6 +282,14 @@ int main(int argc, char** argv) {
         JOBOBJECT_EXTENDED_LIMIT_INFORMATION info;
         memset(&info,0,sizeof(JOBOBJECT_EXTENDED_LIMIT_INFORMATION));
         info.BasicLimitInformation.LimitFlags = JOB_OBJECT_LIMIT_KILL_ON_JOB_CLOSE;
+        if (cpuTimeLimit>0) {
+            info.BasicLimitInformation.LimitFlags |= JOB_OBJECT_LIMIT_PROCESS_TIME;
+            info.BasicLimitInformation.PerProcessUserTimeLimit.QuadPart = cpuTimeLimit * 10000; // in 100ns
+        }
+        if (memoryLimit>0) {
+            info.BasicLimitInformation.LimitFlags |= JOB_OBJECT_LIMIT_PROCESS_MEMORY;
+            info.ProcessMemoryLimit = memoryLimit * 1024;
+        }
         WINBOOL bSuccess = SetInformationJobObject( hJob, JobObjectExtendedLimitInformation, &info, sizeof( info ) );
         if ( bSuccess == FALSE ) {
             printf( "SetInformationJobObject failed: error %lu\n", GetLastError() );
@@ -258,40 +317,38 @@ int main(int argc, char** argv) {
         EnableVtSequence();
     }
 
-    HANDLE hSharedMemory=INVALID_HANDLE_VALUE;
-    int BUF_SIZE=1024;
-    char* pBuf=nullptr;
-    hSharedMemory = OpenFileMappingA(
-        FILE_MAP_ALL_ACCESS,
-        FALSE,
-        sharedMemoryId
-        );
-    if (hSharedMemory != NULL)
-    {
-        pBuf = (char*) MapViewOfFile(hSharedMemory,   // handle to map object
-            FILE_MAP_ALL_ACCESS, // read/write permission
-            0,
-            0,
-            BUF_SIZE);
-//    } else {
-//        printf("can't open shared memory!\n");
-    }
 
     // Save starting timestamp
     LONGLONG starttime = GetClockTick();
 
     LONGLONG peakMemory=0;
-    LONGLONG execTime=0;
+    LONGLONG userTime=0;
+    LONGLONG sysTime=0;
+    LONGLONG pageFaults=0;
     // Then execute said command
-    DWORD returnvalue = ExecuteCommand(command,reInp,peakMemory,execTime);
+    DWORD returnvalue = ExecuteCommand(command,reInp,peakMemory,userTime,sysTime,pageFaults);
 
     // Get ending timestamp
     LONGLONG endtime = GetClockTick();
     double seconds = (endtime - starttime) / (double)GetClockFrequency();
-    double execSeconds = (double)execTime/10000;
-
+    double execSeconds = (userTime + sysTime) / 1000.0;
+
+    if (pSharedData) {
+        pSharedData->exitCode = returnvalue;
+        pSharedData->termSignal = 0;
+        pSharedData->wallTime = (LONGLONG)(seconds * 1000000);
+        pSharedData->userTime = userTime;
+        pSharedData->sysTime = sysTime;
+        pSharedData->peakMemory = peakMemory;
+        // windows doesn't distinguish soft/hard page faults, nor count context switches
+        pSharedData->minorPageFaults = pageFaults;
+        pSharedData->majorPageFaults = 0;
+        pSharedData->voluntaryContextSwitches = 0;
+        pSharedData->involuntaryContextSwitches = 0;
+        MemoryBarrier();
+        strcpy(pSharedData->state,"FINISHED");
+    }
     if (pBuf) {
-        strcpy(pBuf,"FINISHED");
         UnmapViewOfFile(pBuf);
     }
     if (hSharedMemory != NULL && hSharedMemory!=INVALID_HANDLE_VALUE) {
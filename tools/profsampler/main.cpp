@@ -0,0 +1,194 @@
+/*
+ *  This file is part of Red Panda C++
+ *  Copyright (C) 2020-2022 Roy Qu (royqh1979@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * A minimal sampling profiler, loaded into the profiled program by LD_PRELOAD.
+ *
+ * The program counter is sampled on each SIGPROF (setitimer(ITIMER_PROF)).
+ * Samples inside the main executable are counted by their address relative
+ * to the executable's load bias (so they can be symbolized by addr2line even
+ * for PIE executables), and are written to $REDPANDA_PROFILE_OUTPUT when the
+ * program exits.
+ */
+
+#include <errno.h>
+#include <link.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+#define PROFILE_OUTPUT_ENV "REDPANDA_PROFILE_OUTPUT"
+#define PROFILE_INTERVAL_ENV "REDPANDA_PROFILE_INTERVAL"
+#define DEFAULT_INTERVAL 1000 // us
+#define SAMPLE_TABLE_SIZE 65536 // must be power of 2
+#define MAX_TEXT_SEGMENTS 16
+#define MAX_PATH_LENGTH 4096
+
+struct SampleSlot {
+    uintptr_t address; // relative to load bias, 0 if the slot is not used
+    unsigned long count;
+};
+
+struct TextSegment {
+    uintptr_t start;
+    uintptr_t end;
+};
+
+static SampleSlot sampleTable[SAMPLE_TABLE_SIZE];
+static unsigned long totalSamples;
+static unsigned long otherSamples; // samples not in the main executable
+static unsigned long droppedSamples; // sample table is full
+static uintptr_t loadBias;
+static TextSegment textSegments[MAX_TEXT_SEGMENTS];
+static int textSegmentCount;
+static long samplingInterval;
+static pid_t ownerPid;
+static char outputFilename[MAX_PATH_LENGTH];
+
+static uintptr_t GetProgramCounter(void* context) {
+    ucontext_t* uc = (ucontext_t*)context;
+#if defined(__x86_64__)
+    return uc->uc_mcontext.gregs[REG_RIP];
+#elif defined(__i386__)
+    return uc->uc_mcontext.gregs[REG_EIP];
+#elif defined(__aarch64__)
+    return uc->uc_mcontext.pc;
+#elif defined(__riscv)
+    return uc->uc_mcontext.__gregs[REG_PC];
+#elif defined(__loongarch__)
+    return uc->uc_mcontext.__pc;
+#else
+    (void)uc;
+    return 0;
+#endif
+}
+
+static bool InMainExecutable(uintptr_t pc) {
+    for (int i=0;i<textSegmentCount;i++) {
+        if (pc>=textSegments[i].start && pc<textSegments[i].end)
+            return true;
+    }
+    return false;
+}
+
+// Must be async-signal-safe: only touches the preallocated table with atomic operations.
+static void OnSigProf(int, siginfo_t*, void* context) {
+    int savedErrno = errno;
+    __sync_fetch_and_add(&totalSamples, 1);
+    uintptr_t pc = GetProgramCounter(context);
+    if (pc==0 || !InMainExecutable(pc)) {
+        __sync_fetch_and_add(&otherSamples, 1);
+        errno = savedErrno;
+        return;
+    }
+    uintptr_t address = pc - loadBias;
+    size_t index = (size_t)((address >> 1) * 2654435761u);
+    for (size_t i=0;i<SAMPLE_TABLE_SIZE;i++) {
+        SampleSlot* slot = &sampleTable[(index + i) & (SAMPLE_TABLE_SIZE - 1)];
+        if (slot->address == 0)
+            __sync_bool_compare_and_swap(&slot->address, 0, address);
+        if (slot->address == address) {
+            __sync_fetch_and_add(&slot->count, 1);
+            errno = savedErrno;
+            return;
+        }
+    }
+    __sync_fetch_and_add(&droppedSamples, 1);
+    errno = savedErrno;
+}
+
+// The main executable is the first object reported by dl_iterate_phdr
+static int FindMainExecutable(struct dl_phdr_info *info, size_t, void *) {
+    loadBias = info->dlpi_addr;
+    for (int i=0;i<info->dlpi_phnum && textSegmentCount<MAX_TEXT_SEGMENTS;i++) {
+        const ElfW(Phdr)* phdr = &info->dlpi_phdr[i];
+        if (phdr->p_type == PT_LOAD && (phdr->p_flags & PF_X)) {
+            textSegments[textSegmentCount].start = info->dlpi_addr + phdr->p_vaddr;
+            textSegments[textSegmentCount].end = info->dlpi_addr + phdr->p_vaddr + phdr->p_memsz;
+            textSegmentCount++;
+        }
+    }
+    return 1;
+}
+
+__attribute__((constructor))
+static void StartSampler() {
+    const char* output = getenv(PROFILE_OUTPUT_ENV);
+    if (!output || !*output || strlen(output)>=MAX_PATH_LENGTH)
+        return;
+    strcpy(outputFilename, output);
+    // programs started by the profiled program must not overwrite the output
+    unsetenv(PROFILE_OUTPUT_ENV);
+
+    samplingInterval = DEFAULT_INTERVAL;
+    const char* interval = getenv(PROFILE_INTERVAL_ENV);
+    if (interval && atol(interval)>0)
+        samplingInterval = atol(interval);
+
+    dl_iterate_phdr(FindMainExecutable, NULL);
+    if (textSegmentCount == 0)
+        return;
+    ownerPid = getpid();
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_sigaction = OnSigProf;
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    if (sigaction(SIGPROF, &action, NULL) != 0) {
+        ownerPid = 0;
+        return;
+    }
+    struct itimerval timer;
+    timer.it_interval.tv_sec = samplingInterval / 1000000;
+    timer.it_interval.tv_usec = samplingInterval % 1000000;
+    timer.it_value = timer.it_interval;
+    if (setitimer(ITIMER_PROF, &timer, NULL) != 0)
+        ownerPid = 0;
+}
+
+__attribute__((destructor))
+static void StopSampler() {
+    // the timer is not inherited by forked children, and they must not write the output
+    if (ownerPid == 0 || getpid() != ownerPid)
+        return;
+    struct itimerval timer;
+    memset(&timer, 0, sizeof(timer));
+    setitimer(ITIMER_PROF, &timer, NULL);
+    signal(SIGPROF, SIG_IGN);
+
+    FILE* file = fopen(outputFilename, "w");
+    if (!file)
+        return;
+    fprintf(file, "redpanda-profile 1\n");
+    fprintf(file, "interval %ld\n", samplingInterval);
+    fprintf(file, "total %lu\n", totalSamples);
+    fprintf(file, "other %lu\n", otherSamples);
+    fprintf(file, "dropped %lu\n", droppedSamples);
+    for (size_t i=0;i<SAMPLE_TABLE_SIZE;i++) {
+        if (sampleTable[i].address != 0 && sampleTable[i].count > 0)
+            fprintf(file, "%lx %lu\n", (unsigned long)sampleTable[i].address, sampleTable[i].count);
+    }
+    fclose(file);
+}
@@ -0,0 +1,25 @@
+TEMPLATE = lib
+TARGET = redpanda-profsampler
+
+QT -= core gui
+
+CONFIG += c++11 plugin
+CONFIG -= qt
+
+isEmpty(APP_NAME) {
+    APP_NAME = RedPandaCPP
+}
+
+SOURCES += \
+    main.cpp
+
+isEmpty(PREFIX) {
+    PREFIX = /usr/local
+}
+isEmpty(LIBEXECDIR) {
+    LIBEXECDIR = $${PREFIX}/libexec
+}
+
+# Default rules for deployment.
+unix:!android: target.path = $${LIBEXECDIR}/$${APP_NAME}
+!isEmpty(target.path): INSTALLS += target
@@ -0,0 +1,8 @@
+target("redpanda-profsampler")
+    set_kind("shared")
+
+    add_files("main.cpp")
+
+    if is_xdg() then
+        on_install(install_libexec)
+    end
@@ -203,6 +203,9 @@ end
 includes("libs/qsynedit")
 includes("libs/redpanda_qt_utils")
 includes("tools/consolepauser")
+if is_os("linux") then
+    includes("tools/profsampler")
+end
 if has_config("vcs") then
     if is_os("windows") then
         includes("tools/redpanda-win-git-askpass")